@@ -0,0 +1,733 @@
+/*____________________________________________________________________
+|
+| File: asset_convert.cpp
+|
+| Description: Source file to asset pack entry conversions, used by the
+|   packer tool.
+|
+| Functions: AssetConvert_File
+|             Read_File
+|             Has_Extension
+|            AssetConvert_LWO2
+|             Read_VX
+|             Compare_Corners
+|            AssetConvert_LWO2_Triangles
+|            AssetConvert_File_Triangles
+|            AssetConvert_BMP
+|             Decode_BMP
+|            AssetConvert_WAV
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#include "asset_convert.h"
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define BE16(_p_) ((unsigned) (_p_)[0] << 8 | (unsigned) (_p_)[1])
+#define BE32(_p_) ((unsigned) (_p_)[0] << 24 | (unsigned) (_p_)[1] << 16 | (unsigned) (_p_)[2] << 8 | (unsigned) (_p_)[3])
+#define LE16(_p_) ((unsigned) (_p_)[0] | (unsigned) (_p_)[1] << 8)
+#define LE32(_p_) ((unsigned) (_p_)[0] | (unsigned) (_p_)[1] << 8 | (unsigned) (_p_)[2] << 16 | (unsigned) (_p_)[3] << 24)
+#define ID4(_p_,_id_) (memcmp ((_p_), (_id_), 4) == 0)
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+// One corner of a polygon, before corners with the same point and uv are merged into a vertex
+typedef struct {
+	int   point;
+	float u, v;
+	bool  has_uv;             // set by a per polygon uv (VMAD)
+	int   vertex;
+} LwoCorner;
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static unsigned char *Read_File (const char *file, size_t *size);
+static bool Has_Extension (const char *file, const char *ext);
+static int Read_VX (const unsigned char *p, const unsigned char *end, int *index);
+static int Compare_Corners (const void *a, const void *b);
+static bool Decode_BMP (const unsigned char *bmp, size_t size, unsigned char **pixels, unsigned *width, unsigned *height);
+
+/*___________________
+|
+| Global variables
+|__________________*/
+
+static const LwoCorner *Sort_Corners;   // corners being sorted by AssetConvert_LWO2()
+
+/*____________________________________________________________________
+|
+| Function: AssetConvert_File
+|
+| Input: Called from packer tool, headless driver
+| Output: Converts a source file (and its alpha file, for a texture).
+|   Returns true on success, else false.
+|___________________________________________________________________*/
+
+bool AssetConvert_File (const char *file, const char *alt_file, AssetPackEntry *entry, unsigned char **data)
+{
+	unsigned char *src, *alt = NULL;
+	size_t size, alt_size = 0;
+	bool ok = false;
+
+	memset (entry, 0, sizeof (AssetPackEntry));
+	*data = NULL;
+	if (!AssetPack_Normalize_Name (file, entry->name))
+		return (false);
+	src = Read_File (file, &size);
+	if (src == NULL)
+		return (false);
+	if (alt_file) {
+		alt = Read_File (alt_file, &alt_size);
+		if (alt == NULL) {
+			free (src);
+			return (false);
+		}
+	}
+
+	if (Has_Extension (file, ".lwo"))
+		ok = AssetConvert_LWO2 (src, size, entry, data);
+	else if (Has_Extension (file, ".bmp"))
+		ok = AssetConvert_BMP (src, size, alt, alt_size, entry, data);
+	else if (Has_Extension (file, ".wav"))
+		ok = AssetConvert_WAV (src, size, entry, data);
+	free (src);
+	free (alt);
+
+	return (ok);
+}
+
+/*____________________________________________________________________
+|
+| Function: Read_File
+|
+| Input: Called from AssetConvert_File(), AssetConvert_File_Triangles()
+| Output: Returns the contents of a file (size in size) or NULL on error.
+|   Caller must free the memory.
+|___________________________________________________________________*/
+
+static unsigned char *Read_File (const char *file, size_t *size)
+{
+	FILE *fp;
+	long length;
+	unsigned char *data = NULL;
+
+	*size = 0;
+	fp = fopen (file, "rb");
+	if (fp == NULL)
+		return (NULL);
+	if (fseek (fp, 0, SEEK_END) == 0 && (length = ftell (fp)) >= 0 && fseek (fp, 0, SEEK_SET) == 0) {
+		data = (unsigned char *) malloc (length + 1);
+		if (data && fread (data, 1, length, fp) != (size_t) length) {
+			free (data);
+			data = NULL;
+		}
+		if (data)
+			*size = length;
+	}
+	fclose (fp);
+
+	return (data);
+}
+
+/*____________________________________________________________________
+|
+| Function: Has_Extension
+|
+| Input: Called from AssetConvert_File()
+| Output: Returns true if file ends in ext, ignoring case.
+|___________________________________________________________________*/
+
+static bool Has_Extension (const char *file, const char *ext)
+{
+	size_t n = strlen (file), m = strlen (ext);
+
+	if (n < m)
+		return (false);
+	for (size_t i = 0; i < m; i++)
+		if (tolower ((unsigned char) file[n - m + i]) != ext[i])
+			return (false);
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetConvert_LWO2
+|
+| Input: Called from AssetConvert_File()
+| Output: Converts the polygons of every layer of a LightWave object to
+|   an indexed triangle list.  Polygons are split into fans, normals are
+|   smoothed over every polygon sharing a point, and texture coordinates
+|   come from the first uv map (v flipped so 0 is the top of the image),
+|   with per polygon uvs where the object has them.  Returns true on
+|   success, else false.
+|___________________________________________________________________*/
+
+bool AssetConvert_LWO2 (const unsigned char *lwo, size_t size, AssetPackEntry *entry, unsigned char **out)
+{
+	const unsigned char *p, *form_end;
+	float *points, *point_uv, *point_normal;
+	unsigned char *point_has_uv;
+	LwoCorner *corners;
+	int *poly_first, *poly_count, *order;
+	int num_points = 0, num_polys = 0, num_corners = 0;
+	int point_base = 0, poly_base = -1;
+	int max_points, max_polys, max_corners;
+	int num_vertices = 0, num_indices = 0;
+	char uv_map[64] = "";          // name of the uv map in use
+	bool ok = true;
+
+	if (size < 12 || !ID4 (lwo, "FORM") || !ID4 (lwo + 8, "LWO2"))
+		return (false);
+	form_end = lwo + 8 + BE32 (lwo + 4);
+	if (form_end > lwo + size)
+		form_end = lwo + size;
+
+	// Nothing in the file can have more of these than it has bytes for (a polygon
+	//   with no points is just its 2 byte count)
+	max_points = (int) (size / 12) + 1;
+	max_polys = (int) (size / 2) + 1;
+	max_corners = (int) (size / 2) + 1;
+	points = (float *) malloc (max_points * 3 * sizeof (float));
+	point_uv = (float *) malloc (max_points * 2 * sizeof (float));
+	point_normal = (float *) calloc (max_points * 3, sizeof (float));
+	point_has_uv = (unsigned char *) calloc (max_points, 1);
+	corners = (LwoCorner *) malloc (max_corners * sizeof (LwoCorner));
+	order = (int *) malloc (max_corners * sizeof (int));
+	poly_first = (int *) malloc (max_polys * sizeof (int));
+	poly_count = (int *) malloc (max_polys * sizeof (int));
+	if (!points || !point_uv || !point_normal || !point_has_uv || !corners || !order || !poly_first || !poly_count)
+		ok = false;
+
+	for (p = lwo + 12; ok && p + 8 <= form_end; ) {
+		const unsigned char *data = p + 8, *end;
+		if (BE32 (p + 4) > (size_t) (form_end - data)) {
+			ok = false;
+			break;
+		}
+		end = data + BE32 (p + 4);
+		if (ID4 (p, "PNTS")) {
+			// Later chunks index the points of the latest PNTS
+			point_base = num_points;
+			for (const unsigned char *q = data; q + 12 <= end; q += 12) {
+				for (int k = 0; k < 3; k++) {
+					unsigned bits = BE32 (q + 4 * k);
+					memcpy (&points[num_points * 3 + k], &bits, 4);
+				}
+				num_points++;
+			}
+		}
+		else if ((ID4 (p, "VMAP") || ID4 (p, "VMAD")) && end - data >= 6 && ID4 (data, "TXUV") && BE16 (data + 4) >= 2) {
+			bool per_poly = ID4 (p, "VMAD");
+			int dim = BE16 (data + 4);
+			const unsigned char *q = data + 6;
+			const char *name = (const char *) q;
+			size_t name_len = strnlen (name, end - q);
+			// Use only the first uv map
+			if (uv_map[0] == 0 && name_len < sizeof (uv_map))
+				strcpy (uv_map, name);
+			q += (name_len + 2) & ~(size_t) 1;
+			if (name_len < sizeof (uv_map) && strncmp (name, uv_map, name_len) == 0 && uv_map[name_len] == 0) {
+				while (q < end) {
+					int point, poly = 0, n;
+					float uv[2];
+					n = Read_VX (q, end, &point);
+					if (n == 0)
+						break;
+					q += n;
+					if (per_poly) {
+						n = Read_VX (q, end, &poly);
+						if (n == 0)
+							break;
+						q += n;
+					}
+					if (q + 4 * dim > end)
+						break;
+					for (int k = 0; k < 2; k++) {
+						unsigned bits = BE32 (q + 4 * k);
+						memcpy (&uv[k], &bits, 4);
+					}
+					q += 4 * dim;
+					point += point_base;
+					if (point >= num_points)
+						continue;
+					if (!per_poly) {
+						point_uv[point * 2] = uv[0];
+						point_uv[point * 2 + 1] = uv[1];
+						point_has_uv[point] = 1;
+					}
+					else if (poly_base >= 0 && poly_base + poly < num_polys) {
+						poly += poly_base;
+						for (int c = poly_first[poly]; c < poly_first[poly] + poly_count[poly]; c++)
+							if (corners[c].point == point) {
+								corners[c].u = uv[0];
+								corners[c].v = uv[1];
+								corners[c].has_uv = true;
+							}
+					}
+				}
+			}
+		}
+		else if (ID4 (p, "POLS") && end - data >= 4) {
+			// Only faces, not patches, bones or curves
+			poly_base = ID4 (data, "FACE") ? num_polys : -1;
+			for (const unsigned char *q = data + 4; poly_base >= 0 && q + 2 <= end; ) {
+				int count = BE16 (q) & 0x3FF;
+				q += 2;
+				poly_first[num_polys] = num_corners;
+				poly_count[num_polys] = 0;
+				for (int k = 0; k < count; k++) {
+					int point, n = Read_VX (q, end, &point);
+					if (n == 0 || point + point_base >= num_points) {
+						ok = false;
+						break;
+					}
+					q += n;
+					corners[num_corners].point = point + point_base;
+					corners[num_corners].has_uv = false;
+					num_corners++;
+				}
+				if (!ok)
+					break;
+				poly_count[num_polys++] = count;
+			}
+		}
+		p = end + ((end - data) & 1);
+	}
+
+	// Smooth normals: sum each polygon's area weighted normal into its points
+	for (int i = 0; ok && i < num_polys; i++) {
+		const float *v0;
+		float n[3] = { 0, 0, 0 };
+		if (poly_count[i] < 3)
+			continue;
+		v0 = &points[corners[poly_first[i]].point * 3];
+		for (int k = 1; k + 1 < poly_count[i]; k++) {
+			const float *v1 = &points[corners[poly_first[i] + k].point * 3];
+			const float *v2 = &points[corners[poly_first[i] + k + 1].point * 3];
+			float a[3] = { v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2] };
+			float b[3] = { v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2] };
+			n[0] += a[1] * b[2] - a[2] * b[1];
+			n[1] += a[2] * b[0] - a[0] * b[2];
+			n[2] += a[0] * b[1] - a[1] * b[0];
+		}
+		for (int k = 0; k < poly_count[i]; k++) {
+			int point = corners[poly_first[i] + k].point;
+			point_normal[point * 3] += n[0];
+			point_normal[point * 3 + 1] += n[1];
+			point_normal[point * 3 + 2] += n[2];
+		}
+		num_indices += (poly_count[i] - 2) * 3;
+	}
+
+	// Corners with the same point and uv become one vertex
+	for (int c = 0; ok && c < num_corners; c++) {
+		LwoCorner *corner = &corners[c];
+		if (!corner->has_uv) {
+			bool has = point_has_uv[corner->point] != 0;
+			corner->u = has ? point_uv[corner->point * 2] : 0;
+			corner->v = has ? point_uv[corner->point * 2 + 1] : 0;
+		}
+		order[c] = c;
+	}
+	if (ok) {
+		Sort_Corners = corners;
+		qsort (order, num_corners, sizeof (int), Compare_Corners);
+		for (int i = 0; i < num_corners; i++) {
+			if (i == 0 || Compare_Corners (&order[i - 1], &order[i]) != 0)
+				num_vertices++;
+			corners[order[i]].vertex = num_vertices - 1;
+		}
+	}
+
+	*out = NULL;
+	if (ok && num_indices) {
+		size_t vertex_bytes = (size_t) num_vertices * ASSET_PACK_VERTEX_FLOATS * sizeof (float);
+		*out = (unsigned char *) malloc (vertex_bytes + num_indices * sizeof (unsigned));
+		ok = *out != NULL;
+		if (ok) {
+			float *vertices = (float *) *out;
+			unsigned *indices = (unsigned *) (*out + vertex_bytes);
+			AssetPackMeshInfo *info = &entry->info.mesh;
+			int n = 0;
+
+			for (int i = 0; i < num_corners; i++) {
+				const LwoCorner *corner = &corners[order[i]];
+				float *vertex = &vertices[corner->vertex * ASSET_PACK_VERTEX_FLOATS];
+				const float *normal = &point_normal[corner->point * 3];
+				float length = sqrtf (normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+				if (length == 0)
+					length = 1;
+				memcpy (vertex, &points[corner->point * 3], 3 * sizeof (float));
+				vertex[3] = normal[0] / length;
+				vertex[4] = normal[1] / length;
+				vertex[5] = normal[2] / length;
+				vertex[6] = corner->u;
+				vertex[7] = 1 - corner->v;
+			}
+			for (int i = 0; i < num_polys; i++)
+				for (int k = 1; k + 1 < poly_count[i]; k++) {
+					indices[n++] = corners[poly_first[i]].vertex;
+					indices[n++] = corners[poly_first[i] + k].vertex;
+					indices[n++] = corners[poly_first[i] + k + 1].vertex;
+				}
+
+			entry->kind = ASSET_PACK_MESH;
+			entry->size = vertex_bytes + num_indices * sizeof (unsigned);
+			info->num_vertices = num_vertices;
+			info->num_indices = num_indices;
+			for (int k = 0; k < 3; k++) {
+				info->bound_min[k] = vertices[k];
+				info->bound_max[k] = vertices[k];
+			}
+			for (int i = 1; i < num_vertices; i++)
+				for (int k = 0; k < 3; k++) {
+					float x = vertices[i * ASSET_PACK_VERTEX_FLOATS + k];
+					if (x < info->bound_min[k])
+						info->bound_min[k] = x;
+					if (x > info->bound_max[k])
+						info->bound_max[k] = x;
+				}
+		}
+	}
+	else
+		ok = false;
+
+	free (points);
+	free (point_uv);
+	free (point_normal);
+	free (point_has_uv);
+	free (corners);
+	free (order);
+	free (poly_first);
+	free (poly_count);
+
+	return (ok);
+}
+
+/*____________________________________________________________________
+|
+| Function: Read_VX
+|
+| Input: Called from AssetConvert_LWO2(), AssetConvert_LWO2_Triangles()
+| Output: Reads a LightWave variable length index into index.  Returns
+|   the # of bytes it took, 0 if it runs past end.
+|___________________________________________________________________*/
+
+static int Read_VX (const unsigned char *p, const unsigned char *end, int *index)
+{
+	if (p + 2 > end)
+		return (0);
+	if (p[0] != 0xFF) {
+		*index = (int) BE16 (p);
+		return (2);
+	}
+	if (p + 4 > end)
+		return (0);
+	*index = (int) (BE32 (p) & 0x00FFFFFF);
+
+	return (4);
+}
+
+/*____________________________________________________________________
+|
+| Function: Compare_Corners
+|
+| Input: Called from qsort(), AssetConvert_LWO2()
+| Output: Orders corner indices by point, then uv.
+|___________________________________________________________________*/
+
+static int Compare_Corners (const void *a, const void *b)
+{
+	const LwoCorner *ca = &Sort_Corners[*(const int *)a], *cb = &Sort_Corners[*(const int *)b];
+
+	if (ca->point != cb->point)
+		return (ca->point < cb->point ? -1 : 1);
+	if (ca->u != cb->u)
+		return (ca->u < cb->u ? -1 : 1);
+	if (ca->v != cb->v)
+		return (ca->v < cb->v ? -1 : 1);
+
+	return (0);
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetConvert_LWO2_Triangles
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Walks the face polygon lists of an LWO2 file in memory and
+|   returns the # of triangles fanning them makes, as the conversion
+|   does, 0 if it isn't an LWO2 file.
+|___________________________________________________________________*/
+
+int AssetConvert_LWO2_Triangles (const unsigned char *lwo, size_t size)
+{
+	const unsigned char *p, *form_end;
+	int triangles = 0;
+
+	if (size < 12 || !ID4 (lwo, "FORM") || !ID4 (lwo + 8, "LWO2"))
+		return (0);
+	form_end = lwo + 8 + BE32 (lwo + 4);
+	if (form_end > lwo + size)
+		form_end = lwo + size;
+
+	for (p = lwo + 12; p + 8 <= form_end; ) {
+		const unsigned char *data = p + 8, *end;
+		if (BE32 (p + 4) > (size_t) (form_end - data))
+			break;
+		end = data + BE32 (p + 4);
+		// Only faces, not patches, bones or curves
+		if (ID4 (p, "POLS") && end - data >= 4 && ID4 (data, "FACE")) {
+			for (const unsigned char *q = data + 4; q + 2 <= end; ) {
+				int count = BE16 (q) & 0x3FF;
+				q += 2;
+				for (int k = 0; k < count; k++) {
+					int point, n = Read_VX (q, end, &point);
+					if (n == 0)
+						return (triangles);
+					q += n;
+				}
+				if (count >= 3)
+					triangles += count - 2;
+			}
+		}
+		p = end + ((end - data) & 1);
+	}
+
+	return (triangles);
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetConvert_File_Triangles
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Returns the # of triangles in an LWO2 file, from its polygon
+|   lists, or -1 if it can't be read.
+|___________________________________________________________________*/
+
+int AssetConvert_File_Triangles (const char *file)
+{
+	size_t size;
+	unsigned char *data = Read_File (file, &size);
+
+	if (data == NULL)
+		return (-1);
+	int triangles = AssetConvert_LWO2_Triangles (data, size);
+	free (data);
+
+	return (triangles);
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetConvert_BMP
+|
+| Input: Called from AssetConvert_File()
+| Output: Converts a BMP image to a texture with every mip level (each
+|   a 2x2 box filter of the one before).  Alpha comes from the
+|   brightness of alpha_bmp (the same size), or is opaque if it's NULL.
+|   Returns true on success, else false.
+|___________________________________________________________________*/
+
+bool AssetConvert_BMP (const unsigned char *bmp, size_t size, const unsigned char *alpha_bmp, size_t alpha_size, AssetPackEntry *entry, unsigned char **out)
+{
+	unsigned char *pixels, *alpha = NULL, *level, *prev;
+	unsigned width, height, alpha_width, alpha_height, levels = 1;
+	size_t total = 0;
+
+	*out = NULL;
+	if (!Decode_BMP (bmp, size, &pixels, &width, &height))
+		return (false);
+	if (alpha_bmp) {
+		if (!Decode_BMP (alpha_bmp, alpha_size, &alpha, &alpha_width, &alpha_height) || alpha_width != width || alpha_height != height) {
+			free (pixels);
+			free (alpha);
+			return (false);
+		}
+		for (size_t i = 0; i < (size_t) width * height; i++)
+			pixels[i * 4 + 3] = (unsigned char) ((alpha[i * 4] + alpha[i * 4 + 1] + alpha[i * 4 + 2]) / 3);
+		free (alpha);
+	}
+
+	while ((width >> levels) || (height >> levels))
+		levels++;
+	if (levels > ASSET_PACK_MAX_LEVELS) {
+		free (pixels);
+		return (false);
+	}
+	for (unsigned i = 0; i < levels; i++)
+		total += AssetPack_Level_Size (width, height, i);
+	*out = (unsigned char *) malloc (total);
+	if (*out == NULL) {
+		free (pixels);
+		return (false);
+	}
+
+	memcpy (*out, pixels, AssetPack_Level_Size (width, height, 0));
+	free (pixels);
+	prev = *out;
+	level = *out + AssetPack_Level_Size (width, height, 0);
+	for (unsigned i = 1; i < levels; i++) {
+		unsigned pw = width >> (i - 1) ? width >> (i - 1) : 1, ph = height >> (i - 1) ? height >> (i - 1) : 1;
+		unsigned w = width >> i ? width >> i : 1, h = height >> i ? height >> i : 1;
+		for (unsigned y = 0; y < h; y++)
+			for (unsigned x = 0; x < w; x++) {
+				// A side already down to 1 texel isn't halved
+				unsigned x0 = pw > 1 ? 2 * x : x, x1 = pw > 1 ? 2 * x + 1 : x;
+				unsigned y0 = ph > 1 ? 2 * y : y, y1 = ph > 1 ? 2 * y + 1 : y;
+				for (int c = 0; c < 4; c++)
+					level[(y * w + x) * 4 + c] = (unsigned char) ((prev[(y0 * pw + x0) * 4 + c] + prev[(y0 * pw + x1) * 4 + c] +
+						prev[(y1 * pw + x0) * 4 + c] + prev[(y1 * pw + x1) * 4 + c] + 2) / 4);
+			}
+		prev = level;
+		level += AssetPack_Level_Size (width, height, i);
+	}
+
+	entry->kind = ASSET_PACK_TEXTURE;
+	entry->size = total;
+	entry->info.texture.width = width;
+	entry->info.texture.height = height;
+	entry->info.texture.levels = levels;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Decode_BMP
+|
+| Input: Called from AssetConvert_BMP()
+| Output: Decodes an uncompressed 8 (palette), 24 or 32 bit BMP to 4
+|   bytes per pixel (B, G, R, 255), top row first.  Returns true on
+|   success, else false.  Caller must free *pixels.
+|___________________________________________________________________*/
+
+static bool Decode_BMP (const unsigned char *bmp, size_t size, unsigned char **pixels, unsigned *width, unsigned *height)
+{
+	unsigned offset, header_size, bits, compression, colors, stride;
+	int w, h;
+	const unsigned char *palette;
+
+	*pixels = NULL;
+	if (size < 54 || bmp[0] != 'B' || bmp[1] != 'M')
+		return (false);
+	offset = LE32 (bmp + 10);
+	header_size = LE32 (bmp + 14);
+	w = (int) LE32 (bmp + 18);
+	h = (int) LE32 (bmp + 22);
+	bits = LE16 (bmp + 28);
+	compression = LE32 (bmp + 30);
+	colors = LE32 (bmp + 46);
+	if (w <= 0 || h == 0 || w > 32768 || h > 32768 || h < -32768 || compression != 0 || (bits != 8 && bits != 24 && bits != 32))
+		return (false);
+	*width = (unsigned) w;
+	*height = (unsigned) (h < 0 ? -h : h);
+	stride = ((*width * bits + 31) / 32) * 4;
+	if (offset > size || (size_t) stride * *height > size - offset)
+		return (false);
+	palette = bmp + 14 + header_size;
+	if (bits == 8) {
+		if (colors == 0 || colors > 256)
+			colors = 256;
+		if (14 + header_size + colors * 4 > size)
+			return (false);
+	}
+
+	*pixels = (unsigned char *) malloc ((size_t) *width * *height * 4);
+	if (*pixels == NULL)
+		return (false);
+	for (unsigned y = 0; y < *height; y++) {
+		// Rows are stored bottom up unless the height is negative
+		const unsigned char *row = bmp + offset + (size_t) stride * (h < 0 ? y : *height - 1 - y);
+		unsigned char *dst = *pixels + (size_t) y * *width * 4;
+		for (unsigned x = 0; x < *width; x++, dst += 4) {
+			const unsigned char *src;
+			if (bits == 8)
+				src = palette + 4 * (row[x] < colors ? row[x] : 0);
+			else
+				src = row + x * (bits / 8);
+			dst[0] = src[0];
+			dst[1] = src[1];
+			dst[2] = src[2];
+			dst[3] = 255;
+		}
+	}
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetConvert_WAV
+|
+| Input: Called from AssetConvert_File()
+| Output: Copies the samples of an 8 or 16 bit PCM WAV file.  Returns
+|   true on success, else false.
+|___________________________________________________________________*/
+
+bool AssetConvert_WAV (const unsigned char *wav, size_t size, AssetPackEntry *entry, unsigned char **out)
+{
+	const unsigned char *p, *end = wav + size, *samples = NULL;
+	unsigned channels = 0, rate = 0, bits = 0, samples_size = 0;
+
+	*out = NULL;
+	if (size < 12 || !ID4 (wav, "RIFF") || !ID4 (wav + 8, "WAVE"))
+		return (false);
+	for (p = wav + 12; p + 8 <= end; ) {
+		unsigned chunk_size = LE32 (p + 4);
+		const unsigned char *data = p + 8;
+		if (chunk_size > (size_t) (end - data))
+			return (false);
+		if (ID4 (p, "fmt ") && chunk_size >= 16) {
+			// PCM only
+			if (LE16 (data) != 1)
+				return (false);
+			channels = LE16 (data + 2);
+			rate = LE32 (data + 4);
+			bits = LE16 (data + 14);
+		}
+		else if (ID4 (p, "data")) {
+			samples = data;
+			samples_size = chunk_size;
+		}
+		p = data + chunk_size + (chunk_size & 1);
+	}
+	if (samples == NULL || channels == 0 || rate == 0 || (bits != 8 && bits != 16))
+		return (false);
+
+	*out = (unsigned char *) malloc (samples_size + 1);
+	if (*out == NULL)
+		return (false);
+	memcpy (*out, samples, samples_size);
+	entry->kind = ASSET_PACK_SOUND;
+	entry->size = samples_size;
+	entry->info.sound.channels = channels;
+	entry->info.sound.sample_rate = rate;
+	entry->info.sound.bits = bits;
+
+	return (true);
+}
@@ -0,0 +1,41 @@
+/*____________________________________________________________________
+|
+| File: asset_convert.h
+|
+| Description: Converts the game's source asset files into asset pack
+|   entries: LightWave LWO2 objects into vertex and index buffers, BMP
+|   images (with an optional second BMP for alpha) into mip mapped 32
+|   bit textures, and WAV files into their PCM samples.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _ASSET_CONVERT_H_
+#define _ASSET_CONVERT_H_
+
+#include "asset_pack.h"
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+// Reads file (and alt_file, a texture's alpha, or NULL) and converts it by
+//   its extension (.lwo, .bmp or .wav).  Fills in entry (name, kind, info and
+//   size) and sets *data to the converted data, which the caller must free.
+//   Returns true on success, else false.
+bool AssetConvert_File (const char *file, const char *alt_file, AssetPackEntry *entry, unsigned char **data);
+
+// Each converts a file already in memory, filling in the entry's kind, info and size.  Caller must free *out.
+bool AssetConvert_LWO2 (const unsigned char *lwo, size_t size, AssetPackEntry *entry, unsigned char **out);
+bool AssetConvert_BMP (const unsigned char *bmp, size_t size, const unsigned char *alpha_bmp, size_t alpha_size, AssetPackEntry *entry, unsigned char **out);
+bool AssetConvert_WAV (const unsigned char *wav, size_t size, AssetPackEntry *entry, unsigned char **out);
+
+// Return the # of triangles AssetConvert_LWO2() would make of a file in
+//   memory, or read from disk (-1 if it can't be read), from its polygon
+//   lists alone (nothing is converted)
+int  AssetConvert_LWO2_Triangles (const unsigned char *lwo, size_t size);
+int  AssetConvert_File_Triangles (const char *file);
+
+#endif
@@ -0,0 +1,333 @@
+/*____________________________________________________________________
+|
+| File: asset_loader.cpp
+|
+| Description: Reads queued asset files on worker threads and uploads
+|   them on the main thread.
+|
+| Functions: AssetLoader_Init
+|            AssetLoader_Free
+|            AssetLoader_Add
+|            AssetLoader_Start
+|             Worker_Run
+|             Read_Asset
+|              Read_File
+|            AssetLoader_Upload
+|            AssetLoader_Done
+|            AssetLoader_Progress
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <new>
+
+#include "profile.h"
+#include "asset_loader.h"
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+struct AssetWorkers {
+	std::thread       threads[ASSET_MAX_THREADS];
+	int               num_threads;
+	std::atomic<int>  next;                       // next asset for a worker to take
+	std::atomic<bool> ready[ASSET_MAX_ASSETS];    // files read (and parsed), safe to upload
+};
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static void Worker_Run (AssetLoader *loader);
+static void Read_Asset (AssetLoader *loader, Asset *asset);
+static unsigned char *Read_File (const char *file, size_t *size);
+
+/*____________________________________________________________________
+|
+| Function: AssetLoader_Init
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Sets up an empty loader.
+|___________________________________________________________________*/
+
+void AssetLoader_Init (AssetLoader *loader, AssetParseFunc parse, AssetUploadFunc upload, void *context)
+{
+	memset (loader, 0, sizeof (AssetLoader));
+	loader->parse = parse;
+	loader->upload = upload;
+	loader->context = context;
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetLoader_Free
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Stops the workers (after the asset each is reading) and frees
+|   the data of any asset not uploaded.
+|___________________________________________________________________*/
+
+void AssetLoader_Free (AssetLoader *loader)
+{
+	if (loader->workers) {
+		// Nothing left for the workers to take
+		loader->workers->next = loader->num_assets;
+		for (int i = 0; i < loader->workers->num_threads; i++)
+			loader->workers->threads[i].join ();
+		delete loader->workers;
+		loader->workers = NULL;
+	}
+	for (int i = 0; i < loader->num_assets; i++) {
+		free (loader->assets[i].data);
+		free (loader->assets[i].alt_data);
+		loader->assets[i].data = loader->assets[i].alt_data = NULL;
+	}
+	loader->num_assets = 0;
+	loader->num_uploaded = 0;
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetLoader_Add
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Queues an asset.  Returns true on success, false if the queue
+|   is full or a file name is too long.
+|___________________________________________________________________*/
+
+bool AssetLoader_Add (AssetLoader *loader, int kind, const char *file, const char *alt_file, void *target)
+{
+	Asset *asset;
+
+	if (loader->workers || loader->num_assets == ASSET_MAX_ASSETS)
+		return (false);
+	if (strlen (file) >= ASSET_MAX_PATH || (alt_file && strlen (alt_file) >= ASSET_MAX_PATH))
+		return (false);
+
+	asset = &loader->assets[loader->num_assets++];
+	memset (asset, 0, sizeof (Asset));
+	asset->kind = kind;
+	strcpy (asset->file, file);
+	if (alt_file)
+		strcpy (asset->alt_file, alt_file);
+	asset->target = target;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetLoader_Start
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Starts the workers.  Returns true on success, else false (no
+|   threads could be made, AssetLoader_Upload() reads the files itself).
+|___________________________________________________________________*/
+
+bool AssetLoader_Start (AssetLoader *loader, int threads)
+{
+	AssetWorkers *workers;
+
+	if (loader->workers)
+		return (true);
+
+	// Leave a core for the main thread, which is uploading and drawing meanwhile
+	if (threads <= 0)
+		threads = (int) std::thread::hardware_concurrency () - 1;
+	if (threads < 1)
+		threads = 1;
+	if (threads > ASSET_MAX_THREADS)
+		threads = ASSET_MAX_THREADS;
+	// No point in more workers than assets
+	if (threads > loader->num_assets)
+		threads = loader->num_assets;
+	if (threads == 0)
+		return (true);
+
+	workers = new (std::nothrow) AssetWorkers;
+	if (workers == NULL)
+		return (false);
+	workers->num_threads = 0;
+	workers->next = 0;
+	for (int i = 0; i < ASSET_MAX_ASSETS; i++)
+		workers->ready[i] = false;
+	loader->workers = workers;
+
+	for (int i = 0; i < threads; i++) {
+		try {
+			workers->threads[i] = std::thread (Worker_Run, loader);
+		}
+		catch (...) {
+			break;
+		}
+		workers->num_threads++;
+	}
+	if (workers->num_threads == 0) {
+		delete workers;
+		loader->workers = NULL;
+		return (false);
+	}
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Worker_Run
+|
+| Input: Called from AssetLoader_Start() (on a worker thread)
+| Output: Reads assets, taking the next unread one each time, until
+|   there are none left.
+|___________________________________________________________________*/
+
+static void Worker_Run (AssetLoader *loader)
+{
+	AssetWorkers *workers = loader->workers;
+	int i;
+
+	Profile_Set_Thread_Name ("asset loader");
+	while ((i = workers->next++) < loader->num_assets) {
+		Read_Asset (loader, &loader->assets[i]);
+		workers->ready[i].store (true, std::memory_order_release);
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Read_Asset
+|
+| Input: Called from Worker_Run(), AssetLoader_Upload()
+| Output: Reads an asset's files and parses them.  Sets read_ok false
+|   if a file can't be read or the parse fails.
+|___________________________________________________________________*/
+
+static void Read_Asset (AssetLoader *loader, Asset *asset)
+{
+	PROFILE_ZONE ("Read asset");
+
+	asset->data = Read_File (asset->file, &asset->size);
+	asset->read_ok = (asset->data != NULL);
+	if (asset->alt_file[0]) {
+		asset->alt_data = Read_File (asset->alt_file, &asset->alt_size);
+		if (asset->alt_data == NULL)
+			asset->read_ok = false;
+	}
+	if (asset->read_ok && loader->parse)
+		asset->read_ok = loader->parse (loader->context, asset);
+}
+
+/*____________________________________________________________________
+|
+| Function: Read_File
+|
+| Input: Called from Read_Asset()
+| Output: Returns the contents of a file (size in size) or NULL on error.
+|   Caller must free the memory.
+|___________________________________________________________________*/
+
+static unsigned char *Read_File (const char *file, size_t *size)
+{
+	FILE *fp;
+	long length;
+	unsigned char *data = NULL;
+
+	*size = 0;
+	fp = fopen (file, "rb");
+	if (fp == NULL)
+		return (NULL);
+	if (fseek (fp, 0, SEEK_END) == 0 && (length = ftell (fp)) >= 0 && fseek (fp, 0, SEEK_SET) == 0) {
+		// One extra byte so an empty file still gets a buffer
+		data = (unsigned char *) malloc (length + 1);
+		if (data && fread (data, 1, length, fp) != (size_t) length) {
+			free (data);
+			data = NULL;
+		}
+		if (data)
+			*size = length;
+	}
+	fclose (fp);
+
+	return (data);
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetLoader_Upload
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Hands ready assets to the upload function in the order they
+|   were added, stopping at one that isn't ready or once seconds have
+|   passed, and frees their data.  Returns the # of assets uploaded.
+|___________________________________________________________________*/
+
+int AssetLoader_Upload (AssetLoader *loader, float seconds)
+{
+	ProfileTime start = Profile_Now ();
+	ProfileTime budget = (ProfileTime) (seconds * 1e9f);
+	int n = 0;
+
+	while (loader->num_uploaded < loader->num_assets) {
+		Asset *asset = &loader->assets[loader->num_uploaded];
+		if (loader->workers == NULL)
+			Read_Asset (loader, asset);
+		else if (!loader->workers->ready[loader->num_uploaded].load (std::memory_order_acquire))
+			break;
+		{
+			PROFILE_ZONE ("Upload asset");
+			if (!asset->read_ok || !loader->upload (loader->context, asset))
+				loader->errors++;
+		}
+		free (asset->data);
+		free (asset->alt_data);
+		asset->data = asset->alt_data = NULL;
+		loader->num_uploaded++;
+		n++;
+		if (Profile_Now () - start >= budget)
+			break;
+	}
+
+	return (n);
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetLoader_Done
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Returns true if every asset has been uploaded.
+|___________________________________________________________________*/
+
+bool AssetLoader_Done (const AssetLoader *loader)
+{
+	return (loader->num_uploaded == loader->num_assets);
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetLoader_Progress
+|
+| Input: Called from Program_Run()
+| Output: Returns the fraction of assets uploaded, 0-1.
+|___________________________________________________________________*/
+
+float AssetLoader_Progress (const AssetLoader *loader)
+{
+	if (loader->num_assets == 0)
+		return (1);
+
+	return ((float) loader->num_uploaded / loader->num_assets);
+}
@@ -0,0 +1,103 @@
+/*____________________________________________________________________
+|
+| File: asset_loader.h
+|
+| Description: Asset loader.  Files are queued up front, then a pool of
+|   worker threads reads them (and runs an optional parse function on
+|   the bytes) while the main thread keeps drawing.  Each frame the main
+|   thread hands finished assets to an upload function, within a time
+|   budget, since the graphics and sound libraries can only be called
+|   from the thread that owns the device.
+|
+|   Usage:
+|     AssetLoader_Init (&loader, NULL, Upload, context);
+|     AssetLoader_Add (&loader, MODEL, "tree.lwo", NULL, &obj_tree);
+|     ...
+|     AssetLoader_Start (&loader, 0);
+|     while (!AssetLoader_Done (&loader)) {
+|       AssetLoader_Upload (&loader, 0.016f);
+|       Draw_Loading_Screen (AssetLoader_Progress (&loader));
+|     }
+|     AssetLoader_Free (&loader);
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _ASSET_LOADER_H_
+#define _ASSET_LOADER_H_
+
+#include <stddef.h>
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define ASSET_MAX_ASSETS   128
+#define ASSET_MAX_PATH     128
+#define ASSET_MAX_THREADS  8
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	int            kind;           // caller's, tells the upload function what the asset is
+	char           file[ASSET_MAX_PATH];
+	char           alt_file[ASSET_MAX_PATH];  // second file (a texture's alpha), "" if none
+	void          *target;         // where the upload function puts the result
+	unsigned char *data;           // file contents, read by a worker
+	size_t         size;
+	unsigned char *alt_data;
+	size_t         alt_size;
+	void          *parsed;         // set by the parse function, if any
+	bool           read_ok;        // both files were read
+} Asset;
+
+// Runs on a worker thread after the files are read.  Returns true on success, else false.
+typedef bool (*AssetParseFunc)  (void *context, Asset *asset);
+// Runs on the thread calling AssetLoader_Upload().  Returns true on success, else false.
+typedef bool (*AssetUploadFunc) (void *context, Asset *asset);
+
+struct AssetWorkers;
+
+typedef struct {
+	Asset                assets[ASSET_MAX_ASSETS];
+	int                  num_assets;
+	int                  num_uploaded;  // assets before this have all been uploaded
+	int                  errors;        // assets that couldn't be read, parsed or uploaded
+	AssetParseFunc       parse;
+	AssetUploadFunc      upload;
+	void                *context;
+	struct AssetWorkers *workers;       // threads and per asset ready flags
+} AssetLoader;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+// parse may be NULL
+void  AssetLoader_Init (AssetLoader *loader, AssetParseFunc parse, AssetUploadFunc upload, void *context);
+// Waits for the workers and frees any data not yet uploaded
+void  AssetLoader_Free (AssetLoader *loader);
+
+// Queues a file (and an optional second file).  Must be called before AssetLoader_Start().
+//   Returns true on success, false if the queue is full or a name is too long.
+bool  AssetLoader_Add (AssetLoader *loader, int kind, const char *file, const char *alt_file, void *target);
+
+// Starts threads workers (0 for one less than the # of cores), which read the files in the order they were added.
+//   Returns true on success, else false (the assets are read on this thread by AssetLoader_Upload()).
+bool  AssetLoader_Start (AssetLoader *loader, int threads);
+
+// Uploads the assets that are ready, in the order they were added, until
+//   seconds have passed (always at least one if it's ready).  Returns the # uploaded.
+int   AssetLoader_Upload (AssetLoader *loader, float seconds);
+
+bool  AssetLoader_Done (const AssetLoader *loader);
+// Returns the fraction of assets uploaded, 0-1
+float AssetLoader_Progress (const AssetLoader *loader);
+
+#endif
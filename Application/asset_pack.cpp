@@ -0,0 +1,422 @@
+/*____________________________________________________________________
+|
+| File: asset_pack.cpp
+|
+| Description: Maps asset packs into memory, looks up their entries and
+|   writes new packs.
+|
+| Functions: AssetPack_Open
+|             Map_File
+|            AssetPack_Close
+|            AssetPack_Find
+|            AssetPack_Mesh
+|            AssetPack_Texture
+|            AssetPack_Sound
+|            AssetPack_Level_Size
+|            AssetPack_Write
+|             Compare_Names
+|            AssetPack_Normalize_Name
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "asset_pack.h"
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static bool Map_File (AssetPack *pack, const char *file);
+static int Compare_Names (const void *a, const void *b);
+
+/*___________________
+|
+| Global variables
+|__________________*/
+
+static const AssetPackEntry *Sort_Entries;  // entries being sorted by AssetPack_Write()
+
+/*____________________________________________________________________
+|
+| Function: AssetPack_Open
+|
+| Input: Called from headless driver
+| Output: Maps the pack read only and checks the header and that every
+|   entry lies inside the file.  Returns true on success, else false.
+|___________________________________________________________________*/
+
+bool AssetPack_Open (AssetPack *pack, const char *file)
+{
+	const AssetPackHeader *header;
+
+	memset (pack, 0, sizeof (AssetPack));
+	if (!Map_File (pack, file))
+		return (false);
+
+	header = (const AssetPackHeader *) pack->base;
+	if (pack->size < sizeof (AssetPackHeader) ||
+		header->magic != ASSET_PACK_MAGIC ||
+		header->version != ASSET_PACK_VERSION ||
+		header->entry_size != sizeof (AssetPackEntry) ||
+		header->file_size != pack->size ||
+		header->num_entries > (pack->size - sizeof (AssetPackHeader)) / sizeof (AssetPackEntry)) {
+		AssetPack_Close (pack);
+		return (false);
+	}
+	pack->entries = (const AssetPackEntry *) (pack->base + sizeof (AssetPackHeader));
+	pack->num_entries = header->num_entries;
+	for (int i = 0; i < pack->num_entries; i++) {
+		const AssetPackEntry *entry = &pack->entries[i];
+		if (entry->offset > pack->size || entry->size > pack->size - entry->offset || entry->offset % ASSET_PACK_ALIGN ||
+			memchr (entry->name, 0, ASSET_PACK_MAX_NAME) == NULL || (i && strcmp (pack->entries[i - 1].name, entry->name) >= 0)) {
+			AssetPack_Close (pack);
+			return (false);
+		}
+	}
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Map_File
+|
+| Input: Called from AssetPack_Open()
+| Output: Maps a whole file read only into pack.  Returns true on
+|   success, else false.
+|___________________________________________________________________*/
+
+static bool Map_File (AssetPack *pack, const char *file)
+{
+#ifdef _WIN32
+	HANDLE fh, mh;
+	LARGE_INTEGER size;
+	void *base;
+
+	fh = CreateFileA (file, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (fh == INVALID_HANDLE_VALUE)
+		return (false);
+	if (!GetFileSizeEx (fh, &size) || size.QuadPart == 0) {
+		CloseHandle (fh);
+		return (false);
+	}
+	mh = CreateFileMappingA (fh, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mh == NULL) {
+		CloseHandle (fh);
+		return (false);
+	}
+	base = MapViewOfFile (mh, FILE_MAP_READ, 0, 0, 0);
+	if (base == NULL) {
+		CloseHandle (mh);
+		CloseHandle (fh);
+		return (false);
+	}
+	pack->base = (const unsigned char *) base;
+	pack->size = (size_t) size.QuadPart;
+	pack->file_handle = fh;
+	pack->map_handle = mh;
+#else
+	struct stat st;
+	void *base;
+	int fd;
+
+	fd = open (file, O_RDONLY);
+	if (fd == -1)
+		return (false);
+	if (fstat (fd, &st) == -1 || st.st_size == 0) {
+		close (fd);
+		return (false);
+	}
+	base = mmap (NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	// The mapping keeps the file open
+	close (fd);
+	if (base == MAP_FAILED)
+		return (false);
+	pack->base = (const unsigned char *) base;
+	pack->size = (size_t) st.st_size;
+#endif
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetPack_Close
+|
+| Input: Called from AssetPack_Open(), headless driver
+| Output: Unmaps the pack.  Views into it are no longer valid.
+|___________________________________________________________________*/
+
+void AssetPack_Close (AssetPack *pack)
+{
+	if (pack->base) {
+#ifdef _WIN32
+		UnmapViewOfFile (pack->base);
+		CloseHandle ((HANDLE) pack->map_handle);
+		CloseHandle ((HANDLE) pack->file_handle);
+#else
+		munmap ((void *) pack->base, pack->size);
+#endif
+	}
+	memset (pack, 0, sizeof (AssetPack));
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetPack_Find
+|
+| Input: Called from AssetPack_Mesh(), AssetPack_Texture(),
+|   AssetPack_Sound(), headless driver
+| Output: Returns the entry named name (either directory separator) or
+|   NULL if there isn't one.
+|___________________________________________________________________*/
+
+const AssetPackEntry *AssetPack_Find (const AssetPack *pack, const char *name)
+{
+	char key[ASSET_PACK_MAX_NAME];
+	int low = 0, high = pack->num_entries - 1;
+
+	if (!AssetPack_Normalize_Name (name, key))
+		return (NULL);
+	while (low <= high) {
+		int mid = (low + high) / 2;
+		int cmp = strcmp (key, pack->entries[mid].name);
+		if (cmp == 0)
+			return (&pack->entries[mid]);
+		if (cmp < 0)
+			high = mid - 1;
+		else
+			low = mid + 1;
+	}
+
+	return (NULL);
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetPack_Mesh
+|
+| Input: Called from headless driver
+| Output: Points mesh at a mesh entry's buffers.  Returns false if there
+|   is no such mesh (or its buffers don't fit the entry).
+|___________________________________________________________________*/
+
+bool AssetPack_Mesh (const AssetPack *pack, const char *name, AssetPackMesh *mesh)
+{
+	const AssetPackEntry *entry = AssetPack_Find (pack, name);
+	unsigned long long vertex_bytes;
+
+	if (entry == NULL || entry->kind != ASSET_PACK_MESH)
+		return (false);
+	vertex_bytes = (unsigned long long) entry->info.mesh.num_vertices * ASSET_PACK_VERTEX_FLOATS * sizeof (float);
+	if (vertex_bytes + (unsigned long long) entry->info.mesh.num_indices * sizeof (unsigned) > entry->size)
+		return (false);
+
+	mesh->info = &entry->info.mesh;
+	mesh->vertices = (const float *) (pack->base + entry->offset);
+	mesh->indices = (const unsigned *) (pack->base + entry->offset + vertex_bytes);
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetPack_Texture
+|
+| Input: Called from headless driver
+| Output: Points texture at each mip level of a texture entry.  Returns
+|   false if there is no such texture (or its levels don't fit the
+|   entry).
+|___________________________________________________________________*/
+
+bool AssetPack_Texture (const AssetPack *pack, const char *name, AssetPackTexture *texture)
+{
+	const AssetPackEntry *entry = AssetPack_Find (pack, name);
+	const AssetPackTextureInfo *info;
+	unsigned long long offset = 0;
+
+	if (entry == NULL || entry->kind != ASSET_PACK_TEXTURE)
+		return (false);
+	info = &entry->info.texture;
+	if (info->levels == 0 || info->levels > ASSET_PACK_MAX_LEVELS)
+		return (false);
+
+	texture->info = info;
+	for (unsigned level = 0; level < info->levels; level++) {
+		texture->levels[level] = pack->base + entry->offset + offset;
+		texture->level_width[level] = info->width >> level ? info->width >> level : 1;
+		texture->level_height[level] = info->height >> level ? info->height >> level : 1;
+		offset += AssetPack_Level_Size (info->width, info->height, level);
+	}
+
+	return (offset <= entry->size);
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetPack_Sound
+|
+| Input: Called from headless driver
+| Output: Points sound at a sound entry's samples.  Returns false if
+|   there is no such sound.
+|___________________________________________________________________*/
+
+bool AssetPack_Sound (const AssetPack *pack, const char *name, AssetPackSound *sound)
+{
+	const AssetPackEntry *entry = AssetPack_Find (pack, name);
+
+	if (entry == NULL || entry->kind != ASSET_PACK_SOUND)
+		return (false);
+
+	sound->info = &entry->info.sound;
+	sound->samples = pack->base + entry->offset;
+	sound->size = (size_t) entry->size;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetPack_Level_Size
+|
+| Input: Called from AssetPack_Texture(), AssetConvert_BMP()
+| Output: Returns the # of bytes in a mip level of a width x height
+|   texture (each level halves both sides, down to 1).
+|___________________________________________________________________*/
+
+size_t AssetPack_Level_Size (unsigned width, unsigned height, int level)
+{
+	size_t w = width >> level, h = height >> level;
+
+	if (w == 0)
+		w = 1;
+	if (h == 0)
+		h = 1;
+
+	return (w * h * 4);
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetPack_Write
+|
+| Input: Called from packer tool
+| Output: Writes the entries, sorted by name, and their data to file,
+|   filling in each entry's offset.  Returns true on success, else false
+|   (a name is used twice or the file can't be written).
+|___________________________________________________________________*/
+
+bool AssetPack_Write (const char *file, AssetPackEntry *entries, const void * const *data, int num_entries)
+{
+	static const unsigned char zeros[ASSET_PACK_ALIGN] = { 0 };
+	AssetPackHeader header;
+	unsigned long long offset;
+	int *order;
+	FILE *fp;
+	bool ok = true;
+
+	order = (int *) malloc ((num_entries + 1) * sizeof (int));
+	if (order == NULL)
+		return (false);
+	for (int i = 0; i < num_entries; i++)
+		order[i] = i;
+	Sort_Entries = entries;
+	qsort (order, num_entries, sizeof (int), Compare_Names);
+	for (int i = 1; i < num_entries; i++)
+		if (strcmp (entries[order[i - 1]].name, entries[order[i]].name) == 0)
+			ok = false;
+
+	// Lay out the data after the table of contents
+	offset = sizeof (AssetPackHeader) + (unsigned long long) num_entries * sizeof (AssetPackEntry);
+	for (int i = 0; i < num_entries; i++) {
+		AssetPackEntry *entry = &entries[order[i]];
+		offset = (offset + ASSET_PACK_ALIGN - 1) & ~(unsigned long long) (ASSET_PACK_ALIGN - 1);
+		entry->offset = offset;
+		offset += entry->size;
+	}
+	header.magic = ASSET_PACK_MAGIC;
+	header.version = ASSET_PACK_VERSION;
+	header.num_entries = num_entries;
+	header.entry_size = sizeof (AssetPackEntry);
+	header.file_size = offset;
+
+	fp = ok ? fopen (file, "wb") : NULL;
+	if (fp == NULL) {
+		free (order);
+		return (false);
+	}
+	ok = fwrite (&header, sizeof (AssetPackHeader), 1, fp) == 1;
+	for (int i = 0; ok && i < num_entries; i++)
+		ok = fwrite (&entries[order[i]], sizeof (AssetPackEntry), 1, fp) == 1;
+	offset = sizeof (AssetPackHeader) + (unsigned long long) num_entries * sizeof (AssetPackEntry);
+	for (int i = 0; ok && i < num_entries; i++) {
+		const AssetPackEntry *entry = &entries[order[i]];
+		size_t pad = (size_t) (entry->offset - offset);
+		if (pad)
+			ok = fwrite (zeros, 1, pad, fp) == pad;
+		if (ok && entry->size)
+			ok = fwrite (data[order[i]], (size_t) entry->size, 1, fp) == 1;
+		offset = entry->offset + entry->size;
+	}
+	if (fclose (fp) != 0)
+		ok = false;
+	free (order);
+
+	return (ok);
+}
+
+/*____________________________________________________________________
+|
+| Function: Compare_Names
+|
+| Input: Called from qsort()
+| Output: Orders entry indices by entry name.
+|___________________________________________________________________*/
+
+static int Compare_Names (const void *a, const void *b)
+{
+	return (strcmp (Sort_Entries[*(const int *)a].name, Sort_Entries[*(const int *)b].name));
+}
+
+/*____________________________________________________________________
+|
+| Function: AssetPack_Normalize_Name
+|
+| Input: Called from AssetPack_Find(), AssetConvert_File()
+| Output: Copies name to out with '\' changed to '/'.  Returns false if
+|   it doesn't fit in ASSET_PACK_MAX_NAME chars.
+|___________________________________________________________________*/
+
+bool AssetPack_Normalize_Name (const char *name, char *out)
+{
+	int i;
+
+	for (i = 0; name[i]; i++) {
+		if (i == ASSET_PACK_MAX_NAME - 1)
+			return (false);
+		out[i] = name[i] == '\\' ? '/' : name[i];
+	}
+	out[i] = 0;
+
+	return (true);
+}
@@ -0,0 +1,151 @@
+/*____________________________________________________________________
+|
+| File: asset_pack.h
+|
+| Description: Asset pack file.  The packer tool converts the game's
+|   loose asset files once, offline, into one file the game can map into
+|   memory and use in place: meshes as vertex and index buffers, textures
+|   as 32 bit pixels with all their mip levels, sounds as PCM samples.
+|
+|   Layout (little endian):
+|     AssetPackHeader
+|     AssetPackEntry[num_entries]    sorted by name, for binary search
+|     entry data                     each starting on an ASSET_PACK_ALIGN boundary
+|
+|   Entry names are the file names given to the packer with '/' between
+|   directories, so "Objects\monster1.lwo" and "Objects/monster1.lwo"
+|   find the same entry.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _ASSET_PACK_H_
+#define _ASSET_PACK_H_
+
+#include <stddef.h>
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define ASSET_PACK_MAGIC        0x4B505847   // "GXPK"
+#define ASSET_PACK_VERSION      1            // bump whenever the layout or a conversion changes
+#define ASSET_PACK_ALIGN        64
+#define ASSET_PACK_MAX_NAME     96
+#define ASSET_PACK_MAX_LEVELS   16           // mip levels, enough for a 32768 texel texture
+#define ASSET_PACK_VERTEX_FLOATS 8           // x, y, z, nx, ny, nz, u, v
+
+enum {
+	ASSET_PACK_MESH = 1,
+	ASSET_PACK_TEXTURE,
+	ASSET_PACK_SOUND
+};
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	unsigned           magic;
+	unsigned           version;
+	unsigned           num_entries;
+	unsigned           entry_size;       // sizeof(AssetPackEntry), guards against a mismatched build
+	unsigned long long file_size;
+} AssetPackHeader;
+
+// Mesh data: num_vertices * ASSET_PACK_VERTEX_FLOATS floats, then num_indices
+//   unsigned indices (triangle list, clockwise front faces like the source)
+typedef struct {
+	unsigned num_vertices;
+	unsigned num_indices;
+	float    bound_min[3];
+	float    bound_max[3];
+} AssetPackMeshInfo;
+
+// Texture data: each mip level's pixels in turn, largest first, 4 bytes per
+//   texel in B, G, R, A order, rows top to bottom
+typedef struct {
+	unsigned width;
+	unsigned height;
+	unsigned levels;
+} AssetPackTextureInfo;
+
+// Sound data: interleaved PCM samples
+typedef struct {
+	unsigned channels;
+	unsigned sample_rate;
+	unsigned bits;                       // per sample, 8 (unsigned) or 16 (signed)
+} AssetPackSoundInfo;
+
+typedef struct {
+	char               name[ASSET_PACK_MAX_NAME];
+	unsigned           kind;             // ASSET_PACK_MESH, _TEXTURE or _SOUND
+	union {
+		AssetPackMeshInfo    mesh;
+		AssetPackTextureInfo texture;
+		AssetPackSoundInfo   sound;
+	} info;
+	unsigned long long offset;           // from the start of the file
+	unsigned long long size;
+} AssetPackEntry;
+
+// Views into a mapped pack (nothing is copied)
+typedef struct {
+	const AssetPackMeshInfo *info;
+	const float             *vertices;
+	const unsigned          *indices;
+} AssetPackMesh;
+
+typedef struct {
+	const AssetPackTextureInfo *info;
+	const unsigned char        *levels[ASSET_PACK_MAX_LEVELS];
+	unsigned                    level_width[ASSET_PACK_MAX_LEVELS];
+	unsigned                    level_height[ASSET_PACK_MAX_LEVELS];
+} AssetPackTexture;
+
+typedef struct {
+	const AssetPackSoundInfo *info;
+	const unsigned char      *samples;
+	size_t                    size;
+} AssetPackSound;
+
+typedef struct {
+	const unsigned char  *base;          // the mapped file
+	size_t                size;
+	const AssetPackEntry *entries;
+	int                   num_entries;
+	void                 *file_handle;   // platform handles, kept to unmap
+	void                 *map_handle;
+} AssetPack;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+// Maps a pack into memory and checks its table of contents.  Returns true on success, else false.
+bool  AssetPack_Open (AssetPack *pack, const char *file);
+void  AssetPack_Close (AssetPack *pack);
+
+// Returns the entry for a file name or NULL if it isn't in the pack
+const AssetPackEntry *AssetPack_Find (const AssetPack *pack, const char *name);
+
+// Fill in views of an entry.  Return false if the name isn't in the pack or is another kind of asset.
+bool  AssetPack_Mesh (const AssetPack *pack, const char *name, AssetPackMesh *mesh);
+bool  AssetPack_Texture (const AssetPack *pack, const char *name, AssetPackTexture *texture);
+bool  AssetPack_Sound (const AssetPack *pack, const char *name, AssetPackSound *sound);
+
+// Returns the bytes of a texture level (4 per texel)
+size_t AssetPack_Level_Size (unsigned width, unsigned height, int level);
+
+// Writes a pack of num_entries entries (name, kind and info filled in) with their
+//   data (size in each entry).  Returns true on success, else false.
+bool  AssetPack_Write (const char *file, AssetPackEntry *entries, const void * const *data, int num_entries);
+
+// Copies name into out (ASSET_PACK_MAX_NAME chars) with '/' between directories.  Returns false if it's too long.
+bool  AssetPack_Normalize_Name (const char *name, char *out);
+
+#endif
@@ -0,0 +1,296 @@
+/*____________________________________________________________________
+|
+| File: camera_controller.cpp
+|
+| Description: Functions to create and manipulate a camera.
+|
+| Functions: CameraController_Init
+|            CameraController_Set_Speed
+|            CameraController_Update
+|             Rotate_Heading
+|             Normalize
+|            CameraController_View_Matrix
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <string.h>
+#include <math.h>
+
+#include "camera_controller.h"
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static inline void Rotate_Heading (CameraController *camera);
+static inline void Normalize (float *v);
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define ROTATE_UP_MAX   ((float)-89)
+#define ROTATE_DOWN_MAX ((float)89)
+
+#define CAMERA_DISTANCE 10	// distance of 'to' point away from the camera position
+
+#define DEGREES_TO_RADIANS(_deg_) ((_deg_) * 3.14159265f / 180)
+
+/*____________________________________________________________________
+|
+| Function: CameraController_Init
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Sets up a camera at position looking along heading.
+|___________________________________________________________________*/
+
+void CameraController_Init (
+	CameraController *camera,
+	const float      *position,
+	const float      *heading,      // 0,0,1 for cubic environment mapping to work correctly (why?)
+	float             move_speed,   // move speed in feet per second
+	float             eye_height )
+{
+	bool b;
+	float v[3];
+
+	memcpy (camera->position, position, 3 * sizeof(float));
+	memcpy (camera->heading, heading, 3 * sizeof(float));
+	Normalize (camera->heading);  // just in case its not already normalized
+	memcpy (camera->start_heading, camera->heading, 3 * sizeof(float));
+	camera->speed      = move_speed;
+	camera->eye_height = eye_height;
+	camera->xrotate    = 0;
+	camera->yrotate    = 0;
+	camera->sin_x      = camera->sin_y = 0;
+	camera->cos_x      = camera->cos_y = 1;
+	camera->right[0]   = 1;
+	camera->right[1]   = camera->right[2] = 0;
+	Rotate_Heading (camera);
+
+	CameraController_Update (camera, 0, 0, 0, 0, true, &b, &b, v, v);	// force an update to start the camera off in the correct position
+}
+
+/*____________________________________________________________________
+|
+| Function: CameraController_Set_Speed
+|
+| Input: Called from Program_Run()
+| Output: Sets new move speed.
+|___________________________________________________________________*/
+
+void CameraController_Set_Speed (CameraController *camera, float move_speed)
+{
+	camera->speed = move_speed;
+}
+
+/*____________________________________________________________________
+|
+| Function: CameraController_Update
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Turns the camera by xrotate (down) and yrotate (right)
+|   degrees and moves it along the move keys held for elapsed_time ms,
+|   then puts the eye back at its height above the ground.  Runs at the
+|   mouse event rate, so only an angle that changed has its sine and
+|   cosine recomputed, and the heading and right vector are worked out
+|   once, when either did.
+|___________________________________________________________________*/
+
+void CameraController_Update (
+	CameraController *camera,
+	unsigned          elapsed_time,
+	unsigned          move,
+	float             xrotate,
+	float             yrotate,
+	bool              update_all,
+	bool             *position_changed, // returns true if position has changed, else false
+	bool             *camera_changed,   // return true if heading has changed
+	float            *new_position,
+	float            *new_heading )
+{
+	float move_amount;
+	float *position = camera->position, *heading = camera->heading;
+
+/*____________________________________________________________________
+|
+| Init variables
+|___________________________________________________________________*/
+
+	*position_changed = false;
+	*camera_changed   = false;
+
+	// Compute amount of movement to make, if any
+	move_amount = ((float)elapsed_time / 1000) * camera->speed;
+
+/*____________________________________________________________________
+|
+| Rotate heading?
+|___________________________________________________________________*/
+
+	// Add to the current x axis rotation
+	if (xrotate != 0) {
+		camera->xrotate += xrotate;
+		if (camera->xrotate < ROTATE_UP_MAX)
+			camera->xrotate = ROTATE_UP_MAX;
+		else if (camera->xrotate > ROTATE_DOWN_MAX)
+			camera->xrotate = ROTATE_DOWN_MAX;
+		camera->sin_x = sinf (DEGREES_TO_RADIANS (camera->xrotate));
+		camera->cos_x = cosf (DEGREES_TO_RADIANS (camera->xrotate));
+	}
+
+	// Add to the current y axis rotation
+	if (yrotate != 0) {
+		camera->yrotate += yrotate;
+		while (camera->yrotate < -360)
+			camera->yrotate += 360;
+		while (camera->yrotate > 360)
+			camera->yrotate -= 360;
+		camera->sin_y = sinf (DEGREES_TO_RADIANS (camera->yrotate));
+		camera->cos_y = cosf (DEGREES_TO_RADIANS (camera->yrotate));
+	}
+
+	if (xrotate != 0 || yrotate != 0)
+		Rotate_Heading (camera);
+
+/*____________________________________________________________________
+|
+| Move position?
+|___________________________________________________________________*/
+
+	if (move || update_all) {
+		if (move & CAMERA_MOVE_FORWARD) {
+			// Move along the view vector
+			for (int i = 0; i < 3; i++)
+				position[i] += move_amount * heading[i];
+		}
+		if (move & CAMERA_MOVE_BACK) {
+			for (int i = 0; i < 3; i++)
+				position[i] -= move_amount * heading[i];
+		}
+		if (move & CAMERA_MOVE_RIGHT) {
+			// Move along the right vector
+			for (int i = 0; i < 3; i++)
+				position[i] += move_amount * camera->right[i];
+		}
+		if (move & CAMERA_MOVE_LEFT) {
+			for (int i = 0; i < 3; i++)
+				position[i] -= move_amount * camera->right[i];
+		}
+		// Walk on the ground, before anything looks at the new position
+		position[1] = camera->eye_height;
+		*position_changed = true;
+	}
+
+	if (xrotate != 0 || yrotate != 0 || *position_changed)
+		*camera_changed = true;
+
+/*____________________________________________________________________
+|
+| Return new position and heading
+|___________________________________________________________________*/
+
+	memcpy (new_position, position, 3 * sizeof(float));
+	memcpy (new_heading, heading, 3 * sizeof(float));
+}
+
+/*____________________________________________________________________
+|
+| Function: Rotate_Heading
+|
+| Input: Called from CameraController_Init(), CameraController_Update()
+| Output: Turns the start heading about x, then about y (row vectors,
+|   like the gx3d rotate matrices), from the cached sines and cosines,
+|   and works out the right vector to go with it.  A rotation keeps the
+|   heading's length, so it isn't normalized again.
+|___________________________________________________________________*/
+
+static inline void Rotate_Heading (CameraController *camera)
+{
+	const float *h = camera->start_heading;
+	float *heading = camera->heading;
+
+	float y = h[1] * camera->cos_x - h[2] * camera->sin_x;
+	float z = h[1] * camera->sin_x + h[2] * camera->cos_x;
+	heading[0] = h[0] * camera->cos_y + z * camera->sin_y;
+	heading[1] = y;
+	heading[2] = z * camera->cos_y - h[0] * camera->sin_y;
+
+	// World up cross heading, straight up or down has no right so keep the last one
+	float length = sqrtf (heading[0] * heading[0] + heading[2] * heading[2]);
+	if (length > 0) {
+		camera->right[0] = heading[2] / length;
+		camera->right[1] = 0;
+		camera->right[2] = -heading[0] / length;
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Normalize
+|
+| Input: Called from CameraController_Init(), CameraController_View_Matrix()
+| Output: Scales v to unit length (if it has any length).
+|___________________________________________________________________*/
+
+static inline void Normalize (float *v)
+{
+	float length = sqrtf (v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+
+	if (length > 0) {
+		v[0] /= length;
+		v[1] /= length;
+		v[2] /= length;
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: CameraController_View_Matrix
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Computes the camera's view matrix, looking from its position
+|   to a point along its heading with the world's up (left handed, row
+|   vectors, laid out like a gx3dMatrix).
+|___________________________________________________________________*/
+
+void CameraController_View_Matrix (const CameraController *camera, float *matrix)
+{
+	const float *eye = camera->position;
+	float to[3], xaxis[3], yaxis[3], zaxis[3];
+
+	// Compute a point the camera is looking at
+	for (int i = 0; i < 3; i++) {
+		to[i] = eye[i] + camera->heading[i] * CAMERA_DISTANCE;
+		zaxis[i] = to[i] - eye[i];
+	}
+	Normalize (zaxis);
+	// x = world up cross z, y = z cross x
+	xaxis[0] = zaxis[2];
+	xaxis[1] = 0;
+	xaxis[2] = -zaxis[0];
+	Normalize (xaxis);
+	yaxis[0] = zaxis[1] * xaxis[2] - zaxis[2] * xaxis[1];
+	yaxis[1] = zaxis[2] * xaxis[0] - zaxis[0] * xaxis[2];
+	yaxis[2] = zaxis[0] * xaxis[1] - zaxis[1] * xaxis[0];
+
+	for (int i = 0; i < 3; i++) {
+		matrix[i * 4 + 0] = xaxis[i];
+		matrix[i * 4 + 1] = yaxis[i];
+		matrix[i * 4 + 2] = zaxis[i];
+		matrix[i * 4 + 3] = 0;
+	}
+	matrix[12] = -(xaxis[0] * eye[0] + xaxis[1] * eye[1] + xaxis[2] * eye[2]);
+	matrix[13] = -(yaxis[0] * eye[0] + yaxis[1] * eye[1] + yaxis[2] * eye[2]);
+	matrix[14] = -(zaxis[0] * eye[0] + zaxis[1] * eye[1] + zaxis[2] * eye[2]);
+	matrix[15] = 1;
+}
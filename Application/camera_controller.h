@@ -0,0 +1,82 @@
+/*____________________________________________________________________
+|
+| File: camera_controller.h
+|
+| Description: First person camera.  Moves the player's eye with the
+|   move keys and turns it with the mouse.  All of a camera's state is
+|   in its CameraController, so any number of them can be updated, on
+|   any threads, and nothing is sent to the graphics library: the
+|   caller asks for the view matrix when it needs one.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _CAMERA_CONTROLLER_H_
+#define _CAMERA_CONTROLLER_H_
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+// move commands
+#define CAMERA_MOVE_FORWARD 0x1
+#define CAMERA_MOVE_BACK    0x2
+#define CAMERA_MOVE_RIGHT   0x4
+#define CAMERA_MOVE_LEFT    0x8
+
+#define RUN_SPEED 15.3f  // feet per second (based on a 12-minute mile run)
+#define EYE_HEIGHT 5     // the eye stays this high above the ground
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	float position[3];
+	float start_heading[3];    // normalized
+	float heading[3];          // normalized
+	float right[3];            // normalized, world up cross heading
+	float speed;               // move speed in feet per second
+	float eye_height;
+	float xrotate;             // degrees, looking down is positive
+	float yrotate;             // degrees, turning right is positive
+	float sin_x, cos_x;        // of xrotate and yrotate, only recomputed when they change
+	float sin_y, cos_y;
+} CameraController;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+// Init starting position, other parameters
+void CameraController_Init (
+	CameraController *camera,
+	const float      *position,
+	const float      *heading,      // 0,0,1 for cubic environment mapping to work correctly (why?)
+	float             move_speed,   // move speed in feet per second
+	float             eye_height );
+
+// Sets new move speed (in fps)
+void CameraController_Set_Speed (CameraController *camera, float move_speed);
+
+// Update position
+void CameraController_Update (
+	CameraController *camera,
+	unsigned          elapsed_time,     // ms
+	unsigned          move,             // CAMERA_MOVE_* bits
+	float             xrotate,          // degrees to turn, see MouseLook_Take()
+	float             yrotate,
+	bool              update_all,
+	bool             *position_changed, // returns true if position has changed, else false
+	bool             *camera_changed,   // return true if heading has changed
+	float            *new_position,
+	float            *new_heading );
+
+// Gets the view matrix (16 floats, row vectors) for the camera as it is now
+void CameraController_View_Matrix (const CameraController *camera, float *matrix);
+
+#endif
@@ -0,0 +1,98 @@
+/*____________________________________________________________________
+|
+| File: fixed_timestep.cpp
+|
+| Description: Fixed rate simulation clock.
+|
+| Functions: FixedTimestep_Init
+|            FixedTimestep_Reset
+|            FixedTimestep_Advance
+|            FixedTimestep_Alpha
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include "fixed_timestep.h"
+
+/*____________________________________________________________________
+|
+| Function: FixedTimestep_Init
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Sets up a clock running rate steps per second, at most
+|   max_steps of them per frame.
+|___________________________________________________________________*/
+
+void FixedTimestep_Init (FixedTimestep *timestep, float rate, int max_steps)
+{
+	timestep->step = 1 / rate;
+	timestep->max_steps = max_steps < 1 ? 1 : max_steps;
+	FixedTimestep_Reset (timestep);
+}
+
+/*____________________________________________________________________
+|
+| Function: FixedTimestep_Reset
+|
+| Input: Called from FixedTimestep_Init(), Program_Run()
+| Output: Throws away any time not yet simulated.
+|___________________________________________________________________*/
+
+void FixedTimestep_Reset (FixedTimestep *timestep)
+{
+	timestep->accumulator = 0;
+	timestep->dropped_steps = 0;
+}
+
+/*____________________________________________________________________
+|
+| Function: FixedTimestep_Advance
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Adds elapsed_seconds and returns # of whole steps now due.  If
+|   more than max_steps are due, the rest are dropped (the simulation
+|   slows down rather than falling further and further behind).
+|___________________________________________________________________*/
+
+int FixedTimestep_Advance (FixedTimestep *timestep, double elapsed_seconds)
+{
+	int steps;
+
+	timestep->accumulator += elapsed_seconds;
+	steps = (int)(timestep->accumulator / timestep->step);
+	if (steps > timestep->max_steps) {
+		timestep->dropped_steps += steps - timestep->max_steps;
+		timestep->accumulator -= (steps - timestep->max_steps) * (double)timestep->step;
+		steps = timestep->max_steps;
+	}
+	timestep->accumulator -= steps * (double)timestep->step;
+
+	return (steps);
+}
+
+/*____________________________________________________________________
+|
+| Function: FixedTimestep_Alpha
+|
+| Input: Called from Program_Run()
+| Output: Returns the fraction of a step left over after the last
+|   advance, for interpolating between the last two simulation states.
+|___________________________________________________________________*/
+
+float FixedTimestep_Alpha (const FixedTimestep *timestep)
+{
+	float alpha = (float)(timestep->accumulator / timestep->step);
+
+	if (alpha < 0)
+		alpha = 0;
+	else if (alpha > 1)
+		alpha = 1;
+
+	return (alpha);
+}
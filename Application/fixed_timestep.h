@@ -0,0 +1,43 @@
+/*____________________________________________________________________
+|
+| File: fixed_timestep.h
+|
+| Description: Accumulator that turns variable frame times into a whole
+|   number of fixed length simulation steps, plus how far the frame is
+|   into the next step (for render interpolation).  Caps the steps run
+|   in one frame so a long stall doesn't snowball.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _FIXED_TIMESTEP_H_
+#define _FIXED_TIMESTEP_H_
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	float  step;               // seconds per simulation step
+	double accumulator;        // seconds not yet simulated
+	int    max_steps;          // most steps run for one frame
+	int    dropped_steps;      // steps skipped because a frame took too long
+} FixedTimestep;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+void  FixedTimestep_Init (FixedTimestep *timestep, float rate, int max_steps);  // rate in steps per second
+void  FixedTimestep_Reset (FixedTimestep *timestep);
+
+// Adds a frame's elapsed time, returns # of steps to run now
+int   FixedTimestep_Advance (FixedTimestep *timestep, double elapsed_seconds);
+
+// Returns how far (0-1) the time is between the last step and the next
+float FixedTimestep_Alpha (const FixedTimestep *timestep);
+
+#endif
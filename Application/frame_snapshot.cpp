@@ -0,0 +1,252 @@
+/*____________________________________________________________________
+|
+| File: frame_snapshot.cpp
+|
+| Description: Builds the renderer's copy of a frame.
+|
+| Functions: FrameSnapshot_Init
+|            FrameSnapshot_Free
+|            FrameSnapshot_Build
+|             Reserve_Monsters
+|             Cull_Trees
+|             Cull_Flowers
+|             Cull_Monsters
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "profile.h"
+#include "frame_snapshot.h"
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+// Shared by the culling jobs of one build
+typedef struct {
+	FrameSnapshot *snapshot;
+	const World   *world;
+	float          alpha;
+	FrameScene    *scene;
+	long long      monster_triangles;
+} FrameBuild;
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static bool Reserve_Monsters (FrameSnapshot *snapshot, int count);
+static void Cull_Trees (void *data);
+static void Cull_Flowers (void *data);
+static void Cull_Monsters (void *data);
+
+/*____________________________________________________________________
+|
+| Function: FrameSnapshot_Init
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Sets up an empty snapshot.
+|___________________________________________________________________*/
+
+void FrameSnapshot_Init (FrameSnapshot *snapshot)
+{
+	memset (snapshot, 0, sizeof(FrameSnapshot));
+}
+
+/*____________________________________________________________________
+|
+| Function: FrameSnapshot_Free
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Frees the snapshot's monster arrays.
+|___________________________________________________________________*/
+
+void FrameSnapshot_Free (FrameSnapshot *snapshot)
+{
+	free (snapshot->monster_type);
+	free (snapshot->monster_x);
+	free (snapshot->monster_z);
+	free (snapshot->monster_growl);
+	free (snapshot->visible_monsters);
+	memset (snapshot, 0, sizeof(FrameSnapshot));
+}
+
+/*____________________________________________________________________
+|
+| Function: FrameSnapshot_Build
+|
+| Input: Called from Program_Run() (on a job), headless driver
+| Output: Copies what gets drawn out of world, then culls the trees,
+|   flowers and monsters against the camera's frustum, each as a job
+|   (or one after the other on this thread if jobs is NULL).  Returns
+|   true on success, else false.
+|___________________________________________________________________*/
+
+bool FrameSnapshot_Build (
+	FrameSnapshot *snapshot,
+	const World   *world,
+	float          alpha,
+	const float   *eye,
+	const float   *heading,
+	FrameScene    *scene,
+	JobSystem     *jobs )
+{
+	FrameBuild build = { snapshot, world, alpha, scene, 0 };
+	ProfileTime start = Profile_Now ();
+
+	if (!Reserve_Monsters (snapshot, world->monsters.count))
+		return (false);
+
+	memcpy (snapshot->eye, eye, 3 * sizeof(float));
+	memcpy (snapshot->heading, heading, 3 * sizeof(float));
+	Frustum_Init (&snapshot->frustum, eye, heading, scene->fov, scene->aspect, scene->near_plane, scene->far_plane);
+	snapshot->health = world->health;
+	snapshot->deadmonsters = world->deadmonsters;
+	snapshot->all_first_aids_collected = World_All_First_Aids_Collected (world);
+	memcpy (snapshot->hit_position, world->hit_position, sizeof(world->hit_position));
+	memcpy (snapshot->hit_timer, world->hit_timer, sizeof(world->hit_timer));
+	memcpy (snapshot->first_aid_collected, world->first_aid_collected, sizeof(world->first_aid_collected));
+	memcpy (snapshot->first_aid_x, world->first_aid_x, sizeof(world->first_aid_x));
+	memcpy (snapshot->first_aid_z, world->first_aid_z, sizeof(world->first_aid_z));
+
+	if (jobs) {
+		JobCounter culled = { 0 };
+		Job_Submit (jobs, Cull_Trees, &build, &culled);
+		Job_Submit (jobs, Cull_Flowers, &build, &culled);
+		Job_Submit (jobs, Cull_Monsters, &build, &culled);
+		Job_Wait (jobs, &culled);
+	}
+	else {
+		Cull_Trees (&build);
+		Cull_Flowers (&build);
+		Cull_Monsters (&build);
+	}
+	snapshot->triangles = scene->tree_lod->stats.triangles + scene->flower_lod->stats.triangles + build.monster_triangles;
+	Profile_Record ("Culling", start, Profile_Now ());
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Reserve_Monsters
+|
+| Input: Called from FrameSnapshot_Build()
+| Output: Makes room for count monsters.  Returns true on success, else
+|   false (the arrays that grew are kept).
+|___________________________________________________________________*/
+
+static bool Reserve_Monsters (FrameSnapshot *snapshot, int count)
+{
+	if (count <= snapshot->monster_capacity)
+		return (true);
+
+	int *type = (int *) realloc (snapshot->monster_type, count * sizeof(int));
+	if (type)
+		snapshot->monster_type = type;
+	float *x = (float *) realloc (snapshot->monster_x, count * sizeof(float));
+	if (x)
+		snapshot->monster_x = x;
+	float *z = (float *) realloc (snapshot->monster_z, count * sizeof(float));
+	if (z)
+		snapshot->monster_z = z;
+	unsigned char *growl = (unsigned char *) realloc (snapshot->monster_growl, count);
+	if (growl)
+		snapshot->monster_growl = growl;
+	int *visible = (int *) realloc (snapshot->visible_monsters, count * sizeof(int));
+	if (visible)
+		snapshot->visible_monsters = visible;
+	if (type == NULL || x == NULL || z == NULL || growl == NULL || visible == NULL)
+		return (false);
+	snapshot->monster_capacity = count;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Cull_Trees
+|
+| Input: Called from FrameSnapshot_Build() (maybe as a job)
+| Output: Culls the trees and sorts the visible ones by level of detail.
+|___________________________________________________________________*/
+
+static void Cull_Trees (void *data)
+{
+	FrameBuild *build = (FrameBuild *) data;
+	FrameSnapshot *snapshot = build->snapshot;
+	LodGroup *lod = build->scene->tree_lod;
+
+	int n = SceneryBVH_Cull (build->scene->tree_bvh, &snapshot->frustum, snapshot->visible_trees);
+	Lod_Select (lod, snapshot->visible_trees, n, build->world->tree_x, build->world->tree_z, snapshot->eye, build->scene->pixel_scale);
+	for (int l = 0; l < LOD_MAX_LEVELS; l++) {
+		snapshot->num_trees[l] = l < lod->model->num_levels ? lod->stats.count[l] : 0;
+		memcpy (snapshot->trees[l], lod->list[l], snapshot->num_trees[l] * sizeof(int));
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Cull_Flowers
+|
+| Input: Called from FrameSnapshot_Build() (maybe as a job)
+| Output: Culls the flowers and keeps the ones close and big enough to
+|   draw (flowers have one level of detail).
+|___________________________________________________________________*/
+
+static void Cull_Flowers (void *data)
+{
+	FrameBuild *build = (FrameBuild *) data;
+	FrameSnapshot *snapshot = build->snapshot;
+	LodGroup *lod = build->scene->flower_lod;
+
+	int n = SceneryBVH_Cull (build->scene->flower_bvh, &snapshot->frustum, snapshot->visible_flowers);
+	Lod_Select (lod, snapshot->visible_flowers, n, build->world->flower_x, build->world->flower_z, snapshot->eye, build->scene->pixel_scale);
+	snapshot->num_flowers = lod->stats.count[0];
+	memcpy (snapshot->flowers, lod->list[0], snapshot->num_flowers * sizeof(int));
+}
+
+/*____________________________________________________________________
+|
+| Function: Cull_Monsters
+|
+| Input: Called from FrameSnapshot_Build() (maybe as a job)
+| Output: Copies every monster at its render position and lists the
+|   ones whose bounding sphere is in view.
+|___________________________________________________________________*/
+
+static void Cull_Monsters (void *data)
+{
+	FrameBuild *build = (FrameBuild *) data;
+	FrameSnapshot *snapshot = build->snapshot;
+	const World *world = build->world;
+	int n = 0;
+
+	snapshot->num_monsters = world->monsters.count;
+	for (int k = 0; k < world->monsters.count; k++) {
+		int type = world->monsters.type[k];
+		float center[3];
+		World_Monster_Render_Position (world, k, build->alpha, &snapshot->monster_x[k], &snapshot->monster_z[k]);
+		snapshot->monster_type[k] = type;
+		snapshot->monster_growl[k] = world->monsters.growl[k];
+		center[0] = snapshot->monster_x[k];
+		center[1] = world->monster_center_y[type];
+		center[2] = snapshot->monster_z[k];
+		if (Frustum_Test_Sphere (&snapshot->frustum, center, world->monster_radius[type]) != FRUSTUM_OUTSIDE) {
+			snapshot->visible_monsters[n++] = k;
+			build->monster_triangles += build->scene->monster_triangles[type];
+		}
+	}
+	snapshot->num_visible_monsters = n;
+}
@@ -0,0 +1,107 @@
+/*____________________________________________________________________
+|
+| File: frame_snapshot.h
+|
+| Description: Everything the renderer needs to draw one frame, copied
+|   out of the world after the frame's simulation steps: the camera,
+|   the visible scenery at its level of detail, the visible monsters at
+|   their render positions, hit markers, first aids and the player's
+|   state.  The game keeps two, so the next frame's simulation and
+|   culling can fill one on worker threads while the main thread draws
+|   the other, and nothing the renderer reads is changed under it.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _FRAME_SNAPSHOT_H_
+#define _FRAME_SNAPSHOT_H_
+
+#include "world.h"
+#include "frustum.h"
+#include "scenery_bvh.h"
+#include "lod.h"
+#include "job.h"
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+// What a snapshot is built from, besides the world (doesn't change between frames)
+typedef struct {
+	const SceneryBVH *tree_bvh;
+	const SceneryBVH *flower_bvh;
+	LodGroup         *tree_lod;        // only one snapshot may be built at a time, these keep state
+	LodGroup         *flower_lod;
+	float             fov;             // projection
+	float             aspect;
+	float             near_plane;
+	float             far_plane;
+	float             pixel_scale;     // for LOD, see Lod_Pixel_Scale()
+	int               monster_triangles[WORLD_MONSTER_TYPES];
+} FrameScene;
+
+typedef struct {
+	// Camera the frame was culled for
+	float       eye[3];
+	float       heading[3];
+	float       view[16];              // view matrix (filled in by the caller)
+	Frustum     frustum;
+	// Player
+	float       health;
+	int         deadmonsters;
+	bool        all_first_aids_collected;
+	// Monsters at their render positions, and the ones in view
+	int         num_monsters;
+	int         monster_capacity;
+	int        *monster_type;
+	float      *monster_x;
+	float      *monster_z;
+	unsigned char *monster_growl;
+	int        *visible_monsters;
+	int         num_visible_monsters;
+	// Scenery in view, by level of detail
+	int         trees[LOD_MAX_LEVELS][WORLD_MAX_TREES];
+	int         num_trees[LOD_MAX_LEVELS];
+	int         flowers[WORLD_MAX_FLOWERS];
+	int         num_flowers;
+	long long   triangles;             // scenery and monsters in view
+	// Hit markers and first aids
+	WorldVector hit_position[WORLD_MAX_HIT];
+	float       hit_timer[WORLD_MAX_HIT];
+	bool        first_aid_collected[WORLD_MAX_EVENTS];
+	float       first_aid_x[WORLD_MAX_EVENTS];   // moved away once collected
+	float       first_aid_z[WORLD_MAX_EVENTS];
+	// What happened in the steps before the snapshot (filled in by the caller)
+	int         steps;
+	int         hits;
+	int         first_aids_collected;
+	// Scratch for culling
+	int         visible_trees[WORLD_MAX_TREES];
+	int         visible_flowers[WORLD_MAX_FLOWERS];
+} FrameSnapshot;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+void FrameSnapshot_Init (FrameSnapshot *snapshot);
+void FrameSnapshot_Free (FrameSnapshot *snapshot);
+
+// Fills in snapshot from world, drawing monsters alpha (0-1) of the way
+//   through the last step, and culls it for a camera at eye looking
+//   along heading.  Trees, flowers and monsters are culled as separate
+//   jobs if jobs isn't NULL.  Returns true on success, false if out of
+//   memory.
+bool FrameSnapshot_Build (
+	FrameSnapshot *snapshot,
+	const World   *world,
+	float          alpha,
+	const float   *eye,
+	const float   *heading,
+	FrameScene    *scene,
+	JobSystem     *jobs );
+
+#endif
@@ -0,0 +1,183 @@
+/*____________________________________________________________________
+|
+| File: frustum.cpp
+|
+| Description: Platform independent view frustum.
+|
+| Functions: Frustum_Init
+|             Set_Plane
+|            Frustum_Test_Box
+|            Frustum_Test_Sphere
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <math.h>
+
+#include "frustum.h"
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static void Set_Plane (float *plane, float nx, float ny, float nz, const float *point);
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define DEGREES_TO_RADIANS(_d_) ((_d_) * 3.14159265f / 180)
+
+/*____________________________________________________________________
+|
+| Function: Frustum_Init
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Computes the 6 planes of a left-handed perspective view
+|   (world up is +y).
+|___________________________________________________________________*/
+
+void Frustum_Init (
+	Frustum     *frustum,
+	const float *eye,
+	const float *heading,
+	float        fov,
+	float        aspect,
+	float        near_plane,
+	float        far_plane )
+{
+	float fx, fy, fz, rx, ry, rz, ux, uy, uz, len, tan_x, tan_y, p[3];
+
+	fx = heading[0];
+	fy = heading[1];
+	fz = heading[2];
+
+	// right = world_up x heading
+	rx = fz;
+	ry = 0;
+	rz = -fx;
+	len = sqrtf ((rx * rx) + (rz * rz));
+	if (len < 1e-6f) {
+		// looking straight up or down, any right vector will do
+		rx = 1;
+		rz = 0;
+	}
+	else {
+		rx /= len;
+		rz /= len;
+	}
+	// up = heading x right
+	ux = (fy * rz) - (fz * ry);
+	uy = (fz * rx) - (fx * rz);
+	uz = (fx * ry) - (fy * rx);
+
+	tan_y = tanf (DEGREES_TO_RADIANS (fov) / 2);
+	tan_x = tan_y * aspect;
+
+	// Near and far
+	p[0] = eye[0] + (fx * near_plane);
+	p[1] = eye[1] + (fy * near_plane);
+	p[2] = eye[2] + (fz * near_plane);
+	Set_Plane (frustum->plane[0], fx, fy, fz, p);
+	p[0] = eye[0] + (fx * far_plane);
+	p[1] = eye[1] + (fy * far_plane);
+	p[2] = eye[2] + (fz * far_plane);
+	Set_Plane (frustum->plane[1], -fx, -fy, -fz, p);
+	// Left, right, bottom, top
+	Set_Plane (frustum->plane[2],  rx + (fx * tan_x),  ry + (fy * tan_x),  rz + (fz * tan_x), eye);
+	Set_Plane (frustum->plane[3], -rx + (fx * tan_x), -ry + (fy * tan_x), -rz + (fz * tan_x), eye);
+	Set_Plane (frustum->plane[4],  ux + (fx * tan_y),  uy + (fy * tan_y),  uz + (fz * tan_y), eye);
+	Set_Plane (frustum->plane[5], -ux + (fx * tan_y), -uy + (fy * tan_y), -uz + (fz * tan_y), eye);
+}
+
+/*____________________________________________________________________
+|
+| Function: Set_Plane
+|
+| Input: Called from Frustum_Init()
+| Output: Sets plane to have the normalized normal n and go through
+|   point.
+|___________________________________________________________________*/
+
+static void Set_Plane (float *plane, float nx, float ny, float nz, const float *point)
+{
+	float len = sqrtf ((nx * nx) + (ny * ny) + (nz * nz));
+
+	plane[0] = nx / len;
+	plane[1] = ny / len;
+	plane[2] = nz / len;
+	plane[3] = -((plane[0] * point[0]) + (plane[1] * point[1]) + (plane[2] * point[2]));
+}
+
+/*____________________________________________________________________
+|
+| Function: Frustum_Test_Box
+|
+| Input: Called from SceneryBVH_Cull()
+| Output: Returns relation of the axis aligned box to the frustum.  Only
+|   tests the planes whose bits are set in *planes (if planes is NULL,
+|   tests all of them).  Bits of planes the box is completely inside
+|   of are cleared.
+|___________________________________________________________________*/
+
+FrustumRelation Frustum_Test_Box (const Frustum *frustum, const float *min, const float *max, unsigned *planes)
+{
+	unsigned mask = planes ? *planes : FRUSTUM_ALL_PLANES;
+	FrustumRelation relation = FRUSTUM_INSIDE;
+
+	for (int i = 0; i < FRUSTUM_PLANES; i++) {
+		if ((mask & (1 << i)) == 0)
+			continue;
+		const float *p = frustum->plane[i];
+		// corner farthest along the normal, and the one nearest
+		float far_x  = p[0] >= 0 ? max[0] : min[0];
+		float far_y  = p[1] >= 0 ? max[1] : min[1];
+		float far_z  = p[2] >= 0 ? max[2] : min[2];
+		float near_x = p[0] >= 0 ? min[0] : max[0];
+		float near_y = p[1] >= 0 ? min[1] : max[1];
+		float near_z = p[2] >= 0 ? min[2] : max[2];
+		if ((p[0] * far_x) + (p[1] * far_y) + (p[2] * far_z) + p[3] < 0)
+			return (FRUSTUM_OUTSIDE);
+		if ((p[0] * near_x) + (p[1] * near_y) + (p[2] * near_z) + p[3] < 0)
+			relation = FRUSTUM_INTERSECT;
+		else
+			mask &= ~(1 << i);
+	}
+
+	if (planes)
+		*planes = mask;
+
+	return (relation);
+}
+
+/*____________________________________________________________________
+|
+| Function: Frustum_Test_Sphere
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Returns relation of the sphere to the frustum.
+|___________________________________________________________________*/
+
+FrustumRelation Frustum_Test_Sphere (const Frustum *frustum, const float *center, float radius)
+{
+	FrustumRelation relation = FRUSTUM_INSIDE;
+
+	for (int i = 0; i < FRUSTUM_PLANES; i++) {
+		const float *p = frustum->plane[i];
+		float d = (p[0] * center[0]) + (p[1] * center[1]) + (p[2] * center[2]) + p[3];
+		if (d < -radius)
+			return (FRUSTUM_OUTSIDE);
+		if (d < radius)
+			relation = FRUSTUM_INTERSECT;
+	}
+
+	return (relation);
+}
@@ -0,0 +1,58 @@
+/*____________________________________________________________________
+|
+| File: frustum.h
+|
+| Description: Platform independent view frustum built from the camera
+|   position, heading and projection, with box and sphere tests.  Lets
+|   culling run without the graphics library (headless, worker threads).
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _FRUSTUM_H_
+#define _FRUSTUM_H_
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define FRUSTUM_PLANES     6
+#define FRUSTUM_ALL_PLANES ((1 << FRUSTUM_PLANES) - 1)
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef enum {
+	FRUSTUM_OUTSIDE,
+	FRUSTUM_INSIDE,
+	FRUSTUM_INTERSECT
+} FrustumRelation;
+
+typedef struct {
+	float plane[FRUSTUM_PLANES][4];   // normal (pointing inside), distance
+} Frustum;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+void Frustum_Init (
+	Frustum     *frustum,
+	const float *eye,          // x,y,z
+	const float *heading,      // x,y,z normalized view direction
+	float        fov,          // vertical field of view in degrees
+	float        aspect,       // width / height
+	float        near_plane,
+	float        far_plane );
+
+// Tests a box against the planes set in *planes and clears the bits of
+//   planes the box is completely inside of (so children can skip them)
+FrustumRelation Frustum_Test_Box (const Frustum *frustum, const float *min, const float *max, unsigned *planes);
+FrustumRelation Frustum_Test_Sphere (const Frustum *frustum, const float *center, float radius);
+
+#endif
@@ -0,0 +1,2905 @@
+/*____________________________________________________________________
+|
+| File: headless.cpp
+|
+| Description: Headless driver for the game simulation.  Runs the world
+|   with no renderer, sound or input so the simulation can be
+|   benchmarked and regression tested on any platform.  Only needs the
+|   platform independent modules:
+|
+|     g++ -O2 -ffp-contract=off -o headless headless.cpp world.cpp \
+|         monster_pool.cpp monster_kernel.cpp spatial_grid.cpp \
+|         frustum.cpp scenery_bvh.cpp render_queue.cpp fixed_timestep.cpp \
+|         profile.cpp input.cpp replay.cpp rng.cpp spawn.cpp hitscan.cpp \
+|         particles.cpp voice.cpp asset_loader.cpp asset_pack.cpp \
+|         asset_convert.cpp hud_text.cpp lod.cpp job.cpp frame_snapshot.cpp \
+|         camera_controller.cpp mouse_look.cpp light_manager.cpp \
+|         light_cluster.cpp
+|
+|   Usage: headless [options]
+|     -ticks n        # of simulation steps to run
+|     -rate n         simulation steps per second
+|     -frame-ms n     simulated render frame time (results must not depend on it)
+|     -seed n         random seed
+|     -monsters n     # of monsters of each type
+|     -kernel name    monster kernel: scalar, sse2 or avx2
+|     -verify         check that every monster kernel, and bulk and single random draws, give identical
+|                     results, that respawn points keep away from the player, and that
+|                     shots hit what a test against every monster and tree hits, and that
+|                     the loudest sounds get the real voices, and that HUD numbers of any
+|                     length lay out where the old three digit score did, and that mouse
+|                     look turns as far for the same movement at any frame rate, and that
+|                     shots read during a frame are taken by its last step
+|     -scenery n      benchmark frustum culling n props, hierarchy vs brute force
+|     -render         count draw calls and state changes, per instance vs render queue
+|     -lod            count triangles drawn and level switches per frame with level of detail
+|     -pipeline       time frames with the simulation and culling on the main thread vs on a
+|                     job, a frame ahead of the (mock) draw, and check both draw the same
+|     -camera-update n time n camera updates from scripted mouse movement, cached
+|                     rotation vs rotate matrices, and check they agree
+|     -cameras n      benchmark updating n cameras, one after the other and in parallel on
+|                     jobs, and check they end up the same
+|     -particles n    benchmark n particle emitters seen from a moving camera
+|     -lights n       walk through n fire lights, count lights sent to the driver per frame
+|     -clusters n     benchmark building light clusters for n lights from a moving camera,
+|                     and check cluster shading matches shading with every light
+|     -assets file    benchmark loading the files listed in file, twice (drop the OS
+|                     file cache first for cold numbers).  One asset per line, a
+|                     texture's alpha file after it, as for the packer tool.
+|     -load-threads n asset reading threads, 0 reads them one by one on the main thread
+|                     like the game used to (default: one less than the # of cores)
+|     -pack file      time mapping an asset pack and viewing every entry; with -assets,
+|                     also converting the listed loose files and checking the pack matches
+|     -profile file   print per frame zone times and write a Chrome trace to file
+|     -record file    save the simulation's input to a replay file
+|     -replay file    rerun a recorded session (game or headless) as fast as possible
+|
+| Functions: main
+|             Run_Simulation
+|              State_Hash
+|             Run_Replay
+|             Verify_Kernels
+|              Random_Float
+|             Verify_Rng
+|             Verify_Spawn
+|             Verify_Hitscan
+|             Verify_Voices
+|             Verify_Hud_Text
+|             Verify_Mouse_Look
+|             Verify_Input
+|             Bench_Scenery
+|             Bench_Render
+|              Queue_Frame
+|             Bench_Lod
+|             Bench_Pipeline
+|              Pipeline_Frame
+|              Submit_Snapshot
+|             Bench_Cameras
+|              Update_Cameras
+|             Bench_Camera_Update
+|              Matrix_Camera_Update
+|             Bench_Lights
+|             Bench_Clusters
+|             Bench_Particles
+|             Bench_Assets
+|              Read_Asset_List
+|              Bench_Upload
+|             Bench_Pack
+|              Verify_Empty_Polygons
+|               Put_BE32
+|              Mock_Set_Texture
+|              Mock_Set_Object_Matrix
+|              Mock_Draw_Object
+|              Mock_Draw_Instances
+|              Null_Load_Sample
+|              Null_Play
+|              Null_Stop
+|              Null_Is_Playing
+|              Null_Set_Position
+|              Mock_Set_Light
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+#include "world.h"
+#include "monster_kernel.h"
+#include "scenery_bvh.h"
+#include "render_queue.h"
+#include "fixed_timestep.h"
+#include "profile.h"
+#include "input.h"
+#include "replay.h"
+#include "rng.h"
+#include "particles.h"
+#include "voice.h"
+#include "hud_text.h"
+#include "lod.h"
+#include "job.h"
+#include "frame_snapshot.h"
+#include "camera_controller.h"
+#include "mouse_look.h"
+#include "light_manager.h"
+#include "light_cluster.h"
+#include "asset_loader.h"
+#include "asset_pack.h"
+#include "asset_convert.h"
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define DEFAULT_TICKS   100000
+#define DEFAULT_SEED    1
+#define DEFAULT_RATE    60     // simulation steps per second
+#define DEFAULT_FRAME   16     // ms, simulated render frame time
+#define SHOT_INTERVAL   30     // ticks between shots
+#define WALK_RADIUS     300.0f // player walks in a circle this big
+#define VERIFY_MONSTERS 1003   // not a multiple of the SIMD width, to exercise the scalar remainder
+#define VERIFY_ROUNDS   2000
+#define SCENERY_FRAMES  2000   // camera positions to cull from
+#define CAMERA_FOV      75     // same projection as the game
+#define CAMERA_ASPECT   (4.0f / 3)
+#define CAMERA_NEAR     0.1f
+#define CAMERA_FAR      2750
+#define TEST_STREAM     RNG_NUM_STREAMS   // random stream for test data, not used by the game
+#define RNG_VERIFY_DRAWS 1000003
+#define SPAWN_VERIFY_CENTERS 10000
+#define SPAWN_VERIFY_POINTS  100  // per center
+#define HITSCAN_VERIFY_SHOTS 20000
+#define HITSCAN_VERIFY_MONSTERS 2000  // extra monsters of each type
+#define PARTICLE_CAPACITY 65536
+#define VOICE_EMITTERS  300    // growling monsters around the listener
+#define VOICE_BUDGET    16     // same as the game
+#define VOICE_FRAMES    5000
+#define LOAD_FRAME_SECONDS (1.0f / 60)   // upload budget per loading screen frame, same as the game
+#define LOD_SCREEN_HEIGHT 768
+#define LOD_HYSTERESIS  0.15f  // same as the game
+#define PIPELINE_HEALTH 1000   // the scripted player is healed when it drops below this
+#define CAMERA_BATCH    256    // cameras updated per job
+#define LIGHT_SLOTS     4      // same as the game
+#define CLUSTER_MIN_RANGE 10   // muzzle flash
+#define CLUSTER_MAX_RANGE 75   // fire
+#define CLUSTER_CHECK_EVERY 16 // frames between shading checks
+#define CLUSTER_SAMPLES 64     // points shaded per check
+#define CLUSTER_SAMPLE_FAR 400 // farthest point shaded
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+// Counts the calls a render backend gets
+typedef struct {
+	long long texture_changes;
+	long long matrix_changes;
+	long long draw_calls;
+} MockRenderer;
+
+// Sound backend with no sound: plays for the sample's length on a clock the caller advances
+typedef struct {
+	double time;
+	float  seconds[VOICE_MAX_SAMPLES];
+	int    loads;
+	int    voice_sample[VOICE_MAX_VOICES];   // -1 if stopped
+	double voice_end[VOICE_MAX_VOICES];
+	float  voice_pos[VOICE_MAX_VOICES][3];
+	long long plays;
+	long long positions;
+} NullSound;
+
+// Light slots as a driver would have them
+typedef struct {
+	LightDesc slot[LIGHT_MAX_SLOTS];
+	bool      lit[LIGHT_MAX_SLOTS];
+} MockLights;
+
+// Stands in for the graphics library: "uploads" an asset by reading every byte
+typedef struct {
+	long long bytes;
+	unsigned  checksum;
+} BenchUploads;
+
+// One frame of the scripted player, simulated and culled by Pipeline_Frame()
+typedef struct {
+	World         *world;
+	int            frame;
+	FrameSnapshot *snapshot;
+	FrameScene    *scene;
+	JobSystem     *jobs;            // NULL to cull on the calling thread
+	double         sim_seconds;
+	double         build_seconds;
+	bool           ok;
+} PipelineFrame;
+
+// A slice of the cameras for Update_Cameras()
+typedef struct {
+	CameraController *cameras;
+	int               count;
+	int               first;        // index of cameras[0], picks its scripted input
+	int               frame;
+} CameraBatch;
+
+/*___________________
+|
+| Global variables
+|__________________*/
+
+static Rng Test_Rng;
+
+// Same switch points as the game: full tree, simple tree, impostor; flowers dropped past 400 units
+static const LodModel Tree_Lod_Model = { 3, { 150, 40, 0 }, { 2400, 600, 2 }, 16, 15, 0 };
+static const LodModel Flower_Lod_Model = { 1, { 3 }, { 180 }, 1.5f, 1, 400 };
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static void Run_Simulation (World *world, int ticks, float rate, unsigned frame_ms, Replay *record);
+static void Run_Replay (World *world, Replay *replay);
+static unsigned State_Hash (const World *world);
+static bool Verify_Kernels (unsigned seed);
+static float Random_Float (float low, float high);
+static bool Verify_Rng (unsigned seed);
+static bool Verify_Spawn (unsigned seed);
+static bool Verify_Hitscan (unsigned seed);
+static bool Verify_Voices (unsigned seed);
+static bool Verify_Hud_Text ();
+static bool Verify_Mouse_Look ();
+static bool Verify_Input ();
+static bool Bench_Scenery (unsigned seed, int props);
+static bool Bench_Render (World *world, int frames);
+static int  Queue_Frame (World *world, const SceneryBVH *tree_bvh, const SceneryBVH *flower_bvh, const Frustum *frustum, int *visible, RenderQueue *queue);
+static bool Bench_Lod (World *world, int frames);
+static bool Bench_Pipeline (unsigned seed, int monsters, MonsterKernelType kernel, int frames);
+static void Pipeline_Frame (void *data);
+static unsigned Submit_Snapshot (const FrameSnapshot *snapshot, const World *world, RenderQueue *queue, RenderBackend *backend);
+static bool Bench_Cameras (int cameras, int frames);
+static void Update_Cameras (void *data);
+static bool Bench_Camera_Update (int updates);
+static void Matrix_Camera_Update (CameraController *camera, unsigned elapsed_time, unsigned move, float xrotate, float yrotate);
+static bool Bench_Lights (unsigned seed, int lights, int frames);
+static bool Bench_Clusters (unsigned seed, int lights, int frames);
+static bool Bench_Particles (unsigned seed, int emitters);
+static bool Bench_Assets (const char *list_file, int threads);
+static int  Read_Asset_List (const char *list_file, char (*files)[ASSET_MAX_PATH], char (*alt_files)[ASSET_MAX_PATH]);
+static bool Bench_Upload (void *context, Asset *asset);
+static bool Bench_Pack (const char *pack_file, const char *list_file);
+static bool Verify_Empty_Polygons ();
+static void Put_BE32 (unsigned char *p, unsigned n);
+static void Mock_Set_Texture (void *context, RenderTexture texture);
+static void Mock_Set_Object_Matrix (void *context, RenderObject object, const float *matrix);
+static void Mock_Draw_Object (void *context, RenderObject object);
+static void Mock_Draw_Instances (void *context, RenderObject object, const float *matrices, int count);
+static bool Null_Load_Sample (void *context, int sample, const char *file, bool positional, float min_dist, float max_dist, float *seconds);
+static void Null_Play (void *context, int voice, int sample, bool loop, float volume);
+static void Null_Stop (void *context, int voice);
+static bool Null_Is_Playing (void *context, int voice);
+static void Null_Set_Position (void *context, int voice, float x, float y, float z);
+static void Mock_Set_Light (void *context, int slot, const LightDesc *light);
+
+/*____________________________________________________________________
+|
+| Function: main
+|
+| Input: Command line options (see top of file)
+| Output: Runs the simulation and prints timing and game statistics.
+|___________________________________________________________________*/
+
+int main (int argc, char **argv)
+{
+	int ticks = DEFAULT_TICKS;
+	float rate = DEFAULT_RATE;
+	unsigned frame_ms = DEFAULT_FRAME;
+	unsigned seed = DEFAULT_SEED;
+	int monsters = WORLD_START_MONSTERS;
+	MonsterKernelType kernel = MonsterKernel_Best ();
+	bool verify = false;
+	int scenery = 0;
+	bool render = false;
+	bool lod = false;
+	bool pipeline = false;
+	int cameras = 0;
+	int camera_updates = 0;
+	int particles = 0;
+	int lights = 0;
+	int clusters = 0;
+	const char *assets_file = NULL;
+	int load_threads = 0;
+	bool load_threads_set = false;
+	const char *pack_file = NULL;
+	const char *profile_file = NULL;
+	const char *record_file = NULL;
+	const char *replay_file = NULL;
+	Replay replay;
+	World *world;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp (argv[i], "-ticks") && i + 1 < argc)
+			ticks = atoi (argv[++i]);
+		else if (!strcmp (argv[i], "-rate") && i + 1 < argc)
+			rate = (float) atof (argv[++i]);
+		else if (!strcmp (argv[i], "-frame-ms") && i + 1 < argc)
+			frame_ms = (unsigned) atoi (argv[++i]);
+		else if (!strcmp (argv[i], "-seed") && i + 1 < argc)
+			seed = (unsigned) strtoul (argv[++i], NULL, 10);
+		else if (!strcmp (argv[i], "-monsters") && i + 1 < argc)
+			monsters = atoi (argv[++i]);
+		else if (!strcmp (argv[i], "-kernel") && i + 1 < argc) {
+			i++;
+			if (!strcmp (argv[i], "scalar"))
+				kernel = MONSTER_KERNEL_SCALAR;
+			else if (!strcmp (argv[i], "sse2"))
+				kernel = MONSTER_KERNEL_SSE2;
+			else if (!strcmp (argv[i], "avx2"))
+				kernel = MONSTER_KERNEL_AVX2;
+			else {
+				fprintf (stderr, "unknown kernel %s\n", argv[i]);
+				return (1);
+			}
+		}
+		else if (!strcmp (argv[i], "-verify"))
+			verify = true;
+		else if (!strcmp (argv[i], "-scenery") && i + 1 < argc)
+			scenery = atoi (argv[++i]);
+		else if (!strcmp (argv[i], "-render"))
+			render = true;
+		else if (!strcmp (argv[i], "-lod"))
+			lod = true;
+		else if (!strcmp (argv[i], "-pipeline"))
+			pipeline = true;
+		else if (!strcmp (argv[i], "-cameras") && i + 1 < argc)
+			cameras = atoi (argv[++i]);
+		else if (!strcmp (argv[i], "-camera-update") && i + 1 < argc)
+			camera_updates = atoi (argv[++i]);
+		else if (!strcmp (argv[i], "-particles") && i + 1 < argc)
+			particles = atoi (argv[++i]);
+		else if (!strcmp (argv[i], "-lights") && i + 1 < argc)
+			lights = atoi (argv[++i]);
+		else if (!strcmp (argv[i], "-clusters") && i + 1 < argc)
+			clusters = atoi (argv[++i]);
+		else if (!strcmp (argv[i], "-assets") && i + 1 < argc)
+			assets_file = argv[++i];
+		else if (!strcmp (argv[i], "-load-threads") && i + 1 < argc) {
+			load_threads = atoi (argv[++i]);
+			load_threads_set = true;
+		}
+		else if (!strcmp (argv[i], "-pack") && i + 1 < argc)
+			pack_file = argv[++i];
+		else if (!strcmp (argv[i], "-profile") && i + 1 < argc)
+			profile_file = argv[++i];
+		else if (!strcmp (argv[i], "-record") && i + 1 < argc)
+			record_file = argv[++i];
+		else if (!strcmp (argv[i], "-replay") && i + 1 < argc)
+			replay_file = argv[++i];
+		else {
+			fprintf (stderr, "unknown option %s\n", argv[i]);
+			return (1);
+		}
+	}
+
+	if (rate <= 0 || frame_ms == 0) {
+		fprintf (stderr, "rate and frame time must be positive\n");
+		return (1);
+	}
+	if (verify) {
+		bool ok = Verify_Kernels (seed);
+		ok = Verify_Rng (seed) && ok;
+		ok = Verify_Spawn (seed) && ok;
+		ok = Verify_Hitscan (seed) && ok;
+		ok = Verify_Voices (seed) && ok;
+		ok = Verify_Hud_Text () && ok;
+		ok = Verify_Mouse_Look () && ok;
+		ok = Verify_Input () && ok;
+		return (ok ? 0 : 1);
+	}
+	if (scenery > 0)
+		return (Bench_Scenery (seed, scenery) ? 0 : 1);
+	if (particles > 0)
+		return (Bench_Particles (seed, particles) ? 0 : 1);
+	if (cameras > 0)
+		return (Bench_Cameras (cameras, ticks) ? 0 : 1);
+	if (lights > 0)
+		return (Bench_Lights (seed, lights, ticks) ? 0 : 1);
+	if (clusters > 0)
+		return (Bench_Clusters (seed, clusters, ticks) ? 0 : 1);
+	if (camera_updates > 0)
+		return (Bench_Camera_Update (camera_updates) ? 0 : 1);
+	if (pack_file)
+		return (Bench_Pack (pack_file, assets_file) ? 0 : 1);
+	if (assets_file)
+		return (Bench_Assets (assets_file, load_threads_set ? load_threads : -1) ? 0 : 1);
+
+	if (!MonsterKernel_Supported (kernel)) {
+		fprintf (stderr, "%s kernel not supported on this cpu\n", MonsterKernel_Name (kernel));
+		return (1);
+	}
+	if (pipeline)
+		return (Bench_Pipeline (seed, monsters, kernel, ticks) ? 0 : 1);
+
+	// A replay sets up the world the way it was recorded
+	if (replay_file) {
+		if (!Replay_Load (&replay, replay_file)) {
+			fprintf (stderr, "can't read replay %s\n", replay_file);
+			return (1);
+		}
+		seed = replay.seed;
+		monsters = replay.monsters;
+	}
+
+	world = (World *) malloc (sizeof(World));
+	if (world == NULL) {
+		fprintf (stderr, "out of memory\n");
+		return (1);
+	}
+
+	if (!World_Init (world, seed)) {
+		fprintf (stderr, "can't init world\n");
+		return (1);
+	}
+	for (int i = 0; i < WORLD_MONSTER_TYPES; i++)
+		if (monsters > WORLD_START_MONSTERS)
+			World_Spawn_Monsters (world, i, monsters - WORLD_START_MONSTERS);
+	World_Set_Monster_Bounds (world, 0, 6, 4);
+	World_Set_Monster_Bounds (world, 1, 6, 4);
+	World_Set_Monster_Bounds (world, 2, 3, 4);
+	if (replay_file)
+		for (int i = 0; i < WORLD_MONSTER_TYPES; i++)
+			World_Set_Monster_Bounds (world, i, replay.monster_center_y[i], replay.monster_radius[i]);
+	World_Set_Monster_Kernel (world, kernel);
+	if (record_file && !Replay_Init (&replay, seed, rate, world, REPLAY_FLAG_IMMORTAL)) {
+		fprintf (stderr, "out of memory\n");
+		return (1);
+	}
+
+	if (profile_file) {
+		Profile_Init ();
+		Profile_Set_Thread_Name ("main");
+	}
+	if (render || lod) {
+		if (!(render ? Bench_Render (world, ticks) : Bench_Lod (world, ticks))) {
+			World_Free (world);
+			free (world);
+			return (1);
+		}
+	}
+	else if (replay_file) {
+		Run_Replay (world, &replay);
+		Replay_Free (&replay);
+	}
+	else {
+		Run_Simulation (world, ticks, rate, frame_ms, record_file ? &replay : NULL);
+		if (record_file) {
+			if (Replay_Save (&replay, record_file))
+				printf ("recorded:         %d ticks in %d bytes\n", replay.ticks, replay.size);
+			else
+				fprintf (stderr, "can't write %s\n", record_file);
+			Replay_Free (&replay);
+		}
+	}
+
+	if (profile_file) {
+		ProfileZoneSummary summary[PROFILE_MAX_ZONES];
+		int num_zones = Profile_Summary (summary, PROFILE_MAX_ZONES);
+		printf ("zone (ms per frame, last %d frames)  p50      p99      max\n", num_zones ? summary[0].frames : 0);
+		for (int i = 0; i < num_zones; i++)
+			printf ("  %-32s %8.4f %8.4f %8.4f\n", summary[i].name, summary[i].p50_ms, summary[i].p99_ms, summary[i].max_ms);
+		if (!Profile_Write_Trace (profile_file))
+			fprintf (stderr, "can't write %s\n", profile_file);
+		Profile_Free ();
+	}
+
+	World_Free (world);
+	free (world);
+
+	return (0);
+}
+
+/*____________________________________________________________________
+|
+| Function: Run_Simulation
+|
+| Input: Called from main()
+| Output: Steps the world with a scripted player (walking in a circle,
+|   shooting periodically) and reports ticks per second.  Time comes in
+|   frames of frame_ms through a fixed timestep clock, the way the game
+|   drives it, so the results (and state hash) are the same for any
+|   frame time.  Shots are queued as input commands at the start of the
+|   frame they happen in, stamped with the time they happen (mid tick),
+|   and taken by the step whose slice of time they fall in.  If record
+|   isn't NULL, each step's input is added to it.
+|___________________________________________________________________*/
+
+static void Run_Simulation (World *world, int ticks, float rate, unsigned frame_ms, Replay *record)
+{
+	WorldInput input;
+	WorldStepResult result;
+	FixedTimestep clock;
+	int hits = 0, kills = 0, first_aids = 0;
+	long long nearby = 0;
+	int nearest_found = 0;
+	int frames = 0, tick = 0, next_shot = 0;
+	double seconds;
+	InputQueue input_queue;
+	InputLatency latency;
+	ProfileTime frame_time = 0;
+
+	memset (&input, 0, sizeof(input));
+	input.player_position.y = 6;
+	input.moving = true;
+	// No cap on steps per frame, every frame time must give the same simulation
+	FixedTimestep_Init (&clock, rate, ticks);
+	if (!Input_Init (&input_queue)) {
+		fprintf (stderr, "out of memory\n");
+		return;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+
+	while (tick < ticks) {
+		Profile_Begin_Frame ();
+		int steps = FixedTimestep_Advance (&clock, frame_ms / 1000.0);
+		frames++;
+		frame_time = (ProfileTime) frames * frame_ms * 1000000;
+		// The player's clicks during this frame
+		for (; next_shot < ticks && (ProfileTime)((next_shot + 0.5) * 1e9 / rate) <= frame_time; next_shot += SHOT_INTERVAL)
+			Input_Push (&input_queue, INPUT_CMD_SHOOT, 0, (ProfileTime)((next_shot + 0.5) * 1e9 / rate));
+		for (; steps > 0 && tick < ticks; steps--, tick++) {
+			float angle = (float)tick * 0.001f;
+			input.player_position.x = cosf (angle) * WALK_RADIUS;
+			input.player_position.z = sinf (angle) * WALK_RADIUS;
+			// look along the direction of travel
+			input.player_heading.x = -sinf (angle);
+			input.player_heading.y = 0;
+			input.player_heading.z = cosf (angle);
+			input.shots = Input_Take_Shots (&input_queue, (ProfileTime)((tick + 1) * 1e9 / rate), frame_time);
+
+			World_Step (world, clock.step, &input, &result);
+			if (record) {
+				ReplayTick rt;
+				memset (&rt, 0, sizeof(rt));
+				rt.input = input;
+				if (!Replay_Record (record, &rt)) {
+					fprintf (stderr, "out of memory, recording stopped\n");
+					record = NULL;
+				}
+			}
+
+			hits += result.hits;
+			kills += result.kills;
+			first_aids += result.first_aids_collected;
+			// proximity queries other systems make each tick
+			nearby += World_Monsters_In_Radius (world, input.player_position.x, input.player_position.z, WORLD_AGGRO_DIST, NULL, 0);
+			if (World_Nearest_Monster (world, input.player_position.x, input.player_position.z, WORLD_SPAWN_DIST, NULL) != -1)
+				nearest_found++;
+			// keep the player alive so every tick does the same amount of work
+			if (world->health <= 0)
+				world->health = WORLD_MAX_HEALTH;
+		}
+		Profile_End_Frame ();
+	}
+
+	seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+	Input_Get_Latency (&input_queue, &latency);
+	Input_Free (&input_queue);
+
+	printf ("kernel:           %s\n", MonsterKernel_Name (world->monster_kernel));
+	printf ("monsters:         %d\n", world->monsters.count);
+	printf ("ticks:            %d at %g per second\n", ticks, rate);
+	printf ("frames:           %d of %u ms\n", frames, frame_ms);
+	printf ("seconds:          %.3f\n", seconds);
+	printf ("ticks per second: %.0f\n", seconds > 0 ? ticks / seconds : 0.0);
+	printf ("hits:             %d\n", hits);
+	printf ("kills:            %d\n", kills);
+	printf ("first aids:       %d\n", first_aids);
+	printf ("avg aggro nearby: %.1f\n", ticks ? (double)nearby / ticks : 0.0);
+	printf ("nearest found:    %d\n", nearest_found);
+	printf ("shot latency:     p50 %.2f ms, p99 %.2f ms, max %.2f ms (last %d)\n", latency.p50_ms, latency.p99_ms, latency.max_ms, latency.samples);
+	printf ("state hash:       %08x\n", State_Hash (world));
+}
+
+/*____________________________________________________________________
+|
+| Function: Run_Replay
+|
+| Input: Called from main()
+| Output: Steps the world with each recorded step's input, as fast as
+|   possible, and reports ticks per second.  The state hash matches the
+|   one from the recorded run.
+|___________________________________________________________________*/
+
+static void Run_Replay (World *world, Replay *replay)
+{
+	ReplayTick tick;
+	WorldStepResult result;
+	float time_step = 1 / replay->rate;
+	int ticks = 0, hits = 0, kills = 0, first_aids = 0, shots = 0;
+	double seconds;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+
+	Replay_Rewind (replay);
+	while (Replay_Next (replay, &tick)) {
+		Profile_Begin_Frame ();
+		World_Step (world, time_step, &tick.input, &result);
+		ticks++;
+		shots += tick.input.shots;
+		hits += result.hits;
+		kills += result.kills;
+		first_aids += result.first_aids_collected;
+		if ((replay->flags & REPLAY_FLAG_IMMORTAL) && world->health <= 0)
+			world->health = WORLD_MAX_HEALTH;
+		Profile_End_Frame ();
+	}
+
+	seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+	if (ticks != replay->ticks)
+		fprintf (stderr, "replay ended after %d of %d ticks\n", ticks, replay->ticks);
+	printf ("kernel:           %s\n", MonsterKernel_Name (world->monster_kernel));
+	printf ("monsters:         %d\n", world->monsters.count);
+	printf ("ticks:            %d at %g per second (%.1f s of play)\n", ticks, replay->rate, ticks / replay->rate);
+	printf ("seconds:          %.3f\n", seconds);
+	printf ("ticks per second: %.0f\n", seconds > 0 ? ticks / seconds : 0.0);
+	printf ("shots:            %d\n", shots);
+	printf ("hits:             %d\n", hits);
+	printf ("kills:            %d\n", kills);
+	printf ("first aids:       %d\n", first_aids);
+	printf ("health:           %.0f\n", world->health);
+	printf ("state hash:       %08x\n", State_Hash (world));
+}
+
+/*____________________________________________________________________
+|
+| Function: State_Hash
+|
+| Input: Called from Run_Simulation()
+| Output: Returns a hash of the monster positions and player health,
+|   for checking that two runs ended up in exactly the same state.
+|___________________________________________________________________*/
+
+static unsigned State_Hash (const World *world)
+{
+	unsigned hash = 2166136261u;   // FNV-1a
+	const unsigned char *p;
+
+	p = (const unsigned char *) world->monsters.x;
+	for (size_t i = 0; i < world->monsters.count * sizeof(float); i++)
+		hash = (hash ^ p[i]) * 16777619u;
+	p = (const unsigned char *) world->monsters.z;
+	for (size_t i = 0; i < world->monsters.count * sizeof(float); i++)
+		hash = (hash ^ p[i]) * 16777619u;
+	p = (const unsigned char *) &world->health;
+	for (size_t i = 0; i < sizeof(float); i++)
+		hash = (hash ^ p[i]) * 16777619u;
+
+	return (hash);
+}
+
+/*____________________________________________________________________
+|
+| Function: Verify_Kernels
+|
+| Input: Called from main()
+| Output: Runs every supported monster kernel on identical copies of a
+|   randomly filled pool, many rounds, and checks that positions, growl
+|   flags, attacker counts and arrivals match the scalar kernel bit for
+|   bit.  Returns true if they all match.
+|___________________________________________________________________*/
+
+static bool Verify_Kernels (unsigned seed)
+{
+	const MonsterKernelType types[] = { MONSTER_KERNEL_SCALAR, MONSTER_KERNEL_SSE2, MONSTER_KERNEL_AVX2 };
+	const int num_types = sizeof(types) / sizeof(types[0]);
+	MonsterPool pool[3];
+	MonsterKernelParams params;
+	MonsterKernelResult result[3];
+	float event_x[WORLD_MONSTER_TYPES], event_z[WORLD_MONSTER_TYPES];
+	bool ok = true;
+
+	Rng_Seed (&Test_Rng, seed, TEST_STREAM);
+
+	for (int t = 0; t < num_types; t++) {
+		MonsterPool_Init (&pool[t], VERIFY_MONSTERS);
+		result[t].arrived = (int *) malloc (pool[t].capacity * sizeof(int));
+	}
+	for (int k = 0; k < VERIFY_MONSTERS; k++) {
+		int type = Rng_Range (&Test_Rng, 0, WORLD_MONSTER_TYPES);
+		MonsterPool_Add (&pool[0], type, Random_Float (-WORLD_HALF_SIZE, WORLD_HALF_SIZE), Random_Float (-WORLD_HALF_SIZE, WORLD_HALF_SIZE), 9.0f + 6.0f * type);
+		pool[0].hits[k] = Rng_Range (&Test_Rng, 0, 4) == 0 ? 1 : 0;
+	}
+
+	params.aggro_dist  = WORLD_AGGRO_DIST;
+	params.stop_dist   = 10;
+	params.attack_dist = WORLD_ATTACK_DIST;
+	params.growl_dist  = WORLD_GROWL_DIST;
+	params.arrive_dist = 5;
+	params.seek_speed  = 15;
+	params.time_step   = 1.0f / DEFAULT_RATE;
+	params.event_x     = event_x;
+	params.event_z     = event_z;
+
+	for (int round = 0; round < VERIFY_ROUNDS && ok; round++) {
+		// New targets each round, sometimes exactly on top of a monster to hit the edge cases
+		params.player_x = Random_Float (-WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+		params.player_z = Random_Float (-WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+		if ((round % 7) == 0) {
+			params.player_x = pool[0].x[round % VERIFY_MONSTERS];
+			params.player_z = pool[0].z[round % VERIFY_MONSTERS];
+		}
+		for (int i = 0; i < WORLD_MONSTER_TYPES; i++) {
+			event_x[i] = (float) Rng_Range (&Test_Rng, -WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+			event_z[i] = (float) Rng_Range (&Test_Rng, -WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+		}
+
+		for (int t = 1; t < num_types; t++) {
+			pool[t].count = pool[0].count;
+			memcpy (pool[t].x,     pool[0].x,     pool[0].count * sizeof(float));
+			memcpy (pool[t].z,     pool[0].z,     pool[0].count * sizeof(float));
+			memcpy (pool[t].speed, pool[0].speed, pool[0].count * sizeof(float));
+			memcpy (pool[t].hits,  pool[0].hits,  pool[0].count * sizeof(int));
+			memcpy (pool[t].type,  pool[0].type,  pool[0].count * sizeof(unsigned char));
+		}
+
+		for (int t = 0; t < num_types; t++)
+			if (MonsterKernel_Supported (types[t]))
+				MonsterKernel_Update (types[t], &pool[t], &params, &result[t]);
+
+		for (int t = 1; t < num_types; t++) {
+			if (!MonsterKernel_Supported (types[t]))
+				continue;
+			if (memcmp (pool[t].x, pool[0].x, pool[0].count * sizeof(float)) ||
+				  memcmp (pool[t].z, pool[0].z, pool[0].count * sizeof(float)) ||
+				  memcmp (pool[t].growl, pool[0].growl, pool[0].count) ||
+				  result[t].attackers != result[0].attackers ||
+				  result[t].num_arrived != result[0].num_arrived ||
+				  memcmp (result[t].arrived, result[0].arrived, result[0].num_arrived * sizeof(int))) {
+				printf ("%s kernel differs from scalar in round %d\n", MonsterKernel_Name (types[t]), round);
+				ok = false;
+			}
+		}
+	}
+
+	for (int t = 0; t < num_types; t++) {
+		printf ("%-6s %s\n", MonsterKernel_Name (types[t]), !MonsterKernel_Supported (types[t]) ? "not supported" : ok ? "ok" : "checked");
+		free (result[t].arrived);
+		MonsterPool_Free (&pool[t]);
+	}
+
+	return (ok);
+}
+
+/*____________________________________________________________________
+|
+| Function: Random_Float
+|
+| Input: Called from Verify_Kernels(), Verify_Spawn(), Verify_Hitscan(),
+|   Verify_Voices(), Bench_Scenery(), Bench_Particles()
+| Output: Returns a random number between low and high.
+|___________________________________________________________________*/
+
+static float Random_Float (float low, float high)
+{
+	return (Rng_Float_Range (&Test_Rng, low, high));
+}
+
+/*____________________________________________________________________
+|
+| Function: Verify_Rng
+|
+| Input: Called from main()
+| Output: Checks that bulk random fills give exactly the values single
+|   draws do, starting at every generator in turn, and reports the
+|   time of each.  Returns true if they match.
+|___________________________________________________________________*/
+
+static bool Verify_Rng (unsigned seed)
+{
+	float *bulk, *single;
+	double bulk_seconds = 0, single_seconds = 0;
+	bool ok = true;
+
+	bulk = (float *) malloc (RNG_VERIFY_DRAWS * sizeof(float));
+	single = (float *) malloc (RNG_VERIFY_DRAWS * sizeof(float));
+	if (bulk == NULL || single == NULL) {
+		fprintf (stderr, "out of memory\n");
+		free (bulk);
+		free (single);
+		return (false);
+	}
+
+	for (int skip = 0; skip < RNG_LANES && ok; skip++) {
+		Rng a, b;
+		Rng_Seed (&a, seed, RNG_STREAM_SPAWN);
+		for (int i = 0; i < skip; i++)
+			Rng_Next (&a);
+		b = a;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+		Rng_Fill_Float_Range (&a, bulk, RNG_VERIFY_DRAWS, -WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+		std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now ();
+		for (int i = 0; i < RNG_VERIFY_DRAWS; i++)
+			single[i] = Rng_Float_Range (&b, -WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now ();
+		bulk_seconds += std::chrono::duration<double> (middle - start).count ();
+		single_seconds += std::chrono::duration<double> (end - middle).count ();
+
+		if (memcmp (bulk, single, RNG_VERIFY_DRAWS * sizeof(float)) || Rng_Next (&a) != Rng_Next (&b)) {
+			printf ("bulk random fill differs from single draws (starting at generator %d)\n", skip);
+			ok = false;
+		}
+	}
+	printf ("rng    %s (bulk %.2f ns per value, single %.2f ns)\n", ok ? "ok" : "differs",
+		bulk_seconds * 1e9 / (RNG_LANES * (double) RNG_VERIFY_DRAWS), single_seconds * 1e9 / (RNG_LANES * (double) RNG_VERIFY_DRAWS));
+
+	free (bulk);
+	free (single);
+
+	return (ok);
+}
+
+/*____________________________________________________________________
+|
+| Function: Verify_Spawn
+|
+| Input: Called from main()
+| Output: Places points around many random player positions (some on
+|   the edge of the world) and checks that every one is in the world and
+|   at least WORLD_SPAWN_DIST from the player.  Reports the time per
+|   point.  Returns true if they all are.
+|___________________________________________________________________*/
+
+static bool Verify_Spawn (unsigned seed)
+{
+	SpatialGrid grid;
+	SpawnRegion region;
+	float xs[SPAWN_VERIFY_POINTS], zs[SPAWN_VERIFY_POINTS];
+	double seconds = 0;
+	int bad = 0;
+
+	if (!SpatialGrid_Init (&grid, -WORLD_HALF_SIZE, WORLD_HALF_SIZE, WORLD_GRID_CELL_SIZE, 1) ||
+		!Spawn_Init (&region, &grid, WORLD_SPAWN_DIST)) {
+		fprintf (stderr, "out of memory\n");
+		return (false);
+	}
+	Rng_Seed (&Test_Rng, seed, TEST_STREAM);
+
+	for (int c = 0; c < SPAWN_VERIFY_CENTERS; c++) {
+		float px = Random_Float (-WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+		float pz = Random_Float (-WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+		if ((c % 5) == 0)
+			px = (c % 2) ? WORLD_HALF_SIZE : -WORLD_HALF_SIZE;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+		Spawn_Set_Center (&region, px, pz);
+		Spawn_Points (&region, &Test_Rng, xs, zs, SPAWN_VERIFY_POINTS);
+		seconds += std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+		for (int i = 0; i < SPAWN_VERIFY_POINTS; i++) {
+			float dx = xs[i] - px, dz = zs[i] - pz;
+			if (dx * dx + dz * dz < (float) WORLD_SPAWN_DIST * WORLD_SPAWN_DIST ||
+				xs[i] < -WORLD_HALF_SIZE || xs[i] > WORLD_HALF_SIZE || zs[i] < -WORLD_HALF_SIZE || zs[i] > WORLD_HALF_SIZE)
+				bad++;
+		}
+	}
+	printf ("spawn  %s (%.1f ns per point, %d of %d cells allowed at the last center)\n", bad ? "failed" : "ok",
+		seconds * 1e9 / ((double) SPAWN_VERIFY_CENTERS * SPAWN_VERIFY_POINTS), region.num_allowed, region.cells * region.cells);
+	if (bad)
+		printf ("%d points too close to the player or outside the world\n", bad);
+
+	Spawn_Free (&region);
+	SpatialGrid_Free (&grid);
+
+	return (bad == 0);
+}
+
+/*____________________________________________________________________
+|
+| Function: Verify_Hitscan
+|
+| Input: Called from main()
+| Output: Fires random shots through a crowded world, with and without
+|   penetration, and checks that the grid walk hits the same monsters,
+|   in the same order, as testing every monster and tree.  Reports the
+|   time per shot both ways.  Returns true if they all match.
+|___________________________________________________________________*/
+
+static bool Verify_Hitscan (unsigned seed)
+{
+	World *world = (World *) malloc (sizeof(World));
+	MonsterPool *monsters;
+	WorldShot shot, expect;
+	double walk_seconds = 0, brute_seconds = 0;
+	long long cells = 0, hits = 0;
+	int bad = 0;
+
+	if (world == NULL || !World_Init (world, seed)) {
+		fprintf (stderr, "can't init world\n");
+		return (false);
+	}
+	for (int i = 0; i < WORLD_MONSTER_TYPES; i++)
+		World_Spawn_Monsters (world, i, HITSCAN_VERIFY_MONSTERS);
+	World_Set_Monster_Bounds (world, 0, 6, 4);
+	World_Set_Monster_Bounds (world, 1, 6, 4);
+	World_Set_Monster_Bounds (world, 2, 3, 4);
+	monsters = &world->monsters;
+	Rng_Seed (&Test_Rng, seed, TEST_STREAM);
+
+	for (int s = 0; s < HITSCAN_VERIFY_SHOTS; s++) {
+		WorldVector origin, dir;
+		float o[3], d[3], length;
+		int penetration = (s % 4 == 0) ? 3 : 0;
+
+		// Eye height, looking mostly level, a few from outside the world
+		origin.x = Random_Float (-WORLD_HALF_SIZE * 1.1f, WORLD_HALF_SIZE * 1.1f);
+		origin.y = 5;
+		origin.z = Random_Float (-WORLD_HALF_SIZE * 1.1f, WORLD_HALF_SIZE * 1.1f);
+		dir.x = Random_Float (-1, 1);
+		dir.y = Random_Float (-0.1f, 0.1f);
+		dir.z = Random_Float (-1, 1);
+		if (s % 50 == 0)
+			dir.z = 0;
+		length = sqrtf (dir.x * dir.x + dir.y * dir.y + dir.z * dir.z);
+		dir.x /= length;
+		dir.y /= length;
+		dir.z /= length;
+		World_Set_Shot_Penetration (world, penetration);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+		World_Cast_Shot (world, &origin, &dir, &shot);
+		walk_seconds += std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+		cells += shot.cells;
+		hits += shot.num_monsters;
+
+		// Every tree, then every monster in front of the nearest one
+		start = std::chrono::steady_clock::now ();
+		o[0] = origin.x; o[1] = origin.y; o[2] = origin.z;
+		d[0] = dir.x; d[1] = dir.y; d[2] = dir.z;
+		expect.num_monsters = 0;
+		expect.blocked = -1;
+		for (int i = 0; i < WORLD_MAX_TREES; i++) {
+			float t = Hitscan_Ray_Cylinder (o, d, world->tree_x[i], world->tree_z[i], WORLD_TREE_RADIUS);
+			if (t >= 0 && t <= WORLD_SHOT_RANGE && (expect.blocked < 0 || t < expect.blocked))
+				expect.blocked = t;
+		}
+		for (int i = 0; i < monsters->count; i++) {
+			int type = monsters->type[i], n;
+			float center[3] = { monsters->x[i], world->monster_center_y[type], monsters->z[i] };
+			float t = Hitscan_Ray_Sphere (o, d, center, world->monster_radius[type]);
+			if (t < 0 || t > WORLD_SHOT_RANGE || (expect.blocked >= 0 && t >= expect.blocked))
+				continue;
+			// Keep the penetration + 1 nearest (monsters are visited in index order, so ties keep the first)
+			if (expect.num_monsters > penetration) {
+				if (t >= expect.distance[penetration])
+					continue;
+				expect.num_monsters--;
+			}
+			for (n = expect.num_monsters; n > 0 && expect.distance[n - 1] > t; n--) {
+				expect.monsters[n] = expect.monsters[n - 1];
+				expect.distance[n] = expect.distance[n - 1];
+			}
+			expect.monsters[n] = i;
+			expect.distance[n] = t;
+			expect.num_monsters++;
+		}
+		brute_seconds += std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+		bool same = shot.num_monsters == expect.num_monsters;
+		for (int i = 0; same && i < shot.num_monsters; i++)
+			same = shot.monsters[i] == expect.monsters[i];
+		if (!same)
+			bad++;
+	}
+	printf ("hitscan %s (%.0f ns per shot, %.0f ns testing everything, %.1f cells per shot, %lld hits)\n", bad ? "failed" : "ok",
+		walk_seconds * 1e9 / HITSCAN_VERIFY_SHOTS, brute_seconds * 1e9 / HITSCAN_VERIFY_SHOTS, (double) cells / HITSCAN_VERIFY_SHOTS, hits);
+	if (bad)
+		printf ("%d of %d shots hit different monsters\n", bad, HITSCAN_VERIFY_SHOTS);
+
+	World_Free (world);
+	free (world);
+
+	return (bad == 0);
+}
+
+/*____________________________________________________________________
+|
+| Function: Verify_Voices
+|
+| Input: Called from main()
+| Output: Plays growls from monsters around a walking listener, plus
+|   shots and hits, through the voice manager with the null backend.
+|   Checks that each file is loaded once, that the real voices always
+|   go to the most audible sounds, and that the library has the right
+|   position for every real voice.  Reports the voices and position
+|   updates per frame.  Returns true if every check passes.
+|___________________________________________________________________*/
+
+static bool Verify_Voices (unsigned seed)
+{
+	VoiceBackend backend = { Null_Load_Sample, Null_Play, Null_Stop, Null_Is_Playing, Null_Set_Position, NULL };
+	NullSound null_sound;
+	VoiceManager manager;
+	int zombie[WORLD_MONSTER_TYPES], shoot, hit;
+	long long real = 0, virtual_voices = 0, positions = 0;
+	int bad = 0;
+
+	memset (&null_sound, 0, sizeof(NullSound));
+	for (int v = 0; v < VOICE_MAX_VOICES; v++)
+		null_sound.voice_sample[v] = -1;
+	backend.context = &null_sound;
+	if (!Voice_Init (&manager, &backend, VOICE_BUDGET, VOICE_EMITTERS + 32)) {
+		fprintf (stderr, "out of memory\n");
+		return (false);
+	}
+	// Same files as the game (zombie1 twice), lengths made up
+	zombie[0] = Voice_Load (&manager, "wav/zombie1.wav", true, 5, 75, 1);
+	zombie[1] = Voice_Load (&manager, "wav/zombie1.wav", true, 5, 75, 1);
+	zombie[2] = Voice_Load (&manager, "wav/zombie2.wav", true, 5, 75, 1);
+	shoot = Voice_Load (&manager, "wav/shoot.wav", false, 0, 0, 0.75f);
+	hit = Voice_Load (&manager, "wav/gun_hit.wav", false, 0, 0, 0.75f);
+	if (null_sound.loads != 4)
+		bad++;
+
+	Rng_Seed (&Test_Rng, seed, TEST_STREAM);
+	for (int i = 0; i < VOICE_EMITTERS; i++)
+		Voice_Create_Emitter (&manager, zombie[i % WORLD_MONSTER_TYPES]);
+
+	for (int frame = 0; frame < VOICE_FRAMES; frame++) {
+		float seconds = 1.0f / DEFAULT_RATE;
+		float angle = (float)frame * 0.001f;
+		float lx = cosf (angle) * 100, lz = sinf (angle) * 100;
+
+		// Monsters around the listener, some growling
+		for (int i = 0; i < VOICE_EMITTERS; i++) {
+			float a = angle * (1 + (i % 7)) + i, d = 2.0f + (i % 50) * 3;
+			Voice_Set_Position (&manager, i, lx + cosf (a) * d, 5, lz + sinf (a) * d);
+			if (!Voice_Is_Playing (&manager, i) && Random_Float (0, 1) < 0.05f)
+				Voice_Play (&manager, i, false);
+		}
+		if (frame % SHOT_INTERVAL == 0) {
+			Voice_Play_Once (&manager, shoot, 0, 0, 0);
+			Voice_Play_Once (&manager, hit, 0, 0, 0);
+		}
+		null_sound.time += seconds;
+		long long sent = null_sound.positions;
+		Voice_Update (&manager, lx, 6, lz, seconds);
+		positions += null_sound.positions - sent;
+		real += manager.stats.real;
+		virtual_voices += manager.stats.virtual_voices;
+
+		// No virtual sound may be louder than a real one, every real one must be where its emitter is
+		float quietest_real = 2, loudest_virtual = 0;
+		int num_real = 0;
+		for (int i = 0; i < manager.max_emitters; i++) {
+			const VoiceEmitter *e = &manager.emitters[i];
+			if (!e->in_use || !e->playing || e->audibility <= 0)
+				continue;
+			if (e->voice == -1) {
+				if (e->audibility > loudest_virtual)
+					loudest_virtual = e->audibility;
+				continue;
+			}
+			num_real++;
+			if (e->audibility < quietest_real)
+				quietest_real = e->audibility;
+			if (null_sound.voice_sample[e->voice] != e->sample ||
+				(manager.samples[e->sample].positional &&
+				 (null_sound.voice_pos[e->voice][0] != e->x || null_sound.voice_pos[e->voice][1] != e->y || null_sound.voice_pos[e->voice][2] != e->z)))
+				bad++;
+		}
+		if (num_real > VOICE_BUDGET || (num_real && loudest_virtual > quietest_real))
+			bad++;
+	}
+
+	printf ("voices %s (%.1f real, %.1f virtual, %.1f positions sent per frame for %d emitters, %d files loaded)\n", bad ? "failed" : "ok",
+		(double)real / VOICE_FRAMES, (double)virtual_voices / VOICE_FRAMES, (double)positions / VOICE_FRAMES, VOICE_EMITTERS, null_sound.loads);
+	if (bad)
+		printf ("%d checks failed\n", bad);
+
+	Voice_Free (&manager);
+
+	return (bad == 0);
+}
+
+/*____________________________________________________________________
+|
+| Function: Verify_Hud_Text
+|
+| Input: Called from main()
+| Output: Lays out numbers with the game's digit font.  Checks that the
+|   scores the HUD could show before (0-999) land where its three digit
+|   slots were, that longer numbers get every digit, evenly spaced and
+|   ending at the same spot, that strings the font can't draw all of
+|   keep their spacing, and that a glyph strip has one quad per glyph
+|   joined by degenerate triangles.  Returns true if every check passes.
+|___________________________________________________________________*/
+
+static bool Verify_Hud_Text ()
+{
+	const HudFont font = { '0', 10, 10, 1, 0.03f, 0.03f };     // same as the game's
+	const float slots[3] = { -0.70f, -0.67f, -0.64f };           // old HUD digit positions
+	HudGlyph glyphs[HUD_TEXT_MAX_GLYPHS], cut[HUD_TEXT_MAX_GLYPHS];
+	static float strip[6 * HUD_TEXT_MAX_GLYPHS * HUD_TEXT_VERTEX_FLOATS];
+	char text[24];
+	int n, bad = 0;
+
+	for (int score = 0; score < 1000; score++) {
+		n = HudText_Layout_Number (&font, score, -0.64f, 0.35f, HUD_ALIGN_RIGHT, glyphs, HUD_TEXT_MAX_GLYPHS);
+		sprintf (text, "%d", score);
+		if (n != (int) strlen (text)) {
+			bad++;
+			continue;
+		}
+		for (int i = 0; i < n; i++)
+			if (glyphs[i].glyph != text[i] - '0' || fabsf (glyphs[i].x - slots[3 - n + i]) > 1e-5f || glyphs[i].y != 0.35f)
+				bad++;
+	}
+
+	long long value = 0;
+	for (int digits = 1; digits <= 19; digits++) {
+		// 1, 12, 123, ... up to 19 digits, built before it's used so it never overflows
+		value = value * 10 + digits % 10;
+		n = HudText_Layout_Number (&font, value, -0.64f, 0.35f, HUD_ALIGN_RIGHT, glyphs, HUD_TEXT_MAX_GLYPHS);
+		sprintf (text, "%lld", value);
+		if (n != digits || fabsf (glyphs[n - 1].x + 0.64f) > 1e-5f) {
+			bad++;
+			continue;
+		}
+		for (int i = 0; i < n; i++) {
+			if (glyphs[i].glyph != text[i] - '0' || glyphs[i].u0 != glyphs[i].glyph / 10.0f || glyphs[i].v0 != 0 || glyphs[i].v1 != 1)
+				bad++;
+			if (i > 0 && fabsf (glyphs[i].x - glyphs[i - 1].x - font.advance) > 1e-5f)
+				bad++;
+		}
+		// Cut short, the glyphs that fit stay where they were
+		int m = HudText_Layout_Number (&font, value, -0.64f, 0.35f, HUD_ALIGN_RIGHT, cut, 3);
+		if (m != (n < 3 ? n : 3) || memcmp (cut, glyphs, m * sizeof(HudGlyph)))
+			bad++;
+
+		int vertices = HudText_Strip (&font, glyphs, n, 0, strip);
+		if (vertices != HudText_Strip_Vertices (n))
+			bad++;
+		// Each join repeats the last vertex of one quad and the first of the next
+		for (int i = 1; i < n; i++) {
+			const float *join = &strip[(6 * i - 2) * HUD_TEXT_VERTEX_FLOATS];
+			if (memcmp (join - HUD_TEXT_VERTEX_FLOATS, join, HUD_TEXT_VERTEX_FLOATS * sizeof(float)) ||
+				memcmp (join + HUD_TEXT_VERTEX_FLOATS, join + 2 * HUD_TEXT_VERTEX_FLOATS, HUD_TEXT_VERTEX_FLOATS * sizeof(float)) ||
+				join[3 * HUD_TEXT_VERTEX_FLOATS] != glyphs[i].x - font.size * 0.5f)
+				bad++;
+		}
+	}
+
+	// Characters the font doesn't have take up space but aren't drawn
+	n = HudText_Layout (&font, "1:2", 0, 0, HUD_ALIGN_LEFT, glyphs, HUD_TEXT_MAX_GLYPHS);
+	if (n != 2 || glyphs[0].x != 0 || fabsf (glyphs[1].x - 2 * font.advance) > 1e-5f)
+		bad++;
+	n = HudText_Layout (&font, "123", 0, 0, HUD_ALIGN_CENTER, glyphs, HUD_TEXT_MAX_GLYPHS);
+	if (n != 3 || fabsf (glyphs[1].x) > 1e-5f)
+		bad++;
+
+	printf ("hud text %s (one atlas, %d strip vertices for a 19 digit number)\n", bad ? "failed" : "ok", HudText_Strip_Vertices (19));
+	if (bad)
+		printf ("%d checks failed\n", bad);
+
+	return (bad == 0);
+}
+
+/*____________________________________________________________________
+|
+| Function: Verify_Mouse_Look
+|
+| Input: Called from main()
+| Output: Moves a mouse the same way (a slow drift, then a fast flick)
+|   read at frame rates from 30 to 1000 per second, and checks that the
+|   turn adds up to the same, that the slow drift of less than a count
+|   per frame isn't lost, and that the flick is accelerated.  Returns
+|   true if it all checks out.
+|___________________________________________________________________*/
+
+static bool Verify_Mouse_Look ()
+{
+	const int rates[] = { 30, 60, 144, 300, 1000 };
+	const MouseCurve curve = { 0.15f, 0.5f, 1, 0.5f, 3, false };
+	float turn[2][5];                          // drift, flick at each rate
+	int bad = 0;
+
+	for (int r = 0; r < 5; r++) {
+		for (int k = 0; k < 2; k++) {
+			// Drift: 100 counts a second for 2 seconds, flick: 3000 counts in 0.2 seconds
+			double counts_per_second = k ? 15000 : 100, seconds = k ? 0.2 : 2;
+			int frames = (int)(seconds * rates[r] + 0.5);
+			MouseLook look;
+			double moved = 0;
+			int read = 0;
+			float yaw, pitch;
+			MouseLook_Init (&look, &curve);
+			MouseLook_Add (&look, 0, 0, 1000000000);
+			turn[k][r] = 0;
+			for (int f = 1; f <= frames; f++) {
+				// The device reports whole counts, whatever moved since the last read
+				moved = counts_per_second * f / rates[r];
+				int dx = (int)moved - read;
+				read += dx;
+				MouseLook_Add (&look, dx, 0, 1000000000 + (ProfileTime)(f * 1e9 / rates[r]));
+				MouseLook_Take (&look, &yaw, &pitch);
+				turn[k][r] += yaw;
+			}
+		}
+		if (fabsf (turn[0][r] - 200 * curve.sensitivity) > 0.01f)
+			bad++;
+	}
+	// Same flick at every rate (a frame's rounding of counts is all that may differ)
+	for (int r = 1; r < 5; r++)
+		if (fabsf (turn[1][r] - turn[1][0]) > turn[1][0] * 0.01f)
+			bad++;
+	if (turn[1][0] <= 3000 * curve.sensitivity * 1.5f)
+		bad++;
+
+	printf ("mouse look %s (drift %.2f, flick %.1f degrees at 30 fps, %.2f, %.1f at 1000 fps)\n", bad ? "failed" : "ok",
+		turn[0][0], turn[1][0], turn[0][4], turn[1][4]);
+
+	return (bad == 0);
+}
+
+/*____________________________________________________________________
+|
+| Function: Verify_Input
+|
+| Input: Called from main()
+| Output: Clicks every frame at frame rates from 30 to 300 per second,
+|   stamping each shot when it's read, after the frame's time is taken,
+|   and hands the shots to the steps the way the game does.  Checks
+|   that a frame that steps takes every shot read so far (none wait for
+|   the next frame's steps) and that no shot waits longer than a step.
+|   Returns true if it all checks out.
+|___________________________________________________________________*/
+
+static bool Verify_Input ()
+{
+	const int rates[] = { 30, 60, 144, 300 };
+	const double read_ms = 0.2;                // events are read this long after the frame's time
+	float worst[4];
+	int bad = 0;
+
+	for (int r = 0; r < 4; r++) {
+		InputQueue queue;
+		InputLatency latency;
+		FixedTimestep clock;
+		if (!Input_Init (&queue)) {
+			fprintf (stderr, "out of memory\n");
+			return (false);
+		}
+		FixedTimestep_Init (&clock, DEFAULT_RATE, 8);
+		for (int f = 1; f <= 2 * rates[r]; f++) {
+			ProfileTime new_time = (ProfileTime)(f * 1e9 / rates[r]);
+			ProfileTime now = new_time + (ProfileTime)(read_ms * 1e6);
+			Input_Push (&queue, INPUT_CMD_SHOOT, 0, now);
+			int steps = FixedTimestep_Advance (&clock, 1.0 / rates[r]);
+			int taken = 0;
+			for (int step = 0; step < steps; step++) {
+				ProfileTime step_end = now;
+				if (step < steps - 1)
+					step_end = new_time - (ProfileTime)((clock.accumulator + (steps - 1 - step) * (double)clock.step) * 1e9);
+				taken += Input_Take_Shots (&queue, step_end, now);
+			}
+			if (steps ? queue.count != 0 : taken != 0)
+				bad++;
+		}
+		Input_Get_Latency (&queue, &latency);
+		worst[r] = latency.max_ms;
+		if (latency.max_ms > 1000.0 / DEFAULT_RATE + 0.01)
+			bad++;
+		Input_Free (&queue);
+	}
+
+	printf ("input %s (longest shot wait %.2f ms at 30 fps, %.2f at 60, %.2f at 144, %.2f at 300)\n", bad ? "failed" : "ok",
+		worst[0], worst[1], worst[2], worst[3]);
+
+	return (bad == 0);
+}
+
+/*____________________________________________________________________
+|
+| Function: Bench_Scenery
+|
+| Input: Called from main()
+| Output: Scatters props over the world, then culls them against the
+|   frustum of a camera walking and turning through the world, both by
+|   walking the hierarchy and by testing every prop.  Reports the time
+|   of each and checks that they find the same props.  Returns true if
+|   they agree.
+|___________________________________________________________________*/
+
+static bool Bench_Scenery (unsigned seed, int props)
+{
+	const float local_min[3] = { -5, 0, -5 };   // about the size of a tree
+	const float local_max[3] = { 5, 30, 5 };
+	float *xs, *zs;
+	int *out, *mark;
+	SceneryBVH bvh;
+	Frustum frustum;
+	long long visible = 0;
+	double bvh_seconds = 0, brute_seconds = 0;
+	bool ok = true;
+
+	Rng_Seed (&Test_Rng, seed, TEST_STREAM);
+
+	xs = (float *) malloc (props * sizeof(float));
+	zs = (float *) malloc (props * sizeof(float));
+	out = (int *) malloc (props * sizeof(int));
+	mark = (int *) calloc (props, sizeof(int));
+	if (xs == NULL || zs == NULL || out == NULL || mark == NULL) {
+		fprintf (stderr, "out of memory\n");
+		return (false);
+	}
+	for (int i = 0; i < props; i++) {
+		xs[i] = Random_Float (-WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+		zs[i] = Random_Float (-WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+	if (!SceneryBVH_Build (&bvh, xs, zs, props, local_min, local_max)) {
+		fprintf (stderr, "can't build scenery hierarchy\n");
+		return (false);
+	}
+	double build_seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+	for (int frame = 0; frame < SCENERY_FRAMES && ok; frame++) {
+		float angle = (float)frame * 0.01f;
+		float eye[3] = { cosf (angle) * WALK_RADIUS, 6, sinf (angle) * WALK_RADIUS };
+		// look around as well as along the direction of travel
+		float look = angle * 3;
+		float heading[3] = { -sinf (look), 0, cosf (look) };
+		Frustum_Init (&frustum, eye, heading, CAMERA_FOV, CAMERA_ASPECT, CAMERA_NEAR, CAMERA_FAR);
+
+		start = std::chrono::steady_clock::now ();
+		int found = SceneryBVH_Cull (&bvh, &frustum, out);
+		bvh_seconds += std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+		visible += found;
+
+		start = std::chrono::steady_clock::now ();
+		int brute_found = 0;
+		for (int i = 0; i < props; i++) {
+			float min[3] = { xs[i] + local_min[0], local_min[1], zs[i] + local_min[2] };
+			float max[3] = { xs[i] + local_max[0], local_max[1], zs[i] + local_max[2] };
+			if (Frustum_Test_Box (&frustum, min, max, NULL) != FRUSTUM_OUTSIDE) {
+				mark[i] = frame + 1;
+				brute_found++;
+			}
+		}
+		brute_seconds += std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+		if (found != brute_found)
+			ok = false;
+		for (int i = 0; i < found && ok; i++)
+			if (mark[out[i]] != frame + 1)
+				ok = false;
+		if (!ok)
+			printf ("hierarchy and brute force differ in frame %d\n", frame);
+	}
+
+	printf ("props:            %d\n", props);
+	printf ("nodes:            %d\n", bvh.num_nodes);
+	printf ("build ms:         %.3f\n", build_seconds * 1000);
+	printf ("avg visible:      %.1f\n", (double)visible / SCENERY_FRAMES);
+	printf ("hierarchy us:     %.2f per frame\n", bvh_seconds * 1e6 / SCENERY_FRAMES);
+	printf ("brute force us:   %.2f per frame\n", brute_seconds * 1e6 / SCENERY_FRAMES);
+	printf ("results:          %s\n", ok ? "match" : "differ");
+
+	SceneryBVH_Free (&bvh);
+	free (xs);
+	free (zs);
+	free (out);
+	free (mark);
+
+	return (ok);
+}
+
+/*____________________________________________________________________
+|
+| Function: Bench_Render
+|
+| Input: Called from main()
+| Output: Steps the world like Run_Simulation() and each frame queues
+|   the visible flowers, trees, monsters and first aids (what the game
+|   draws), then counts the backend calls three ways: drawing each
+|   instance on its own (texture, matrix and draw per instance, as the
+|   game used to), through the render queue, and through the render
+|   queue with a backend that can instance.  Returns true on success.
+|___________________________________________________________________*/
+
+static bool Bench_Render (World *world, int frames)
+{
+	const float tree_min[3] = { -5, 0, -5 }, tree_max[3] = { 5, 30, 5 };
+	const float flower_min[3] = { -1, 0, -1 }, flower_max[3] = { 1, 2, 1 };
+	SceneryBVH tree_bvh, flower_bvh;
+	RenderQueue queue;
+	Frustum frustum;
+	WorldInput input;
+	MockRenderer naive, queued, instanced;
+	RenderBackend backend, instancing_backend;
+	int *visible;
+	long long instances = 0, batches = 0;
+
+	if (!SceneryBVH_Build (&tree_bvh, world->tree_x, world->tree_z, WORLD_MAX_TREES, tree_min, tree_max) ||
+		  !SceneryBVH_Build (&flower_bvh, world->flower_x, world->flower_z, WORLD_MAX_FLOWERS, flower_min, flower_max) ||
+		  !RenderQueue_Init (&queue, WORLD_MAX_FLOWERS + WORLD_MAX_TREES + world->monsters.capacity)) {
+		fprintf (stderr, "can't init renderer\n");
+		return (false);
+	}
+	visible = (int *) malloc ((WORLD_MAX_FLOWERS + WORLD_MAX_TREES) * sizeof(int));
+	if (visible == NULL) {
+		fprintf (stderr, "out of memory\n");
+		return (false);
+	}
+
+	memset (&naive, 0, sizeof(MockRenderer));
+	memset (&queued, 0, sizeof(MockRenderer));
+	memset (&instanced, 0, sizeof(MockRenderer));
+	backend.set_texture = Mock_Set_Texture;
+	backend.set_object_matrix = Mock_Set_Object_Matrix;
+	backend.draw_object = Mock_Draw_Object;
+	backend.draw_instances = NULL;
+	backend.context = &queued;
+	instancing_backend = backend;
+	instancing_backend.draw_instances = Mock_Draw_Instances;
+	instancing_backend.context = &instanced;
+
+	memset (&input, 0, sizeof(input));
+	input.player_position.y = 6;
+	input.moving = true;
+
+	for (int frame = 0; frame < frames; frame++) {
+		float angle = (float)frame * 0.001f;
+		input.player_position.x = cosf (angle) * WALK_RADIUS;
+		input.player_position.z = sinf (angle) * WALK_RADIUS;
+		input.player_heading.x = -sinf (angle);
+		input.player_heading.y = 0;
+		input.player_heading.z = cosf (angle);
+		input.shots = (frame % SHOT_INTERVAL) == 0 ? 1 : 0;
+		World_Step (world, 1.0f / DEFAULT_RATE, &input, NULL);
+		if (world->health <= 0)
+			world->health = WORLD_MAX_HEALTH;
+
+		Frustum_Init (&frustum, &input.player_position.x, &input.player_heading.x, CAMERA_FOV, CAMERA_ASPECT, CAMERA_NEAR, CAMERA_FAR);
+
+		// One texture, matrix and draw per instance
+		int count = Queue_Frame (world, &tree_bvh, &flower_bvh, &frustum, visible, &queue);
+		naive.texture_changes += count;
+		naive.matrix_changes += count;
+		naive.draw_calls += count;
+		RenderQueue_Flush (&queue, &backend);
+		instances += queue.stats.instances;
+		batches += queue.stats.batches;
+
+		Queue_Frame (world, &tree_bvh, &flower_bvh, &frustum, visible, &queue);
+		RenderQueue_Flush (&queue, &instancing_backend);
+	}
+
+	printf ("frames:           %d\n", frames);
+	printf ("avg instances:    %.1f\n", (double)instances / frames);
+	printf ("avg batches:      %.1f\n", (double)batches / frames);
+	printf ("                  draw calls  texture changes  matrix changes  (per frame)\n");
+	printf ("per instance:     %10.1f  %15.1f  %14.1f\n", (double)naive.draw_calls / frames, (double)naive.texture_changes / frames, (double)naive.matrix_changes / frames);
+	printf ("render queue:     %10.1f  %15.1f  %14.1f\n", (double)queued.draw_calls / frames, (double)queued.texture_changes / frames, (double)queued.matrix_changes / frames);
+	printf ("instanced queue:  %10.1f  %15.1f  %14.1f\n", (double)instanced.draw_calls / frames, (double)instanced.texture_changes / frames, (double)instanced.matrix_changes / frames);
+
+	free (visible);
+	RenderQueue_Free (&queue);
+	SceneryBVH_Free (&tree_bvh);
+	SceneryBVH_Free (&flower_bvh);
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Queue_Frame
+|
+| Input: Called from Bench_Render()
+| Output: Queues everything visible in the frustum, in the order the
+|   game does.  Returns # of instances queued.
+|___________________________________________________________________*/
+
+static int Queue_Frame (World *world, const SceneryBVH *tree_bvh, const SceneryBVH *flower_bvh, const Frustum *frustum, int *visible, RenderQueue *queue)
+{
+	// Stand-ins for the game's object and texture handles
+	static char flower, tree, monster[WORLD_MONSTER_TYPES], first_aid;
+	static char tex_flower, tex_tree, tex_monster[WORLD_MONSTER_TYPES], tex_first_aid;
+
+	RenderQueue_Begin_Frame (queue);
+
+	int n = SceneryBVH_Cull (flower_bvh, frustum, visible);
+	for (int v = 0; v < n; v++)
+		RenderQueue_Add_Translate (queue, &flower, &tex_flower, world->flower_x[visible[v]], 0, world->flower_z[visible[v]]);
+	n = SceneryBVH_Cull (tree_bvh, frustum, visible);
+	for (int v = 0; v < n; v++)
+		RenderQueue_Add_Translate (queue, &tree, &tex_tree, world->tree_x[visible[v]], 0, world->tree_z[visible[v]]);
+	for (int k = 0; k < world->monsters.count; k++) {
+		int type = world->monsters.type[k];
+		float center[3] = { world->monsters.x[k], world->monster_center_y[type], world->monsters.z[k] };
+		if (Frustum_Test_Sphere (frustum, center, world->monster_radius[type]) != FRUSTUM_OUTSIDE)
+			RenderQueue_Add_Translate (queue, &monster[type], &tex_monster[type], world->monsters.x[k], 0, world->monsters.z[k]);
+	}
+	for (int i = 0; i < WORLD_MAX_EVENTS; i++) {
+		float center[3] = { world->first_aid_x[i], 0, world->first_aid_z[i] };
+		if (!world->first_aid_collected[i] && Frustum_Test_Sphere (frustum, center, 2) != FRUSTUM_OUTSIDE)
+			RenderQueue_Add_Translate (queue, &first_aid, &tex_first_aid, world->first_aid_x[i], 0, world->first_aid_z[i]);
+	}
+
+	return (queue->count);
+}
+
+/*____________________________________________________________________
+|
+| Function: Bench_Lod
+|
+| Input: Called from main()
+| Output: Walks a camera through the world like Bench_Render() and picks
+|   the level of detail of the visible trees and flowers each frame,
+|   with the game's switch points and hysteresis and with none.  Checks
+|   that every visible prop lands in one list, and that without
+|   hysteresis each gets the level its size calls for.  Reports the
+|   triangles drawn per frame against drawing everything at full
+|   detail, the props at each level, level switches per frame and the
+|   selection time.  Triangle counts are stand-ins, the game counts its
+|   meshes'.  Returns true if every check passes.
+|___________________________________________________________________*/
+
+static bool Bench_Lod (World *world, int frames)
+{
+	const float tree_min[3] = { -5, 0, -5 }, tree_max[3] = { 5, 30, 5 };
+	const float flower_min[3] = { -1, 0, -1 }, flower_max[3] = { 1, 2, 1 };
+	const LodModel *models[2] = { &Tree_Lod_Model, &Flower_Lod_Model };
+	const float *xs[2] = { world->tree_x, world->flower_x }, *zs[2] = { world->tree_z, world->flower_z };
+	SceneryBVH bvh[2];
+	LodGroup group[2], exact[2];               // game's hysteresis, none
+	Frustum frustum;
+	int *visible;
+	float pixel_scale = Lod_Pixel_Scale (CAMERA_FOV, LOD_SCREEN_HEIGHT);
+	long long full = 0, drawn = 0, props = 0, culled = 0, switches = 0, exact_switches = 0;
+	long long levels[2][LOD_MAX_LEVELS] = { { 0 } };
+	double seconds = 0;
+	int bad = 0;
+
+	if (!SceneryBVH_Build (&bvh[0], world->tree_x, world->tree_z, WORLD_MAX_TREES, tree_min, tree_max) ||
+		  !SceneryBVH_Build (&bvh[1], world->flower_x, world->flower_z, WORLD_MAX_FLOWERS, flower_min, flower_max) ||
+		  !Lod_Init (&group[0], &Tree_Lod_Model, WORLD_MAX_TREES, LOD_HYSTERESIS) ||
+		  !Lod_Init (&group[1], &Flower_Lod_Model, WORLD_MAX_FLOWERS, LOD_HYSTERESIS) ||
+		  !Lod_Init (&exact[0], &Tree_Lod_Model, WORLD_MAX_TREES, 0) ||
+		  !Lod_Init (&exact[1], &Flower_Lod_Model, WORLD_MAX_FLOWERS, 0)) {
+		fprintf (stderr, "out of memory\n");
+		return (false);
+	}
+	visible = (int *) malloc (WORLD_MAX_FLOWERS * sizeof(int));
+	if (visible == NULL) {
+		fprintf (stderr, "out of memory\n");
+		return (false);
+	}
+
+	for (int frame = 0; frame < frames; frame++) {
+		float angle = (float)frame * 0.001f;
+		// Walk in and out as well as around, so props cross the switch points both ways
+		float r = WALK_RADIUS * (0.5f + 0.5f * sinf (angle * 7));
+		float eye[3] = { cosf (angle) * r, 6, sinf (angle) * r };
+		float heading[3] = { -sinf (angle), 0, cosf (angle) };
+
+		Frustum_Init (&frustum, eye, heading, CAMERA_FOV, CAMERA_ASPECT, CAMERA_NEAR, CAMERA_FAR);
+		for (int k = 0; k < 2; k++) {
+			const LodModel *model = models[k];
+			int n = SceneryBVH_Cull (&bvh[k], &frustum, visible);
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+			Lod_Select (&group[k], visible, n, xs[k], zs[k], eye, pixel_scale);
+			seconds += std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+			Lod_Select (&exact[k], visible, n, xs[k], zs[k], eye, pixel_scale);
+
+			int listed = group[k].stats.culled;
+			for (int l = 0; l < model->num_levels; l++) {
+				listed += group[k].stats.count[l];
+				levels[k][l] += group[k].stats.count[l];
+			}
+			if (listed != n)
+				bad++;
+			// Without hysteresis the level is just the first switch point the size reaches
+			for (int v = 0; v < n; v++) {
+				int i = visible[v];
+				float dx = xs[k][i] - eye[0], dy = model->center_y - eye[1], dz = zs[k][i] - eye[2];
+				float d = sqrtf (dx * dx + dy * dy + dz * dz);
+				float size = 2 * model->radius * pixel_scale / (d > model->radius ? d : model->radius);
+				int level = 0;
+				while (level < model->num_levels && size < model->min_pixels[level])
+					level++;
+				if (model->cull_distance > 0 && d > model->cull_distance)
+					level = model->num_levels;
+				// Sizes right at a switch point can round either way
+				if (exact[k].level[i] != level && fabsf (size - model->min_pixels[level < model->num_levels ? level : level - 1]) > size * 1e-4f &&
+					fabsf (d - model->cull_distance) > d * 1e-4f)
+					bad++;
+			}
+			full += (long long) n * model->triangles[0];
+			drawn += group[k].stats.triangles;
+			props += n;
+			culled += group[k].stats.culled;
+			switches += group[k].stats.switches;
+			exact_switches += exact[k].stats.switches;
+		}
+	}
+
+	printf ("frames:           %d\n", frames);
+	printf ("avg visible:      %.1f props, %.1f culled by size or distance\n", (double)props / frames, (double)culled / frames);
+	printf ("trees per level:  %.1f full, %.1f simple, %.1f impostor\n", (double)levels[0][0] / frames, (double)levels[0][1] / frames, (double)levels[0][2] / frames);
+	printf ("flowers drawn:    %.1f\n", (double)levels[1][0] / frames);
+	printf ("triangles:        %.0f per frame, %.0f at full detail\n", (double)drawn / frames, (double)full / frames);
+	printf ("level switches:   %.2f per frame, %.2f without hysteresis\n", (double)switches / frames, (double)exact_switches / frames);
+	printf ("selection:        %.1f ns per prop\n", props ? seconds * 1e9 / props : 0);
+	printf ("lod %s\n", bad ? "failed" : "ok");
+	if (bad)
+		printf ("%d checks failed\n", bad);
+
+	free (visible);
+	for (int k = 0; k < 2; k++) {
+		Lod_Free (&group[k]);
+		Lod_Free (&exact[k]);
+		SceneryBVH_Free (&bvh[k]);
+	}
+
+	return (bad == 0);
+}
+
+/*____________________________________________________________________
+|
+| Function: Bench_Pipeline
+|
+| Input: Called from main()
+| Output: Runs the scripted player for frames frames twice, the way the
+|   game used to and the way it does now.  Serial: each frame simulates,
+|   culls and then submits to a mock renderer, all on this thread.
+|   Pipelined: the next frame is simulated and culled on a job (which
+|   culls trees, flowers and monsters as jobs of its own) while this
+|   thread submits the frame before it.  Checks that both end in the
+|   same world state and submit the same frames.  Reports ms per frame
+|   for each, and the time of each stage.  Returns true if they match.
+|___________________________________________________________________*/
+
+static bool Bench_Pipeline (unsigned seed, int monsters, MonsterKernelType kernel, int frames)
+{
+	const float tree_min[3] = { -5, 0, -5 }, tree_max[3] = { 5, 30, 5 };
+	const float flower_min[3] = { -1, 0, -1 }, flower_max[3] = { 1, 2, 1 };
+	World *world[2];                          // serial, pipelined
+	SceneryBVH tree_bvh, flower_bvh;
+	LodGroup tree_lod, flower_lod;
+	FrameScene scene;
+	FrameSnapshot *snapshots;                 // serial uses the first
+	JobSystem jobs;
+	RenderQueue queue;
+	MockRenderer mock;
+	RenderBackend backend;
+	PipelineFrame job;
+	unsigned frames_hash[2] = { 2166136261u, 2166136261u };
+	double seconds[2], sim = 0, build = 0, submit = 0, wait = 0;
+	bool ok = true;
+
+	world[0] = (World *) malloc (sizeof(World));
+	world[1] = (World *) malloc (sizeof(World));
+	snapshots = (FrameSnapshot *) malloc (2 * sizeof(FrameSnapshot));
+	if (world[0] == NULL || world[1] == NULL || snapshots == NULL) {
+		fprintf (stderr, "out of memory\n");
+		return (false);
+	}
+	for (int w = 0; w < 2; w++) {
+		if (!World_Init (world[w], seed)) {
+			fprintf (stderr, "can't init world\n");
+			return (false);
+		}
+		for (int i = 0; i < WORLD_MONSTER_TYPES; i++)
+			if (monsters > WORLD_START_MONSTERS)
+				World_Spawn_Monsters (world[w], i, monsters - WORLD_START_MONSTERS);
+		World_Set_Monster_Bounds (world[w], 0, 6, 4);
+		World_Set_Monster_Bounds (world[w], 1, 6, 4);
+		World_Set_Monster_Bounds (world[w], 2, 3, 4);
+		World_Set_Monster_Kernel (world[w], kernel);
+	}
+	if (!SceneryBVH_Build (&tree_bvh, world[0]->tree_x, world[0]->tree_z, WORLD_MAX_TREES, tree_min, tree_max) ||
+		  !SceneryBVH_Build (&flower_bvh, world[0]->flower_x, world[0]->flower_z, WORLD_MAX_FLOWERS, flower_min, flower_max) ||
+		  !Lod_Init (&tree_lod, &Tree_Lod_Model, WORLD_MAX_TREES, LOD_HYSTERESIS) ||
+		  !Lod_Init (&flower_lod, &Flower_Lod_Model, WORLD_MAX_FLOWERS, LOD_HYSTERESIS) ||
+		  !RenderQueue_Init (&queue, WORLD_MAX_FLOWERS + WORLD_MAX_TREES + world[0]->monsters.capacity + WORLD_MAX_HIT) ||
+		  !Job_Init (&jobs, -1)) {
+		fprintf (stderr, "out of memory\n");
+		return (false);
+	}
+	FrameSnapshot_Init (&snapshots[0]);
+	FrameSnapshot_Init (&snapshots[1]);
+
+	memset (&scene, 0, sizeof(FrameScene));
+	scene.tree_bvh = &tree_bvh;
+	scene.flower_bvh = &flower_bvh;
+	scene.tree_lod = &tree_lod;
+	scene.flower_lod = &flower_lod;
+	scene.fov = CAMERA_FOV;
+	scene.aspect = CAMERA_ASPECT;
+	scene.near_plane = CAMERA_NEAR;
+	scene.far_plane = CAMERA_FAR;
+	scene.pixel_scale = Lod_Pixel_Scale (CAMERA_FOV, LOD_SCREEN_HEIGHT);
+	for (int i = 0; i < WORLD_MONSTER_TYPES; i++)
+		scene.monster_triangles[i] = 1000;
+
+	memset (&mock, 0, sizeof(MockRenderer));
+	backend.set_texture = Mock_Set_Texture;
+	backend.set_object_matrix = Mock_Set_Object_Matrix;
+	backend.draw_object = Mock_Draw_Object;
+	backend.draw_instances = Mock_Draw_Instances;
+	backend.context = &mock;
+	memset (&job, 0, sizeof(PipelineFrame));
+	job.scene = &scene;
+
+	// Serial: simulate, cull and submit one after the other
+	job.world = world[0];
+	job.snapshot = &snapshots[0];
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+	for (int frame = 0; frame < frames; frame++) {
+		job.frame = frame;
+		Pipeline_Frame (&job);
+		if (!job.ok)
+			break;
+		std::chrono::steady_clock::time_point submit_start = std::chrono::steady_clock::now ();
+		frames_hash[0] = (frames_hash[0] ^ Submit_Snapshot (&snapshots[0], world[0], &queue, &backend)) * 16777619u;
+		submit += std::chrono::duration<double> (std::chrono::steady_clock::now () - submit_start).count ();
+		sim += job.sim_seconds;
+		build += job.build_seconds;
+	}
+	seconds[0] = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+	ok = job.ok;
+
+	// Pipelined: frame n is simulated and culled on a job while frame n-1 is submitted,
+	// levels of detail start over so both runs pick the same
+	memset (tree_lod.level, LOD_UNSET, WORLD_MAX_TREES);
+	memset (flower_lod.level, LOD_UNSET, WORLD_MAX_FLOWERS);
+	job.world = world[1];
+	job.jobs = &jobs;
+	int front = 0;
+	start = std::chrono::steady_clock::now ();
+	for (int frame = 0; frame <= frames && ok; frame++) {
+		JobCounter done = { 0 };
+		if (frame < frames) {
+			job.frame = frame;
+			job.snapshot = &snapshots[1 - front];
+			Job_Submit (&jobs, Pipeline_Frame, &job, &done);
+		}
+		// Nothing to submit before the first frame is built
+		if (frame > 0)
+			frames_hash[1] = (frames_hash[1] ^ Submit_Snapshot (&snapshots[front], world[1], &queue, &backend)) * 16777619u;
+		std::chrono::steady_clock::time_point wait_start = std::chrono::steady_clock::now ();
+		Job_Wait (&jobs, &done);
+		wait += std::chrono::duration<double> (std::chrono::steady_clock::now () - wait_start).count ();
+		ok = job.ok;
+		front = 1 - front;
+	}
+	seconds[1] = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+	bool match = ok && State_Hash (world[0]) == State_Hash (world[1]) && frames_hash[0] == frames_hash[1];
+	if (!ok)
+		fprintf (stderr, "out of memory\n");
+	if (frames > 0) {
+		printf ("frames:           %d\n", frames);
+		printf ("job workers:      %d\n", jobs.num_threads);
+		printf ("serial:           %.3f ms per frame (simulate %.3f, cull %.3f, submit %.3f)\n",
+			seconds[0] * 1e3 / frames, sim * 1e3 / frames, build * 1e3 / frames, submit * 1e3 / frames);
+		printf ("pipelined:        %.3f ms per frame (%.3f waiting for the next frame)\n", seconds[1] * 1e3 / frames, wait * 1e3 / frames);
+		printf ("speedup:          %.2fx\n", seconds[1] > 0 ? seconds[0] / seconds[1] : 0);
+		printf ("draw calls:       %.1f per frame\n", (double)mock.draw_calls / (2 * frames));
+		printf ("state hash:       %08x %08x\n", State_Hash (world[0]), State_Hash (world[1]));
+	}
+	printf ("pipeline %s\n", match ? "ok" : "failed");
+
+	Job_Free (&jobs);
+	FrameSnapshot_Free (&snapshots[0]);
+	FrameSnapshot_Free (&snapshots[1]);
+	RenderQueue_Free (&queue);
+	Lod_Free (&tree_lod);
+	Lod_Free (&flower_lod);
+	SceneryBVH_Free (&tree_bvh);
+	SceneryBVH_Free (&flower_bvh);
+	for (int w = 0; w < 2; w++) {
+		World_Free (world[w]);
+		free (world[w]);
+	}
+	free (snapshots);
+
+	return (match);
+}
+
+/*____________________________________________________________________
+|
+| Function: Pipeline_Frame
+|
+| Input: Called from Bench_Pipeline() (maybe as a job)
+| Output: Steps the world once with the scripted player, as
+|   Bench_Render() does, then builds the frame's snapshot from the
+|   player's eyes.
+|___________________________________________________________________*/
+
+static void Pipeline_Frame (void *data)
+{
+	PipelineFrame *job = (PipelineFrame *) data;
+	World *world = job->world;
+	WorldInput input;
+	WorldStepResult result;
+	float angle = (float)job->frame * 0.001f;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+	memset (&input, 0, sizeof(input));
+	input.player_position.x = cosf (angle) * WALK_RADIUS;
+	input.player_position.y = 6;
+	input.player_position.z = sinf (angle) * WALK_RADIUS;
+	input.player_heading.x = -sinf (angle);
+	input.player_heading.z = cosf (angle);
+	input.moving = true;
+	input.shots = (job->frame % SHOT_INTERVAL) == 0 ? 1 : 0;
+	World_Step (world, 1.0f / DEFAULT_RATE, &input, &result);
+	if (world->health < PIPELINE_HEALTH)
+		world->health = WORLD_MAX_HEALTH;
+	std::chrono::steady_clock::time_point built = std::chrono::steady_clock::now ();
+	job->sim_seconds = std::chrono::duration<double> (built - start).count ();
+
+	job->ok = FrameSnapshot_Build (job->snapshot, world, 1, &input.player_position.x, &input.player_heading.x, job->scene, job->jobs);
+	job->snapshot->hits = result.hits;
+	job->build_seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - built).count ();
+}
+
+/*____________________________________________________________________
+|
+| Function: Submit_Snapshot
+|
+| Input: Called from Bench_Pipeline()
+| Output: Queues and flushes a snapshot the way the game draws it.
+|   Returns a hash of what was queued.
+|___________________________________________________________________*/
+
+static unsigned Submit_Snapshot (const FrameSnapshot *snapshot, const World *world, RenderQueue *queue, RenderBackend *backend)
+{
+	// Stand-ins for the game's object and texture handles
+	static char flower, tree[LOD_MAX_LEVELS], monster[WORLD_MONSTER_TYPES], hit, first_aid;
+	static char tex_flower, tex_tree[LOD_MAX_LEVELS], tex_monster[WORLD_MONSTER_TYPES], tex_hit, tex_first_aid;
+	unsigned hash = 2166136261u;
+
+	RenderQueue_Begin_Frame (queue);
+	for (int v = 0; v < snapshot->num_flowers; v++) {
+		int i = snapshot->flowers[v];
+		RenderQueue_Add_Translate (queue, &flower, &tex_flower, world->flower_x[i], 0, world->flower_z[i]);
+	}
+	for (int l = 0; l < LOD_MAX_LEVELS; l++)
+		for (int v = 0; v < snapshot->num_trees[l]; v++) {
+			int i = snapshot->trees[l][v];
+			RenderQueue_Add_Translate (queue, &tree[l], &tex_tree[l], world->tree_x[i], 0, world->tree_z[i]);
+		}
+	for (int v = 0; v < snapshot->num_visible_monsters; v++) {
+		int k = snapshot->visible_monsters[v];
+		int type = snapshot->monster_type[k];
+		RenderQueue_Add_Translate (queue, &monster[type], &tex_monster[type], snapshot->monster_x[k], 0, snapshot->monster_z[k]);
+	}
+	for (int i = 0; i < WORLD_MAX_HIT; i++)
+		if (snapshot->hit_timer[i] > 0)
+			RenderQueue_Add_Translate (queue, &hit, &tex_hit, snapshot->hit_position[i].x, snapshot->hit_position[i].y, snapshot->hit_position[i].z);
+	// Only the snapshot, the job may be moving the world's first aids
+	for (int i = 0; i < WORLD_MAX_EVENTS; i++) {
+		float center[3] = { snapshot->first_aid_x[i], 0, snapshot->first_aid_z[i] };
+		if (!snapshot->first_aid_collected[i] && Frustum_Test_Sphere (&snapshot->frustum, center, 2) != FRUSTUM_OUTSIDE)
+			RenderQueue_Add_Translate (queue, &first_aid, &tex_first_aid, snapshot->first_aid_x[i], 0, snapshot->first_aid_z[i]);
+	}
+
+	// Hash the matrices in queued order, before the flush sorts them
+	const unsigned char *p = (const unsigned char *) queue->matrices;
+	for (size_t i = 0; i < queue->count * 16 * sizeof(float); i++)
+		hash = (hash ^ p[i]) * 16777619u;
+	hash = (hash ^ (unsigned) snapshot->hits) * 16777619u;
+	RenderQueue_Flush (queue, backend);
+
+	return (hash);
+}
+
+/*____________________________________________________________________
+|
+| Function: Bench_Cameras
+|
+| Input: Called from main()
+| Output: Sets up cameras cameras, spread over the world, and updates
+|   each with its own scripted keys and mouse for frames frames, once
+|   one camera after the other on this thread and once in batches on
+|   jobs.  Checks that both runs leave every camera the same, that the
+|   eye stays on the ground, and that the view matrix puts the eye at
+|   the origin looking down +z.  Reports ns per camera update and view
+|   matrix.  Returns true if every check passes.
+|___________________________________________________________________*/
+
+static bool Bench_Cameras (int cameras, int frames)
+{
+	CameraController *serial, *parallel;
+	CameraBatch *batches;
+	JobSystem jobs;
+	int num_batches = (cameras + CAMERA_BATCH - 1) / CAMERA_BATCH;
+	double seconds[2], view_seconds;
+	float view[16];
+	int bad = 0;
+
+	serial = (CameraController *) malloc (cameras * sizeof(CameraController));
+	parallel = (CameraController *) malloc (cameras * sizeof(CameraController));
+	batches = (CameraBatch *) malloc (num_batches * sizeof(CameraBatch));
+	if (serial == NULL || parallel == NULL || batches == NULL || !Job_Init (&jobs, -1)) {
+		fprintf (stderr, "out of memory\n");
+		return (false);
+	}
+	for (int i = 0; i < cameras; i++) {
+		float angle = (float)i * 2.39996f;       // golden angle, spreads them out
+		float position[3] = { cosf (angle) * WALK_RADIUS, 6, sinf (angle) * WALK_RADIUS };
+		float heading[3] = { -sinf (angle), 0, cosf (angle) };
+		CameraController_Init (&serial[i], position, heading, RUN_SPEED, EYE_HEIGHT);
+	}
+	memcpy (parallel, serial, cameras * sizeof(CameraController));
+
+	// One after the other
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+	for (int frame = 0; frame < frames; frame++) {
+		CameraBatch batch = { serial, cameras, 0, frame };
+		Update_Cameras (&batch);
+	}
+	seconds[0] = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+	// In batches on jobs
+	start = std::chrono::steady_clock::now ();
+	for (int frame = 0; frame < frames; frame++) {
+		JobCounter done = { 0 };
+		for (int b = 0; b < num_batches; b++) {
+			batches[b].first = b * CAMERA_BATCH;
+			batches[b].cameras = parallel + batches[b].first;
+			batches[b].count = cameras - batches[b].first < CAMERA_BATCH ? cameras - batches[b].first : CAMERA_BATCH;
+			batches[b].frame = frame;
+			Job_Submit (&jobs, Update_Cameras, &batches[b], &done);
+		}
+		Job_Wait (&jobs, &done);
+	}
+	seconds[1] = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+	start = std::chrono::steady_clock::now ();
+	for (int i = 0; i < cameras; i++) {
+		CameraController_View_Matrix (&serial[i], view);
+		const float *eye = serial[i].position, *h = serial[i].heading;
+		// Eye goes to the origin, a point ahead of it onto +z
+		for (int c = 0; c < 3; c++) {
+			float e = eye[0] * view[c] + eye[1] * view[4 + c] + eye[2] * view[8 + c] + view[12 + c];
+			float a = (eye[0] + h[0]) * view[c] + (eye[1] + h[1]) * view[4 + c] + (eye[2] + h[2]) * view[8 + c] + view[12 + c];
+			if (fabsf (e) > 1e-2f || fabsf (a - (c == 2 ? 1 : 0)) > 1e-3f)
+				bad++;
+		}
+		if (eye[1] != EYE_HEIGHT)
+			bad++;
+	}
+	view_seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+	if (memcmp (serial, parallel, cameras * sizeof(CameraController)))
+		bad++;
+
+	double updates = (double)cameras * frames;
+	printf ("cameras:          %d for %d frames\n", cameras, frames);
+	printf ("job workers:      %d\n", jobs.num_threads);
+	printf ("one by one:       %.1f ns per update\n", updates > 0 ? seconds[0] * 1e9 / updates : 0);
+	printf ("on jobs:          %.1f ns per update (%d batches per frame)\n", updates > 0 ? seconds[1] * 1e9 / updates : 0, num_batches);
+	printf ("view matrix:      %.1f ns\n", view_seconds * 1e9 / cameras);
+	printf ("cameras %s\n", bad ? "failed" : "ok");
+	if (bad)
+		printf ("%d checks failed\n", bad);
+
+	Job_Free (&jobs);
+	free (serial);
+	free (parallel);
+	free (batches);
+
+	return (bad == 0);
+}
+
+/*____________________________________________________________________
+|
+| Function: Update_Cameras
+|
+| Input: Called from Bench_Cameras() (maybe as a job)
+| Output: Updates a batch of cameras one frame, each with keys and mouse
+|   movement made up from its index and the frame.
+|___________________________________________________________________*/
+
+static void Update_Cameras (void *data)
+{
+	CameraBatch *batch = (CameraBatch *) data;
+	float position[3], heading[3];
+	bool position_changed, camera_changed;
+
+	for (int i = 0; i < batch->count; i++) {
+		unsigned h = (unsigned)(batch->first + i) * 2654435761u ^ (unsigned)batch->frame * 40503u;
+		h ^= h >> 15;
+		h *= 2246822519u;
+		h ^= h >> 13;
+		float yaw = ((int)(h & 63) - 32) * 0.15f;
+		float pitch = ((int)((h >> 6) & 15) - 8) * 0.15f;
+		CameraController_Set_Speed (&batch->cameras[i], (h >> 14) & 1 ? RUN_SPEED * 3 : RUN_SPEED);
+		CameraController_Update (&batch->cameras[i], DEFAULT_FRAME, (h >> 10) & 15, pitch, yaw, false,
+			&position_changed, &camera_changed, position, heading);
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Bench_Camera_Update
+|
+| Input: Called from main()
+| Output: Feeds one camera updates updates of scripted mouse movement
+|   and keys, as fast as mouse events come, and times
+|   CameraController_Update() against the way the camera used to turn
+|   (rotate matrices about x and y, multiplied, the start heading
+|   transformed and normalized, the right vector worked out again for
+|   each strafe key).  Checks the two agree on the heading after every
+|   update and on where the camera ends up.  Returns true if they do.
+|___________________________________________________________________*/
+
+static bool Bench_Camera_Update (int updates)
+{
+	const float start_position[3] = { 0, 6, -20 }, start_heading[3] = { 0, 0, 1 };
+	CameraController camera, matrix_camera;
+	float *yaw, *pitch;
+	unsigned *keys;
+	float position[3], heading[3];
+	bool position_changed, camera_changed;
+	double seconds[2];
+	int bad = 0;
+
+	yaw = (float *) malloc (updates * sizeof(float));
+	pitch = (float *) malloc (updates * sizeof(float));
+	keys = (unsigned *) malloc (updates * sizeof(unsigned));
+	if (yaw == NULL || pitch == NULL || keys == NULL) {
+		fprintf (stderr, "out of memory\n");
+		return (false);
+	}
+	// Mostly small moves, now and then a flick, strafing a quarter of the time
+	for (int i = 0; i < updates; i++) {
+		unsigned h = (unsigned)i * 2654435761u;
+		h ^= h >> 15;
+		h *= 2246822519u;
+		h ^= h >> 13;
+		int scale = (h >> 20) & 7 ? 4 : 64;
+		yaw[i] = ((int)(h % (2 * scale + 1)) - scale) * 0.15f;
+		pitch[i] = ((int)((h >> 8) % 5) - 2) * 0.15f;
+		keys[i] = (h >> 16) & 3 ? CAMERA_MOVE_FORWARD : CAMERA_MOVE_FORWARD | ((h >> 18) & 1 ? CAMERA_MOVE_RIGHT : CAMERA_MOVE_LEFT);
+	}
+
+	CameraController_Init (&camera, start_position, start_heading, RUN_SPEED, EYE_HEIGHT);
+	matrix_camera = camera;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+	for (int i = 0; i < updates; i++)
+		Matrix_Camera_Update (&matrix_camera, 1, keys[i], pitch[i], yaw[i]);
+	seconds[0] = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+	start = std::chrono::steady_clock::now ();
+	for (int i = 0; i < updates; i++)
+		CameraController_Update (&camera, 1, keys[i], pitch[i], yaw[i], false, &position_changed, &camera_changed, position, heading);
+	seconds[1] = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+	// Again in step, comparing headings as they go
+	CameraController_Init (&camera, start_position, start_heading, RUN_SPEED, EYE_HEIGHT);
+	matrix_camera = camera;
+	for (int i = 0; i < updates; i++) {
+		Matrix_Camera_Update (&matrix_camera, 1, keys[i], pitch[i], yaw[i]);
+		CameraController_Update (&camera, 1, keys[i], pitch[i], yaw[i], false, &position_changed, &camera_changed, position, heading);
+		for (int c = 0; c < 3; c++)
+			if (fabsf (camera.heading[c] - matrix_camera.heading[c]) > 1e-5f)
+				bad++;
+	}
+	for (int c = 0; c < 3; c++)
+		if (fabsf (camera.position[c] - matrix_camera.position[c]) > 1e-2f)
+			bad++;
+
+	printf ("updates:          %d\n", updates);
+	printf ("matrices:         %.1f ns per update\n", updates > 0 ? seconds[0] * 1e9 / updates : 0);
+	printf ("cached basis:     %.1f ns per update\n", updates > 0 ? seconds[1] * 1e9 / updates : 0);
+	printf ("camera update %s\n", bad ? "failed" : "ok");
+	if (bad)
+		printf ("%d checks failed\n", bad);
+
+	free (yaw);
+	free (pitch);
+	free (keys);
+
+	return (bad == 0);
+}
+
+/*____________________________________________________________________
+|
+| Function: Matrix_Camera_Update
+|
+| Input: Called from Bench_Camera_Update()
+| Output: Turns and moves the camera the way CameraController_Update()
+|   used to, with 4x4 rotate matrices laid out like gx3d's.
+|___________________________________________________________________*/
+
+static void Matrix_Camera_Update (CameraController *camera, unsigned elapsed_time, unsigned move, float xrotate, float yrotate)
+{
+	float mx[16], my[16], mxy[16], v[4], right[3];
+	float move_amount = ((float)elapsed_time / 1000) * camera->speed;
+	float *heading = camera->heading, *position = camera->position;
+
+	camera->xrotate += xrotate;
+	if (camera->xrotate < -89)
+		camera->xrotate = -89;
+	else if (camera->xrotate > 89)
+		camera->xrotate = 89;
+	camera->yrotate += yrotate;
+	while (camera->yrotate < -360)
+		camera->yrotate += 360;
+	while (camera->yrotate > 360)
+		camera->yrotate -= 360;
+
+	if (xrotate != 0 || yrotate != 0) {
+		float ax = camera->xrotate * 3.14159265f / 180, ay = camera->yrotate * 3.14159265f / 180;
+		memset (mx, 0, sizeof(mx));
+		memset (my, 0, sizeof(my));
+		mx[0] = mx[15] = 1;
+		mx[5] = mx[10] = cosf (ax);
+		mx[6] = sinf (ax);
+		mx[9] = -sinf (ax);
+		my[5] = my[15] = 1;
+		my[0] = my[10] = cosf (ay);
+		my[2] = -sinf (ay);
+		my[8] = sinf (ay);
+		for (int r = 0; r < 4; r++)
+			for (int c = 0; c < 4; c++)
+				mxy[r * 4 + c] = mx[r * 4] * my[c] + mx[r * 4 + 1] * my[4 + c] + mx[r * 4 + 2] * my[8 + c] + mx[r * 4 + 3] * my[12 + c];
+		for (int c = 0; c < 4; c++)
+			v[c] = camera->start_heading[0] * mxy[c] + camera->start_heading[1] * mxy[4 + c] + camera->start_heading[2] * mxy[8 + c] + mxy[12 + c];
+		float length = sqrtf (v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+		for (int c = 0; c < 3; c++)
+			heading[c] = v[c] / length;
+	}
+
+	if (move) {
+		if (move & CAMERA_MOVE_FORWARD)
+			for (int c = 0; c < 3; c++)
+				position[c] += move_amount * heading[c];
+		if (move & CAMERA_MOVE_BACK)
+			for (int c = 0; c < 3; c++)
+				position[c] -= move_amount * heading[c];
+		if (move & CAMERA_MOVE_RIGHT) {
+			right[0] = heading[2];
+			right[1] = 0;
+			right[2] = -heading[0];
+			float length = sqrtf (right[0] * right[0] + right[2] * right[2]);
+			for (int c = 0; c < 3; c++)
+				position[c] += move_amount * right[c] / length;
+		}
+		if (move & CAMERA_MOVE_LEFT) {
+			right[0] = heading[2];
+			right[1] = 0;
+			right[2] = -heading[0];
+			float length = sqrtf (right[0] * right[0] + right[2] * right[2]);
+			for (int c = 0; c < 3; c++)
+				position[c] -= move_amount * right[c] / length;
+		}
+		position[1] = camera->eye_height;
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Bench_Lights
+|
+| Input: Called from main()
+| Output: Scatters lights fires over the world and walks the player,
+|   carrying a light, through it for frames frames (standing still
+|   every other second), giving the game's light slots to the most
+|   relevant lights each frame.  Checks that the slots hold the best
+|   lights there are and that what was sent to each slot matches its
+|   light now.  Reports lights sent per frame against sending every
+|   light every frame, and the time to assign and flush.  Returns true
+|   if every check passes.
+|___________________________________________________________________*/
+
+static bool Bench_Lights (unsigned seed, int lights, int frames)
+{
+	const LightDesc player_desc = { { 0, 5, 0 }, { 1, 0, 0 }, 200, 0.1f };
+	const LightDesc fire_desc = { { 0, 0, 0 }, { 1, 0.68f, 0.25f }, 75, 0.1f };
+	LightManager manager;
+	MockLights mock;
+	LightBackend backend = { Mock_Set_Light, &mock };
+	float *score, *sorted;
+	long long pushes = 0, reassigned = 0, selected = 0;
+	double seconds = 0;
+	int bad = 0;
+
+	score = (float *) malloc ((lights + 1) * sizeof(float));
+	sorted = (float *) malloc ((lights + 1) * sizeof(float));
+	if (score == NULL || sorted == NULL || !LightManager_Init (&manager, 1 + lights, LIGHT_SLOTS)) {
+		fprintf (stderr, "out of memory\n");
+		return (false);
+	}
+	int player = LightManager_Add (&manager, &player_desc, true);
+	Rng_Seed (&Test_Rng, seed, TEST_STREAM);
+	for (int i = 0; i < lights; i++) {
+		LightDesc fire = fire_desc;
+		fire.position[0] = Random_Float (-WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+		fire.position[2] = Random_Float (-WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+		if (LightManager_Add (&manager, &fire, false) == -1) {
+			fprintf (stderr, "out of memory\n");
+			return (false);
+		}
+	}
+	memset (&mock, 0, sizeof(MockLights));
+
+	float angle = 0;
+	for (int frame = 0; frame < frames; frame++) {
+		if ((frame / DEFAULT_RATE) % 2 == 0)
+			angle += 0.002f;
+		float eye[3] = { cosf (angle) * WALK_RADIUS, 5, sinf (angle) * WALK_RADIUS };
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+		LightManager_Move (&manager, player, eye);
+		LightManager_Assign (&manager, NULL, 0, eye, 0);
+		pushes += LightManager_Flush (&manager, &backend);
+		seconds += std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+		reassigned += manager.stats.reassigned;
+		selected += manager.stats.selected;
+
+		// The driver has what the slots hold now
+		for (int s = 0; s < LIGHT_SLOTS; s++) {
+			int light = manager.slot_light[s];
+			if (light == -1 ? mock.lit[s] : !mock.lit[s] || memcmp (&mock.slot[s], &manager.lights[light], sizeof(LightDesc)))
+				bad++;
+		}
+		// The slots hold the best lights: the player's, then as bright at the eye as the best fires (by brute force)
+		int n = 0;
+		for (int i = 0; i < manager.count; i++) {
+			const LightDesc *light = &manager.lights[i];
+			float dx = light->position[0] - eye[0], dy = light->position[1] - eye[1], dz = light->position[2] - eye[2];
+			float d = sqrtf (dx * dx + dy * dy + dz * dz);
+			score[i] = d < light->range ? (1 - d / light->range) / (1 + light->attenuation * d) : 0;
+			if (i != player && score[i] > 0)
+				sorted[n++] = score[i];
+		}
+		std::sort (sorted, sorted + n, std::greater<float> ());
+		int fires = 0;
+		float worst = 1;
+		bool has_player = false;
+		for (int s = 0; s < LIGHT_SLOTS; s++) {
+			int light = manager.slot_light[s];
+			if (light == player)
+				has_player = true;
+			else if (light != -1) {
+				if (score[light] < worst)
+					worst = score[light];
+				fires++;
+			}
+		}
+		int expect = n < LIGHT_SLOTS - 1 ? n : LIGHT_SLOTS - 1;
+		if (!has_player || fires != expect || (fires > 0 && fabsf (worst - sorted[fires - 1]) > 1e-5f))
+			bad++;
+	}
+
+	printf ("lights:           %d fires and the player's, %d slots, %d frames\n", lights, LIGHT_SLOTS, frames);
+	printf ("in range:         %.2f per frame\n", (double)selected / frames);
+	printf ("slots reassigned: %.3f per frame\n", (double)reassigned / frames);
+	printf ("lights sent:      %.3f per frame, %d sending every light every frame\n", (double)pushes / frames, lights + 1);
+	printf ("assign and flush: %.1f ns per frame\n", seconds * 1e9 / frames);
+	printf ("lights %s\n", bad ? "failed" : "ok");
+	if (bad)
+		printf ("%d checks failed\n", bad);
+
+	free (score);
+	free (sorted);
+	LightManager_Free (&manager);
+
+	return (bad == 0);
+}
+
+/*____________________________________________________________________
+|
+| Function: Bench_Clusters
+|
+| Input: Called from main()
+| Output: Scatters lights of random range and color over the world and
+|   walks a camera through them for frames frames, building the light
+|   clusters for its view each frame.  Every few frames, shades random
+|   points in view with the lights of their cluster and with every
+|   light, and checks they agree and that each cluster lists every
+|   light reaching the point.  Reports the build time and how many
+|   lights a point looks at against every light.  Returns true if
+|   every check passes.
+|___________________________________________________________________*/
+
+static bool Bench_Clusters (unsigned seed, int lights, int frames)
+{
+	LightDesc *desc;
+	LightClusters clusters;
+	CameraController camera;
+	float view[16];
+	long long visible = 0, entries = 0, looked_at = 0, samples = 0;
+	int max_per_cluster = 0;
+	double seconds = 0;
+	int bad = 0;
+
+	desc = (LightDesc *) malloc (lights * sizeof(LightDesc));
+	if (desc == NULL || !LightClusters_Init (&clusters, CAMERA_FOV, CAMERA_ASPECT, CAMERA_NEAR, CAMERA_FAR)) {
+		fprintf (stderr, "out of memory\n");
+		return (false);
+	}
+	Rng_Seed (&Test_Rng, seed, TEST_STREAM);
+	for (int i = 0; i < lights; i++) {
+		desc[i].position[0] = Random_Float (-WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+		desc[i].position[1] = Random_Float (0, 20);
+		desc[i].position[2] = Random_Float (-WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+		desc[i].color[0] = Random_Float (0.5f, 1);
+		desc[i].color[1] = Random_Float (0.2f, 0.8f);
+		desc[i].color[2] = Random_Float (0, 0.4f);
+		desc[i].range = Random_Float (CLUSTER_MIN_RANGE, CLUSTER_MAX_RANGE);
+		desc[i].attenuation = 0.1f;
+	}
+
+	for (int frame = 0; frame < frames; frame++) {
+		float angle = frame * 0.002f;
+		float eye[3] = { cosf (angle) * WALK_RADIUS, 5, sinf (angle) * WALK_RADIUS };
+		float heading[3] = { -sinf (angle), 0, cosf (angle) };
+		CameraController_Init (&camera, eye, heading, RUN_SPEED, EYE_HEIGHT);
+		CameraController_View_Matrix (&camera, view);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+		if (!LightClusters_Build (&clusters, view, desc, lights)) {
+			fprintf (stderr, "out of memory\n");
+			return (false);
+		}
+		seconds += std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+		visible += clusters.stats.visible;
+		entries += clusters.stats.entries;
+		if (clusters.stats.max_per_cluster > max_per_cluster)
+			max_per_cluster = clusters.stats.max_per_cluster;
+
+		if (frame % CLUSTER_CHECK_EVERY)
+			continue;
+		for (int k = 0; k < CLUSTER_SAMPLES; k++) {
+			// A point in view (view matrix columns are the camera's axes), facing anywhere
+			float z = CAMERA_NEAR * 10 * powf (CLUSTER_SAMPLE_FAR / (CAMERA_NEAR * 10), Random_Float (0, 1));
+			float x = Random_Float (-0.999f, 0.999f) * z * clusters.tan_x;
+			float y = Random_Float (-0.999f, 0.999f) * z * clusters.tan_y;
+			float p[3], normal[3] = { Random_Float (-1, 1), Random_Float (-1, 1), Random_Float (-1, 1) };
+			float length = sqrtf (normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			for (int a = 0; a < 3; a++) {
+				p[a] = eye[a] + x * view[a * 4] + y * view[a * 4 + 1] + z * view[a * 4 + 2];
+				normal[a] = length > 0 ? normal[a] / length : 1;
+			}
+			int cluster = LightClusters_Find (&clusters, p);
+			if (cluster == -1) {
+				bad++;
+				continue;
+			}
+			int n;
+			const int *list = LightClusters_Lights (&clusters, cluster, &n);
+			looked_at += n;
+			samples++;
+			// Every light reaching the point is listed, and shades it the same as every light does
+			float rgb[3], all[3] = { 0, 0, 0 };
+			for (int i = 0; i < lights; i++) {
+				float dx = desc[i].position[0] - p[0], dy = desc[i].position[1] - p[1], dz = desc[i].position[2] - p[2];
+				if (sqrtf (dx * dx + dy * dy + dz * dz) < desc[i].range && std::find (list, list + n, i) == list + n)
+					bad++;
+				LightClusters_Shade_Light (&desc[i], p, normal, all);
+			}
+			LightClusters_Shade (&clusters, desc, p, normal, rgb);
+			for (int c = 0; c < 3; c++)
+				if (fabsf (rgb[c] - all[c]) > 1e-4f * (1 + all[c]))
+					bad++;
+		}
+	}
+
+	printf ("clusters:         %d lights, %dx%dx%d clusters, %d frames\n", lights, LIGHT_CLUSTER_X, LIGHT_CLUSTER_Y, LIGHT_CLUSTER_Z, frames);
+	printf ("lights in view:   %.1f per frame\n", (double)visible / frames);
+	printf ("cluster lists:    %.2f lights per cluster, %d most\n", (double)entries / frames / LIGHT_CLUSTERS, max_per_cluster);
+	printf ("lights shaded:    %.2f per point, %d with every light\n", samples ? (double)looked_at / samples : 0.0, lights);
+	printf ("cluster build:    %.1f us per frame\n", seconds * 1e6 / frames);
+	printf ("clusters %s\n", bad ? "failed" : "ok");
+	if (bad)
+		printf ("%d checks failed\n", bad);
+
+	free (desc);
+	LightClusters_Free (&clusters);
+
+	return (bad == 0);
+}
+
+/*____________________________________________________________________
+|
+| Function: Bench_Particles
+|
+| Input: Called from main()
+| Output: Scatters emitters over the world, half poison and half fire,
+|   and each frame culls, updates and queues them for a camera walking
+|   and turning through the world.  Reports the time of each part and
+|   the draw calls of the game's way (an effect drawn at each visible
+|   emitter) against quads through a backend with and without
+|   instancing.  Returns true on success.
+|___________________________________________________________________*/
+
+static bool Bench_Particles (unsigned seed, int emitters)
+{
+	// Same as the game's effects
+	ParticleEffect fire = { 40, 1.0f, 8, 0.25f, 1.5f, -2, 3, 0.5f, 15 };
+	ParticleEffect poison = { 6, 1.5f, 2, 0.5f, 2, -0.5f, 1, 2.5f, 8 };
+	RenderTexture textures[PARTICLE_MAX_EFFECTS] = { (RenderTexture) 1, (RenderTexture) 2 };
+	RenderObject quad = (RenderObject) 1;
+	float billboard[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+	ParticleEngine engine;
+	RenderQueue queue;
+	RenderBackend backend, instancing_backend;
+	MockRenderer queued, instanced;
+	Frustum frustum;
+	double cull_seconds = 0, update_seconds = 0, draw_seconds = 0;
+	long long alive = 0, drawn = 0, visible = 0;
+
+	if (!Particle_Init (&engine, PARTICLE_CAPACITY, emitters, seed) || !RenderQueue_Init (&queue, PARTICLE_CAPACITY)) {
+		fprintf (stderr, "out of memory\n");
+		return (false);
+	}
+	Particle_Add_Effect (&engine, &fire);
+	Particle_Add_Effect (&engine, &poison);
+	Rng_Seed (&Test_Rng, seed, TEST_STREAM);
+	for (int i = 0; i < emitters; i++)
+		Particle_Create_Emitter (&engine, i & 1, Random_Float (-WORLD_HALF_SIZE, WORLD_HALF_SIZE), 8, Random_Float (-WORLD_HALF_SIZE, WORLD_HALF_SIZE));
+
+	memset (&queued, 0, sizeof(MockRenderer));
+	memset (&instanced, 0, sizeof(MockRenderer));
+	backend.set_texture = Mock_Set_Texture;
+	backend.set_object_matrix = Mock_Set_Object_Matrix;
+	backend.draw_object = Mock_Draw_Object;
+	backend.draw_instances = NULL;
+	backend.context = &queued;
+	instancing_backend = backend;
+	instancing_backend.draw_instances = Mock_Draw_Instances;
+	instancing_backend.context = &instanced;
+
+	for (int frame = 0; frame < SCENERY_FRAMES; frame++) {
+		float angle = (float)frame * 0.01f;
+		float eye[3] = { cosf (angle) * WALK_RADIUS, 6, sinf (angle) * WALK_RADIUS };
+		float look = angle * 3;
+		float heading[3] = { -sinf (look), 0, cosf (look) };
+		Frustum_Init (&frustum, eye, heading, CAMERA_FOV, CAMERA_ASPECT, CAMERA_NEAR, CAMERA_FAR);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+		Particle_Cull (&engine, &frustum);
+		cull_seconds += std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+		for (int i = 0; i < engine.num_emitters; i++)
+			visible += engine.emitters[i].visible;
+
+		start = std::chrono::steady_clock::now ();
+		Particle_Update (&engine, 1.0f / DEFAULT_RATE);
+		update_seconds += std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+		alive += engine.count;
+
+		RenderQueue_Begin_Frame (&queue);
+		start = std::chrono::steady_clock::now ();
+		drawn += Particle_Draw (&engine, &queue, quad, textures, billboard);
+		draw_seconds += std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+		RenderQueue_Flush (&queue, &backend);
+
+		Particle_Draw (&engine, &queue, quad, textures, billboard);
+		RenderQueue_Flush (&queue, &instancing_backend);
+	}
+
+	printf ("emitters:         %d\n", emitters);
+	printf ("avg visible:      %.1f emitters\n", (double)visible / SCENERY_FRAMES);
+	printf ("avg particles:    %.1f alive, %.1f drawn\n", (double)alive / SCENERY_FRAMES, (double)drawn / SCENERY_FRAMES);
+	printf ("cull us:          %.2f per frame\n", cull_seconds * 1e6 / SCENERY_FRAMES);
+	printf ("update us:        %.2f per frame (%.2f ns per particle)\n", update_seconds * 1e6 / SCENERY_FRAMES,
+		alive ? update_seconds * 1e9 / alive : 0);
+	printf ("queue us:         %.2f per frame\n", draw_seconds * 1e6 / SCENERY_FRAMES);
+	printf ("draw calls:       %.1f per frame drawing an effect at each visible emitter (the game)\n", (double)visible / SCENERY_FRAMES);
+	printf ("                  %.1f queueing quads without instancing, %.1f with\n",
+		(double)queued.draw_calls / SCENERY_FRAMES, (double)instanced.draw_calls / SCENERY_FRAMES);
+	printf ("dropped:          %d (arena holds %d)\n", engine.dropped, engine.capacity);
+
+	RenderQueue_Free (&queue);
+	Particle_Free (&engine);
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Bench_Assets
+|
+| Input: Called from main()
+| Output: Loads the assets listed in list_file the way the game loads them, reading on threads workers (-1 for the loader's default, 0
+|   to read each file on the main thread just before its upload), with
+|   a loading screen frame after each AssetLoader_Upload().  Loads them
+|   twice, so the second pass shows a warm file cache.  Reports the time
+|   to load everything and the longest frame.  Returns true on success.
+|___________________________________________________________________*/
+
+static bool Bench_Assets (const char *list_file, int threads)
+{
+	static char files[ASSET_MAX_ASSETS][ASSET_MAX_PATH], alt_files[ASSET_MAX_ASSETS][ASSET_MAX_PATH];
+	int num_files;
+	AssetLoader loader;
+	BenchUploads uploads;
+
+	num_files = Read_Asset_List (list_file, files, alt_files);
+	if (num_files < 0)
+		return (false);
+
+	printf ("assets:           %d\n", num_files);
+	for (int pass = 0; pass < 2; pass++) {
+		double frame_max = 0;
+
+		memset (&uploads, 0, sizeof(BenchUploads));
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+		AssetLoader_Init (&loader, NULL, Bench_Upload, &uploads);
+		for (int i = 0; i < num_files; i++)
+			AssetLoader_Add (&loader, 0, files[i], alt_files[i][0] ? alt_files[i] : NULL, NULL);
+		if (threads != 0 && !AssetLoader_Start (&loader, threads))
+			fprintf (stderr, "can't start loader threads, reading on the main thread\n");
+		while (!AssetLoader_Done (&loader)) {
+			std::chrono::steady_clock::time_point frame_start = std::chrono::steady_clock::now ();
+			// Nothing ready: a game frame would draw and wait for the display here, leaving the cpu to the workers
+			if (AssetLoader_Upload (&loader, LOAD_FRAME_SECONDS) == 0)
+				std::this_thread::yield ();
+			double frame = std::chrono::duration<double> (std::chrono::steady_clock::now () - frame_start).count ();
+			if (frame > frame_max)
+				frame_max = frame;
+		}
+		double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+		printf ("%s pass:      %.2f ms, %.1f MB, longest frame %.2f ms, %d errors, checksum %08x\n",
+			pass == 0 ? "first " : "second", seconds * 1e3, uploads.bytes / 1048576.0, frame_max * 1e3, loader.errors, uploads.checksum);
+		AssetLoader_Free (&loader);
+	}
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Read_Asset_List
+|
+| Input: Called from Bench_Assets(), Bench_Pack()
+| Output: Reads up to ASSET_MAX_ASSETS assets from an asset list (file,
+|   then an optional alpha file, per line, # for comments).  Returns the
+|   # read, or -1 on error.
+|___________________________________________________________________*/
+
+static int Read_Asset_List (const char *list_file, char (*files)[ASSET_MAX_PATH], char (*alt_files)[ASSET_MAX_PATH])
+{
+	FILE *fp;
+	char line[2 * ASSET_MAX_PATH + 2];
+	int num_files = 0;
+
+	fp = fopen (list_file, "r");
+	if (fp == NULL) {
+		fprintf (stderr, "can't read %s\n", list_file);
+		return (-1);
+	}
+	while (num_files < ASSET_MAX_ASSETS && fgets (line, sizeof(line), fp)) {
+		alt_files[num_files][0] = 0;
+		if (sscanf (line, "%127s %127s", files[num_files], alt_files[num_files]) < 1 || files[num_files][0] == '#')
+			continue;
+		num_files++;
+	}
+	fclose (fp);
+
+	return (num_files);
+}
+
+/*____________________________________________________________________
+|
+| Function: Bench_Upload
+|
+| Input: Called from AssetLoader_Upload()
+| Output: Upload function for Bench_Assets(): checksums the asset's
+|   bytes in a BenchUploads.  Returns true.
+|___________________________________________________________________*/
+
+static bool Bench_Upload (void *context, Asset *asset)
+{
+	BenchUploads *uploads = (BenchUploads *)context;
+	unsigned hash = 2166136261u;
+
+	for (size_t i = 0; i < asset->size; i++)
+		hash = (hash ^ asset->data[i]) * 16777619u;
+	uploads->checksum ^= hash;
+	uploads->bytes += asset->size;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Bench_Pack
+|
+| Input: Called from main()
+| Output: Maps an asset pack and gets a view of every entry, touching
+|   each page of it, then unmaps it.  Given an asset list, also reads
+|   and converts each listed file the way the packer does and checks the
+|   pack holds the same bytes, and that the triangle count the game takes
+|   of a mesh without converting it agrees.  Also converts a malformed
+|   mesh.  Returns true if the pack opens and matches the list.
+|___________________________________________________________________*/
+
+static bool Bench_Pack (const char *pack_file, const char *list_file)
+{
+	static char files[ASSET_MAX_ASSETS][ASSET_MAX_PATH], alt_files[ASSET_MAX_ASSETS][ASSET_MAX_PATH];
+	AssetPack pack;
+	unsigned checksum = 0;
+	unsigned long long bytes = 0;
+	int bad = 0;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+	if (!AssetPack_Open (&pack, pack_file)) {
+		fprintf (stderr, "can't open pack %s\n", pack_file);
+		return (false);
+	}
+	for (int i = 0; i < pack.num_entries; i++) {
+		const char *name = pack.entries[i].name;
+		const unsigned char *data = NULL;
+		size_t size = 0;
+		AssetPackMesh mesh;
+		AssetPackTexture texture;
+		AssetPackSound sound;
+
+		if (AssetPack_Mesh (&pack, name, &mesh)) {
+			data = (const unsigned char *) mesh.vertices;
+			size = (size_t) pack.entries[i].size;
+			for (unsigned k = 0; k < mesh.info->num_indices; k++)
+				if (mesh.indices[k] >= mesh.info->num_vertices) {
+					bad++;
+					break;
+				}
+		}
+		else if (AssetPack_Texture (&pack, name, &texture)) {
+			data = texture.levels[0];
+			size = (size_t) pack.entries[i].size;
+		}
+		else if (AssetPack_Sound (&pack, name, &sound)) {
+			data = sound.samples;
+			size = sound.size;
+		}
+		else
+			bad++;
+		// One byte per page is enough to fault the whole entry in
+		for (size_t k = 0; k < size; k += 4096)
+			checksum += data[k];
+		bytes += size;
+	}
+	double pack_seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+	printf ("pack:             %d entries, %.1f MB, %.2f ms to map and view (%d bad), checksum %08x\n",
+		pack.num_entries, bytes / 1048576.0, pack_seconds * 1e3, bad, checksum);
+	if (!Verify_Empty_Polygons ())
+		bad++;
+
+	if (list_file) {
+		int num_files = Read_Asset_List (list_file, files, alt_files), mismatches = 0;
+		if (num_files < 0) {
+			AssetPack_Close (&pack);
+			return (false);
+		}
+		bytes = 0;
+		start = std::chrono::steady_clock::now ();
+		for (int i = 0; i < num_files; i++) {
+			AssetPackEntry entry;
+			unsigned char *data;
+			const AssetPackEntry *packed = AssetPack_Find (&pack, files[i]);
+			if (!AssetConvert_File (files[i], alt_files[i][0] ? alt_files[i] : NULL, &entry, &data)) {
+				fprintf (stderr, "can't convert %s\n", files[i]);
+				mismatches++;
+				continue;
+			}
+			if (packed == NULL || packed->kind != entry.kind || packed->size != entry.size ||
+				memcmp (&packed->info, &entry.info, sizeof(entry.info)) || memcmp (pack.base + packed->offset, data, (size_t) entry.size)) {
+				fprintf (stderr, "%s doesn't match the pack\n", files[i]);
+				mismatches++;
+			}
+			// The game counts triangles without converting, it has to agree
+			if (entry.kind == ASSET_PACK_MESH && AssetConvert_File_Triangles (files[i]) != (int)(entry.info.mesh.num_indices / 3)) {
+				fprintf (stderr, "%s triangle count doesn't match its conversion\n", files[i]);
+				mismatches++;
+			}
+			bytes += entry.size;
+			free (data);
+		}
+		double loose_seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+		printf ("loose files:      %d assets, %.1f MB, %.2f ms to read and convert (%d don't match the pack)\n",
+			num_files, bytes / 1048576.0, loose_seconds * 1e3, mismatches);
+		bad += mismatches;
+	}
+	AssetPack_Close (&pack);
+
+	return (bad == 0);
+}
+
+/*____________________________________________________________________
+|
+| Function: Verify_Empty_Polygons
+|
+| Input: Called from Bench_Pack()
+| Output: Converts a mesh whose FACE chunk is mostly polygons with no
+|   points (2 bytes each, the most polygons a chunk can hold) ahead of
+|   one triangle.  Returns true if it comes out as that one triangle.
+|___________________________________________________________________*/
+
+static bool Verify_Empty_Polygons ()
+{
+	const int EMPTY = 1000;
+	const float points[9] = { 0, 0, 0, 1, 0, 0, 0, 1, 0 };
+	const unsigned char triangle[8] = { 0, 3, 0, 0, 0, 1, 0, 2 };    // 3 points, then their indices
+	unsigned pols_size = 4 + EMPTY * 2 + sizeof(triangle);
+	size_t size = 12 + 8 + sizeof(points) + 8 + pols_size;
+	unsigned char *lwo, *p, *data = NULL;
+	AssetPackEntry entry;
+	int triangles;
+	bool ok;
+
+	lwo = (unsigned char *) calloc (size, 1);
+	if (lwo == NULL) {
+		fprintf (stderr, "out of memory\n");
+		return (false);
+	}
+	p = lwo;
+	memcpy (p, "FORM", 4);
+	Put_BE32 (p + 4, (unsigned)(size - 8));
+	memcpy (p + 8, "LWO2", 4);
+	p += 12;
+	memcpy (p, "PNTS", 4);
+	Put_BE32 (p + 4, sizeof(points));
+	p += 8;
+	for (int k = 0; k < 9; k++, p += 4) {
+		unsigned bits;
+		memcpy (&bits, &points[k], 4);
+		Put_BE32 (p, bits);
+	}
+	memcpy (p, "POLS", 4);
+	Put_BE32 (p + 4, pols_size);
+	memcpy (p + 8, "FACE", 4);
+	p += 12 + EMPTY * 2;           // the empty polygons are already zeros
+	memcpy (p, triangle, sizeof(triangle));
+
+	ok = AssetConvert_LWO2 (lwo, size, &entry, &data);
+	triangles = AssetConvert_LWO2_Triangles (lwo, size);
+	if (ok)
+		ok = entry.info.mesh.num_indices == 3 && triangles == 1;
+	printf ("empty polygons:   %d ahead of a triangle, %s\n", EMPTY, ok ? "converted to 1 triangle" : "FAILED");
+	free (data);
+	free (lwo);
+
+	return (ok);
+}
+
+/*____________________________________________________________________
+|
+| Function: Put_BE32
+|
+| Input: Called from Verify_Empty_Polygons()
+| Output: Writes n big endian, the byte order of LWO2 files.
+|___________________________________________________________________*/
+
+static void Put_BE32 (unsigned char *p, unsigned n)
+{
+	p[0] = (unsigned char)(n >> 24);
+	p[1] = (unsigned char)(n >> 16);
+	p[2] = (unsigned char)(n >> 8);
+	p[3] = (unsigned char) n;
+}
+
+/*____________________________________________________________________
+|
+| Function: Mock_Set_Texture, Mock_Set_Object_Matrix, Mock_Draw_Object,
+|           Mock_Draw_Instances
+|
+| Input: Called from RenderQueue_Flush()
+| Output: Mock render backend: counts the calls in a MockRenderer.
+|___________________________________________________________________*/
+
+static void Mock_Set_Texture (void *context, RenderTexture texture)
+{
+	((MockRenderer *)context)->texture_changes++;
+}
+
+static void Mock_Set_Object_Matrix (void *context, RenderObject object, const float *matrix)
+{
+	((MockRenderer *)context)->matrix_changes++;
+}
+
+static void Mock_Draw_Object (void *context, RenderObject object)
+{
+	((MockRenderer *)context)->draw_calls++;
+}
+
+static void Mock_Draw_Instances (void *context, RenderObject object, const float *matrices, int count)
+{
+	((MockRenderer *)context)->draw_calls++;
+	((MockRenderer *)context)->matrix_changes += count > 0 ? 1 : 0;
+}
+
+/*____________________________________________________________________
+|
+| Function: Null_Load_Sample, Null_Play, Null_Stop, Null_Is_Playing,
+|           Null_Set_Position
+|
+| Input: Called from Voice_Load(), Voice_Play(), Voice_Stop(),
+|   Voice_Update()
+| Output: Null sound backend: keeps the state a sound library would
+|   (what each voice plays, until when, and where) without any sound.
+|___________________________________________________________________*/
+
+static bool Null_Load_Sample (void *context, int sample, const char *file, bool positional, float min_dist, float max_dist, float *seconds)
+{
+	NullSound *null_sound = (NullSound *)context;
+
+	null_sound->loads++;
+	null_sound->seconds[sample] = positional ? 1.5f : 0.3f;
+	*seconds = null_sound->seconds[sample];
+
+	return (true);
+}
+
+static void Null_Play (void *context, int voice, int sample, bool loop, float volume)
+{
+	NullSound *null_sound = (NullSound *)context;
+
+	null_sound->plays++;
+	null_sound->voice_sample[voice] = sample;
+	null_sound->voice_end[voice] = loop ? 1e30 : null_sound->time + null_sound->seconds[sample];
+}
+
+static void Null_Stop (void *context, int voice)
+{
+	((NullSound *)context)->voice_sample[voice] = -1;
+}
+
+static bool Null_Is_Playing (void *context, int voice)
+{
+	NullSound *null_sound = (NullSound *)context;
+
+	return (null_sound->voice_sample[voice] != -1 && null_sound->time < null_sound->voice_end[voice]);
+}
+
+static void Null_Set_Position (void *context, int voice, float x, float y, float z)
+{
+	NullSound *null_sound = (NullSound *)context;
+
+	null_sound->positions++;
+	null_sound->voice_pos[voice][0] = x;
+	null_sound->voice_pos[voice][1] = y;
+	null_sound->voice_pos[voice][2] = z;
+}
+
+/*____________________________________________________________________
+|
+| Function: Mock_Set_Light
+|
+| Input: Called from LightManager_Flush()
+| Output: Mock light backend: keeps what each slot was sent.
+|___________________________________________________________________*/
+
+static void Mock_Set_Light (void *context, int slot, const LightDesc *light)
+{
+	MockLights *mock = (MockLights *) context;
+
+	mock->lit[slot] = light != NULL;
+	if (light)
+		mock->slot[slot] = *light;
+}
@@ -0,0 +1,216 @@
+/*____________________________________________________________________
+|
+| File: hitscan.cpp
+|
+| Description: Grid ray walk and ray-shape tests for shots.
+|
+| Functions: Hitscan_Begin
+|            Hitscan_Next
+|            Hitscan_Ray_Sphere
+|            Hitscan_Ray_Cylinder
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <math.h>
+#include <float.h>
+
+#include "hitscan.h"
+
+/*____________________________________________________________________
+|
+| Function: Hitscan_Begin
+|
+| Input: Called from World_Cast_Shot()
+| Output: Sets up walk at the first cell under the ray (done at once if
+|   the ray misses the grid within max_dist).  The walk covers the grid
+|   plus a ring of cells around it, counted from the cell before the
+|   first one.
+|___________________________________________________________________*/
+
+void Hitscan_Begin (HitscanWalk *walk, const SpatialGrid *grid, float ox, float oz, float dx, float dz, float max_dist)
+{
+	float min = grid->min - grid->cell_size, max = grid->min + (grid->cells + 1) * grid->cell_size;
+	float t0 = 0, t1 = max_dist;
+	float o[2] = { ox, oz }, d[2] = { dx, dz };
+	float px, pz;
+
+	walk->cells = grid->cells + 2;
+	walk->t_max = max_dist;
+	walk->done = false;
+
+	// Clip the ray to the grid
+	for (int axis = 0; axis < 2; axis++) {
+		if (d[axis] == 0) {
+			if (o[axis] < min || o[axis] > max)
+				walk->done = true;
+		}
+		else {
+			float ta = (min - o[axis]) / d[axis], tb = (max - o[axis]) / d[axis];
+			if (ta > tb) {
+				float t = ta;
+				ta = tb;
+				tb = t;
+			}
+			if (ta > t0)
+				t0 = ta;
+			if (tb < t1)
+				t1 = tb;
+		}
+	}
+	if (walk->done || t0 > t1) {
+		walk->done = true;
+		return;
+	}
+	walk->t_max = t1;
+
+	px = ox + dx * t0;
+	pz = oz + dz * t0;
+	walk->cx = (int) floorf ((px - min) * grid->inv_cell_size);
+	walk->cz = (int) floorf ((pz - min) * grid->inv_cell_size);
+	if (walk->cx < 0)
+		walk->cx = 0;
+	else if (walk->cx >= walk->cells)
+		walk->cx = walk->cells - 1;
+	if (walk->cz < 0)
+		walk->cz = 0;
+	else if (walk->cz >= walk->cells)
+		walk->cz = walk->cells - 1;
+
+	if (dx > 0) {
+		walk->step_x = 1;
+		walk->next_x = (min + (walk->cx + 1) * grid->cell_size - ox) / dx;
+		walk->delta_x = grid->cell_size / dx;
+	}
+	else if (dx < 0) {
+		walk->step_x = -1;
+		walk->next_x = (min + walk->cx * grid->cell_size - ox) / dx;
+		walk->delta_x = -grid->cell_size / dx;
+	}
+	else {
+		walk->step_x = 0;
+		walk->next_x = walk->delta_x = FLT_MAX;
+	}
+	if (dz > 0) {
+		walk->step_z = 1;
+		walk->next_z = (min + (walk->cz + 1) * grid->cell_size - oz) / dz;
+		walk->delta_z = grid->cell_size / dz;
+	}
+	else if (dz < 0) {
+		walk->step_z = -1;
+		walk->next_z = (min + walk->cz * grid->cell_size - oz) / dz;
+		walk->delta_z = -grid->cell_size / dz;
+	}
+	else {
+		walk->step_z = 0;
+		walk->next_z = walk->delta_z = FLT_MAX;
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Hitscan_Next
+|
+| Input: Called from World_Cast_Shot()
+| Output: Returns the current cell in cx, cz (-1 to the grid size, the
+|   ring cells are outside the grid) and the distance the ray leaves it
+|   in t_exit, then steps to the next cell.  Returns false if there are
+|   no more cells.
+|___________________________________________________________________*/
+
+bool Hitscan_Next (HitscanWalk *walk, int *cx, int *cz, float *t_exit)
+{
+	float t;
+
+	if (walk->done)
+		return (false);
+
+	*cx = walk->cx - 1;
+	*cz = walk->cz - 1;
+	if (walk->next_x < walk->next_z) {
+		t = walk->next_x;
+		walk->cx += walk->step_x;
+		walk->next_x += walk->delta_x;
+	}
+	else {
+		t = walk->next_z;
+		walk->cz += walk->step_z;
+		walk->next_z += walk->delta_z;
+	}
+	if (t >= walk->t_max) {
+		t = walk->t_max;
+		walk->done = true;
+	}
+	else if (walk->cx < 0 || walk->cx >= walk->cells || walk->cz < 0 || walk->cz >= walk->cells)
+		walk->done = true;
+	*t_exit = t;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Hitscan_Ray_Sphere
+|
+| Input: Called from World_Cast_Shot(), headless driver
+| Output: Returns the distance along the ray to the sphere, 0 if the ray
+|   starts inside it, or -1 if it misses (or the sphere is behind).
+|___________________________________________________________________*/
+
+float Hitscan_Ray_Sphere (const float origin[3], const float dir[3], const float center[3], float radius)
+{
+	float vx, vy, vz, b, c, disc;
+
+	vx = center[0] - origin[0];
+	vy = center[1] - origin[1];
+	vz = center[2] - origin[2];
+	c = (vx * vx) + (vy * vy) + (vz * vz) - (radius * radius);
+	// Ray starts inside the sphere?
+	if (c <= 0)
+		return (0);
+	b = (vx * dir[0]) + (vy * dir[1]) + (vz * dir[2]);
+	// Sphere is behind the ray?
+	if (b < 0)
+		return (-1);
+	disc = (b * b) - c;
+	if (disc < 0)
+		return (-1);
+
+	return (b - sqrtf (disc));
+}
+
+/*____________________________________________________________________
+|
+| Function: Hitscan_Ray_Cylinder
+|
+| Input: Called from World_Cast_Shot(), headless driver
+| Output: Returns the distance along the ray to a vertical cylinder, 0
+|   if the ray starts inside it, or -1 if it misses.
+|___________________________________________________________________*/
+
+float Hitscan_Ray_Cylinder (const float origin[3], const float dir[3], float cx, float cz, float radius)
+{
+	float vx, vz, a, b, c, disc;
+
+	vx = cx - origin[0];
+	vz = cz - origin[2];
+	c = (vx * vx) + (vz * vz) - (radius * radius);
+	if (c <= 0)
+		return (0);
+	// Straight up or down never reaches it
+	a = (dir[0] * dir[0]) + (dir[2] * dir[2]);
+	b = (vx * dir[0]) + (vz * dir[2]);
+	if (a == 0 || b < 0)
+		return (-1);
+	disc = (b * b) - a * c;
+	if (disc < 0)
+		return (-1);
+
+	return ((b - sqrtf (disc)) / a);
+}
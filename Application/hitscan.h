@@ -0,0 +1,59 @@
+/*____________________________________________________________________
+|
+| File: hitscan.h
+|
+| Description: Ray casting helpers for instant hit shots.  Walks the
+|   cells of a spatial grid under a ray, front to back, one cell per
+|   call (a 2D DDA over x-z, with distances measured along the 3D ray),
+|   so a shot only looks at what's near its path and can stop at the
+|   first thing it hits.  Plus the ray tests against the shapes things
+|   are shot as.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _HITSCAN_H_
+#define _HITSCAN_H_
+
+#include "spatial_grid.h"
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	int   cells;               // grid size plus the ring around it
+	int   cx, cz;              // current cell, counting the ring
+	int   step_x, step_z;      // -1, 0 or 1
+	float next_x, next_z;      // distance along the ray to the next x / z cell boundary
+	float delta_x, delta_z;    // distance along the ray between x / z boundaries
+	float t_max;
+	bool  done;
+} HitscanWalk;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+// Starts walking the cells under a ray.  dx, dz are the x and z of the
+//   normalized 3D direction, so distances are along the 3D ray.  The
+//   walk includes a ring of cells just outside the grid, so a ray that
+//   only grazes the edge still finds things sticking out over it.  A
+//   ray starting outside starts where it enters the ring.
+void  Hitscan_Begin (HitscanWalk *walk, const SpatialGrid *grid, float ox, float oz, float dx, float dz, float max_dist);
+
+// Gets the next cell (-1 to grid cells, outside the grid is the ring) and the
+//   distance at which the ray leaves it, returns false when done
+bool  Hitscan_Next (HitscanWalk *walk, int *cx, int *cz, float *t_exit);
+
+// Returns the distance to where the ray (dir normalized) enters a sphere
+//   (0 if it starts inside), or -1 if it misses
+float Hitscan_Ray_Sphere (const float origin[3], const float dir[3], const float center[3], float radius);
+
+// Same for an infinitely tall vertical cylinder (a tree trunk)
+float Hitscan_Ray_Cylinder (const float origin[3], const float dir[3], float cx, float cz, float radius);
+
+#endif
@@ -0,0 +1,150 @@
+/*____________________________________________________________________
+|
+| File: hud_text.cpp
+|
+| Description: HUD text layout and glyph strips.
+|
+| Functions: HudText_Layout
+|            HudText_Layout_Number
+|            HudText_Strip
+|             Put_Vertex
+|            HudText_Strip_Vertices
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hud_text.h"
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static float *Put_Vertex (float *vertex, float x, float y, float z, float u, float v);
+
+/*____________________________________________________________________
+|
+| Function: HudText_Layout
+|
+| Input: Called from HudText_Layout_Number(), Program_Run(), headless
+|   driver
+| Output: Fills in out with the glyphs of text, returns how many (at
+|   most max_out, the string is laid out in full and cut off after).
+|___________________________________________________________________*/
+
+int HudText_Layout (const HudFont *font, const char *text, float x, float y, HudAlign align, HudGlyph *out, int max_out)
+{
+	int length = (int) strlen (text), n = 0;
+	float start = x;
+
+	if (align == HUD_ALIGN_RIGHT)
+		start = x - (length - 1) * font->advance;
+	else if (align == HUD_ALIGN_CENTER)
+		start = x - (length - 1) * font->advance * 0.5f;
+
+	for (int i = 0; i < length && n < max_out; i++) {
+		int glyph = text[i] - font->first_char;
+		if (glyph < 0 || glyph >= font->num_glyphs)
+			continue;
+		int column = glyph % font->columns, row = glyph / font->columns;
+		out[n].glyph = glyph;
+		out[n].x = start + i * font->advance;
+		out[n].y = y;
+		out[n].u0 = (float) column / font->columns;
+		out[n].v0 = (float) row / font->rows;
+		out[n].u1 = (float) (column + 1) / font->columns;
+		out[n].v1 = (float) (row + 1) / font->rows;
+		n++;
+	}
+
+	return (n);
+}
+
+/*____________________________________________________________________
+|
+| Function: HudText_Layout_Number
+|
+| Input: Called from Queue_Number(), headless driver
+| Output: Lays out value in decimal, returns the # of glyphs.
+|___________________________________________________________________*/
+
+int HudText_Layout_Number (const HudFont *font, long long value, float x, float y, HudAlign align, HudGlyph *out, int max_out)
+{
+	char text[24];
+
+	sprintf (text, "%lld", value);
+
+	return (HudText_Layout (font, text, x, y, align, out, max_out));
+}
+
+/*____________________________________________________________________
+|
+| Function: HudText_Strip
+|
+| Input: Called from headless driver
+| Output: Writes each glyph as a quad (top left, bottom left, top right,
+|   bottom right) into one triangle strip, repeating the last vertex of
+|   a quad and the first of the next between them.  Returns the # of
+|   vertices written.
+|___________________________________________________________________*/
+
+int HudText_Strip (const HudFont *font, const HudGlyph *glyphs, int count, float z, float *vertices)
+{
+	float half = font->size * 0.5f;
+	float *vertex = vertices;
+
+	for (int i = 0; i < count; i++) {
+		const HudGlyph *g = &glyphs[i];
+		if (i > 0)
+			vertex = Put_Vertex (vertex, g->x - half, g->y + half, z, g->u0, g->v0);
+		vertex = Put_Vertex (vertex, g->x - half, g->y + half, z, g->u0, g->v0);
+		vertex = Put_Vertex (vertex, g->x - half, g->y - half, z, g->u0, g->v1);
+		vertex = Put_Vertex (vertex, g->x + half, g->y + half, z, g->u1, g->v0);
+		vertex = Put_Vertex (vertex, g->x + half, g->y - half, z, g->u1, g->v1);
+		if (i < count - 1)
+			vertex = Put_Vertex (vertex, g->x + half, g->y - half, z, g->u1, g->v1);
+	}
+
+	return ((int) (vertex - vertices) / HUD_TEXT_VERTEX_FLOATS);
+}
+
+/*____________________________________________________________________
+|
+| Function: Put_Vertex
+|
+| Input: Called from HudText_Strip()
+| Output: Writes a vertex, returns where the next one goes.
+|___________________________________________________________________*/
+
+static float *Put_Vertex (float *vertex, float x, float y, float z, float u, float v)
+{
+	vertex[0] = x;
+	vertex[1] = y;
+	vertex[2] = z;
+	vertex[3] = u;
+	vertex[4] = v;
+
+	return (vertex + HUD_TEXT_VERTEX_FLOATS);
+}
+
+/*____________________________________________________________________
+|
+| Function: HudText_Strip_Vertices
+|
+| Input: Called from any module
+| Output: Returns the # of vertices in the strip of count glyphs.
+|___________________________________________________________________*/
+
+int HudText_Strip_Vertices (int count)
+{
+	return (count > 0 ? 6 * count - 2 : 0);
+}
@@ -0,0 +1,72 @@
+/*____________________________________________________________________
+|
+| File: hud_text.h
+|
+| Description: HUD text layout.  A font is a grid of glyphs in one atlas
+|   texture (the game's is the ten digits).  Laying out a string gives
+|   each glyph's position and atlas cell, for any length of string, and
+|   the glyphs can be turned into one triangle strip of quads so the
+|   whole string is a single draw with a single texture.
+|
+|   Positions are in HUD units (the 2D camera's view), glyph positions
+|   are their centers.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _HUD_TEXT_H_
+#define _HUD_TEXT_H_
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define HUD_TEXT_MAX_GLYPHS     32     // longest string the game lays out at once
+#define HUD_TEXT_VERTEX_FLOATS  5      // x, y, z, u, v
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef enum {
+	HUD_ALIGN_LEFT,                    // first glyph centered on x
+	HUD_ALIGN_CENTER,                  // string centered on x
+	HUD_ALIGN_RIGHT                    // last glyph centered on x
+} HudAlign;
+
+typedef struct {
+	char  first_char;                  // character of glyph 0, the rest follow in order
+	int   num_glyphs;
+	int   columns;                     // atlas grid, glyphs in rows left to right from the top
+	int   rows;
+	float advance;                     // distance between glyph centers
+	float size;                        // glyph height and width
+} HudFont;
+
+typedef struct {
+	int   glyph;
+	float x, y;
+	float u0, v0, u1, v1;              // atlas cell
+} HudGlyph;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+// Lays out text at (x, y), skipping characters the font doesn't have (they
+//   still take up space).  Fills in up to max_out glyphs, returns how many.
+int  HudText_Layout (const HudFont *font, const char *text, float x, float y, HudAlign align, HudGlyph *out, int max_out);
+// Same for a number, in decimal
+int  HudText_Layout_Number (const HudFont *font, long long value, float x, float y, HudAlign align, HudGlyph *out, int max_out);
+
+// Writes a triangle strip of count glyph quads at depth z (degenerate
+//   triangles join the quads).  Returns the # of vertices, at most
+//   HudText_Strip_Vertices(count).
+int  HudText_Strip (const HudFont *font, const HudGlyph *glyphs, int count, float z, float *vertices);
+int  HudText_Strip_Vertices (int count);
+
+#endif
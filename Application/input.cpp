@@ -0,0 +1,243 @@
+/*____________________________________________________________________
+|
+| File: input.cpp
+|
+| Description: Timestamped player input commands.
+|
+| Functions: Input_Init
+|            Input_Free
+|            Input_Push
+|            Input_Apply
+|            Input_Take_Shots
+|            Input_Clear
+|            Input_Get_Latency
+|             Compare_Floats
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "input.h"
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static int Compare_Floats (const void *a, const void *b);
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define MIN_CAPACITY 64
+
+/*____________________________________________________________________
+|
+| Function: Input_Init
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Creates an empty queue.  Returns true on success, else false.
+|___________________________________________________________________*/
+
+bool Input_Init (InputQueue *queue)
+{
+	memset (queue, 0, sizeof(InputQueue));
+
+	queue->commands = (InputCommand *) malloc (MIN_CAPACITY * sizeof(InputCommand));
+	if (queue->commands == NULL)
+		return (false);
+	queue->capacity = MIN_CAPACITY;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Input_Free
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Frees all memory used by the queue.
+|___________________________________________________________________*/
+
+void Input_Free (InputQueue *queue)
+{
+	free (queue->commands);
+	memset (queue, 0, sizeof(InputQueue));
+}
+
+/*____________________________________________________________________
+|
+| Function: Input_Push
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Adds a command to the end of the queue.  Returns true on
+|   success, else false.
+|___________________________________________________________________*/
+
+bool Input_Push (InputQueue *queue, InputCommandType type, unsigned value, ProfileTime time)
+{
+	InputCommand *command;
+
+	if (queue->count == queue->capacity) {
+		int capacity = queue->capacity * 2;
+		InputCommand *commands = (InputCommand *) realloc (queue->commands, capacity * sizeof(InputCommand));
+		if (commands == NULL)
+			return (false);
+		queue->commands = commands;
+		queue->capacity = capacity;
+	}
+
+	command = &queue->commands[queue->count++];
+	command->type = type;
+	command->value = value;
+	command->time = time;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Input_Apply
+|
+| Input: Called from Program_Run()
+| Output: Applies the queued commands, other than shots, to state in the
+|   order they were read.  Shots are left queued for Input_Take_Shots().
+|   Returns # of commands applied.
+|___________________________________________________________________*/
+
+int Input_Apply (InputQueue *queue, bool playing, InputState *state)
+{
+	int i, kept = 0, applied = 0;
+
+	state->pressed = 0;
+	for (i = 0; i < queue->count; i++) {
+		const InputCommand *command = &queue->commands[i];
+		switch (command->type) {
+			case INPUT_CMD_MOVE_START:
+				if (playing)
+					state->move |= command->value;
+				break;
+			case INPUT_CMD_MOVE_STOP:
+				if (playing)
+					state->move &= ~command->value;
+				break;
+			case INPUT_CMD_RUN_START:
+				if (playing)
+					state->run = true;
+				break;
+			case INPUT_CMD_RUN_STOP:
+				if (playing)
+					state->run = false;
+				break;
+			case INPUT_CMD_SHOOT:
+				// Kept for the step it falls in
+				if (playing) {
+					queue->commands[kept++] = *command;
+					continue;
+				}
+				break;
+			case INPUT_CMD_PRESS:
+				state->pressed |= command->value;
+				break;
+			case INPUT_CMD_TOGGLE:
+				state->pressed ^= command->value;
+				break;
+		}
+		applied++;
+	}
+	queue->count = kept;
+
+	return (applied);
+}
+
+/*____________________________________________________________________
+|
+| Function: Input_Take_Shots
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Removes the shots read at or before until, records how long
+|   each waited (until now) and returns how many were removed.
+|___________________________________________________________________*/
+
+int Input_Take_Shots (InputQueue *queue, ProfileTime until, ProfileTime now)
+{
+	int i, kept = 0, shots = 0;
+
+	for (i = 0; i < queue->count; i++) {
+		const InputCommand *command = &queue->commands[i];
+		if (command->type == INPUT_CMD_SHOOT && command->time <= until) {
+			float ms = now > command->time ? (now - command->time) / 1e6f : 0;
+			queue->latency[queue->num_latency++ % INPUT_LATENCY_HISTORY] = ms;
+			shots++;
+		}
+		else
+			queue->commands[kept++] = *command;
+	}
+	queue->count = kept;
+
+	return (shots);
+}
+
+/*____________________________________________________________________
+|
+| Function: Input_Clear
+|
+| Input: Called from Program_Run()
+| Output: Drops every queued command and clears the held state.
+|___________________________________________________________________*/
+
+void Input_Clear (InputQueue *queue, InputState *state)
+{
+	queue->count = 0;
+	memset (state, 0, sizeof(InputState));
+}
+
+/*____________________________________________________________________
+|
+| Function: Input_Get_Latency
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Returns the latency of the last INPUT_LATENCY_HISTORY shots.
+|___________________________________________________________________*/
+
+void Input_Get_Latency (const InputQueue *queue, InputLatency *latency)
+{
+	float sorted[INPUT_LATENCY_HISTORY];
+	int n = queue->num_latency < INPUT_LATENCY_HISTORY ? queue->num_latency : INPUT_LATENCY_HISTORY;
+
+	memset (latency, 0, sizeof(InputLatency));
+	if (n == 0)
+		return;
+
+	memcpy (sorted, queue->latency, n * sizeof(float));
+	qsort (sorted, n, sizeof(float), Compare_Floats);
+	latency->samples = n;
+	latency->p50_ms = sorted[(n - 1) / 2];
+	latency->p99_ms = sorted[((n - 1) * 99) / 100];
+	latency->max_ms = sorted[n - 1];
+}
+
+/*____________________________________________________________________
+|
+| Function: Compare_Floats
+|
+| Input: Called from qsort() in Input_Get_Latency()
+| Output: Orders floats smallest first.
+|___________________________________________________________________*/
+
+static int Compare_Floats (const void *a, const void *b)
+{
+	float fa = *(const float *)a, fb = *(const float *)b;
+
+	return (fa < fb ? -1 : (fa > fb ? 1 : 0));
+}
@@ -0,0 +1,104 @@
+/*____________________________________________________________________
+|
+| File: input.h
+|
+| Description: Player input as a buffer of timestamped commands.  The
+|   game reads every pending event each frame, turns it into a command
+|   and queues it.  Held state (movement, running) and menu presses are
+|   applied once per frame.  Shots stay queued until the fixed step
+|   whose time slice they fall in takes them, which is when their
+|   latency (time read until the simulation sees them) is measured.
+|
+|   Commands are independent of the input device, so a driver can queue
+|   them from a script instead of from events.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _INPUT_H_
+#define _INPUT_H_
+
+#include "profile.h"
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+// Presses (InputState.pressed)
+#define INPUT_PRESS_QUIT          0x1
+#define INPUT_PRESS_START         0x2
+#define INPUT_PRESS_INSTRUCTIONS  0x4
+#define INPUT_PRESS_WIN           0x8
+
+#define INPUT_LATENCY_HISTORY     1024    // shots in the rolling latency summary
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef enum {
+	INPUT_CMD_MOVE_START,     // value: move bits to set
+	INPUT_CMD_MOVE_STOP,      // value: move bits to clear
+	INPUT_CMD_RUN_START,
+	INPUT_CMD_RUN_STOP,
+	INPUT_CMD_SHOOT,
+	INPUT_CMD_PRESS,          // value: INPUT_PRESS_* bit to set
+	INPUT_CMD_TOGGLE          // value: INPUT_PRESS_* bit to flip (two presses cancel)
+} InputCommandType;
+
+typedef struct {
+	InputCommandType type;
+	unsigned         value;
+	ProfileTime      time;     // when the command was read
+} InputCommand;
+
+typedef struct {
+	unsigned move;             // move bits held (CAMERA_MOVE_*)
+	bool     run;
+	unsigned pressed;          // INPUT_PRESS_* since the last apply
+} InputState;
+
+typedef struct {
+	int   samples;
+	float p50_ms;
+	float p99_ms;
+	float max_ms;
+} InputLatency;
+
+typedef struct {
+	InputCommand *commands;    // in order read, not yet applied
+	int           count;
+	int           capacity;
+	float         latency[INPUT_LATENCY_HISTORY];  // ms, ring
+	int           num_latency;                      // # ever recorded
+} InputQueue;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+bool Input_Init (InputQueue *queue);
+void Input_Free (InputQueue *queue);
+
+// Queues a command (grows the queue if needed).  Returns true on success, else false.
+bool Input_Push (InputQueue *queue, InputCommandType type, unsigned value, ProfileTime time);
+
+// Applies every queued command except shots to state, in order.  If not
+//   playing, movement and shots are dropped.  Returns # of commands applied.
+int  Input_Apply (InputQueue *queue, bool playing, InputState *state);
+
+// Removes the shots read at or before until and returns how many.  Call
+//   once per fixed step with the time its slice ends, now is the time the
+//   step runs (for latency).
+int  Input_Take_Shots (InputQueue *queue, ProfileTime until, ProfileTime now);
+
+// Drops every queued command (ignores held state too)
+void Input_Clear (InputQueue *queue, InputState *state);
+
+void Input_Get_Latency (const InputQueue *queue, InputLatency *latency);
+
+#endif
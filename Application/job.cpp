@@ -0,0 +1,235 @@
+/*____________________________________________________________________
+|
+| File: job.cpp
+|
+| Description: Job system.
+|
+| Functions: Job_Init
+|            Job_Free
+|            Job_Submit
+|            Job_Wait
+|             Run_Job
+|            Worker_Run
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <string.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <new>
+
+#include "profile.h"
+#include "job.h"
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	JobFunc     func;
+	void       *data;
+	JobCounter *counter;
+} Job;
+
+struct JobQueue {
+	std::thread             threads[JOB_MAX_THREADS];
+	std::mutex              lock;
+	std::condition_variable work;          // a job was queued, or stopping
+	std::condition_variable done;          // a job finished
+	Job                     jobs[JOB_QUEUE_SIZE];
+	int                     head;          // next job to run
+	int                     count;
+	bool                    stop;
+};
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static void Run_Job (JobQueue *queue, Job *job, std::unique_lock<std::mutex> &held);
+static void Worker_Run (JobQueue *queue);
+
+/*____________________________________________________________________
+|
+| Function: Job_Init
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Sets up the queue and starts the workers.  Returns true on
+|   success, else false.  If fewer workers start than asked for, the
+|   ones that did are used.
+|___________________________________________________________________*/
+
+bool Job_Init (JobSystem *system, int threads)
+{
+	JobQueue *queue;
+
+	memset (system, 0, sizeof(JobSystem));
+	// Leave a core for the calling thread, which waits by running jobs too
+	if (threads < 0) {
+		threads = (int) std::thread::hardware_concurrency () - 1;
+		if (threads < 1)
+			threads = 1;
+	}
+	if (threads > JOB_MAX_THREADS)
+		threads = JOB_MAX_THREADS;
+
+	queue = new (std::nothrow) JobQueue;
+	if (queue == NULL)
+		return (false);
+	queue->head = 0;
+	queue->count = 0;
+	queue->stop = false;
+	system->queue = queue;
+
+	for (int i = 0; i < threads; i++) {
+		try {
+			queue->threads[i] = std::thread (Worker_Run, queue);
+		}
+		catch (...) {
+			break;
+		}
+		system->num_threads++;
+	}
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Job_Free
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Lets the workers finish the queued jobs, joins them and frees
+|   the queue.
+|___________________________________________________________________*/
+
+void Job_Free (JobSystem *system)
+{
+	JobQueue *queue = system->queue;
+
+	if (queue == NULL)
+		return;
+	{
+		std::unique_lock<std::mutex> held (queue->lock);
+		// With no workers, the queued jobs still have to run
+		while (system->num_threads == 0 && queue->count > 0) {
+			Job job = queue->jobs[queue->head];
+			queue->head = (queue->head + 1) % JOB_QUEUE_SIZE;
+			queue->count--;
+			Run_Job (queue, &job, held);
+		}
+		queue->stop = true;
+	}
+	queue->work.notify_all ();
+	for (int i = 0; i < system->num_threads; i++)
+		queue->threads[i].join ();
+	delete queue;
+	memset (system, 0, sizeof(JobSystem));
+}
+
+/*____________________________________________________________________
+|
+| Function: Job_Submit
+|
+| Input: Called from any thread
+| Output: Counts the job on counter and queues it.  If the queue is full
+|   the job is run now, on this thread.
+|___________________________________________________________________*/
+
+void Job_Submit (JobSystem *system, JobFunc func, void *data, JobCounter *counter)
+{
+	JobQueue *queue = system->queue;
+	Job job = { func, data, counter };
+	std::unique_lock<std::mutex> held (queue->lock);
+
+	counter->pending++;
+	if (queue->count == JOB_QUEUE_SIZE) {
+		Run_Job (queue, &job, held);
+		return;
+	}
+	queue->jobs[(queue->head + queue->count) % JOB_QUEUE_SIZE] = job;
+	queue->count++;
+	held.unlock ();
+	queue->work.notify_one ();
+}
+
+/*____________________________________________________________________
+|
+| Function: Job_Wait
+|
+| Input: Called from any thread
+| Output: Runs queued jobs (any, not just the ones on counter) until
+|   every job on counter has finished, then sleeps until the rest
+|   running on other threads do.
+|___________________________________________________________________*/
+
+void Job_Wait (JobSystem *system, JobCounter *counter)
+{
+	JobQueue *queue = system->queue;
+	std::unique_lock<std::mutex> held (queue->lock);
+
+	while (counter->pending > 0) {
+		if (queue->count > 0) {
+			Job job = queue->jobs[queue->head];
+			queue->head = (queue->head + 1) % JOB_QUEUE_SIZE;
+			queue->count--;
+			Run_Job (queue, &job, held);
+		}
+		else
+			queue->done.wait (held);
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Run_Job
+|
+| Input: Called from Job_Free(), Job_Submit(), Job_Wait(), Worker_Run()
+|   with the queue locked
+| Output: Runs the job with the queue unlocked, then counts it down and
+|   wakes up the waiting threads.  Returns with the queue locked.
+|___________________________________________________________________*/
+
+static void Run_Job (JobQueue *queue, Job *job, std::unique_lock<std::mutex> &held)
+{
+	held.unlock ();
+	job->func (job->data);
+	held.lock ();
+	job->counter->pending--;
+	queue->done.notify_all ();
+}
+
+/*____________________________________________________________________
+|
+| Function: Worker_Run
+|
+| Input: Called from Job_Init() (as a thread)
+| Output: Runs jobs until the system is stopped.
+|___________________________________________________________________*/
+
+static void Worker_Run (JobQueue *queue)
+{
+	Profile_Set_Thread_Name ("job worker");
+
+	std::unique_lock<std::mutex> held (queue->lock);
+	for (;;) {
+		while (queue->count == 0 && !queue->stop)
+			queue->work.wait (held);
+		if (queue->count == 0)
+			break;
+		Job job = queue->jobs[queue->head];
+		queue->head = (queue->head + 1) % JOB_QUEUE_SIZE;
+		queue->count--;
+		Run_Job (queue, &job, held);
+	}
+}
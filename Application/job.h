@@ -0,0 +1,64 @@
+/*____________________________________________________________________
+|
+| File: job.h
+|
+| Description: A small job system.  Worker threads take jobs (a function
+|   and its data) off one queue in the order they were submitted.  Each
+|   job counts down a counter when it finishes, and a thread waiting on
+|   a counter runs queued jobs itself meanwhile, so jobs may submit and
+|   wait for jobs of their own without tying up a worker.
+|
+|     JobCounter done = { 0 };
+|     Job_Submit (&jobs, Cull_Trees, &trees, &done);
+|     Job_Submit (&jobs, Cull_Flowers, &flowers, &done);
+|     ...                                 // other work on this thread
+|     Job_Wait (&jobs, &done);
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _JOB_H_
+#define _JOB_H_
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define JOB_MAX_THREADS  16
+#define JOB_QUEUE_SIZE   256       // a job submitted to a full queue runs right away
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef void (*JobFunc) (void *data);
+
+typedef struct {
+	int pending;                   // jobs submitted and not finished (only changed by the job system)
+} JobCounter;
+
+typedef struct {
+	struct JobQueue *queue;
+	int              num_threads;  // workers, 0 if jobs run in Job_Wait()
+} JobSystem;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+// Starts threads workers (-1 for one less than the # of cores, 0 for
+//   none).  Returns true on success, else false.
+bool Job_Init (JobSystem *system, int threads);
+// Waits for the queued jobs, then stops the workers
+void Job_Free (JobSystem *system);
+
+// Queues func(data), counter is counted down when it has run
+void Job_Submit (JobSystem *system, JobFunc func, void *data, JobCounter *counter);
+// Returns once every job counted by counter has run
+void Job_Wait (JobSystem *system, JobCounter *counter);
+
+#endif
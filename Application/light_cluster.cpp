@@ -0,0 +1,393 @@
+/*____________________________________________________________________
+|
+| File: light_cluster.cpp
+|
+| Description: Clustered light lists and shading.
+|
+| Functions: LightClusters_Init
+|            LightClusters_Free
+|            LightClusters_Build
+|             Grow_Lights
+|             Grow_Index
+|             Slice
+|            LightClusters_Visible
+|            LightClusters_Find
+|            LightClusters_Lights
+|            LightClusters_Shade_Light
+|            LightClusters_Shade
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "light_cluster.h"
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static bool Grow_Lights (LightClusters *clusters, int count);
+static bool Grow_Index (LightClusters *clusters, int entries);
+static inline int Slice (const LightClusters *clusters, float z);
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define DEGREES_TO_RADIANS(_deg_) ((_deg_) * 3.14159265f / 180)
+
+/*____________________________________________________________________
+|
+| Function: LightClusters_Init
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Sets up empty clusters for a perspective view.  Returns true
+|   on success, else false.
+|___________________________________________________________________*/
+
+bool LightClusters_Init (LightClusters *clusters, float fov, float aspect, float near_plane, float far_plane)
+{
+	memset (clusters, 0, sizeof(LightClusters));
+	if (near_plane <= 0 || far_plane <= near_plane)
+		return (false);
+	clusters->tan_y = tanf (DEGREES_TO_RADIANS (fov) / 2);
+	clusters->tan_x = clusters->tan_y * aspect;
+	clusters->near_plane = near_plane;
+	clusters->far_plane = far_plane;
+	clusters->slice_scale = LIGHT_CLUSTER_Z / logf (far_plane / near_plane);
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: LightClusters_Free
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Frees the clusters' memory.
+|___________________________________________________________________*/
+
+void LightClusters_Free (LightClusters *clusters)
+{
+	free (clusters->x);
+	free (clusters->y);
+	free (clusters->z);
+	free (clusters->radius);
+	free (clusters->bounds);
+	free (clusters->visible);
+	free (clusters->index);
+	memset (clusters, 0, sizeof(LightClusters));
+}
+
+/*____________________________________________________________________
+|
+| Function: LightClusters_Build
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Puts the lights in view space, works out the clusters each
+|   one's range reaches (from the box around it, so some lists get a
+|   light that just misses), then counts the lights of each cluster,
+|   turns the counts into where each list ends and fills the lists back
+|   to front, leaving each cluster's offset at the start of its list and
+|   its lights in index order.  Returns false if out of memory.
+|___________________________________________________________________*/
+
+bool LightClusters_Build (LightClusters *clusters, const float *view, const LightDesc *lights, int count)
+{
+	const float *m = view;
+	int *offset = clusters->offset;
+
+	memcpy (clusters->view, view, 16 * sizeof(float));
+	memset (offset, 0, sizeof(clusters->offset));
+	memset (&clusters->stats, 0, sizeof(LightClusterStats));
+	clusters->num_visible = 0;
+	if (count > clusters->capacity && !Grow_Lights (clusters, count))
+		return (false);
+	clusters->stats.lights = count;
+
+	// Centers in view space
+	float *x = clusters->x, *y = clusters->y, *z = clusters->z, *radius = clusters->radius;
+	for (int i = 0; i < count; i++) {
+		const float *p = lights[i].position;
+		x[i] = p[0] * m[0] + p[1] * m[4] + p[2] * m[8] + m[12];
+		y[i] = p[0] * m[1] + p[1] * m[5] + p[2] * m[9] + m[13];
+		z[i] = p[0] * m[2] + p[1] * m[6] + p[2] * m[10] + m[14];
+		radius[i] = lights[i].range;
+	}
+
+	// Tiles and slices of each light's box.  Across the screen, x / z over the
+	//   box is least at its left side, nearest depth if that's left of the eye
+	//   (farthest if not), and most at its right side the same way, likewise up.
+	//   Selects rather than branches, NaNs from a box behind the eye are clamped
+	//   away and the light is marked empty (first tile past the last).
+	const float near_plane = clusters->near_plane, far_plane = clusters->far_plane;
+	const float tan_x = clusters->tan_x, tan_y = clusters->tan_y;
+	int *bounds = clusters->bounds;
+	for (int i = 0; i < count; i++) {
+		float r = radius[i];
+		float zmin = fmaxf (z[i] - r, near_plane);
+		float zmax = fminf (z[i] + r, far_plane);
+		float x0 = x[i] - r, x1 = x[i] + r, y0 = y[i] - r, y1 = y[i] + r;
+		float left   = x0 / (x0 < 0 ? zmin : zmax) / tan_x;
+		float right  = x1 / (x1 < 0 ? zmax : zmin) / tan_x;
+		float bottom = y0 / (y0 < 0 ? zmin : zmax) / tan_y;
+		float top    = y1 / (y1 < 0 ? zmax : zmin) / tan_y;
+		bool empty = r <= 0 || zmin > zmax || right < -1 || left > 1 || top < -1 || bottom > 1;
+		int *b = &bounds[i * 6];
+		b[0] = (int) fminf (fmaxf ((left + 1) * (0.5f * LIGHT_CLUSTER_X), 0), LIGHT_CLUSTER_X - 1);
+		b[1] = empty ? -1 : (int) fminf (fmaxf ((right + 1) * (0.5f * LIGHT_CLUSTER_X), 0), LIGHT_CLUSTER_X - 1);
+		b[2] = (int) fminf (fmaxf ((bottom + 1) * (0.5f * LIGHT_CLUSTER_Y), 0), LIGHT_CLUSTER_Y - 1);
+		b[3] = (int) fminf (fmaxf ((top + 1) * (0.5f * LIGHT_CLUSTER_Y), 0), LIGHT_CLUSTER_Y - 1);
+		b[4] = Slice (clusters, zmin);
+		b[5] = Slice (clusters, zmax);
+	}
+
+	// Count each cluster's lights
+	int *visible = clusters->visible, num_visible = 0;
+	for (int i = 0; i < count; i++) {
+		const int *b = &bounds[i * 6];
+		if (b[0] > b[1])
+			continue;
+		visible[num_visible++] = i;
+		for (int s = b[4]; s <= b[5]; s++)
+			for (int ty = b[2]; ty <= b[3]; ty++) {
+				int *row = &offset[(s * LIGHT_CLUSTER_Y + ty) * LIGHT_CLUSTER_X];
+				for (int tx = b[0]; tx <= b[1]; tx++)
+					row[tx]++;
+			}
+	}
+	clusters->num_visible = num_visible;
+
+	// Counts to where each list ends
+	int entries = 0, max_per_cluster = 0;
+	for (int c = 0; c < LIGHT_CLUSTERS; c++) {
+		if (offset[c] > max_per_cluster)
+			max_per_cluster = offset[c];
+		entries += offset[c];
+		offset[c] = entries;
+	}
+	offset[LIGHT_CLUSTERS] = entries;
+	if (entries > clusters->index_capacity && !Grow_Index (clusters, entries)) {
+		memset (offset, 0, sizeof(clusters->offset));
+		clusters->num_visible = 0;
+		return (false);
+	}
+
+	// Fill the lists back to front, so each ends up in light order
+	int *index = clusters->index;
+	for (int v = num_visible - 1; v >= 0; v--) {
+		int i = visible[v];
+		const int *b = &bounds[i * 6];
+		for (int s = b[4]; s <= b[5]; s++)
+			for (int ty = b[2]; ty <= b[3]; ty++) {
+				int *row = &offset[(s * LIGHT_CLUSTER_Y + ty) * LIGHT_CLUSTER_X];
+				for (int tx = b[0]; tx <= b[1]; tx++)
+					index[--row[tx]] = i;
+			}
+	}
+
+	clusters->stats.visible = num_visible;
+	clusters->stats.entries = entries;
+	clusters->stats.max_per_cluster = max_per_cluster;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Grow_Lights
+|
+| Input: Called from LightClusters_Build()
+| Output: Makes room for at least count lights' scratch.  Returns true
+|   on success, else false (the arrays that grew are kept).
+|___________________________________________________________________*/
+
+static bool Grow_Lights (LightClusters *clusters, int count)
+{
+	int capacity = clusters->capacity * 2;
+	if (capacity < count)
+		capacity = count;
+
+	float *x = (float *) realloc (clusters->x, capacity * sizeof(float));
+	if (x)
+		clusters->x = x;
+	float *y = (float *) realloc (clusters->y, capacity * sizeof(float));
+	if (y)
+		clusters->y = y;
+	float *z = (float *) realloc (clusters->z, capacity * sizeof(float));
+	if (z)
+		clusters->z = z;
+	float *radius = (float *) realloc (clusters->radius, capacity * sizeof(float));
+	if (radius)
+		clusters->radius = radius;
+	int *bounds = (int *) realloc (clusters->bounds, capacity * 6 * sizeof(int));
+	if (bounds)
+		clusters->bounds = bounds;
+	int *visible = (int *) realloc (clusters->visible, capacity * sizeof(int));
+	if (visible)
+		clusters->visible = visible;
+	if (x == NULL || y == NULL || z == NULL || radius == NULL || bounds == NULL || visible == NULL)
+		return (false);
+	clusters->capacity = capacity;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Grow_Index
+|
+| Input: Called from LightClusters_Build()
+| Output: Makes room for at least entries list entries.  Returns true
+|   on success, else false.
+|___________________________________________________________________*/
+
+static bool Grow_Index (LightClusters *clusters, int entries)
+{
+	int capacity = clusters->index_capacity * 2;
+	if (capacity < entries)
+		capacity = entries;
+
+	int *index = (int *) realloc (clusters->index, capacity * sizeof(int));
+	if (index == NULL)
+		return (false);
+	clusters->index = index;
+	clusters->index_capacity = capacity;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Slice
+|
+| Input: Called from LightClusters_Build(), LightClusters_Find()
+| Output: Returns the depth slice of a view space depth.  Slices grow
+|   with distance, each the same ratio of far to near.
+|___________________________________________________________________*/
+
+static inline int Slice (const LightClusters *clusters, float z)
+{
+	float s = logf (z / clusters->near_plane) * clusters->slice_scale;
+
+	return ((int) fminf (fmaxf (s, 0), LIGHT_CLUSTER_Z - 1));
+}
+
+/*____________________________________________________________________
+|
+| Function: LightClusters_Visible
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Returns the lights of the last build that reach any cluster.
+|___________________________________________________________________*/
+
+const int *LightClusters_Visible (const LightClusters *clusters, int *count)
+{
+	*count = clusters->num_visible;
+
+	return (clusters->visible);
+}
+
+/*____________________________________________________________________
+|
+| Function: LightClusters_Find
+|
+| Input: Called from LightClusters_Shade(), headless driver
+| Output: Returns the cluster a world position is in, by the view of the
+|   last build, or -1 if it's out of view.
+|___________________________________________________________________*/
+
+int LightClusters_Find (const LightClusters *clusters, const float *position)
+{
+	const float *m = clusters->view, *p = position;
+
+	float x = p[0] * m[0] + p[1] * m[4] + p[2] * m[8] + m[12];
+	float y = p[0] * m[1] + p[1] * m[5] + p[2] * m[9] + m[13];
+	float z = p[0] * m[2] + p[1] * m[6] + p[2] * m[10] + m[14];
+	if (z < clusters->near_plane || z > clusters->far_plane)
+		return (-1);
+	float ndc_x = x / z / clusters->tan_x;
+	float ndc_y = y / z / clusters->tan_y;
+	if (ndc_x < -1 || ndc_x > 1 || ndc_y < -1 || ndc_y > 1)
+		return (-1);
+	int tx = (int) fminf ((ndc_x + 1) * (0.5f * LIGHT_CLUSTER_X), LIGHT_CLUSTER_X - 1);
+	int ty = (int) fminf ((ndc_y + 1) * (0.5f * LIGHT_CLUSTER_Y), LIGHT_CLUSTER_Y - 1);
+
+	return ((Slice (clusters, z) * LIGHT_CLUSTER_Y + ty) * LIGHT_CLUSTER_X + tx);
+}
+
+/*____________________________________________________________________
+|
+| Function: LightClusters_Lights
+|
+| Input: Called from LightClusters_Shade(), headless driver
+| Output: Returns a cluster's lights.
+|___________________________________________________________________*/
+
+const int *LightClusters_Lights (const LightClusters *clusters, int cluster, int *count)
+{
+	*count = clusters->offset[cluster + 1] - clusters->offset[cluster];
+
+	return (&clusters->index[clusters->offset[cluster]]);
+}
+
+/*____________________________________________________________________
+|
+| Function: LightClusters_Shade_Light
+|
+| Input: Called from LightClusters_Shade(), headless driver
+| Output: Adds the diffuse light a point light gives a position to rgb:
+|   its color by how squarely it faces the normal, falling off like a
+|   light manager score (linear attenuation, faded out to its range).
+|___________________________________________________________________*/
+
+void LightClusters_Shade_Light (const LightDesc *light, const float *position, const float *normal, float *rgb)
+{
+	float dx = light->position[0] - position[0];
+	float dy = light->position[1] - position[1];
+	float dz = light->position[2] - position[2];
+	float d = sqrtf (dx * dx + dy * dy + dz * dz);
+
+	if (d >= light->range)
+		return;
+	float facing = d > 0 ? (normal[0] * dx + normal[1] * dy + normal[2] * dz) / d : 1;
+	if (facing <= 0)
+		return;
+	float a = facing * (1 - d / light->range) / (1 + light->attenuation * d);
+	rgb[0] += light->color[0] * a;
+	rgb[1] += light->color[1] * a;
+	rgb[2] += light->color[2] * a;
+}
+
+/*____________________________________________________________________
+|
+| Function: LightClusters_Shade
+|
+| Input: Called from headless driver
+| Output: Sets rgb to the light a position with a normal gets from the
+|   lights of its cluster (black if out of view).
+|___________________________________________________________________*/
+
+void LightClusters_Shade (const LightClusters *clusters, const LightDesc *lights, const float *position, const float *normal, float *rgb)
+{
+	rgb[0] = rgb[1] = rgb[2] = 0;
+
+	int cluster = LightClusters_Find (clusters, position);
+	if (cluster == -1)
+		return;
+	int n;
+	const int *list = LightClusters_Lights (clusters, cluster, &n);
+	for (int j = 0; j < n; j++)
+		LightClusters_Shade_Light (&lights[list[j]], position, normal, rgb);
+}
@@ -0,0 +1,94 @@
+/*____________________________________________________________________
+|
+| File: light_cluster.h
+|
+| Description: Clustered lighting for many point lights.  The view
+|   frustum is cut into a grid of froxels (tiles across the screen,
+|   slices in depth, thinner near the eye) and each froxel gets the list
+|   of lights whose range reaches it, so shading a point only looks at
+|   the few lights of its froxel instead of every light in the scene.
+|
+|   The lists are built on the CPU each frame in passes over the lights
+|   kept as arrays of floats (view space centers and ranges, then the
+|   froxel bounds of each) so the compiler can vectorize them, then a
+|   count, offset and fill pass packs every list into one index array.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _LIGHT_CLUSTER_H_
+#define _LIGHT_CLUSTER_H_
+
+#include "light_manager.h"
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define LIGHT_CLUSTER_X      16       // tiles across
+#define LIGHT_CLUSTER_Y      8        // tiles down
+#define LIGHT_CLUSTER_Z      24       // depth slices
+#define LIGHT_CLUSTERS       (LIGHT_CLUSTER_X * LIGHT_CLUSTER_Y * LIGHT_CLUSTER_Z)
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	int lights;                    // given to the last build
+	int visible;                   // reaching at least one cluster
+	int entries;                   // in every cluster's list
+	int max_per_cluster;
+} LightClusterStats;
+
+typedef struct {
+	float   tan_x, tan_y;          // half the view's width and height at a distance of 1
+	float   near_plane, far_plane;
+	float   slice_scale;           // depth slices per log unit of distance
+	float   view[16];              // of the last build
+	// Per light scratch, as arrays so the build loops vectorize
+	float  *x, *y, *z, *radius;    // view space
+	int    *bounds;                // first and last tile x, tile y, slice (6 per light)
+	int    *visible;               // lights reaching the view
+	int     num_visible;
+	int     capacity;
+	int     offset[LIGHT_CLUSTERS + 1];   // each cluster's list starts at index[offset[c]]
+	int    *index;
+	int     index_capacity;
+	LightClusterStats stats;       // last build
+} LightClusters;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+// Sets up clusters for a perspective view (vertical fov in degrees,
+//   aspect = width / height).  Returns true on success, else false.
+bool LightClusters_Init (LightClusters *clusters, float fov, float aspect, float near_plane, float far_plane);
+void LightClusters_Free (LightClusters *clusters);
+
+// Builds every cluster's light list for a view matrix (row vectors,
+//   like CameraController_View_Matrix()).  Returns false if out of
+//   memory (clusters are left empty).
+bool LightClusters_Build (LightClusters *clusters, const float *view, const LightDesc *lights, int count);
+
+// Lights reaching any cluster of the last build (# returned in *count)
+const int *LightClusters_Visible (const LightClusters *clusters, int *count);
+
+// Returns the cluster a world position is in, or -1 if out of view
+int  LightClusters_Find (const LightClusters *clusters, const float *position);
+// Returns a cluster's lights (# returned in *count)
+const int *LightClusters_Lights (const LightClusters *clusters, int cluster, int *count);
+
+// Adds the diffuse light a point light gives a position with a normal
+//   to rgb (the light manager's falloff, nothing past its range)
+void LightClusters_Shade_Light (const LightDesc *light, const float *position, const float *normal, float *rgb);
+// Sets rgb to the light the lights of a position's cluster give it, the
+//   shading path a shader backend would run per pixel
+void LightClusters_Shade (const LightClusters *clusters, const LightDesc *lights, const float *position, const float *normal, float *rgb);
+
+#endif
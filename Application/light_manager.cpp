@@ -0,0 +1,315 @@
+/*____________________________________________________________________
+|
+| File: light_manager.cpp
+|
+| Description: Light selection and dirty tracking.
+|
+| Functions: LightManager_Init
+|            LightManager_Free
+|            LightManager_Add
+|             Grow
+|            LightManager_Move
+|            LightManager_Set
+|            LightManager_Rank
+|             Score
+|            LightManager_Assign
+|            LightManager_Flush
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+
+#include "light_manager.h"
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static bool Grow (LightManager *manager);
+static inline float Score (const LightManager *manager, int light, const float *center, float radius);
+
+/*____________________________________________________________________
+|
+| Function: LightManager_Init
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Sets up a manager with no lights and every slot dark (sent on
+|   the first flush).  Returns true on success, else false.
+|___________________________________________________________________*/
+
+bool LightManager_Init (LightManager *manager, int capacity, int num_slots)
+{
+	memset (manager, 0, sizeof(LightManager));
+	if (capacity < 1)
+		capacity = 1;
+	if (num_slots > LIGHT_MAX_SLOTS)
+		num_slots = LIGHT_MAX_SLOTS;
+	manager->lights = (LightDesc *) malloc (capacity * sizeof(LightDesc));
+	manager->pinned = (bool *) malloc (capacity * sizeof(bool));
+	manager->dirty = (bool *) malloc (capacity * sizeof(bool));
+	manager->score = (float *) malloc (capacity * sizeof(float));
+	if (manager->lights == NULL || manager->pinned == NULL || manager->dirty == NULL || manager->score == NULL) {
+		LightManager_Free (manager);
+		return (false);
+	}
+	manager->capacity = capacity;
+	manager->num_slots = num_slots;
+	for (int s = 0; s < LIGHT_MAX_SLOTS; s++) {
+		manager->slot_light[s] = -1;
+		manager->slot_dirty[s] = true;
+	}
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: LightManager_Free
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Frees the manager's memory.
+|___________________________________________________________________*/
+
+void LightManager_Free (LightManager *manager)
+{
+	free (manager->lights);
+	free (manager->pinned);
+	free (manager->dirty);
+	free (manager->score);
+	memset (manager, 0, sizeof(LightManager));
+}
+
+/*____________________________________________________________________
+|
+| Function: LightManager_Add
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Adds a light.  Returns its index, or -1 if out of memory.
+|___________________________________________________________________*/
+
+int LightManager_Add (LightManager *manager, const LightDesc *light, bool pinned)
+{
+	if (manager->count == manager->capacity && !Grow (manager))
+		return (-1);
+
+	int i = manager->count++;
+	manager->lights[i] = *light;
+	manager->pinned[i] = pinned;
+	manager->dirty[i] = true;
+
+	return (i);
+}
+
+/*____________________________________________________________________
+|
+| Function: Grow
+|
+| Input: Called from LightManager_Add()
+| Output: Doubles the room for lights.  Returns true on success, else
+|   false (the arrays that grew are kept).
+|___________________________________________________________________*/
+
+static bool Grow (LightManager *manager)
+{
+	int capacity = manager->capacity * 2;
+
+	LightDesc *lights = (LightDesc *) realloc (manager->lights, capacity * sizeof(LightDesc));
+	if (lights)
+		manager->lights = lights;
+	bool *pinned = (bool *) realloc (manager->pinned, capacity * sizeof(bool));
+	if (pinned)
+		manager->pinned = pinned;
+	bool *dirty = (bool *) realloc (manager->dirty, capacity * sizeof(bool));
+	if (dirty)
+		manager->dirty = dirty;
+	float *score = (float *) realloc (manager->score, capacity * sizeof(float));
+	if (score)
+		manager->score = score;
+	if (lights == NULL || pinned == NULL || dirty == NULL || score == NULL)
+		return (false);
+	manager->capacity = capacity;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: LightManager_Move
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Moves a light, marking it to be sent if it moved.
+|___________________________________________________________________*/
+
+void LightManager_Move (LightManager *manager, int light, const float *position)
+{
+	float *p = manager->lights[light].position;
+
+	if (p[0] != position[0] || p[1] != position[1] || p[2] != position[2]) {
+		memcpy (p, position, 3 * sizeof(float));
+		manager->dirty[light] = true;
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: LightManager_Set
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Changes a light, marking it to be sent if anything changed.
+|___________________________________________________________________*/
+
+void LightManager_Set (LightManager *manager, int light, const LightDesc *desc)
+{
+	if (memcmp (&manager->lights[light], desc, sizeof(LightDesc))) {
+		manager->lights[light] = *desc;
+		manager->dirty[light] = true;
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: LightManager_Rank
+|
+| Input: Called from LightManager_Assign(), headless driver
+| Output: Scores every candidate at the sphere and keeps the k best in
+|   list, best first, by insertion (k is a handful of slots).  Lights
+|   that don't reach the sphere aren't listed.  Returns # listed.
+|___________________________________________________________________*/
+
+int LightManager_Rank (LightManager *manager, const int *candidates, int num_candidates, const float *center, float radius, int k, int *list)
+{
+	float *score = manager->score;
+	int n = 0;
+
+	if (candidates == NULL)
+		num_candidates = manager->count;
+	for (int c = 0; c < num_candidates; c++) {
+		int i = candidates ? candidates[c] : c;
+		score[i] = Score (manager, i, center, radius);
+		if (score[i] <= 0 || (n == k && score[i] <= score[list[n - 1]]))
+			continue;
+		int j = n < k ? n++ : n - 1;
+		// Ties keep the lower index first
+		while (j > 0 && score[list[j - 1]] < score[i]) {
+			list[j] = list[j - 1];
+			j--;
+		}
+		list[j] = i;
+	}
+
+	return (n);
+}
+
+/*____________________________________________________________________
+|
+| Function: Score
+|
+| Input: Called from LightManager_Rank()
+| Output: Returns how bright a light is at the near side of a sphere,
+|   0 if out of range, FLT_MAX if pinned.
+|___________________________________________________________________*/
+
+static inline float Score (const LightManager *manager, int light, const float *center, float radius)
+{
+	const LightDesc *l = &manager->lights[light];
+
+	if (manager->pinned[light])
+		return (FLT_MAX);
+	float dx = l->position[0] - center[0], dy = l->position[1] - center[1], dz = l->position[2] - center[2];
+	float d = sqrtf (dx * dx + dy * dy + dz * dz) - radius;
+	if (d < 0)
+		d = 0;
+	if (d >= l->range)
+		return (0);
+	float brightness = l->color[0] > l->color[1] ? l->color[0] : l->color[1];
+	if (l->color[2] > brightness)
+		brightness = l->color[2];
+
+	return (brightness * (1 - d / l->range) / (1 + l->attenuation * d));
+}
+
+/*____________________________________________________________________
+|
+| Function: LightManager_Assign
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Ranks the candidates at the sphere, keeps the ones already in a
+|   slot there, and puts the rest in the slots freed up, marking every
+|   slot whose light changed.
+|___________________________________________________________________*/
+
+void LightManager_Assign (LightManager *manager, const int *candidates, int num_candidates, const float *center, float radius)
+{
+	int list[LIGHT_MAX_SLOTS];
+	bool placed[LIGHT_MAX_SLOTS] = { false };
+	int slot_light[LIGHT_MAX_SLOTS];
+	int n = LightManager_Rank (manager, candidates, num_candidates, center, radius, manager->num_slots, list);
+
+	// Lights that stay keep their slot
+	for (int s = 0; s < manager->num_slots; s++) {
+		slot_light[s] = -1;
+		for (int j = 0; j < n; j++)
+			if (!placed[j] && list[j] == manager->slot_light[s]) {
+				slot_light[s] = list[j];
+				placed[j] = true;
+				break;
+			}
+	}
+	// The rest fill the slots left, in rank order
+	int s = 0;
+	for (int j = 0; j < n; j++) {
+		if (placed[j])
+			continue;
+		while (slot_light[s] != -1)
+			s++;
+		slot_light[s] = list[j];
+	}
+
+	manager->stats.selected = n;
+	manager->stats.reassigned = 0;
+	for (s = 0; s < manager->num_slots; s++)
+		if (slot_light[s] != manager->slot_light[s]) {
+			manager->slot_light[s] = slot_light[s];
+			manager->slot_dirty[s] = true;
+			manager->stats.reassigned++;
+		}
+}
+
+/*____________________________________________________________________
+|
+| Function: LightManager_Flush
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Sends every slot that got a new light, or whose light changed,
+|   to backend.  Returns # of slots sent.
+|___________________________________________________________________*/
+
+int LightManager_Flush (LightManager *manager, const LightBackend *backend)
+{
+	int pushes = 0;
+
+	for (int s = 0; s < manager->num_slots; s++) {
+		int light = manager->slot_light[s];
+		if (manager->slot_dirty[s] || (light != -1 && manager->dirty[light])) {
+			backend->set_light (backend->context, s, light != -1 ? &manager->lights[light] : NULL);
+			manager->slot_dirty[s] = false;
+			if (light != -1)
+				manager->dirty[light] = false;
+			pushes++;
+		}
+	}
+	manager->stats.pushes = pushes;
+
+	return (pushes);
+}
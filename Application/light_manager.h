@@ -0,0 +1,99 @@
+/*____________________________________________________________________
+|
+| File: light_manager.h
+|
+| Description: Point lights, any number of them, shown through the few
+|   light slots the graphics driver has.  Each frame the lights most
+|   relevant to a point of interest (the player) get the slots, a light
+|   keeping the slot it had, and only slots whose light changed, or
+|   whose light moved or was changed, are sent to the driver.  Slots
+|   are enabled once and never switched off, an empty slot is sent a
+|   dark light instead.
+|
+|   Drivers are a function table like the render queue's, so the
+|   headless driver can count what would be sent.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _LIGHT_MANAGER_H_
+#define _LIGHT_MANAGER_H_
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define LIGHT_MAX_SLOTS  8         // most lights the driver is given at once
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	float position[3];
+	float color[3];                // diffuse and specular
+	float range;                   // lights nothing past this
+	float attenuation;             // linear, per unit of distance
+} LightDesc;
+
+typedef struct {
+	// Sets a slot's light, NULL for a dark one
+	void (*set_light) (void *context, int slot, const LightDesc *light);
+	void  *context;
+} LightBackend;
+
+typedef struct {
+	int selected;                  // lights given a slot
+	int reassigned;                // slots that changed light
+	int pushes;                    // set_light() calls
+} LightStats;
+
+typedef struct {
+	LightDesc    *lights;
+	bool         *pinned;          // always given a slot (the player's light)
+	bool         *dirty;           // changed since last sent
+	float        *score;           // scratch for ranking
+	int           count;
+	int           capacity;
+	int           num_slots;
+	int           slot_light[LIGHT_MAX_SLOTS];   // light in each slot, -1 if dark
+	bool          slot_dirty[LIGHT_MAX_SLOTS];   // has to be sent
+	LightStats    stats;           // last assign and flush
+} LightManager;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+// Sets up room for capacity lights (grows as needed) shown through
+//   num_slots driver slots (up to LIGHT_MAX_SLOTS).  Returns true on
+//   success, else false.
+bool LightManager_Init (LightManager *manager, int capacity, int num_slots);
+void LightManager_Free (LightManager *manager);
+
+// Adds a light.  Returns its index, or -1 if out of memory.
+int  LightManager_Add (LightManager *manager, const LightDesc *light, bool pinned);
+// Change a light, it's only sent again if something changed
+void LightManager_Move (LightManager *manager, int light, const float *position);
+void LightManager_Set (LightManager *manager, int light, const LightDesc *desc);
+
+// Lists up to k of the candidate lights (NULL for every light) that
+//   light a sphere, most relevant first (pinned lights, then by how
+//   bright they are at the sphere).  Returns # listed.
+int  LightManager_Rank (LightManager *manager, const int *candidates, int num_candidates, const float *center, float radius, int k, int *list);
+
+// Gives the slots to the candidate lights (NULL for every light) most
+//   relevant to a sphere (usually the player), for instance the lights
+//   LightClusters_Visible() found reaching the view (a pinned light has
+//   to be a candidate too).  A light keeps its slot while it's still
+//   relevant.
+void LightManager_Assign (LightManager *manager, const int *candidates, int num_candidates, const float *center, float radius);
+
+// Sends the slots that changed to backend.  Returns # of slots sent.
+int  LightManager_Flush (LightManager *manager, const LightBackend *backend);
+
+#endif
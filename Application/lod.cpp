@@ -0,0 +1,185 @@
+/*____________________________________________________________________
+|
+| File: lod.cpp
+|
+| Description: Level of detail selection for scenery.
+|
+| Functions: Lod_Init
+|            Lod_Free
+|            Lod_Pixel_Scale
+|            Lod_Select
+|             Level_For
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "lod.h"
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static inline int Level_For (const LodModel *model, float cull_pixels, float size, float margin);
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define DEGREES_TO_RADIANS(_deg_) ((_deg_) * 3.14159265f / 180)
+
+/*____________________________________________________________________
+|
+| Function: Lod_Init
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Sets up LOD for count props of model, every prop unseen.
+|   Returns true on success, else false.
+|___________________________________________________________________*/
+
+bool Lod_Init (LodGroup *group, const LodModel *model, int count, float hysteresis)
+{
+	memset (group, 0, sizeof(LodGroup));
+	if (count < 1)
+		count = 1;
+	group->level = (unsigned char *) malloc (count);
+	group->size = (float *) malloc (count * sizeof(float));
+	group->lists = (int *) malloc (count * LOD_MAX_LEVELS * sizeof(int));
+	if (group->level == NULL || group->size == NULL || group->lists == NULL) {
+		Lod_Free (group);
+		return (false);
+	}
+	memset (group->level, LOD_UNSET, count);
+	for (int l = 0; l < LOD_MAX_LEVELS; l++)
+		group->list[l] = group->lists + l * count;
+	group->model = model;
+	group->capacity = count;
+	group->hysteresis = hysteresis;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Lod_Free
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Frees the group's memory.
+|___________________________________________________________________*/
+
+void Lod_Free (LodGroup *group)
+{
+	free (group->level);
+	free (group->size);
+	free (group->lists);
+	memset (group, 0, sizeof(LodGroup));
+}
+
+/*____________________________________________________________________
+|
+| Function: Lod_Pixel_Scale
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Returns the pixel height of something 1 unit high, 1 unit in
+|   front of a camera with a vertical field of view of fov degrees.
+|___________________________________________________________________*/
+
+float Lod_Pixel_Scale (float fov, int screen_height)
+{
+	return (screen_height / (2 * tanf (DEGREES_TO_RADIANS (fov) / 2)));
+}
+
+/*____________________________________________________________________
+|
+| Function: Lod_Select
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Works out the projected height of every visible prop in one
+|   pass, then in a second pass moves each prop's level only as far as
+|   it has to, to be within the hysteresis margin of its size, and
+|   adds it to that level's list.  The cull distance is treated as one
+|   more size (the prop's height at that distance), so culling gets the
+|   same margin.
+|___________________________________________________________________*/
+
+void Lod_Select (
+	LodGroup    *group,
+	const int   *visible,
+	int          num_visible,
+	const float *xs,
+	const float *zs,
+	const float *eye,
+	float        pixel_scale )
+{
+	const LodModel *model = group->model;
+	float height = 2 * model->radius * pixel_scale;
+	float cull_pixels = model->cull_distance > 0 ? height / model->cull_distance : 0;
+	float min_d2 = model->radius * model->radius;
+	float dy = model->center_y - eye[1];
+	float *size = group->size;
+	int culled = model->num_levels;
+
+	if (num_visible > group->capacity)
+		num_visible = group->capacity;
+
+	// Projected heights
+	for (int v = 0; v < num_visible; v++) {
+		int i = visible[v];
+		float dx = xs[i] - eye[0], dz = zs[i] - eye[2];
+		float d2 = dx * dx + dy * dy + dz * dz;
+		size[v] = height / sqrtf (d2 > min_d2 ? d2 : min_d2);
+	}
+
+	memset (&group->stats, 0, sizeof(LodStats));
+	for (int v = 0; v < num_visible; v++) {
+		int i = visible[v];
+		int level = group->level[i];
+		// Finest and coarsest levels the prop's size allows, given the margin
+		int finest = Level_For (model, cull_pixels, size[v], 1 - group->hysteresis);
+		int coarsest = Level_For (model, cull_pixels, size[v], 1 + group->hysteresis);
+		if (level == LOD_UNSET)
+			level = Level_For (model, cull_pixels, size[v], 1);
+		else if (level < finest || level > coarsest) {
+			level = level < finest ? finest : coarsest;
+			group->stats.switches++;
+		}
+		group->level[i] = (unsigned char) level;
+		if (level == culled)
+			group->stats.culled++;
+		else
+			group->list[level][group->stats.count[level]++] = i;
+	}
+	for (int l = 0; l < model->num_levels; l++)
+		group->stats.triangles += (long long) group->stats.count[l] * model->triangles[l];
+}
+
+/*____________________________________________________________________
+|
+| Function: Level_For
+|
+| Input: Called from Lod_Select()
+| Output: Returns the level for a prop size pixels high, with every
+|   switch point scaled by margin, or num_levels if it's culled.
+|___________________________________________________________________*/
+
+static inline int Level_For (const LodModel *model, float cull_pixels, float size, float margin)
+{
+	if (size < cull_pixels * margin)
+		return (model->num_levels);
+	for (int l = 0; l < model->num_levels; l++)
+		if (size >= model->min_pixels[l] * margin)
+			return (l);
+
+	return (model->num_levels);
+}
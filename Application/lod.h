@@ -0,0 +1,85 @@
+/*____________________________________________________________________
+|
+| File: lod.h
+|
+| Description: Level of detail for scenery.  Each frame the culled list
+|   of a kind of prop is sorted into one list per level by the prop's
+|   projected height on screen: the full mesh up close, then simpler
+|   meshes, last an impostor billboard, and props too small or too far
+|   away are dropped.  A prop only changes level once its size is a
+|   margin past the switch point (hysteresis), so props standing near a
+|   switch point don't flicker between levels as the camera moves.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _LOD_H_
+#define _LOD_H_
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define LOD_MAX_LEVELS  4
+#define LOD_UNSET       255        // level of a prop not seen yet
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	int   num_levels;
+	float min_pixels[LOD_MAX_LEVELS];  // level i is used while the prop is at least this many pixels high,
+	                                   //   below the last level's the prop is culled (0 never culls)
+	int   triangles[LOD_MAX_LEVELS];
+	float radius;                      // bounding sphere, centered center_y above the prop's position
+	float center_y;
+	float cull_distance;               // culled beyond this, 0 if no limit
+} LodModel;
+
+typedef struct {
+	int       count[LOD_MAX_LEVELS];   // # of props drawn at each level
+	int       culled;                  // visible but too small or too far away
+	int       switches;                // props that changed level
+	long long triangles;               // drawn
+} LodStats;
+
+typedef struct {
+	const LodModel *model;
+	unsigned char  *level;             // every prop's current level, num_levels if culled
+	float          *size;              // projected height of each visible prop (scratch)
+	int            *lists;             // visible props by level, room for capacity props at each level
+	int            *list[LOD_MAX_LEVELS];
+	int             capacity;
+	float           hysteresis;        // fraction of a switch point a prop must pass it by
+	LodStats        stats;             // last selection
+} LodGroup;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+// Sets up LOD for count props of model.  Returns true on success, else false.
+bool  Lod_Init (LodGroup *group, const LodModel *model, int count, float hysteresis);
+void  Lod_Free (LodGroup *group);
+
+// Returns the pixel height of something 1 unit high, 1 unit from the camera
+float Lod_Pixel_Scale (float fov, int screen_height);
+
+// Picks the level of each of the num_visible props in visible (indices
+//   into xs,zs), seen from eye.  Fills in group->list[l] (group->stats.count[l]
+//   props) for each level and group->stats.
+void  Lod_Select (
+	LodGroup    *group,
+	const int   *visible,
+	int          num_visible,
+	const float *xs,
+	const float *zs,
+	const float *eye,
+	float        pixel_scale );
+
+#endif
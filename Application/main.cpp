@@ -9,7 +9,23 @@
 |							 Init_Graphics
 |								Set_Mouse_Cursor
 |             Program_Run
+|							 Queue_Event
 |							 Init_Render_State
+|							 Gx_Set_Texture
+|							 Gx_Set_Object_Matrix
+|							 Gx_Draw_Object
+|							 Gx_Load_Sample
+|								Gx_Load_Copy
+|							 Gx_Play_Voice
+|							 Gx_Stop_Voice
+|							 Gx_Voice_Playing
+|							 Gx_Set_Voice_Position
+|							 Gx_Upload_Asset
+|							 Gx_Set_Light
+|							 Queue_Number
+|							 Model_Triangles
+|							 Add_Lod_Level
+|							 Run_Frame_Job
 |             Program_Free
 |             Program_Immediate_Key_Handler
 |
@@ -30,7 +46,26 @@
 #include <rom8x8.h>
 
 #include "main.h"
-#include "position.h"
+#include "camera_controller.h"
+#include "mouse_look.h"
+#include "light_manager.h"
+#include "light_cluster.h"
+#include "world.h"
+#include "frustum.h"
+#include "scenery_bvh.h"
+#include "render_queue.h"
+#include "fixed_timestep.h"
+#include "input.h"
+#include "replay.h"
+#include "profile.h"
+#include "particles.h"
+#include "voice.h"
+#include "asset_loader.h"
+#include "hud_text.h"
+#include "lod.h"
+#include "asset_convert.h"
+#include "job.h"
+#include "frame_snapshot.h"
 #include <time.h>
 
 /*___________________
@@ -43,6 +78,69 @@ typedef struct {
 	unsigned bitdepth;
 } UserPreferences;
 
+typedef struct {
+	int              keycode;
+	InputCommandType press;			// queued when the key goes down
+	InputCommandType release;		// queued when the key comes up, if has_release
+	bool             has_release;
+	unsigned         value;
+} KeyBinding;
+
+// Sound library side of the voice manager.  A library sound can only
+//   play once at a time, so each sample is loaded once per real voice
+//   (the most that can play it at once) up front.
+typedef struct {
+	char  file[VOICE_MAX_SAMPLES][VOICE_MAX_PATH];
+	bool  positional[VOICE_MAX_SAMPLES];
+	float min_dist[VOICE_MAX_SAMPLES];
+	float max_dist[VOICE_MAX_SAMPLES];
+	Sound copies[VOICE_MAX_SAMPLES][VOICE_MAX_VOICES];
+	bool  copy_busy[VOICE_MAX_SAMPLES][VOICE_MAX_VOICES];
+	int   num_copies[VOICE_MAX_SAMPLES];
+	int   voice_sample[VOICE_MAX_VOICES];	// sample and copy on each voice (-1 if none)
+	int   voice_copy[VOICE_MAX_VOICES];
+} GxSoundBank;
+
+// Graphics library lights the light manager's slots are shown through
+typedef struct {
+	gx3dLight slot[LIGHT_MAX_SLOTS];
+} GxLights;
+
+// A frame's simulation steps and culling, run as a job while the main
+//   thread draws the frame before
+typedef struct {
+	World*         world;
+	float          step;			// seconds per simulation step
+	int            steps;
+	const int*     shots;			// shots fired in each step
+	ReplayTick     tick;			// input for the steps, shots filled in per step
+	Replay*        replay;
+	bool*          recording;		// set to false if the replay runs out of memory
+	bool           replay_full;
+	float          alpha;			// draw monsters this far through the last step
+	float          eye[3];			// camera to cull for
+	float          heading[3];
+	float          view[16];		// view matrix of that camera
+	FrameSnapshot* snapshot;		// filled in for the renderer
+	FrameScene*    scene;
+	JobSystem*     jobs;
+	bool           ok;				// false if the snapshot couldn't be built
+} FrameJob;
+
+// What an asset loader entry is, for Gx_Upload_Asset()
+typedef enum {
+	GX_ASSET_MODEL,
+	GX_ASSET_TEXTURE,
+	GX_ASSET_SOUND
+} GxAssetKind;
+
+// Triangles in each model Gx_Upload_Asset() loaded, counted from the bytes the loader read
+typedef struct {
+	gx3dObject** target[ASSET_MAX_ASSETS];
+	int          triangles[ASSET_MAX_ASSETS];
+	int          count;
+} GxModelTriangles;
+
 /*___________________
 |
 | Function Prototypes
@@ -50,7 +148,23 @@ typedef struct {
 
 static int Init_Graphics(unsigned resolution, unsigned bitdepth, unsigned stencildepth, int* generate_keypress_events);
 static void Set_Mouse_Cursor();
+static void Queue_Event(const evEvent* event, InputQueue* queue, ProfileTime time);
 static void Init_Render_State();
+static void Gx_Set_Texture(void* context, RenderTexture texture);
+static void Gx_Set_Object_Matrix(void* context, RenderObject object, const float* matrix);
+static void Gx_Draw_Object(void* context, RenderObject object);
+static bool Gx_Load_Sample(void* context, int sample, const char* file, bool positional, float min_dist, float max_dist, float* seconds);
+static bool Gx_Load_Copy(GxSoundBank* bank, int sample);
+static void Gx_Play_Voice(void* context, int voice, int sample, bool loop, float volume);
+static void Gx_Stop_Voice(void* context, int voice);
+static bool Gx_Voice_Playing(void* context, int voice);
+static void Gx_Set_Voice_Position(void* context, int voice, float x, float y, float z);
+static bool Gx_Upload_Asset(void* context, Asset* asset);
+static void Gx_Set_Light(void* context, int slot, const LightDesc* light);
+static void Queue_Number(RenderQueue* queue, int value, float x, float y, gx3dObject** obj_numbers, gx3dTexture* tex_num);
+static int Model_Triangles(const GxModelTriangles* models, gx3dObject* const* target);
+static bool Add_Lod_Level(LodModel* model, gx3dObject** objects, gx3dTexture* textures, const char* file, gx3dObject* object, int triangles, gx3dTexture texture, float min_pixels);
+static void Run_Frame_Job(void* data);
 
 /*___________________
 |
@@ -84,6 +198,31 @@ static void Init_Render_State();
 #define AUTO_TRACKING    1
 #define NO_AUTO_TRACKING 0
 
+#define SOUND_VOICES     16	// real voices playing at once, the rest are virtual
+
+#define HUD_DIGIT_SCALE  0.012f	// digit models are drawn at this scale
+#define LIGHT_SLOTS      4		// lights the driver is given at once: the player's and the brightest in view
+#define MUZZLE_FLASH_MS  80		// a shot's flash fades out over this long
+#define MUZZLE_RANGE     40
+
+// The score digits, 0-9 in a row, spaced as the HUD has always drawn them
+static const HudFont Hud_Digits = { '0', 10, 10, 1, 0.03f, 0.03f };
+
+// Mouse look: 0.15 degrees per count moving slowly, fast flicks turn up to 3 times as far
+static const MouseCurve Mouse_Curve = { 0.15f, 0.5f, 1, 0.5f, 3, false };
+
+static const KeyBinding Key_Bindings[] = {
+	{ evKY_ESC,   INPUT_CMD_PRESS,       INPUT_CMD_PRESS,      false, INPUT_PRESS_QUIT },
+	{ 'w',        INPUT_CMD_MOVE_START,  INPUT_CMD_MOVE_STOP,  true,  CAMERA_MOVE_FORWARD },
+	{ 's',        INPUT_CMD_MOVE_START,  INPUT_CMD_MOVE_STOP,  true,  CAMERA_MOVE_BACK },
+	{ 'a',        INPUT_CMD_MOVE_START,  INPUT_CMD_MOVE_STOP,  true,  CAMERA_MOVE_LEFT },
+	{ 'd',        INPUT_CMD_MOVE_START,  INPUT_CMD_MOVE_STOP,  true,  CAMERA_MOVE_RIGHT },
+	{ evKY_SHIFT, INPUT_CMD_RUN_START,   INPUT_CMD_RUN_STOP,   true,  0 },
+	{ evKY_TAB,   INPUT_CMD_TOGGLE,      INPUT_CMD_TOGGLE,     false, INPUT_PRESS_INSTRUCTIONS },
+	{ evKY_ENTER, INPUT_CMD_PRESS,       INPUT_CMD_PRESS,      false, INPUT_PRESS_START },
+	{ evKY_F12,   INPUT_CMD_PRESS,       INPUT_CMD_PRESS,      false, INPUT_PRESS_WIN }
+};
+
 /*____________________________________________________________________
 |
 | Function: Program_Get_User_Preferences
@@ -207,66 +346,49 @@ static void Set_Mouse_Cursor()
 	msSetCursor(msCURSOR_MEDIUM_ARROW, fc, bc);
 }
 
-/*____________________________________________________________________
-|
-| Function: reset_Position
-|
-| Input: Array of monster x and z coordinates
-| Output: Resets monster x and z coordinates to outer edge of game area, while also making sure not to reset a monster right next to the player.
-|___________________________________________________________________*/
-
-void reset_Position(float monster_x[3][25], float monster_z[3][25], int i, int j, int hitTracker[3][25], gx3dVector position)
-{
-	float x, z, dist;
-	monster_x[i][j] = (rand() % 1500) - 750;
-	monster_z[i][j] = (rand() % 1500) - 750;
-	hitTracker[i][j] = 0;
-	x = (monster_x[i][j] - position.x);
-	z = (monster_z[i][j] - position.z);
-	dist = (sqrt((x * x) + (z * z)));
-	if (dist < 250)
-		reset_Position(monster_x, monster_z, i, j, hitTracker, position);
-}
-
 /*____________________________________________________________________
 |
 | Function: Program_Run
 |
 | Input: Called from Program_Thread()
-| Output: Runs program in the current video mode.  Begins with mouse
-|   hidden.
+| Output: Runs program in the current video mode.  Shows the title
+|   while the assets load, then begins with mouse hidden.
 |___________________________________________________________________*/
 
 void Program_Run()
 {
 	// Important constants
-	const int MAX_SHOOT = 11;
-	const int MAX_HIT_SOUND = 15;
-	const int MAX_TREES = 150;
-	const int MAX_FLOWERS = 400;
-	const int MAX_MONSTERS = 25;
-	const int MAX_HIT = 25;
-	const int MAX_EVENTS = 3;
-	const int MONSTER_TYPES = 3;
-	const float MAX_HEALTH = 3000.0;
-
-	unsigned elapsed_time, new_time;
+	const int MAX_TREES = WORLD_MAX_TREES;
+	const int MAX_FLOWERS = WORLD_MAX_FLOWERS;
+	const int MAX_ONE_SHOTS = 32;		// shots and hits sounding at once
+	const int MAX_HIT = WORLD_MAX_HIT;
+	const int MAX_EVENTS = WORLD_MAX_EVENTS;
+	const int MONSTER_TYPES = WORLD_MONSTER_TYPES;
+	const float MAX_HEALTH = WORLD_MAX_HEALTH;
+	const float SIM_RATE = 60;			// simulation steps per second
+	const int MAX_SIM_STEPS = 8;		// most steps run in one frame (the game slows down below SIM_RATE/MAX_SIM_STEPS fps)
+	const float LOAD_FRAME_SECONDS = 1.0f / 60;	// asset upload time per loading screen frame
+	const float LOD_HYSTERESIS = 0.15f;	// props change level once 15% past a switch point
+	const float TREE_FULL_PIXELS = 150;	// trees this many pixels high or more get the full mesh
+	const float TREE_SIMPLE_PIXELS = 40;	// then the simple mesh, then the impostor
+	const float FLOWER_MIN_PIXELS = 3;	// smaller flowers aren't drawn
+	const float FLOWER_CULL_DISTANCE = 400;	// nor are flowers farther away than this
+
+	unsigned elapsed_time;
+	ProfileTime new_time, zone_start, draw_start;
 	bool quit = false;
-	float health = MAX_HEALTH;
 	int health_percentage = 0;
-	int deadmonsters = 0;
 	int score = 0;
-	int tree_x[MAX_TREES];
-	int tree_z[MAX_TREES];
-	int flower_x[MAX_FLOWERS];
-	int flower_z[MAX_FLOWERS];
-	float monster_x[MONSTER_TYPES][MAX_MONSTERS];
-	float monster_z[MONSTER_TYPES][MAX_MONSTERS];
-	float monster_speed[MONSTER_TYPES][MAX_MONSTERS];
-	bool monsters_onscreen[MONSTER_TYPES][MAX_MONSTERS];
-	int hitTimer[MAX_HIT];
-	int hitIndex = 0;
-	int hitTracker[MONSTER_TYPES][MAX_MONSTERS];
+	static World world;
+	FixedTimestep sim_clock;
+	float sim_alpha = 1;
+	InputQueue input_queue;
+	InputState input_state = { 0 };
+	InputLatency input_latency;
+	unsigned world_seed;
+	Replay replay;					// the session, saved on exit for the headless driver to rerun
+	bool recording = false;
+	int replay_mouse_x = 0, replay_mouse_y = 0;	// mouse movement not yet given to a step
 	bool fastMovement = false;
 	bool start = true;
 	bool instructions = false;
@@ -274,25 +396,40 @@ void Program_Run()
 	bool game_over2 = false;
 	bool victory = false;
 	bool victory2 = false;
-	int event_location_x[MAX_EVENTS];
-	int event_location_y[MAX_EVENTS];
-	int event_location_z[MAX_EVENTS];
-	float first_aid_x[MAX_EVENTS];
-	float first_aid_z[MAX_EVENTS];
 	int timer = 0;
 	int count = 0;
 
-	gx3dVector hitPosition[MAX_HIT];
-
-	gxRelation monster_relations[MONSTER_TYPES][MAX_MONSTERS];
-	gxRelation flower_relations[MAX_FLOWERS];
-	gxRelation tree_relations[MAX_TREES];
-	gxRelation firstaid_relations[MAX_EVENTS];
-
-	gx3dBox box[MAX_TREES];
-	gx3dSphere monster_spheres[MONSTER_TYPES][MAX_MONSTERS];
-	gx3dSphere flower_spheres[MAX_FLOWERS];
-	gx3dSphere firstaid_spheres[MAX_EVENTS];
+	SceneryBVH tree_bvh = { 0 }, flower_bvh = { 0 };
+
+	// The next frame is simulated and culled on a job into one snapshot while the
+	//   main thread draws the frame before from the other
+	JobSystem jobs;
+	static FrameSnapshot snapshots[2];
+	int front = 0;						// snapshot being drawn
+	FrameScene frame_scene;
+	FrameJob frame_job;
+	JobCounter frame_done = { 0 };
+	int frame_shots[MAX_SIM_STEPS];
+
+	// Visible instances are queued and drawn grouped by object and texture
+	RenderQueue render_queue;
+	RenderBackend gx_backend = { Gx_Set_Texture, Gx_Set_Object_Matrix, Gx_Draw_Object, NULL, NULL };  // no instancing in gx3d
+	RenderQueueStats render_totals = { 0 };
+	int render_frames = 0;
+
+	// Level of detail: trees get simpler, then a billboard, with distance, far flowers are dropped
+	LodModel tree_lod_model = { 0 }, flower_lod_model = { 0 };
+	LodGroup tree_lod = { 0 }, flower_lod = { 0 };
+	gx3dObject* obj_tree_lod[LOD_MAX_LEVELS];
+	gx3dTexture tex_tree_lod[LOD_MAX_LEVELS];
+	int tree_impostor_level = -1;		// level drawn as a billboard, if there is one
+	int monster_triangles[WORLD_MONSTER_TYPES] = { 0 };
+	long long lod_triangles = 0;		// drawn, since the start
+
+	// Effects: a poison cloud over every monster, a fire at every event
+	ParticleEngine particles;
+	int fx_fire, fx_poison;
+	int num_poison_emitters = 0;		// emitter k follows monster k
 
 	evEvent event;
 	gx3dDriverInfo dinfo;
@@ -357,61 +494,43 @@ void Program_Run()
 	| Initialize the sound library
 	|___________________________________________________________________*/
 
+	// Only the title is loaded before it's shown, worker threads read the
+	// rest of the files meanwhile and they're uploaded between title frames
+	ProfileTime load_start = Profile_Now();
+	AssetLoader assets;
+	static GxModelTriangles model_triangles;
+	model_triangles.count = 0;
+	AssetLoader_Init(&assets, NULL, Gx_Upload_Asset, &model_triangles);
+
 	snd_Init(22, 16, 2, 1, 1);
 	snd_SetListenerDistanceFactorToFeet(snd_3D_APPLY_NOW);
-	Sound s_walk, s_run, s_ambience, s_zombie1[MAX_MONSTERS], s_zombie2[MAX_MONSTERS], s_zombie3[MAX_MONSTERS], s_shoot[MAX_SHOOT], s_hit[MAX_HIT_SOUND], s_collect, s_cough,
-		s_start, s_game_over, s_victory;
-	s_ambience = snd_LoadSound("wav\\ambience.wav", snd_CONTROL_VOLUME, 0);
-	s_walk = snd_LoadSound("wav\\walk.wav", snd_CONTROL_VOLUME, 0);
-	s_run = snd_LoadSound("wav\\run.wav", snd_CONTROL_VOLUME, 0);
+	Sound s_walk, s_run, s_ambience, s_collect, s_cough, s_start, s_game_over, s_victory;
 	s_start = snd_LoadSound("wav\\title.wav", snd_CONTROL_VOLUME, 0);
-	s_game_over = snd_LoadSound("wav\\gameover.wav", snd_CONTROL_VOLUME, 0);
-	s_victory = snd_LoadSound("wav\\win.wav", snd_CONTROL_VOLUME, 0);
-	// Shoot
-	for (int i = 0; i < MAX_SHOOT; i++) {
-		s_shoot[i] = snd_LoadSound("wav\\shoot.wav", snd_CONTROL_VOLUME, 0);
-		snd_SetSoundVolume(s_shoot[i], 75);
-	}
-	// Hit
-	for (int i = 0; i < MAX_HIT_SOUND; i++) {
-		s_hit[i] = snd_LoadSound("wav\\gun_hit.wav", snd_CONTROL_VOLUME, 0);
-		snd_SetSoundVolume(s_hit[i], 75);
-	}
+	snd_SetSoundVolume(s_start, 65);
+	AssetLoader_Add(&assets, GX_ASSET_SOUND, "wav\\ambience.wav", NULL, &s_ambience);
+	AssetLoader_Add(&assets, GX_ASSET_SOUND, "wav\\walk.wav", NULL, &s_walk);
+	AssetLoader_Add(&assets, GX_ASSET_SOUND, "wav\\run.wav", NULL, &s_run);
+	AssetLoader_Add(&assets, GX_ASSET_SOUND, "wav\\gameover.wav", NULL, &s_game_over);
+	AssetLoader_Add(&assets, GX_ASSET_SOUND, "wav\\win.wav", NULL, &s_victory);
 	// Collect
-	s_collect = snd_LoadSound("wav\\collect.wav", snd_CONTROL_VOLUME, 0);
+	AssetLoader_Add(&assets, GX_ASSET_SOUND, "wav\\collect.wav", NULL, &s_collect);
 	// Cough
-	s_cough = snd_LoadSound("wav\\cough.wav", snd_CONTROL_VOLUME, 0);
-	// Monsters
-	for (int i = 0; i < MONSTER_TYPES; i++) {
-		for (int j = 0; j < MAX_MONSTERS; j++) {
-			if (i == 0) {
-				s_zombie1[j] = snd_LoadSound("wav\\zombie1.wav", snd_CONTROL_3D, 0);
-				snd_SetSoundMode(s_zombie1[j], snd_3D_MODE_ORIGIN_RELATIVE, snd_3D_APPLY_NOW);
-				snd_SetSoundMinDistance(s_zombie1[j], 5, snd_3D_APPLY_NOW);
-				snd_SetSoundMaxDistance(s_zombie1[j], 75, snd_3D_APPLY_NOW);
-			}
-			else if (i == 1) {
-				s_zombie2[j] = snd_LoadSound("wav\\zombie1.wav", snd_CONTROL_3D, 0);
-				snd_SetSoundMode(s_zombie2[j], snd_3D_MODE_ORIGIN_RELATIVE, snd_3D_APPLY_NOW);
-				snd_SetSoundMinDistance(s_zombie2[j], 5, snd_3D_APPLY_NOW);
-				snd_SetSoundMaxDistance(s_zombie2[j], 75, snd_3D_APPLY_NOW);
-			}
-			else if (i == 2) {
-				s_zombie3[j] = snd_LoadSound("wav\\zombie2.wav", snd_CONTROL_3D, 0);
-				snd_SetSoundMode(s_zombie3[j], snd_3D_MODE_ORIGIN_RELATIVE, snd_3D_APPLY_NOW);
-				snd_SetSoundMinDistance(s_zombie3[j], 5, snd_3D_APPLY_NOW);
-				snd_SetSoundMaxDistance(s_zombie3[j], 75, snd_3D_APPLY_NOW);
-			}
-		}
+	AssetLoader_Add(&assets, GX_ASSET_SOUND, "wav\\cough.wav", NULL, &s_cough);
+	// Shots, hits and monsters go through the voice manager, so each file is loaded once however many play it
+	static GxSoundBank sound_bank;
+	VoiceBackend gx_sound = { Gx_Load_Sample, Gx_Play_Voice, Gx_Stop_Voice, Gx_Voice_Playing, Gx_Set_Voice_Position, &sound_bank };
+	VoiceManager voices;
+	int snd_shoot, snd_hit, snd_zombie[MONSTER_TYPES];
+	int num_monster_voices = 0;		// emitter k follows monster k
+	if (!Voice_Init(&voices, &gx_sound, SOUND_VOICES, WORLD_START_MONSTERS * MONSTER_TYPES + MAX_ONE_SHOTS)) {
+		debug_WriteFile("Error: can't init voices");
+		quit = true;
 	}
-	// Set volumes
-	snd_SetSoundVolume(s_walk, 55);
-	snd_SetSoundVolume(s_run, 65);
-	snd_SetSoundVolume(s_cough, 80);
-	snd_SetSoundVolume(s_collect, 95);
-	snd_SetSoundVolume(s_ambience, 75);
-	snd_SetSoundVolume(s_start, 65);
-
+	snd_shoot = Voice_Load(&voices, "wav\\shoot.wav", false, 0, 0, 0.75f);
+	snd_hit = Voice_Load(&voices, "wav\\gun_hit.wav", false, 0, 0, 0.75f);
+	snd_zombie[0] = Voice_Load(&voices, "wav\\zombie1.wav", true, 5, 75, 1);
+	snd_zombie[1] = Voice_Load(&voices, "wav\\zombie1.wav", true, 5, 75, 1);
+	snd_zombie[2] = Voice_Load(&voices, "wav\\zombie2.wav", true, 5, 75, 1);
 	/*____________________________________________________________________
 	|
 	| Initialize the graphics state
@@ -447,6 +566,7 @@ void Program_Run()
 	|___________________________________________________________________*/
 
 	gx3dVector heading, position;
+	CameraController camera;
 
 	// Set starting camera position
 	position.x = 0;
@@ -456,7 +576,8 @@ void Program_Run()
 	heading.x = 0;  // {0,0,1} for cubic environment mapping to work correctly
 	heading.y = 0;
 	heading.z = 1;
-	Position_Init(&position, &heading, RUN_SPEED);
+	CameraController_Init(&camera, &position.x, &heading.x, RUN_SPEED, EYE_HEIGHT);
+	position.y = camera.position[1];
 
 	/*____________________________________________________________________
 	|
@@ -482,161 +603,216 @@ void Program_Run()
 	| Create particle systems
 	|___________________________________________________________________*/
 
-	gx3dParticleSystem psys_fire[MAX_EVENTS];
-	for (int i = 0; i < MAX_EVENTS; i++) {
-		psys_fire[i] = Script_ParticleSystem_Create("fire.gxps");
-	}
+	// One system per effect, updated once a frame and drawn at each visible emitter
+	//   (gx3d can't instance, so drawing the engine's particles would be a draw call each)
+	gx3dParticleSystem psys_effect[PARTICLE_MAX_EFFECTS];
+	gx3dParticleSystem psys_fire = Script_ParticleSystem_Create("fire.gxps");
 	gx3dParticleSystem psys_poison = Script_ParticleSystem_Create("poison.gxps");
 
+	// The systems make the particles, the engine only needs the bounds of each effect to cull its emitters
+	ParticleEffect fire_effect = { 0 }, poison_effect = { 0 };
+	fire_effect.radius = 15;
+	poison_effect.radius = 8;
+
 	/*____________________________________________________________________
 	|
 	| Load 3D models
 	|___________________________________________________________________*/
 
+	// Start
+	gx3dObject* obj_start;
+	gx3d_ReadLWO2File("Objects\\title.lwo", &obj_start, gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
+	gx3dTexture tex_start = gx3d_InitTexture_File("Objects\\Images\\title.bmp", 0, 0);
+
 	// Trees
-	gx3d_ReadLWO2File("Objects\\ptree6.lwo", &obj_tree, gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	gx3dTexture tex_tree = gx3d_InitTexture_File("Objects\\Images\\ptree_d512.bmp", "Objects\\Images\\ptree_d512_fa.bmp", 0);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\ptree6.lwo", NULL, &obj_tree);
+	gx3dTexture tex_tree;
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\ptree_d512.bmp", "Objects\\Images\\ptree_d512_fa.bmp", &tex_tree);
 
 	// Flowers
 	gx3dObject* obj_flower;
-	gx3d_ReadLWO2File("Objects\\flower2.lwo", &obj_flower, gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	gx3dTexture tex_flower = gx3d_InitTexture_File("Objects\\Images\\flower.bmp", "Objects\\Images\\flower_fa.bmp", 0);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\flower2.lwo", NULL, &obj_flower);
+	gx3dTexture tex_flower;
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\flower.bmp", "Objects\\Images\\flower_fa.bmp", &tex_flower);
 
 	// Monsters
 	gx3dObject* obj_monster[MONSTER_TYPES];
 	gx3dTexture tex_monster[MONSTER_TYPES];
-	gx3d_ReadLWO2File("Objects\\monster1.lwo", &obj_monster[0], gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	tex_monster[0] = gx3d_InitTexture_File("Objects\\Images\\zombie.bmp", "Objects\\Images\\zombie_fa.bmp", 0);
-	gx3d_ReadLWO2File("Objects\\monster2.lwo", &obj_monster[1], gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	tex_monster[1] = gx3d_InitTexture_File("Objects\\Images\\zombie2.bmp", "Objects\\Images\\zombie_fa.bmp", 0);
-	gx3d_ReadLWO2File("Objects\\monster3.lwo", &obj_monster[2], gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	tex_monster[2] = gx3d_InitTexture_File("Objects\\Images\\crawler.bmp", "Objects\\Images\\crawler_fa.bmp", 0);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\monster1.lwo", NULL, &obj_monster[0]);
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\zombie.bmp", "Objects\\Images\\zombie_fa.bmp", &tex_monster[0]);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\monster2.lwo", NULL, &obj_monster[1]);
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\zombie2.bmp", "Objects\\Images\\zombie_fa.bmp", &tex_monster[1]);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\monster3.lwo", NULL, &obj_monster[2]);
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\crawler.bmp", "Objects\\Images\\crawler_fa.bmp", &tex_monster[2]);
 
 	// Ground
 	gx3dObject* obj_ground;
-	gx3d_ReadLWO2File("Objects\\ground2.lwo", &obj_ground, gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	gx3dTexture tex_ground = gx3d_InitTexture_File("Objects\\Images\\ground2.bmp", 0, 0);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\ground2.lwo", NULL, &obj_ground);
+	gx3dTexture tex_ground;
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\ground2.bmp", NULL, &tex_ground);
 
 	// Skydome
 	gx3dObject* obj_skydome;
-	gx3d_ReadLWO2File("Objects\\sky.lwo", &obj_skydome, gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	gx3dTexture tex_skydome = gx3d_InitTexture_File("Objects\\Images\\sky.bmp", 0, 0);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\sky.lwo", NULL, &obj_skydome);
+	gx3dTexture tex_skydome;
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\sky.bmp", NULL, &tex_skydome);
 
 	// Hit
 	gx3dObject* obj_hit;
-	gx3d_ReadLWO2File("Objects\\hit.lwo", &obj_hit, gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	gx3dTexture tex_hit = gx3d_InitTexture_File("Objects\\Images\\hit.bmp", "Objects\\Images\\hit2.bmp", 0);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\hit.lwo", NULL, &obj_hit);
+	gx3dTexture tex_hit;
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\hit.bmp", "Objects\\Images\\hit2.bmp", &tex_hit);
 
 	// Kills
 	gx3dObject* obj_kills;
-	gx3d_ReadLWO2File("Objects\\kills_billboard.lwo", &obj_kills, gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	gx3dTexture tex_kills = gx3d_InitTexture_File("Objects\\Images\\kills.bmp", "Objects\\Images\\kills_fa.bmp", 0);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\kills_billboard.lwo", NULL, &obj_kills);
+	gx3dTexture tex_kills;
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\kills.bmp", "Objects\\Images\\kills_fa.bmp", &tex_kills);
 
 	// First Aid
 	gx3dObject* obj_firstaid;
-	gx3d_ReadLWO2File("Objects\\firstaid.lwo", &obj_firstaid, gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	gx3dTexture tex_firstaid = gx3d_InitTexture_File("Objects\\Images\\firstaid.bmp", "Objects\\Images\\firstaid_fa.bmp", 0);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\firstaid.lwo", NULL, &obj_firstaid);
+	gx3dTexture tex_firstaid;
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\firstaid.bmp", "Objects\\Images\\firstaid_fa.bmp", &tex_firstaid);
 
 	// Crosshair
 	gx3dObject* obj_crosshair;
-	gx3d_ReadLWO2File("Objects\\crosshair.lwo", &obj_crosshair, gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	gx3dTexture tex_crosshair = gx3d_InitTexture_File("Objects\\Images\\crosshair.bmp", "Objects\\Images\\crosshair_fa.bmp", 0);
-
-	// Start
-	gx3dObject* obj_start;
-	gx3d_ReadLWO2File("Objects\\title.lwo", &obj_start, gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	gx3dTexture tex_start = gx3d_InitTexture_File("Objects\\Images\\title.bmp", 0, 0);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\crosshair.lwo", NULL, &obj_crosshair);
+	gx3dTexture tex_crosshair;
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\crosshair.bmp", "Objects\\Images\\crosshair_fa.bmp", &tex_crosshair);
 
 	// Instructions
 	gx3dObject* obj_instructions;
-	gx3d_ReadLWO2File("Objects\\instructions.lwo", &obj_instructions, gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	gx3dTexture tex_instructions = gx3d_InitTexture_File("Objects\\Images\\instructions.bmp", 0, 0);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\instructions.lwo", NULL, &obj_instructions);
+	gx3dTexture tex_instructions;
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\instructions.bmp", NULL, &tex_instructions);
 
 	// Game Over
 	gx3dObject* obj_game_over;
-	gx3d_ReadLWO2File("Objects\\gameover.lwo", &obj_game_over, gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	gx3dTexture tex_game_over = gx3d_InitTexture_File("Objects\\Images\\gameover.bmp", 0, 0);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\gameover.lwo", NULL, &obj_game_over);
+	gx3dTexture tex_game_over;
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\gameover.bmp", NULL, &tex_game_over);
 
 	// Victory
 	gx3dObject* obj_victory;
-	gx3d_ReadLWO2File("Objects\\victory.lwo", &obj_victory, gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	gx3dTexture tex_victory = gx3d_InitTexture_File("Objects\\Images\\victory.bmp", 0, 0);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\victory.lwo", NULL, &obj_victory);
+	gx3dTexture tex_victory;
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\victory.bmp", NULL, &tex_victory);
 
 	// Numbers
 	gx3dObject* obj_numbers[10];
 	gx3dTexture tex_num[10];
-	gx3d_ReadLWO2File("Objects\\Numbers\\0.lwo", &obj_numbers[0], gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	tex_num[0] = gx3d_InitTexture_File("Objects\\Images\\Numbers\\0.bmp", "Objects\\Images\\Numbers\\0_fa.bmp", 0);
-	gx3d_ReadLWO2File("Objects\\Numbers\\1.lwo", &obj_numbers[1], gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	tex_num[1] = gx3d_InitTexture_File("Objects\\Images\\Numbers\\1.bmp", "Objects\\Images\\Numbers\\1_fa.bmp", 0);
-	gx3d_ReadLWO2File("Objects\\Numbers\\2.lwo", &obj_numbers[2], gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	tex_num[2] = gx3d_InitTexture_File("Objects\\Images\\Numbers\\2.bmp", "Objects\\Images\\Numbers\\2_fa.bmp", 0);
-	gx3d_ReadLWO2File("Objects\\Numbers\\3.lwo", &obj_numbers[3], gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	tex_num[3] = gx3d_InitTexture_File("Objects\\Images\\Numbers\\3.bmp", "Objects\\Images\\Numbers\\3_fa.bmp", 0);
-	gx3d_ReadLWO2File("Objects\\Numbers\\4.lwo", &obj_numbers[4], gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	tex_num[4] = gx3d_InitTexture_File("Objects\\Images\\Numbers\\4.bmp", "Objects\\Images\\Numbers\\4_fa.bmp", 0);
-	gx3d_ReadLWO2File("Objects\\Numbers\\5.lwo", &obj_numbers[5], gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	tex_num[5] = gx3d_InitTexture_File("Objects\\Images\\Numbers\\5.bmp", "Objects\\Images\\Numbers\\5_fa.bmp", 0);
-	gx3d_ReadLWO2File("Objects\\Numbers\\6.lwo", &obj_numbers[6], gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	tex_num[6] = gx3d_InitTexture_File("Objects\\Images\\Numbers\\6.bmp", "Objects\\Images\\Numbers\\6_fa.bmp", 0);
-	gx3d_ReadLWO2File("Objects\\Numbers\\7.lwo", &obj_numbers[7], gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	tex_num[7] = gx3d_InitTexture_File("Objects\\Images\\Numbers\\7.bmp", "Objects\\Images\\Numbers\\7_fa.bmp", 0);
-	gx3d_ReadLWO2File("Objects\\Numbers\\8.lwo", &obj_numbers[8], gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	tex_num[8] = gx3d_InitTexture_File("Objects\\Images\\Numbers\\8.bmp", "Objects\\Images\\Numbers\\8_fa.bmp", 0);
-	gx3d_ReadLWO2File("Objects\\Numbers\\9.lwo", &obj_numbers[9], gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
-	tex_num[9] = gx3d_InitTexture_File("Objects\\Images\\Numbers\\9.bmp", "Objects\\Images\\Numbers\\9_fa.bmp", 0);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\Numbers\\0.lwo", NULL, &obj_numbers[0]);
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\Numbers\\0.bmp", "Objects\\Images\\Numbers\\0_fa.bmp", &tex_num[0]);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\Numbers\\1.lwo", NULL, &obj_numbers[1]);
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\Numbers\\1.bmp", "Objects\\Images\\Numbers\\1_fa.bmp", &tex_num[1]);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\Numbers\\2.lwo", NULL, &obj_numbers[2]);
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\Numbers\\2.bmp", "Objects\\Images\\Numbers\\2_fa.bmp", &tex_num[2]);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\Numbers\\3.lwo", NULL, &obj_numbers[3]);
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\Numbers\\3.bmp", "Objects\\Images\\Numbers\\3_fa.bmp", &tex_num[3]);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\Numbers\\4.lwo", NULL, &obj_numbers[4]);
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\Numbers\\4.bmp", "Objects\\Images\\Numbers\\4_fa.bmp", &tex_num[4]);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\Numbers\\5.lwo", NULL, &obj_numbers[5]);
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\Numbers\\5.bmp", "Objects\\Images\\Numbers\\5_fa.bmp", &tex_num[5]);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\Numbers\\6.lwo", NULL, &obj_numbers[6]);
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\Numbers\\6.bmp", "Objects\\Images\\Numbers\\6_fa.bmp", &tex_num[6]);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\Numbers\\7.lwo", NULL, &obj_numbers[7]);
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\Numbers\\7.bmp", "Objects\\Images\\Numbers\\7_fa.bmp", &tex_num[7]);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\Numbers\\8.lwo", NULL, &obj_numbers[8]);
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\Numbers\\8.bmp", "Objects\\Images\\Numbers\\8_fa.bmp", &tex_num[8]);
+	AssetLoader_Add(&assets, GX_ASSET_MODEL, "Objects\\Numbers\\9.lwo", NULL, &obj_numbers[9]);
+	AssetLoader_Add(&assets, GX_ASSET_TEXTURE, "Objects\\Images\\Numbers\\9.bmp", "Objects\\Images\\Numbers\\9_fa.bmp", &tex_num[9]);
 
 	/*____________________________________________________________________
 	|
 	| create lights
 	|___________________________________________________________________*/
 
-	gx3dLightData event_light_data[MAX_EVENTS];
-	gx3dLight event_light[MAX_EVENTS];
-	gx3dLight player_light;
-	gx3dLightData player_light_data;
-	player_light_data.light_type = gx3d_LIGHT_TYPE_POINT;
-	player_light_data.point.diffuse_color.r = 1;
-	player_light_data.point.diffuse_color.g = 0;
-	player_light_data.point.diffuse_color.b = 0;
-	player_light_data.point.diffuse_color.a = 0;
-	player_light_data.point.specular_color.r = 1;
-	player_light_data.point.specular_color.g = 0;
-	player_light_data.point.specular_color.b = 0;
-	player_light_data.point.specular_color.a = 0;
-	player_light_data.point.ambient_color.r = 1;
-	player_light_data.point.ambient_color.g = 1;
-	player_light_data.point.ambient_color.b = 1;
-	player_light_data.point.ambient_color.a = 0;
-	player_light_data.point.src = position;
-	player_light_data.point.range = 200;
-	player_light_data.point.constant_attenuation = 0;
-	player_light_data.point.linear_attenuation = 0.1;
-	player_light_data.point.quadratic_attenuation = 0;
-	player_light = gx3d_InitLight(&player_light_data);
-	for (int i = 0; i < MAX_EVENTS; i++) {
-		event_light_data[i].light_type = gx3d_LIGHT_TYPE_POINT;
-		event_light_data[i].point.diffuse_color.r = 1;
-		event_light_data[i].point.diffuse_color.g = 0.68;
-		event_light_data[i].point.diffuse_color.b = 0.25;
-		event_light_data[i].point.diffuse_color.a = 0;
-		event_light_data[i].point.specular_color.r = 1;
-		event_light_data[i].point.specular_color.g = 0.68;
-		event_light_data[i].point.specular_color.b = 0.25;
-		event_light_data[i].point.specular_color.a = 0;
-		event_light_data[i].point.ambient_color.r = 1;
-		event_light_data[i].point.ambient_color.g = 1;
-		event_light_data[i].point.ambient_color.b = 1;
-		event_light_data[i].point.ambient_color.a = 0;
-		event_light_data[i].point.src.x = 0;
-		event_light_data[i].point.src.y = 0;
-		event_light_data[i].point.src.z = 0;
-		event_light_data[i].point.range = 75;
-		event_light_data[i].point.constant_attenuation = 0;
-		event_light_data[i].point.linear_attenuation = 0.1;
-		event_light_data[i].point.quadratic_attenuation = 0;
-		event_light[i] = gx3d_InitLight(&event_light_data[i]);
+	// The player carries a red light and a muzzle flash (no range until a shot), each event has a fire (placed once the world is made)
+	const LightDesc player_light_desc = { { position.x, position.y, position.z }, { 1, 0, 0 }, 200, 0.1f };
+	const LightDesc muzzle_light_desc = { { position.x, position.y, position.z }, { 1, 0.9f, 0.6f }, 0, 0.05f };
+	const LightDesc event_light_desc = { { 0, 0, 0 }, { 1, 0.68f, 0.25f }, 75, 0.1f };
+	LightManager lights;
+	int player_light = -1, muzzle_light = -1;
+	unsigned muzzle_ms = 0;
+	int num_light_slots = LIGHT_SLOTS;
+	if (dinfo.max_active_lights > 0 && dinfo.max_active_lights < num_light_slots)
+		num_light_slots = dinfo.max_active_lights;
+	if (LightManager_Init(&lights, 2 + MAX_EVENTS, num_light_slots)) {
+		player_light = LightManager_Add(&lights, &player_light_desc, true);
+		muzzle_light = LightManager_Add(&lights, &muzzle_light_desc, false);
+	}
+	if (player_light == -1 || muzzle_light == -1) {
+		debug_WriteFile("Error: can't init lights");
+		quit = true;
+	}
+	// Slots start dark and stay enabled, the manager only sends the ones that change
+	static GxLights gx_lights;
+	LightBackend light_backend = { Gx_Set_Light, &gx_lights };
+	gx3dLightData dark_light_data;
+	memset(&dark_light_data, 0, sizeof(dark_light_data));
+	dark_light_data.light_type = gx3d_LIGHT_TYPE_POINT;
+	for (int s = 0; s < num_light_slots; s++) {
+		gx_lights.slot[s] = gx3d_InitLight(&dark_light_data);
+		gx3d_EnableLight(gx_lights.slot[s]);
+	}
+
+	/*____________________________________________________________________
+	|
+	| Show the title while the rest of the assets load
+	|___________________________________________________________________*/
+
+	bool title_shown = false;
+	if (!AssetLoader_Start(&assets, 0))
+		debug_WriteFile("Error: can't start asset loader threads, loading on this thread");
+	snd_PlaySound(s_start, 0);
+	while (!AssetLoader_Done(&assets)) {
+		AssetLoader_Upload(&assets, LOAD_FRAME_SECONDS);
+		gx3d_ClearViewport(gx3d_CLEAR_SURFACE | gx3d_CLEAR_ZBUFFER, color, gx3d_MAX_ZBUFFER_VALUE, 0);
+		if (gx3d_BeginRender()) {
+			gx3dMatrix view_save;
+			gx3dVector tfrom = { 0, 0, -1 }, tto = { 0,0,0 }, twup = { 0,1,0 };
+			gx3d_GetViewMatrix(&view_save);
+			gx3d_CameraSetPosition(&tfrom, &tto, &twup, gx3d_CAMERA_ORIENTATION_LOOKTO_FIXED);
+			gx3d_CameraSetViewMatrix();
+			gx3d_SetMaterial(&material_default);
+			gx3d_SetAmbientLight(color3d_white);
+			// Same title as the start screen
+			gx3d_GetTranslateMatrix(&m1, 0, 0, 0);
+			gx3d_GetScaleMatrix(&m2, 0.1f, 0.08f, 0.08f);
+			gx3d_MultiplyMatrix(&m1, &m2, &m);
+			gx3d_SetObjectMatrix(obj_start, &m);
+			gx3d_SetTexture(0, tex_start);
+			gx3d_DrawObject(obj_start, 0);
+			// Progress bar along the bottom
+			gxSetColor(color_yellow);
+			gxDrawFillRectangle(100, gxGetScreenHeight() - 60, 100 + (int)(AssetLoader_Progress(&assets) * (gxGetScreenWidth() - 200)), gxGetScreenHeight() - 50);
+			gx3d_SetViewMatrix(&view_save);
+			gx3d_EndRender();
+			gxFlipVisualActivePages(FALSE);
+		}
+		if (!title_shown) {
+			title_shown = true;
+			sprintf(str, "Startup: title shown after %.0f ms", (Profile_Now() - load_start) / 1e6);
+			debug_WriteFile(str);
+		}
+	}
+	sprintf(str, "Startup: %d assets loaded after %.0f ms", assets.num_assets, (Profile_Now() - load_start) / 1e6);
+	debug_WriteFile(str);
+	if (assets.errors) {
+		sprintf(str, "Error: %d assets didn't load", assets.errors);
+		debug_WriteFile(str);
+		quit = true;
 	}
+	// Stops the loader threads, which must be done before the profiler is reset
+	AssetLoader_Free(&assets);
+
+	// Set volumes
+	snd_SetSoundVolume(s_walk, 55);
+	snd_SetSoundVolume(s_run, 65);
+	snd_SetSoundVolume(s_cough, 80);
+	snd_SetSoundVolume(s_collect, 95);
+	snd_SetSoundVolume(s_ambience, 75);
 
 	/*____________________________________________________________________
 	|
@@ -644,11 +820,14 @@ void Program_Run()
 	|___________________________________________________________________*/
 
 	int move_x, move_y;	// mouse movement counters
+	MouseLook mouse_look;
+	float look_yaw, look_pitch;
 
 	// Flush input queue
 	evFlushEvents();
 	// Zero mouse movement counters
 	msGetMouseMovement(&move_x, &move_y);  // call this here so the next call will get movement that has occurred since it was called here                                    
+	MouseLook_Init(&mouse_look, &Mouse_Curve);
 	  // Hide mouse cursor
 	msHideMouse();
 
@@ -657,60 +836,146 @@ void Program_Run()
 	| Main game loop
 	|___________________________________________________________________*/
 
-	unsigned last_time = 0;
+	ProfileTime last_time = 0;
+	ProfileTime elapsed_ns = 0;		// not yet counted in elapsed_time
+	double frame_seconds = 0;
 	bool force_update = false;
 	unsigned cmd_move = 0;
-	bool draw_wireframe = false;
-	bool first_aid_collected[MAX_EVENTS] = { false, false, false };
-	health = MAX_HEALTH;
 	int counter = 0;
-	int shot_counter = 0;
-	int hit_counter = 0;
 
-	// Create events coordinates at random and place lights and first aids at them
-	for (int i = 0; i < MAX_EVENTS; i++) {
-		// events
-		event_location_x[i] = (rand() % 1500) - 750;
-		event_location_y[i] = 0;
-		event_location_z[i] = (rand() % 1500) - 750;
-		// lights
-		event_light_data[i].point.src.x = event_location_x[i];
-		event_light_data[i].point.src.y = event_location_y[i];
-		event_light_data[i].point.src.z = event_location_z[i];
-		gx3d_UpdateLight(event_light[i], &event_light_data[i]);
-		// first aids
-		first_aid_x[i] = event_location_x[i] + 5;
-		first_aid_z[i] = event_location_z[i] + 5;
+	// Randomly place events, first aids, trees, flowers and monsters
+	world_seed = (unsigned)time(NULL);
+	if (!World_Init(&world, world_seed)) {
+		debug_WriteFile("Error: can't init world");
+		quit = true;
 	}
-
-	// Randomly set coordinates of trees/flowers/monsters
-	// trees
-	for (int i = 0; i < MAX_TREES; i++) {
-		tree_x[i] = (rand() % 1500) - 750;
-		tree_z[i] = (rand() % 1500) - 750;
+	// A model that didn't load is NULL, skip everything that needs the models and quit
+	if (!quit)
+		for (int i = 0; i < MONSTER_TYPES; i++)
+			World_Set_Monster_Bounds(&world, i, obj_monster[i]->bound_sphere.center.y, obj_monster[i]->bound_sphere.radius);
+	recording = Replay_Init(&replay, world_seed, SIM_RATE, &world, 0);
+	if (!recording)
+		debug_WriteFile("Error: can't init replay, session won't be recorded");
+
+	if (!quit) {
+		// Trees and flowers never move, so build the culling hierarchies over them once
+		if (!SceneryBVH_Build(&tree_bvh, world.tree_x, world.tree_z, MAX_TREES, &obj_tree->bound_box.min.x, &obj_tree->bound_box.max.x)) {
+			debug_WriteFile("Error: can't build tree hierarchy");
+			quit = true;
+		}
+		if (!SceneryBVH_Build(&flower_bvh, world.flower_x, world.flower_z, MAX_FLOWERS, &obj_flower->bound_box.min.x, &obj_flower->bound_box.max.x)) {
+			debug_WriteFile("Error: can't build flower hierarchy");
+			quit = true;
+		}
+		// The simple tree and the impostor are optional, trees without them stay at full detail
+		Add_Lod_Level(&tree_lod_model, obj_tree_lod, tex_tree_lod, "Objects\\ptree6.lwo", obj_tree, Model_Triangles(&model_triangles, &obj_tree), tex_tree, TREE_FULL_PIXELS);
+		Add_Lod_Level(&tree_lod_model, obj_tree_lod, tex_tree_lod, "Objects\\ptree6_simple.lwo", NULL, 0, tex_tree, TREE_SIMPLE_PIXELS);
+		FILE* impostor_fp = fopen("Objects\\Images\\ptree6_impostor.bmp", "rb");
+		if (impostor_fp) {
+			fclose(impostor_fp);
+			gx3dTexture tex_impostor = gx3d_InitTexture_File("Objects\\Images\\ptree6_impostor.bmp", "Objects\\Images\\ptree6_impostor_fa.bmp", 0);
+			if (Add_Lod_Level(&tree_lod_model, obj_tree_lod, tex_tree_lod, "Objects\\ptree6_impostor.lwo", NULL, 0, tex_impostor, 0))
+				tree_impostor_level = tree_lod_model.num_levels - 1;
+		}
+		if (tree_lod_model.num_levels == 0) {
+			debug_WriteFile("Error: can't add tree level of detail");
+			quit = true;
+		}
+		else
+			tree_lod_model.min_pixels[tree_lod_model.num_levels - 1] = 0;	// trees are never dropped
+		tree_lod_model.radius = obj_tree->bound_sphere.radius;
+		tree_lod_model.center_y = obj_tree->bound_sphere.center.y;
+		flower_lod_model.num_levels = 1;
+		flower_lod_model.min_pixels[0] = FLOWER_MIN_PIXELS;
+		flower_lod_model.triangles[0] = Model_Triangles(&model_triangles, &obj_flower);
+		flower_lod_model.radius = obj_flower->bound_sphere.radius;
+		flower_lod_model.center_y = obj_flower->bound_sphere.center.y;
+		flower_lod_model.cull_distance = FLOWER_CULL_DISTANCE;
+		for (int i = 0; i < MONSTER_TYPES; i++)
+			monster_triangles[i] = Model_Triangles(&model_triangles, &obj_monster[i]);
+		if (!Lod_Init(&tree_lod, &tree_lod_model, MAX_TREES, LOD_HYSTERESIS) || !Lod_Init(&flower_lod, &flower_lod_model, MAX_FLOWERS, LOD_HYSTERESIS)) {
+			debug_WriteFile("Error: can't init level of detail");
+			quit = true;
+		}
+	}
+	frame_scene.tree_bvh = &tree_bvh;
+	frame_scene.flower_bvh = &flower_bvh;
+	frame_scene.tree_lod = &tree_lod;
+	frame_scene.flower_lod = &flower_lod;
+	frame_scene.fov = fov;
+	frame_scene.aspect = (float)gxGetScreenWidth() / gxGetScreenHeight();
+	frame_scene.near_plane = near_plane;
+	frame_scene.far_plane = far_plane;
+	frame_scene.pixel_scale = Lod_Pixel_Scale(fov, gxGetScreenHeight());
+	// Only the lights in view compete for the driver's slots
+	static LightClusters light_clusters;
+	if (!LightClusters_Init(&light_clusters, fov, frame_scene.aspect, near_plane, far_plane)) {
+		debug_WriteFile("Error: can't init light clusters");
+		quit = true;
+	}
+	for (int i = 0; i < MONSTER_TYPES; i++)
+		frame_scene.monster_triangles[i] = monster_triangles[i];
+	FrameSnapshot_Init(&snapshots[0]);
+	FrameSnapshot_Init(&snapshots[1]);
+	memset(&frame_job, 0, sizeof(FrameJob));
+	frame_job.world = &world;
+	frame_job.shots = frame_shots;
+	frame_job.replay = &replay;
+	frame_job.recording = &recording;
+	frame_job.scene = &frame_scene;
+	frame_job.jobs = &jobs;
+	if (!RenderQueue_Init(&render_queue, MAX_FLOWERS + MAX_TREES + world.monsters.capacity + MAX_HIT + MAX_EVENTS)) {
+		debug_WriteFile("Error: can't init render queue");
+		quit = true;
 	}
-	// flowers
-	for (int i = 0; i < MAX_FLOWERS; i++) {
-		flower_x[i] = (rand() % 1500) - 750;
-		flower_z[i] = (rand() % 1500) - 750;
+	if (!Input_Init(&input_queue)) {
+		debug_WriteFile("Error: can't init input queue");
+		quit = true;
 	}
-	// monsters
-	for (int i = 0; i < MONSTER_TYPES; i++) {
-		for (int j = 0; j < MAX_MONSTERS; j++) {
-			if (i == 0)
-				monster_speed[i][j] = 0.15;
-			else if (i == 1)
-				monster_speed[i][j] = 0.25;
-			else
-				monster_speed[i][j] = 0.35;
-			monster_x[i][j] = (rand() % 1500) - 750;
-			monster_z[i][j] = (rand() % 1500) - 750;
-			hitTracker[i][j] = 0;
+	if (!Particle_Init(&particles, 0, world.monsters.capacity + MAX_EVENTS, world_seed)) {
+		debug_WriteFile("Error: can't init particles");
+		quit = true;
+	}
+	fx_fire = Particle_Add_Effect(&particles, &fire_effect);
+	fx_poison = Particle_Add_Effect(&particles, &poison_effect);
+	psys_effect[fx_fire] = psys_fire;
+	psys_effect[fx_poison] = psys_poison;
+	while (num_poison_emitters < world.monsters.count && Particle_Create_Emitter(&particles, fx_poison, world.monsters.x[num_poison_emitters], 8, world.monsters.z[num_poison_emitters]) != -1)
+		num_poison_emitters++;
+	for (int i = 0; i < MAX_EVENTS; i++)
+		Particle_Create_Emitter(&particles, fx_fire, world.event_x[i], world.event_y[i], world.event_z[i]);
+	while (num_monster_voices < world.monsters.count && Voice_Create_Emitter(&voices, snd_zombie[world.monsters.type[num_monster_voices]]) != -1)
+		num_monster_voices++;
+
+	FixedTimestep_Init(&sim_clock, SIM_RATE, MAX_SIM_STEPS);
+
+	// Place lights at the events
+	for (int i = 0; i < MAX_EVENTS; i++) {
+		LightDesc light = event_light_desc;
+		light.position[0] = world.event_x[i];
+		light.position[1] = world.event_y[i];
+		light.position[2] = world.event_z[i];
+		if (LightManager_Add(&lights, &light, false) == -1) {
+			debug_WriteFile("Error: can't add event light");
+			quit = true;
 		}
 	}
 
 	// Begin the game
+	Profile_Init();
+	Profile_Set_Thread_Name("main");
+	if (!Job_Init(&jobs, -1)) {
+		debug_WriteFile("Error: can't start jobs");
+		quit = true;
+	}
+	// The first frame drawn is the world as it starts
+	if (!quit && !FrameSnapshot_Build(&snapshots[front], &world, 1, &position.x, &heading.x, &frame_scene, &jobs)) {
+		debug_WriteFile("Error: can't build frame snapshot");
+		quit = true;
+	}
+	CameraController_View_Matrix(&camera, snapshots[front].view);
 	while (quit != true) {
+		Profile_Begin_Frame();
 
 		if (!snd_IsPlaying(s_ambience) && !start && !game_over && !victory)
 			snd_PlaySound(s_ambience, 0);
@@ -719,10 +984,10 @@ void Program_Run()
 			
 
 		// End game loop if win/loss conditions are met.
-		if (health <= 0) {
+		if (world.health <= 0) {
 			game_over = true;
 		}
-		if (first_aid_collected[0] == true && first_aid_collected[1] == true && first_aid_collected[2] == true)
+		if (World_All_First_Aids_Collected(&world))
 				victory = true;
 	
 
@@ -731,13 +996,20 @@ void Program_Run()
 		| Update clock
 		|___________________________________________________________________*/
 
-		// Get the current time (# milliseconds since the program started)
-		new_time = timeGetTime();
-		// Compute the elapsed time (in milliseconds) since the last time through this loop
-		if (last_time == 0)
+		// Get the current time (monotonic nanoseconds)
+		new_time = Profile_Now();
+		// Compute the elapsed time since the last time through this loop, exactly for the
+		// simulation and in whole milliseconds (carrying the fraction) for everything else
+		if (last_time == 0) {
 			elapsed_time = 0;
-		else
-			elapsed_time = new_time - last_time;
+			frame_seconds = 0;
+		}
+		else {
+			frame_seconds = (new_time - last_time) / 1e9;
+			elapsed_ns += new_time - last_time;
+			elapsed_time = (unsigned)(elapsed_ns / 1000000);
+			elapsed_ns -= elapsed_time * 1000000ULL;
+		}
 		last_time = new_time;
 
 		/*____________________________________________________________________
@@ -746,7 +1018,7 @@ void Program_Run()
 		|___________________________________________________________________*/
 		if(counter < 10000)
 			counter += elapsed_time;
-		if (counter >= (health * 2) && health < MAX_HEALTH && !victory && !game_over) {
+		if (counter >= (world.health * 2) && world.health < MAX_HEALTH && !victory && !game_over) {
 			if (!snd_IsPlaying(s_cough))
 				snd_PlaySound(s_cough, 0);
 			counter = 0;
@@ -757,84 +1029,22 @@ void Program_Run()
 		| Process user input
 		|___________________________________________________________________*/
 
-		if (evGetEvent(&event)) {
-			// key press
-			if (event.type == evTYPE_RAW_KEY_PRESS) {
-				// If ESC pressed, exit the program
-				if (event.keycode == evKY_ESC)
-					quit = true;
-				else if (event.keycode == 'w' && !start && !game_over && !victory)
-					cmd_move |= POSITION_MOVE_FORWARD;
-				else if (event.keycode == 's' && !start && !game_over && !victory)
-					cmd_move |= POSITION_MOVE_BACK;
-				else if (event.keycode == 'a' && !start && !game_over && !victory)
-					cmd_move |= POSITION_MOVE_LEFT;
-				else if (event.keycode == 'd' && !start && !game_over && !victory)
-					cmd_move |= POSITION_MOVE_RIGHT;
-				else if (event.keycode == evKY_SHIFT && !start && !game_over && !victory)
-					fastMovement = true;
-				else if (event.keycode == evKY_TAB) {
-					if (instructions == true)
-						instructions = false;
-					else
-						instructions = true;
-				}
-				else if (event.keycode == evKY_ENTER && start == true)
-					start = false;
-				else if (event.keycode == evKY_F12)
-					victory = true;
-			}
-			// key release
-			else if (event.type == evTYPE_RAW_KEY_RELEASE && !start && !game_over && !victory) {
-				if (event.keycode == 'w')
-					cmd_move &= ~(POSITION_MOVE_FORWARD);
-				else if (event.keycode == 's')
-					cmd_move &= ~(POSITION_MOVE_BACK);
-				else if (event.keycode == 'a')
-					cmd_move &= ~(POSITION_MOVE_LEFT);
-				else if (event.keycode == 'd')
-					cmd_move &= ~(POSITION_MOVE_RIGHT);
-				else if (event.keycode == evKY_SHIFT)
-					fastMovement = false;
-			}
-			// left click
-			else if (event.type == evTYPE_MOUSE_LEFT_PRESS && !start && !game_over && !victory) {
-				snd_PlaySound(s_shoot[shot_counter], 0);
-				shot_counter++;
-				if (shot_counter >= 11)
-					shot_counter = 0;
-				gx3dRay viewVector;
-				viewVector.origin = position;
-				viewVector.direction = heading;
-				for (int i = 0; i < MONSTER_TYPES; i++) {
-					for (int j = 0; j < MAX_MONSTERS; j++) {
-						if (monsters_onscreen[i][j]) {
-							gxRelation rel = gx3d_Relation_Ray_Sphere(&viewVector, &monster_spheres[i][j]);
-							if (rel != gxRELATION_OUTSIDE) {
-
-								snd_PlaySound(s_hit[hit_counter], 0);
-								hit_counter++;
-								if (hit_counter >= 15)
-									hit_counter = 0;
-
-								// increases the hit tracker
-								hitTracker[i][j]++;
-
-								// Create a new hit
-								hitPosition[hitIndex] = monster_spheres[i][j].center;
-								hitTimer[hitIndex] = 1000 + elapsed_time;
-								hitIndex = (hitIndex + 1) % MAX_HIT;
-
-								// checks to see if the monster has been hit 3 times, if so then increment deadmonsters and then reset position of the monster
-								if (hitTracker[i][j] >= 3) {
-									deadmonsters++;
-									reset_Position(monster_x, monster_z, i, j, hitTracker, position);
-								}
-							}
-						}
-					}
-				}
-			}
+		// Read every pending event, so a burst of presses isn't spread over several frames
+		zone_start = Profile_Now();
+		while (evGetEvent(&event))
+			Queue_Event(&event, &input_queue, Profile_Now());
+		// Apply movement and presses now, shots wait for the step they fall in
+		if (Input_Apply(&input_queue, !start && !game_over && !victory, &input_state)) {
+			if (input_state.pressed & INPUT_PRESS_QUIT)
+				quit = true;
+			if (input_state.pressed & INPUT_PRESS_INSTRUCTIONS)
+				instructions = !instructions;
+			if ((input_state.pressed & INPUT_PRESS_START) && start == true)
+				start = false;
+			if (input_state.pressed & INPUT_PRESS_WIN)
+				victory = true;
+			cmd_move = input_state.move;
+			fastMovement = input_state.run;
 			// walking sound if walking
 			if (cmd_move != 0 && fastMovement == false) {
 				if (!snd_IsPlaying(s_walk))
@@ -857,29 +1067,10 @@ void Program_Run()
 		}
 		// Check for camera movement (via mouse)
 		msGetMouseMovement(&move_x, &move_y);
-
-		/*____________________________________________________________________
-		|
-		| Check for collected first aids
-		|___________________________________________________________________*/
-
-		if (cmd_move != 0) {
-			for (int i = 0; i < MAX_EVENTS; i++) {
-				float x = (first_aid_x[i] - position.x);
-				float z = (first_aid_z[i] - position.z);
-				float collect_dist = (sqrt((x * x) + (z * z)));
-				if (collect_dist < 10) {
-					snd_PlaySound(s_collect, 0);
-					first_aid_collected[i] = true;
-					first_aid_x[i] = 2000.0;
-					first_aid_z[i] = 2000.0;
-					if (health <= 2500)
-						health += 500;
-					else
-						health = 3000;
-				}
-			}
-		}
+		MouseLook_Add(&mouse_look, move_x, move_y, Profile_Now());
+		replay_mouse_x += move_x;
+		replay_mouse_y += move_y;
+		Profile_Record("Input", zone_start, Profile_Now());
 
 		/*____________________________________________________________________
 		|
@@ -887,23 +1078,113 @@ void Program_Run()
 		|___________________________________________________________________*/
 
 		if (fastMovement)
-			Position_Set_Speed(RUN_SPEED * 3);
+			CameraController_Set_Speed(&camera, RUN_SPEED * 3);
 		else
-			Position_Set_Speed(RUN_SPEED);
+			CameraController_Set_Speed(&camera, RUN_SPEED);
 
 		bool position_changed, camera_changed;
-		Position_Update(elapsed_time, cmd_move, move_y, move_x, force_update,
-			&position_changed, &camera_changed, &position, &heading);
+		zone_start = Profile_Now();
+		MouseLook_Take(&mouse_look, &look_yaw, &look_pitch);
+		CameraController_Update(&camera, elapsed_time, cmd_move, look_pitch, look_yaw, force_update,
+			&position_changed, &camera_changed, &position.x, &heading.x);
+		CameraController_View_Matrix(&camera, frame_job.view);
+		Profile_Record("Camera", zone_start, Profile_Now());
+		zone_start = Profile_Now();
 		snd_SetListenerPosition(position.x, position.y, position.z, snd_3D_APPLY_NOW);
 		snd_SetListenerOrientation(heading.x, heading.y, heading.z, 0, 1, 0, snd_3D_APPLY_NOW);
+		Profile_Record("Sound", zone_start, Profile_Now());
+
+		/*____________________________________________________________________
+		|
+		| Get the simulation's input (monsters, first aids, health)
+		|___________________________________________________________________*/
+
+		// Runs at a fixed rate no matter the frame rate, so may step 0 or more times this frame
+		frame_job.steps = 0;
+		if (!start && !game_over && !victory) {
+			frame_job.tick.input.player_position.x = position.x;
+			frame_job.tick.input.player_position.y = position.y;
+			frame_job.tick.input.player_position.z = position.z;
+			frame_job.tick.input.player_heading.x = heading.x;
+			frame_job.tick.input.player_heading.y = heading.y;
+			frame_job.tick.input.player_heading.z = heading.z;
+			frame_job.tick.input.moving = (cmd_move != 0);
+			frame_job.tick.move = cmd_move;
+			frame_job.tick.run = fastMovement;
+			frame_job.tick.mouse_x = replay_mouse_x;
+			frame_job.tick.mouse_y = replay_mouse_y;
+			int steps = FixedTimestep_Advance(&sim_clock, frame_seconds);
+			for (int step = 0; step < steps; step++) {
+				// Each step takes the shots read before the end of its slice of time.  This frame's
+				// events were read after new_time, so the last step takes every shot read so far.
+				ProfileTime now = Profile_Now();
+				ProfileTime step_end = now;
+				if (step < steps - 1)
+					step_end = new_time - (ProfileTime)((sim_clock.accumulator + (steps - 1 - step) * (double)sim_clock.step) * 1e9);
+				frame_shots[step] = Input_Take_Shots(&input_queue, step_end, now);
+				for (int i = 0; i < frame_shots[step]; i++)
+					Voice_Play_Once(&voices, snd_shoot, 0, 0, 0);
+				if (frame_shots[step])
+					muzzle_ms = MUZZLE_FLASH_MS;
+			}
+			if (steps)
+				replay_mouse_x = replay_mouse_y = 0;
+			frame_job.step = sim_clock.step;
+			frame_job.steps = steps;
+			sim_alpha = FixedTimestep_Alpha(&sim_clock);
+		}
+		else {
+			// Don't bank time while the game isn't running
+			FixedTimestep_Reset(&sim_clock);
+			Input_Clear(&input_queue, &input_state);
+			replay_mouse_x = replay_mouse_y = 0;
+		}
 
 		/*____________________________________________________________________
 		|
-		| Update player light position as player moves
+		| Update lights (only what changed is sent to the driver)
 		|___________________________________________________________________*/
 
-		player_light_data.point.src = position;
-		gx3d_UpdateLight(player_light, &player_light_data);
+		zone_start = Profile_Now();
+		LightManager_Move(&lights, player_light, &position.x);
+		// The muzzle flash is just ahead of the eye, shrinking to nothing
+		LightDesc muzzle = lights.lights[muzzle_light];
+		muzzle.position[0] = position.x + heading.x * 2;
+		muzzle.position[1] = position.y + heading.y * 2;
+		muzzle.position[2] = position.z + heading.z * 2;
+		muzzle.range = MUZZLE_RANGE * (float)muzzle_ms / MUZZLE_FLASH_MS;
+		LightManager_Set(&lights, muzzle_light, &muzzle);
+		muzzle_ms = muzzle_ms > elapsed_time ? muzzle_ms - elapsed_time : 0;
+		// Give the slots to the lights reaching the view of the frame drawn next, brightest at the player first
+		int num_candidates = 0;
+		const int* candidates = NULL;
+		if (LightClusters_Build(&light_clusters, snapshots[front].view, lights.lights, lights.count))
+			candidates = LightClusters_Visible(&light_clusters, &num_candidates);
+		LightManager_Assign(&lights, candidates, num_candidates, &position.x, 0);
+		LightManager_Flush(&lights, &light_backend);
+		Profile_Record("Lights", zone_start, Profile_Now());
+
+		/*____________________________________________________________________
+		|
+		| Simulate and cull the next frame on a job, while this one is drawn
+		|___________________________________________________________________*/
+
+		frame_job.alpha = sim_alpha;
+		frame_job.eye[0] = position.x;
+		frame_job.eye[1] = position.y;
+		frame_job.eye[2] = position.z;
+		frame_job.heading[0] = heading.x;
+		frame_job.heading[1] = heading.y;
+		frame_job.heading[2] = heading.z;
+		frame_job.snapshot = &snapshots[1 - front];
+		Job_Submit(&jobs, Run_Frame_Job, &frame_job, &frame_done);
+
+		// Sounds of what happened in the steps behind the frame being drawn
+		FrameSnapshot* snapshot = &snapshots[front];
+		for (int i = 0; i < snapshot->hits; i++)
+			Voice_Play_Once(&voices, snd_hit, 0, 0, 0);
+		if (snapshot->first_aids_collected)
+			snd_PlaySound(s_collect, 0);
 
 		/*____________________________________________________________________
 		|
@@ -911,6 +1192,7 @@ void Program_Run()
 		|___________________________________________________________________*/
 
 		// Render the screen
+		draw_start = Profile_Now();
 		gx3d_ClearViewport(gx3d_CLEAR_SURFACE | gx3d_CLEAR_ZBUFFER, color, gx3d_MAX_ZBUFFER_VALUE, 0);
 		// Start rendering in 3D           
 		if (gx3d_BeginRender()) {
@@ -919,11 +1201,11 @@ void Program_Run()
 
 			if (!start && !game_over && !victory) {
 
+				// Draw from the camera the snapshot was culled for
+				gx3dVector snapshot_heading = { snapshot->heading[0], snapshot->heading[1], snapshot->heading[2] };
+				gx3d_SetViewMatrix((gx3dMatrix*)snapshot->view);
+
 				gx3d_SetAmbientLight(color3d_dim);
-				gx3d_EnableLight(player_light);
-				gx3d_EnableLight(event_light[0]);
-				gx3d_EnableLight(event_light[1]);
-				gx3d_EnableLight(event_light[2]);
 
 				// Draw skydome
 				gx3d_GetTranslateMatrix(&m, 0, -1, 0);
@@ -945,163 +1227,93 @@ void Program_Run()
 				gx3d_EnableAlphaTesting(128);
 
 
-				// Draw flowers
-				for (int i = 0; i < MAX_FLOWERS; i++) {
-					flower_spheres[i] = obj_flower->bound_sphere;
-					flower_spheres[i].center.x = flower_x[i];
-					flower_spheres[i].center.z = flower_z[i];
-					flower_relations[i] = gx3d_Relation_Sphere_Frustum(&flower_spheres[i]);
-					if (flower_relations[i] != gxRELATION_OUTSIDE) {
-						gx3d_GetTranslateMatrix(&m, flower_x[i], 0, flower_z[i]);
-						gx3d_SetObjectMatrix(obj_flower, &m);
-						gx3d_SetTexture(0, tex_flower);
-						gx3d_DrawObject(obj_flower, 0);
-					}
-				}
+				RenderQueue_Begin_Frame(&render_queue);
+				lod_triangles += snapshot->triangles;
 
-				// Draw trees
-				for (int i = 0; i < MAX_TREES; i++) {
-					box[i] = obj_tree->bound_box;
-					gx3d_GetTranslateMatrix(&m, tree_x[i], 0, tree_z[i]);
-					tree_relations[i] = gx3d_Relation_Box_Frustum(&box[i], &m);
-					if (tree_relations[i] != gxRELATION_OUTSIDE) {
-						gx3d_GetTranslateMatrix(&m, tree_x[i], 0, tree_z[i]);
-						gx3d_SetObjectMatrix(obj_tree, &m);
-						gx3d_SetTexture(0, tex_tree);
-						gx3d_DrawObject(obj_tree, 0);
-					}
+				// Queue flowers
+				for (int v = 0; v < snapshot->num_flowers; v++) {
+					int i = snapshot->flowers[v];
+					RenderQueue_Add_Translate(&render_queue, obj_flower, tex_flower, world.flower_x[i], 0, world.flower_z[i]);
 				}
 
-				// Assign monsters new x and z coordinates before drawing them
-				for (int i = 0; i < MONSTER_TYPES; i++) {
-					for (int j = 0; j < MAX_MONSTERS; j++) {
-
-						// checks if the monster should go after player instead of moving toward center
-						float x = monster_x[i][j] - position.x;
-						float z = monster_z[i][j] - position.z;
-						float x2 = 0;
-						float z2 = 0;
-						float dist = (sqrt((x * x) + (z * z)));
-
-						// moves toward player if close or has been shot by player
-						if (dist < 150 || hitTracker[i][j] > 0) {
-							if (dist > 10) {
-								if (monster_x[i][j] < position.x)
-									monster_x[i][j] += monster_speed[i][j];
-								else if (monster_x[i][j] > position.x)
-									monster_x[i][j] -= monster_speed[i][j];
-								if (monster_z[i][j] < position.z)
-									monster_z[i][j] += monster_speed[i][j];
-								else if (monster_z[i][j] > position.z)
-									monster_z[i][j] -= monster_speed[i][j];
-							}
-							// deals damage if monster is within 25 of player
-							if (dist < 15) {
-								health -= elapsed_time;
-							}
-							if (dist < 75) {
-								if (i == 0) {
-									if (!snd_IsPlaying(s_zombie1[j]))
-										snd_PlaySound(s_zombie1[j], 0);
-								}
-								else if (i == 1) {
-									if (!snd_IsPlaying(s_zombie2[j]))
-										snd_PlaySound(s_zombie2[j], 0);
-								}
-								else if (i == 2) {
-									if (!snd_IsPlaying(s_zombie3[j]))
-										snd_PlaySound(s_zombie3[j], 0);
-								}
-							}
-							continue;
+				// Queue trees, impostors turned to face the camera like the monsters
+				gx3dVector billboard_normal = { 0,0,1 };
+				gx3d_GetBillboardRotateYMatrix(&m1, &billboard_normal, &snapshot_heading);
+				for (int l = 0; l < tree_lod_model.num_levels; l++) {
+					for (int v = 0; v < snapshot->num_trees[l]; v++) {
+						int i = snapshot->trees[l][v];
+						if (l == tree_impostor_level) {
+							gx3d_GetTranslateMatrix(&m2, world.tree_x[i], 0, world.tree_z[i]);
+							gx3d_MultiplyMatrix(&m1, &m2, &m);
+							RenderQueue_Add(&render_queue, obj_tree_lod[l], tex_tree_lod[l], (float*)&m);
 						}
-
-						// otherwise move toward assigned events (monster1 to event1, monster2 to event2, etc..)
-						// if monster reaches assigned events, relocate it to a random coordinate
-						x = monster_x[i][j] - event_location_x[i];
-						z = monster_z[i][j] - event_location_z[i];
-						dist = (sqrt((x * x) + (z * z)));
-						x2 = (event_location_x[i] - monster_x[i][j]) / dist;
-						z2 = (event_location_z[i] - monster_z[i][j]) / dist;
-						monster_x[i][j] += x2 * 25 * 0.01f;
-						monster_z[i][j] += z2 * 25 * 0.01f;
-						if (dist < 5)
-							reset_Position(monster_x, monster_z, i, j, hitTracker, position);
+						else
+							RenderQueue_Add_Translate(&render_queue, obj_tree_lod[l], tex_tree_lod[l], world.tree_x[i], 0, world.tree_z[i]);
 					}
 				}
 
-				// setting position of monster sounds to update to new monster positions
-				for (int i = 0; i < MONSTER_TYPES; i++) {
-					for (int j = 0; j < MAX_MONSTERS; j++) {
-						if (i == 0) {
-							snd_SetSoundPosition(s_zombie1[j], monster_x[i][j], 5, monster_z[i][j], snd_3D_APPLY_NOW);
-						}
-						else if (i == 1) {
-							snd_SetSoundPosition(s_zombie2[j], monster_x[i][j], 5, monster_z[i][j], snd_3D_APPLY_NOW);
-						}
-						else if (i == 2) {
-							snd_SetSoundPosition(s_zombie3[j], monster_x[i][j], 5, monster_z[i][j], snd_3D_APPLY_NOW);
-						}
+				// Monsters that are chasing the player growl, only the loudest few get a real voice
+				zone_start = Profile_Now();
+				for (int k = 0; k < snapshot->num_monsters && k < num_monster_voices; k++) {
+					Voice_Set_Position(&voices, k, snapshot->monster_x[k], 5, snapshot->monster_z[k]);
+					if (snapshot->monster_growl[k] && !Voice_Is_Playing(&voices, k)) {
+						Voice_Set_Sample(&voices, k, snd_zombie[snapshot->monster_type[k]]);
+						Voice_Play(&voices, k, false);
 					}
 				}
-
-				// draw monsters along with particle effect
-				gx3dVector billboard_normal = { 0,0,1 };
-				for (int i = 0; i < MONSTER_TYPES; i++) {
-					for (int j = 0; j < MAX_MONSTERS; j++) {
-						monster_spheres[i][j] = obj_monster[i]->bound_sphere;
-						monster_spheres[i][j].center.x = monster_x[i][j];
-						monster_spheres[i][j].center.z = monster_z[i][j];
-						monster_relations[i][j] = gx3d_Relation_Sphere_Frustum(&monster_spheres[i][j]);
-						if (monster_relations[i][j] != gxRELATION_OUTSIDE) {
-							gx3d_GetBillboardRotateYMatrix(&m1, &billboard_normal, &heading);
-							gx3d_GetTranslateMatrix(&m2, monster_x[i][j], 0, monster_z[i][j]);
-							gx3d_MultiplyMatrix(&m1, &m2, &m);
-							gx3d_SetObjectMatrix(obj_monster[i], &m);
-							gx3d_SetTexture(0, tex_monster[i]);
-							gx3d_DrawObject(obj_monster[i], 0);
-							monsters_onscreen[i][j] = true;
-							gx3d_GetTranslateMatrix(&m2, monster_x[i][j], 8, monster_z[i][j]);
-							gx3d_SetParticleSystemMatrix(psys_poison, &m2);
-							gx3d_UpdateParticleSystem(psys_poison, elapsed_time);
-							gx3d_DrawParticleSystem(psys_poison, &heading, draw_wireframe);
-						}
-					}
+				Voice_Update(&voices, position.x, position.y, position.z, (float)frame_seconds);
+				Profile_Record("Sound", zone_start, Profile_Now());
+
+				// Queue monsters, drawn between the last two simulation steps so motion is smooth at any frame rate
+				for (int v = 0; v < snapshot->num_visible_monsters; v++) {
+					int k = snapshot->visible_monsters[v];
+					int i = snapshot->monster_type[k];
+					gx3d_GetTranslateMatrix(&m2, snapshot->monster_x[k], 0, snapshot->monster_z[k]);
+					gx3d_MultiplyMatrix(&m1, &m2, &m);
+					RenderQueue_Add(&render_queue, obj_monster[i], tex_monster[i], (float*)&m);
 				}
 
-				// Process and draw hit markers
+				// Draw scenery and monsters
+				RenderQueue_Flush(&render_queue, &gx_backend);
+
+				// Draw hit markers
 				const float HIT_SCALE = 1;
-				for (int i = 0; i < MAX_HIT; i++) {
-					if (hitTimer[i] > 0)
-						hitTimer[i] -= elapsed_time;
-				}
 				gx3d_SetAmbientLight(color3d_white);
 				for (int i = 0; i < MAX_HIT; i++) {
-					if (hitTimer[i] > 0) {
+					if (snapshot->hit_timer[i] > 0) {
 						gx3d_GetScaleMatrix(&m1, HIT_SCALE, HIT_SCALE, HIT_SCALE);
-						gx3d_GetBillboardRotateYMatrix(&m2, &billboard_normal, &heading);
-						float y = hitPosition[i].y + (1 - (hitTimer[i] / 1000.0f)) * (10);
-						gx3d_GetTranslateMatrix(&m3, hitPosition[i].x, y + 9, hitPosition[i].z);
+						gx3d_GetBillboardRotateYMatrix(&m2, &billboard_normal, &snapshot_heading);
+						float y = snapshot->hit_position[i].y + (1 - (snapshot->hit_timer[i] / WORLD_HIT_MARKER_TIME)) * (10);
+						gx3d_GetTranslateMatrix(&m3, snapshot->hit_position[i].x, y + 9, snapshot->hit_position[i].z);
 						gx3d_MultiplyMatrix(&m1, &m2, &m);
 						gx3d_MultiplyMatrix(&m, &m3, &m);
-						gx3d_SetObjectMatrix(obj_hit, &m);
-						gx3d_SetTexture(0, tex_hit);
-						gx3d_DrawObject(obj_hit, 0);
+						RenderQueue_Add(&render_queue, obj_hit, tex_hit, (float*)&m);
 					}
 				}
+				RenderQueue_Flush(&render_queue, &gx_backend);
 
 
 				/*____________________________________________________________________
 				|
-				| Draw fire particle system
+				| Draw particles (poison over the monsters, fire at the events)
 				|___________________________________________________________________*/
 
-				for (int i = 0; i < MAX_EVENTS; i++) {
-					gx3d_GetTranslateMatrix(&m, event_location_x[i], event_location_y[i], event_location_z[i]);
-					gx3d_SetParticleSystemMatrix(psys_fire[i], &m);
-					gx3d_UpdateParticleSystem(psys_fire[i], elapsed_time);
-					gx3d_DrawParticleSystem(psys_fire[i], &heading, draw_wireframe);
+				zone_start = Profile_Now();
+				for (int k = 0; k < num_poison_emitters && k < snapshot->num_monsters; k++)
+					Particle_Move_Emitter(&particles, k, snapshot->monster_x[k], 8, snapshot->monster_z[k]);
+				Particle_Cull(&particles, &snapshot->frustum);
+				// Each system runs once a frame, however many emitters show it
+				for (int fx = 0; fx < particles.num_effects; fx++)
+					gx3d_UpdateParticleSystem(psys_effect[fx], elapsed_time);
+				for (int i = 0; i < particles.num_emitters; i++) {
+					const ParticleEmitter* e = &particles.emitters[i];
+					if (e->visible) {
+						gx3d_GetTranslateMatrix(&m, e->x, e->y, e->z);
+						gx3d_SetParticleSystemMatrix(psys_effect[e->effect], &m);
+						gx3d_DrawParticleSystem(psys_effect[e->effect], &snapshot_heading, false);
+					}
 				}
+				Profile_Record("Particles", zone_start, Profile_Now());
 
 				/*____________________________________________________________________
 				|
@@ -1109,22 +1321,27 @@ void Program_Run()
 				|___________________________________________________________________*/
 				for (int i = 0; i < MAX_EVENTS; i++) {
 					// If first aid has not been collected, then draw .
-					firstaid_spheres[i] = obj_firstaid->bound_sphere;
-					firstaid_spheres[i].center.x = first_aid_x[i];
-					firstaid_spheres[i].center.z = first_aid_z[i];
-					firstaid_relations[i] = gx3d_Relation_Sphere_Frustum(&firstaid_spheres[i]);
-					if (firstaid_relations[i] != gxRELATION_OUTSIDE) {
-						if (first_aid_collected[i] == false) {
-							gx3d_GetBillboardRotateYMatrix(&m1, &billboard_normal, &heading);
-							gx3d_GetTranslateMatrix(&m2, event_location_x[i] + 5, event_location_y[i], event_location_z[i] + 5);
+					float firstaid_center[3] = { snapshot->first_aid_x[i], obj_firstaid->bound_sphere.center.y, snapshot->first_aid_z[i] };
+					if (Frustum_Test_Sphere(&snapshot->frustum, firstaid_center, obj_firstaid->bound_sphere.radius) != FRUSTUM_OUTSIDE) {
+						if (snapshot->first_aid_collected[i] == false) {
+							gx3d_GetBillboardRotateYMatrix(&m1, &billboard_normal, &snapshot_heading);
+							gx3d_GetTranslateMatrix(&m2, world.event_x[i] + 5, world.event_y[i], world.event_z[i] + 5);
 							gx3d_MultiplyMatrix(&m1, &m2, &m);
-							gx3d_SetObjectMatrix(obj_firstaid, &m);
-							gx3d_SetTexture(0, tex_firstaid);
-							gx3d_DrawObject(obj_firstaid, 0);
+							RenderQueue_Add(&render_queue, obj_firstaid, tex_firstaid, (float*)&m);
 						}
 					}
 				}
+				RenderQueue_Flush(&render_queue, &gx_backend);
+
+				render_totals.instances += render_queue.stats.instances;
+				render_totals.batches += render_queue.stats.batches;
+				render_totals.draw_calls += render_queue.stats.draw_calls;
+				render_totals.texture_changes += render_queue.stats.texture_changes;
+				render_totals.matrix_changes += render_queue.stats.matrix_changes;
+				render_frames++;
 			}
+			Profile_Record("Draw 3D", draw_start, Profile_Now());
+			zone_start = Profile_Now();
 
 			/*____________________________________________________________________
 			|
@@ -1143,24 +1360,20 @@ void Program_Run()
 
 			gx3d_SetAmbientLight(color3d_white);
 			// Draw 2d icons
-			char kills[3] = { 0,0,0 };
 			if (!start && !game_over && !victory) {
 
-				// Score
-				sprintf(kills, "%d", score);
-
 				// Health
-				if (health < 1000) {
+				if (snapshot->health < 1000) {
 					gxSetColor(color_red);
 				}
-				else if (health < 2000) {
+				else if (snapshot->health < 2000) {
 					gxSetColor(color_yellow);
 				}
 				else
 					gxSetColor(color_green);
 				gxDrawRectangle(Health_Bar_Border.xleft, Health_Bar_Border.ytop, Health_Bar_Border.xright, Health_Bar_Border.ybottom);
-				float percentage = health / MAX_HEALTH * 100.0;
-				if (health > 0) {
+				float percentage = snapshot->health / MAX_HEALTH * 100.0;
+				if (snapshot->health > 0) {
 					gxDrawFillRectangle(Health_Bar_Fill.xleft, Health_Bar_Fill.ytop, (percentage * 5) + 100, Health_Bar_Fill.ybottom);
 				}
 
@@ -1174,77 +1387,9 @@ void Program_Run()
 				gx3d_SetTexture(0, tex_crosshair);
 				gx3d_DrawObject(obj_crosshair, 0);
 
-				// First Digit
-				gx3d_GetScaleMatrix(&m1, 0.012, 0.012, 0.012);
-				gx3d_GetRotateYMatrix(&m2, 180);
-				gx3d_GetTranslateMatrix(&m3, -0.70, 0.35, 0);
-				gx3d_MultiplyMatrix(&m1, &m2, &m);
-				gx3d_MultiplyMatrix(&m, &m3, &m);
-				if (score <= 99) {
-					gx3d_SetObjectMatrix(obj_numbers[0], &m);
-					gx3d_SetTexture(0, tex_num[0]);
-					//gx3d_DrawObject(obj_numbers[0], 0);
-				}
-				else {
-					int digit1 = kills[0] - 48;
-					gx3d_SetObjectMatrix(obj_numbers[digit1], &m);
-					gx3d_SetTexture(0, tex_num[digit1]);
-					gx3d_DrawObject(obj_numbers[digit1], 0);
-				}
-
-				// Second Digit
-				gx3d_GetScaleMatrix(&m1, 0.012, 0.012, 0.012);
-				gx3d_GetRotateYMatrix(&m2, 180);
-				gx3d_GetTranslateMatrix(&m3, -0.67, 0.35, 0);
-				gx3d_MultiplyMatrix(&m1, &m2, &m);
-				gx3d_MultiplyMatrix(&m, &m3, &m);
-				if (score <= 9) {
-					gx3d_SetObjectMatrix(obj_numbers[0], &m);
-					gx3d_SetTexture(0, tex_num[0]);
-					//gx3d_DrawObject(obj_numbers[0], 0);
-				}
-				else if (score >= 10 && score >= 100) {
-					int digit2 = kills[1] - 48;
-					gx3d_SetObjectMatrix(obj_numbers[digit2], &m);
-					gx3d_SetTexture(0, tex_num[digit2]);
-					gx3d_DrawObject(obj_numbers[digit2], 0);
-				}
-				else {
-					int digit2 = kills[0] - 48;
-					gx3d_SetObjectMatrix(obj_numbers[digit2], &m);
-					gx3d_SetTexture(0, tex_num[digit2]);
-					gx3d_DrawObject(obj_numbers[digit2], 0);
-				}
-
-				// Third Digit
-				gx3d_GetScaleMatrix(&m1, 0.012, 0.012, 0.012);
-				gx3d_GetRotateYMatrix(&m2, 180);
-				gx3d_GetTranslateMatrix(&m3, -0.64, 0.35, 0);
-				gx3d_MultiplyMatrix(&m1, &m2, &m);
-				gx3d_MultiplyMatrix(&m, &m3, &m);
-				if (score <= 0) {
-					gx3d_SetObjectMatrix(obj_numbers[0], &m);
-					gx3d_SetTexture(0, tex_num[0]);
-					gx3d_DrawObject(obj_numbers[0], 0);
-				}
-				else if (score >= 10 && score <= 99) {
-					int digit2 = kills[1] - 48;
-					gx3d_SetObjectMatrix(obj_numbers[digit2], &m);
-					gx3d_SetTexture(0, tex_num[digit2]);
-					gx3d_DrawObject(obj_numbers[digit2], 0);
-				}
-				else if (score >= 0 && score <= 9) {
-					int digit3 = kills[0] - 48;
-					gx3d_SetObjectMatrix(obj_numbers[digit3], &m);
-					gx3d_SetTexture(0, tex_num[digit3]);
-					gx3d_DrawObject(obj_numbers[digit3], 0);
-				}
-				else {
-					int digit3 = kills[2] - 48;
-					gx3d_SetObjectMatrix(obj_numbers[digit3], &m);
-					gx3d_SetTexture(0, tex_num[digit3]);
-					gx3d_DrawObject(obj_numbers[digit3], 0);
-				}
+				// Score, last digit at the right edge
+				Queue_Number(&render_queue, score, -0.64f, 0.35f, obj_numbers, tex_num);
+				RenderQueue_Flush(&render_queue, &gx_backend);
 			}
 			gx3d_DisableAlphaTesting();
 			gx3d_DisableAlphaBlending();
@@ -1282,17 +1427,15 @@ void Program_Run()
 				gx3d_DrawObject(obj_game_over, 0);
 			}
 
-			health_percentage = (health / MAX_HEALTH) * 100;
+			health_percentage = (snapshot->health / MAX_HEALTH) * 100;
 			timer += elapsed_time;
 			if (timer > 1000) {
 				count++;
 				timer = 0;
 			}
 			if(count > 1 && !victory)
-				score = deadmonsters * 100 / count + health_percentage;
+				score = snapshot->deadmonsters * 100 / count + health_percentage;
 			if (victory) {
-				char final_score[3];
-				sprintf(final_score, "%d", score);
 				snd_StopSound(s_ambience);
 				if (!victory2) {
 					victory2 = true;
@@ -1312,77 +1455,8 @@ void Program_Run()
 
 				gx3d_EnableAlphaBlending();
 				gx3d_EnableAlphaTesting(128);
-				// First Digit
-				gx3d_GetScaleMatrix(&m1, 0.012f, 0.012f, 0.012f);
-				gx3d_GetRotateYMatrix(&m2, 180);
-				gx3d_GetTranslateMatrix(&m3, -0.02, -0.08, 0);
-				gx3d_MultiplyMatrix(&m1, &m2, &m);
-				gx3d_MultiplyMatrix(&m, &m3, &m);
-				if (score <= 99) {
-					gx3d_SetObjectMatrix(obj_numbers[0], &m);
-					gx3d_SetTexture(0, tex_num[0]);
-					//gx3d_DrawObject(obj_numbers[0], 0);
-				}
-				else {
-					int digit1 = final_score[0] - 48;
-					gx3d_SetObjectMatrix(obj_numbers[digit1], &m);
-					gx3d_SetTexture(0, tex_num[digit1]);
-					gx3d_DrawObject(obj_numbers[digit1], 0);
-				}
-
-				// Second Digit
-				gx3d_GetScaleMatrix(&m1, 0.012f, 0.012f, 0.012f);
-				gx3d_GetRotateYMatrix(&m2, 180);
-				gx3d_GetTranslateMatrix(&m3, 0.01, -0.08, 0);
-				gx3d_MultiplyMatrix(&m1, &m2, &m);
-				gx3d_MultiplyMatrix(&m, &m3, &m);
-				if (score <= 9) {
-					gx3d_SetObjectMatrix(obj_numbers[0], &m);
-					gx3d_SetTexture(0, tex_num[0]);
-					//gx3d_DrawObject(obj_numbers[0], 0);
-				}
-				else if (score >= 10 && score >= 100) {
-					int digit2 = final_score[1] - 48;
-					gx3d_SetObjectMatrix(obj_numbers[digit2], &m);
-					gx3d_SetTexture(0, tex_num[digit2]);
-					gx3d_DrawObject(obj_numbers[digit2], 0);
-				}
-				else {
-					int digit2 = final_score[0] - 48;
-					gx3d_SetObjectMatrix(obj_numbers[digit2], &m);
-					gx3d_SetTexture(0, tex_num[digit2]);
-					gx3d_DrawObject(obj_numbers[digit2], 0);
-				}
-
-				// Third Digit
-				gx3d_GetScaleMatrix(&m1, 0.012f, 0.012f, 0.012f);
-				gx3d_GetRotateYMatrix(&m2, 180);
-				gx3d_GetTranslateMatrix(&m3, 0.04, -0.08, 0);
-				gx3d_MultiplyMatrix(&m1, &m2, &m);
-				gx3d_MultiplyMatrix(&m, &m3, &m);
-				if (score <= 0) {
-					gx3d_SetObjectMatrix(obj_numbers[0], &m);
-					gx3d_SetTexture(0, tex_num[0]);
-					gx3d_DrawObject(obj_numbers[0], 0);
-				}
-				else if (score >= 10 && score <= 99) {
-					int digit2 = final_score[1] - 48;
-					gx3d_SetObjectMatrix(obj_numbers[digit2], &m);
-					gx3d_SetTexture(0, tex_num[digit2]);
-					gx3d_DrawObject(obj_numbers[digit2], 0);
-				}
-				else if (score >= 0 && score <= 9) {
-					int digit3 = final_score[0] - 48;
-					gx3d_SetObjectMatrix(obj_numbers[digit3], &m);
-					gx3d_SetTexture(0, tex_num[digit3]);
-					gx3d_DrawObject(obj_numbers[digit3], 0);
-				}
-				else {
-					int digit3 = final_score[2] - 48;
-					gx3d_SetObjectMatrix(obj_numbers[digit3], &m);
-					gx3d_SetTexture(0, tex_num[digit3]);
-					gx3d_DrawObject(obj_numbers[digit3], 0);
-				}
+				Queue_Number(&render_queue, score, 0.04f, -0.08f, obj_numbers, tex_num);
+				RenderQueue_Flush(&render_queue, &gx_backend);
 				gx3d_DisableAlphaBlending();
 				gx3d_DisableAlphaTesting();
 			}
@@ -1403,10 +1477,28 @@ void Program_Run()
 			gx3d_SetViewMatrix(&view_save);
 			// Stop rendering
 			gx3d_EndRender();
+			Profile_Record("HUD", zone_start, Profile_Now());
 
 			// Page flip (so user can see it)
+			zone_start = Profile_Now();
 			gxFlipVisualActivePages(FALSE);
+			Profile_Record("Present", zone_start, Profile_Now());
 		}
+
+		// The next frame's snapshot is drawn next time through
+		zone_start = Profile_Now();
+		Job_Wait(&jobs, &frame_done);
+		Profile_Record("Wait for jobs", zone_start, Profile_Now());
+		if (frame_job.replay_full) {
+			debug_WriteFile("Error: out of memory, replay recording stopped");
+			frame_job.replay_full = false;
+		}
+		if (!frame_job.ok) {
+			debug_WriteFile("Error: can't build frame snapshot");
+			quit = true;
+		}
+		front = 1 - front;
+		Profile_End_Frame();
 	}
 	/*____________________________________________________________________
 	|
@@ -1430,15 +1522,87 @@ void Program_Run()
 	gx3d_FreeObject(obj_hit);
 	gx3d_FreeObject(obj_kills);
 	gx3d_FreeObject(obj_tree);
+	for (int l = 1; l < tree_lod_model.num_levels; l++)
+		gx3d_FreeObject(obj_tree_lod[l]);
+	Lod_Free(&tree_lod);
+	Lod_Free(&flower_lod);
 	gx3d_FreeObject(obj_ground);
 	gx3d_FreeObject(obj_skydome);
 	gx3d_FreeObject(obj_start);
 	gx3d_FreeObject(obj_victory);
 	gx3d_FreeObject(obj_game_over);
 	gx3d_FreeObject(obj_instructions);
+	if (render_frames) {
+		sprintf(str, "Render queue per frame: %d instances, %d batches, %d draw calls, %d texture changes, %d matrix changes",
+			render_totals.instances / render_frames, render_totals.batches / render_frames, render_totals.draw_calls / render_frames,
+			render_totals.texture_changes / render_frames, render_totals.matrix_changes / render_frames);
+		debug_WriteFile(str);
+		sprintf(str, "Triangles per frame: %lld (trees at %d levels of detail)", lod_triangles / render_frames, tree_lod_model.num_levels);
+		debug_WriteFile(str);
+	}
+	Input_Get_Latency(&input_queue, &input_latency);
+	if (input_latency.samples) {
+		sprintf(str, "Input latency (read to simulation, last %d shots): p50 %.2f ms, p99 %.2f ms, max %.2f ms",
+			input_latency.samples, input_latency.p50_ms, input_latency.p99_ms, input_latency.max_ms);
+		debug_WriteFile(str);
+	}
+	// Stop the workers before the profile they record into is freed
+	Job_Free(&jobs);
+	FrameSnapshot_Free(&snapshots[0]);
+	FrameSnapshot_Free(&snapshots[1]);
+	// Frame time breakdown, to find spikes (open profile.json in chrome://tracing)
+	ProfileZoneSummary zone_summary[PROFILE_MAX_ZONES];
+	int num_zones = Profile_Summary(zone_summary, PROFILE_MAX_ZONES);
+	debug_WriteFile("_______________ Frame Profile (ms, last frames) ______________");
+	for (int i = 0; i < num_zones; i++) {
+		sprintf(str, "%-16s p50 %7.3f  p99 %7.3f  max %7.3f", zone_summary[i].name, zone_summary[i].p50_ms, zone_summary[i].p99_ms, zone_summary[i].max_ms);
+		debug_WriteFile(str);
+	}
+	if (!Profile_Write_Trace("profile.json"))
+		debug_WriteFile("Error: can't write profile.json");
+	Profile_Free();
+	RenderQueue_Free(&render_queue);
+	Input_Free(&input_queue);
+	Particle_Free(&particles);
+	Voice_Free(&voices);
+	if (replay.ticks && !Replay_Save(&replay, "replay.rpl"))
+		debug_WriteFile("Error: can't write replay.rpl");
+	Replay_Free(&replay);
+	LightManager_Free(&lights);
+	LightClusters_Free(&light_clusters);
+	SceneryBVH_Free(&tree_bvh);
+	SceneryBVH_Free(&flower_bvh);
+	World_Free(&world);
 	snd_Free();
 }
 
+/*____________________________________________________________________
+|
+| Function: Queue_Event
+|
+| Input: Called from Program_Run()
+| Output: Queues the command (if any) bound to a key or mouse event.
+|___________________________________________________________________*/
+
+static void Queue_Event(const evEvent* event, InputQueue* queue, ProfileTime time)
+{
+	int i, n = sizeof(Key_Bindings) / sizeof(Key_Bindings[0]);
+
+	if (event->type == evTYPE_MOUSE_LEFT_PRESS)
+		Input_Push(queue, INPUT_CMD_SHOOT, 0, time);
+	else if (event->type == evTYPE_RAW_KEY_PRESS || event->type == evTYPE_RAW_KEY_RELEASE) {
+		for (i = 0; i < n; i++)
+			if (Key_Bindings[i].keycode == event->keycode)
+				break;
+		if (i < n) {
+			if (event->type == evTYPE_RAW_KEY_PRESS)
+				Input_Push(queue, Key_Bindings[i].press, Key_Bindings[i].value, time);
+			else if (Key_Bindings[i].has_release)
+				Input_Push(queue, Key_Bindings[i].release, Key_Bindings[i].value, time);
+		}
+	}
+}
+
 /*____________________________________________________________________
 |
 | Function: Init_Render_State
@@ -1477,6 +1641,397 @@ static void Init_Render_State()
 	gx3d_SetTextureFiltering(1, gx3d_TEXTURE_FILTERTYPE_TRILINEAR, 0);
 }
 
+/*____________________________________________________________________
+|
+| Function: Gx_Set_Texture
+|
+| Input: Called from RenderQueue_Flush()
+| Output: Render queue backend: binds a texture to stage 0.
+|___________________________________________________________________*/
+
+static void Gx_Set_Texture(void* context, RenderTexture texture)
+{
+	gx3d_SetTexture(0, (gx3dTexture)texture);
+}
+
+/*____________________________________________________________________
+|
+| Function: Gx_Set_Object_Matrix
+|
+| Input: Called from RenderQueue_Flush()
+| Output: Render queue backend: sets the transform of an object.
+|___________________________________________________________________*/
+
+static void Gx_Set_Object_Matrix(void* context, RenderObject object, const float* matrix)
+{
+	gx3d_SetObjectMatrix((gx3dObject*)object, (gx3dMatrix*)matrix);
+}
+
+/*____________________________________________________________________
+|
+| Function: Gx_Draw_Object
+|
+| Input: Called from RenderQueue_Flush()
+| Output: Render queue backend: draws an object.
+|___________________________________________________________________*/
+
+static void Gx_Draw_Object(void* context, RenderObject object)
+{
+	gx3d_DrawObject((gx3dObject*)object, 0);
+}
+
+/*____________________________________________________________________
+|
+| Function: Gx_Load_Sample
+|
+| Input: Called from Voice_Load()
+| Output: Voice backend: loads a copy of a sample for each real voice,
+|   so nothing is loaded once the game is running.  The sound library
+|   doesn't give lengths, so seconds is left at 0.  Returns true on
+|   success, else false.
+|___________________________________________________________________*/
+
+static bool Gx_Load_Sample(void* context, int sample, const char* file, bool positional, float min_dist, float max_dist, float* seconds)
+{
+	GxSoundBank* bank = (GxSoundBank*)context;
+
+	// First sample loaded, no voice is playing anything yet
+	if (sample == 0)
+		for (int v = 0; v < VOICE_MAX_VOICES; v++)
+			bank->voice_sample[v] = bank->voice_copy[v] = -1;
+
+	strcpy(bank->file[sample], file);
+	bank->positional[sample] = positional;
+	bank->min_dist[sample] = min_dist;
+	bank->max_dist[sample] = max_dist;
+	bank->num_copies[sample] = 0;
+	while (bank->num_copies[sample] < SOUND_VOICES)
+		if (!Gx_Load_Copy(bank, sample))
+			return (false);
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Gx_Load_Copy
+|
+| Input: Called from Gx_Load_Sample()
+| Output: Loads another copy of a sample.  Returns true on success, else
+|   false.
+|___________________________________________________________________*/
+
+static bool Gx_Load_Copy(GxSoundBank* bank, int sample)
+{
+	int n = bank->num_copies[sample];
+	Sound snd;
+
+	if (n == VOICE_MAX_VOICES)
+		return (false);
+	if (bank->positional[sample]) {
+		snd = snd_LoadSound(bank->file[sample], snd_CONTROL_3D, 0);
+		if (snd == 0)
+			return (false);
+		snd_SetSoundMode(snd, snd_3D_MODE_ORIGIN_RELATIVE, snd_3D_APPLY_NOW);
+		snd_SetSoundMinDistance(snd, bank->min_dist[sample], snd_3D_APPLY_NOW);
+		snd_SetSoundMaxDistance(snd, bank->max_dist[sample], snd_3D_APPLY_NOW);
+	}
+	else {
+		snd = snd_LoadSound(bank->file[sample], snd_CONTROL_VOLUME, 0);
+		if (snd == 0)
+			return (false);
+	}
+	bank->copies[sample][n] = snd;
+	bank->copy_busy[sample][n] = false;
+	bank->num_copies[sample]++;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Gx_Play_Voice
+|
+| Input: Called from Voice_Play(), Voice_Update()
+| Output: Voice backend: plays a sample on a voice, from an idle copy of
+|   the sample.  If they're all busy the voice stays silent, a sound is
+|   never loaded mid-game.
+|___________________________________________________________________*/
+
+static void Gx_Play_Voice(void* context, int voice, int sample, bool loop, float volume)
+{
+	GxSoundBank* bank = (GxSoundBank*)context;
+	int c;
+
+	Gx_Stop_Voice(context, voice);
+	for (c = 0; c < bank->num_copies[sample]; c++)
+		if (!bank->copy_busy[sample][c])
+			break;
+	if (c == bank->num_copies[sample])
+		return;
+
+	bank->copy_busy[sample][c] = true;
+	bank->voice_sample[voice] = sample;
+	bank->voice_copy[voice] = c;
+	if (!bank->positional[sample])
+		snd_SetSoundVolume(bank->copies[sample][c], (int)(volume * 100));
+	snd_PlaySound(bank->copies[sample][c], loop ? 1 : 0);
+}
+
+/*____________________________________________________________________
+|
+| Function: Gx_Stop_Voice
+|
+| Input: Called from Voice_Stop(), Voice_Update(), Gx_Play_Voice()
+| Output: Voice backend: stops whatever a voice is playing.
+|___________________________________________________________________*/
+
+static void Gx_Stop_Voice(void* context, int voice)
+{
+	GxSoundBank* bank = (GxSoundBank*)context;
+	int sample = bank->voice_sample[voice], c = bank->voice_copy[voice];
+
+	if (sample == -1)
+		return;
+	if (snd_IsPlaying(bank->copies[sample][c]))
+		snd_StopSound(bank->copies[sample][c]);
+	bank->copy_busy[sample][c] = false;
+	bank->voice_sample[voice] = bank->voice_copy[voice] = -1;
+}
+
+/*____________________________________________________________________
+|
+| Function: Gx_Voice_Playing
+|
+| Input: Called from Voice_Update()
+| Output: Voice backend: returns true if a voice's sound is still going
+|   (if not, its copy is free for other voices).
+|___________________________________________________________________*/
+
+static bool Gx_Voice_Playing(void* context, int voice)
+{
+	GxSoundBank* bank = (GxSoundBank*)context;
+	int sample = bank->voice_sample[voice];
+
+	if (sample == -1)
+		return (false);
+	if (snd_IsPlaying(bank->copies[sample][bank->voice_copy[voice]]))
+		return (true);
+	Gx_Stop_Voice(context, voice);
+
+	return (false);
+}
+
+/*____________________________________________________________________
+|
+| Function: Gx_Set_Voice_Position
+|
+| Input: Called from Voice_Update()
+| Output: Voice backend: moves a voice's sound.
+|___________________________________________________________________*/
+
+static void Gx_Set_Voice_Position(void* context, int voice, float x, float y, float z)
+{
+	GxSoundBank* bank = (GxSoundBank*)context;
+	int sample = bank->voice_sample[voice];
+
+	if (sample != -1)
+		snd_SetSoundPosition(bank->copies[sample][bank->voice_copy[voice]], x, y, z, snd_3D_APPLY_NOW);
+}
+
+/*____________________________________________________________________
+|
+| Function: Gx_Upload_Asset
+|
+| Input: Called from AssetLoader_Upload()
+| Output: Asset loader upload function: loads a model, texture or sound
+|   into asset->target.  The graphics and sound libraries read the
+|   files themselves, by then in the OS file cache from the loader's
+|   read.  Returns true on success, else false.
+|___________________________________________________________________*/
+
+static bool Gx_Upload_Asset(void* context, Asset* asset)
+{
+	const char* alt_file = asset->alt_file[0] ? asset->alt_file : 0;
+
+	switch (asset->kind) {
+		case GX_ASSET_MODEL: {
+			GxModelTriangles* models = (GxModelTriangles*)context;
+			*(gx3dObject**)asset->target = NULL;
+			gx3d_ReadLWO2File(asset->file, (gx3dObject**)asset->target, gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
+			if (*(gx3dObject**)asset->target == NULL)
+				return (false);
+			// Only the polygon lists are walked, nothing is converted
+			models->target[models->count] = (gx3dObject**)asset->target;
+			models->triangles[models->count++] = AssetConvert_LWO2_Triangles(asset->data, asset->size);
+			return (true);
+		}
+		case GX_ASSET_TEXTURE:
+			*(gx3dTexture*)asset->target = gx3d_InitTexture_File(asset->file, alt_file, 0);
+			return (*(gx3dTexture*)asset->target != 0);
+		case GX_ASSET_SOUND:
+			*(Sound*)asset->target = snd_LoadSound(asset->file, snd_CONTROL_VOLUME, 0);
+			return (*(Sound*)asset->target != 0);
+	}
+
+	return (false);
+}
+
+/*____________________________________________________________________
+|
+| Function: Gx_Set_Light
+|
+| Input: Called from LightManager_Flush()
+| Output: Light manager backend: sets a slot's light (dark if NULL).
+|___________________________________________________________________*/
+
+static void Gx_Set_Light(void* context, int slot, const LightDesc* light)
+{
+	gx3dLightData data;
+
+	memset(&data, 0, sizeof(data));
+	data.light_type = gx3d_LIGHT_TYPE_POINT;
+	if (light) {
+		data.point.diffuse_color.r = data.point.specular_color.r = light->color[0];
+		data.point.diffuse_color.g = data.point.specular_color.g = light->color[1];
+		data.point.diffuse_color.b = data.point.specular_color.b = light->color[2];
+		data.point.ambient_color.r = 1;
+		data.point.ambient_color.g = 1;
+		data.point.ambient_color.b = 1;
+		data.point.src.x = light->position[0];
+		data.point.src.y = light->position[1];
+		data.point.src.z = light->position[2];
+		data.point.range = light->range;
+		data.point.linear_attenuation = light->attenuation;
+	}
+	gx3d_UpdateLight(((GxLights*)context)->slot[slot], &data);
+}
+
+/*____________________________________________________________________
+|
+| Function: Queue_Number
+|
+| Input: Called from Program_Run()
+| Output: Queues value (0 if negative) as HUD digits, right aligned with
+|   the last digit centered on x, y.  Any # of digits fits and digits
+|   that repeat are drawn as one batch when the queue is flushed.
+|___________________________________________________________________*/
+
+static void Queue_Number(RenderQueue* queue, int value, float x, float y, gx3dObject** obj_numbers, gx3dTexture* tex_num)
+{
+	HudGlyph glyphs[HUD_TEXT_MAX_GLYPHS];
+	// Digit models face away from the 2D camera, so they're turned around (rotate Y 180)
+	float matrix[16] = {
+		-HUD_DIGIT_SCALE, 0, 0, 0,
+		0, HUD_DIGIT_SCALE, 0, 0,
+		0, 0, -HUD_DIGIT_SCALE, 0,
+		0, 0, 0, 1
+	};
+
+	int n = HudText_Layout_Number(&Hud_Digits, value > 0 ? value : 0, x, y, HUD_ALIGN_RIGHT, glyphs, HUD_TEXT_MAX_GLYPHS);
+	for (int i = 0; i < n; i++) {
+		matrix[12] = glyphs[i].x;
+		matrix[13] = glyphs[i].y;
+		RenderQueue_Add(queue, obj_numbers[glyphs[i].glyph], tex_num[glyphs[i].glyph], matrix);
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Model_Triangles
+|
+| Input: Called from Program_Run()
+| Output: Returns the # of triangles in the model loaded into target,
+|   or 0 if it wasn't loaded.
+|___________________________________________________________________*/
+
+static int Model_Triangles(const GxModelTriangles* models, gx3dObject* const* target)
+{
+	for (int i = 0; i < models->count; i++)
+		if (models->target[i] == target)
+			return (models->triangles[i]);
+
+	return (0);
+}
+
+/*____________________________________________________________________
+|
+| Function: Add_Lod_Level
+|
+| Input: Called from Program_Run()
+| Output: Adds a level of detail to model, drawn with object (with
+|   triangles triangles, or read from file if NULL) and texture while
+|   the prop is at least min_pixels high.  Returns true if the level was
+|   added, false if the object or texture couldn't be loaded or model
+|   has no room.
+|___________________________________________________________________*/
+
+static bool Add_Lod_Level(LodModel* model, gx3dObject** objects, gx3dTexture* textures, const char* file, gx3dObject* object, int triangles, gx3dTexture texture, float min_pixels)
+{
+	int level = model->num_levels;
+
+	if (level == LOD_MAX_LEVELS || texture == 0)
+		return (false);
+	if (object == NULL) {
+		// Variants are optional, so only try to read one that's there
+		triangles = AssetConvert_File_Triangles(file);
+		if (triangles < 0)
+			return (false);
+		gx3d_ReadLWO2File(file, &object, gx3d_VERTEXFORMAT_DEFAULT, gx3d_DONT_LOAD_TEXTURES);
+		if (object == NULL)
+			return (false);
+	}
+	objects[level] = object;
+	textures[level] = texture;
+	model->min_pixels[level] = min_pixels;
+	model->triangles[level] = triangles;
+	model->num_levels++;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Run_Frame_Job
+|
+| Input: Called from Program_Run() (as a job)
+| Output: Runs the frame's simulation steps, recording them in the
+|   replay, then builds the frame's snapshot, culling on more jobs.
+|___________________________________________________________________*/
+
+static void Run_Frame_Job(void* data)
+{
+	FrameJob* job = (FrameJob*)data;
+	FrameSnapshot* snapshot = job->snapshot;
+	WorldStepResult result;
+	ProfileTime start = Profile_Now();
+
+	snapshot->steps = 0;
+	snapshot->hits = 0;
+	snapshot->first_aids_collected = 0;
+	for (int step = 0; step < job->steps; step++) {
+		job->tick.input.shots = job->shots[step];
+		World_Step(job->world, job->step, &job->tick.input, &result);
+		if (*job->recording) {
+			if (!Replay_Record(job->replay, &job->tick)) {
+				job->replay_full = true;
+				*job->recording = false;
+			}
+			job->tick.mouse_x = job->tick.mouse_y = 0;
+		}
+		snapshot->steps++;
+		snapshot->hits += result.hits;
+		snapshot->first_aids_collected += result.first_aids_collected;
+		if (job->world->health <= 0 || World_All_First_Aids_Collected(job->world))
+			break;
+	}
+	if (job->steps)
+		Profile_Record("Simulation", start, Profile_Now());
+
+	job->ok = FrameSnapshot_Build(snapshot, job->world, job->alpha, job->eye, job->heading, job->scene, job->jobs);
+	memcpy(snapshot->view, job->view, sizeof(job->view));
+}
+
 /*____________________________________________________________________
 |
 | Function: Program_Free
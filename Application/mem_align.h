@@ -0,0 +1,63 @@
+/*____________________________________________________________________
+|
+| File: mem_align.h
+|
+| Description: Cache line aligned memory allocation for the platform
+|   independent modules.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _MEM_ALIGN_H_
+#define _MEM_ALIGN_H_
+
+#include <stdlib.h>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+#define CACHE_LINE_SIZE 64
+
+// Rounds n up to a multiple of align (a power of 2)
+#define ALIGN_UP(n,align) (((n) + ((align) - 1)) & ~((align) - 1))
+
+/*____________________________________________________________________
+|
+| Function: Aligned_Malloc
+|
+| Input: Called from any module
+| Output: Allocates size bytes aligned to a cache line.  Returns NULL
+|   on failure.
+|___________________________________________________________________*/
+
+inline void *Aligned_Malloc (size_t size)
+{
+#ifdef _MSC_VER
+	return (_aligned_malloc (size, CACHE_LINE_SIZE));
+#else
+	void *p;
+	if (posix_memalign (&p, CACHE_LINE_SIZE, size))
+		return (NULL);
+	return (p);
+#endif
+}
+
+/*____________________________________________________________________
+|
+| Function: Aligned_Free
+|
+| Input: Called from any module
+| Output: Frees memory allocated with Aligned_Malloc().
+|___________________________________________________________________*/
+
+inline void Aligned_Free (void *p)
+{
+#ifdef _MSC_VER
+	_aligned_free (p);
+#else
+	free (p);
+#endif
+}
+
+#endif
@@ -0,0 +1,431 @@
+/*____________________________________________________________________
+|
+| File: monster_kernel.cpp
+|
+| Description: Batch monster update with scalar, SSE2 and AVX2 versions.
+|   Every version does exactly the same floating point operations in the
+|   same order per monster, so results are bit identical.
+|
+| Functions: MonsterKernel_Best
+|            MonsterKernel_Supported
+|            MonsterKernel_Name
+|            MonsterKernel_Update
+|             Update_Scalar
+|              Update_One
+|             Update_SSE2
+|             Update_AVX2
+|              Store_Masks
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <math.h>
+
+#include "monster_kernel.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define KERNEL_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// Lets gcc/clang compile an AVX2 function without building the whole file for AVX2
+#if defined(KERNEL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static void Update_Scalar (MonsterPool *pool, int first, const MonsterKernelParams *params, MonsterKernelResult *result);
+static inline void Update_One (MonsterPool *pool, int k, const MonsterKernelParams *params, MonsterKernelResult *result);
+#ifdef KERNEL_X86
+static void Update_SSE2 (MonsterPool *pool, const MonsterKernelParams *params, MonsterKernelResult *result);
+TARGET_AVX2 static void Update_AVX2 (MonsterPool *pool, const MonsterKernelParams *params, MonsterKernelResult *result);
+static inline void Store_Masks (MonsterPool *pool, int k, int lanes, int attack, int growl, int arrived, MonsterKernelResult *result);
+static bool Cpu_Has_AVX2 ();
+#endif
+
+/*____________________________________________________________________
+|
+| Function: MonsterKernel_Best
+|
+| Input: Called from World_Init(), headless driver
+| Output: Returns the fastest kernel the cpu supports.
+|___________________________________________________________________*/
+
+MonsterKernelType MonsterKernel_Best ()
+{
+	if (MonsterKernel_Supported (MONSTER_KERNEL_AVX2))
+		return (MONSTER_KERNEL_AVX2);
+	if (MonsterKernel_Supported (MONSTER_KERNEL_SSE2))
+		return (MONSTER_KERNEL_SSE2);
+	return (MONSTER_KERNEL_SCALAR);
+}
+
+/*____________________________________________________________________
+|
+| Function: MonsterKernel_Supported
+|
+| Input: Called from MonsterKernel_Best(), headless driver
+| Output: Returns true if the cpu can run this kernel.
+|___________________________________________________________________*/
+
+bool MonsterKernel_Supported (MonsterKernelType type)
+{
+	switch (type) {
+		case MONSTER_KERNEL_SCALAR:
+			return (true);
+#ifdef KERNEL_X86
+		case MONSTER_KERNEL_SSE2:
+#if defined(_M_X64) || defined(__x86_64__)
+			return (true);	// always there on x64
+#elif defined(_MSC_VER)
+			{
+				int info[4];
+				__cpuid (info, 1);
+				return ((info[3] & (1 << 26)) != 0);
+			}
+#else
+			return (__builtin_cpu_supports ("sse2") != 0);
+#endif
+		case MONSTER_KERNEL_AVX2:
+			return (Cpu_Has_AVX2 ());
+#endif
+		default:
+			return (false);
+	}
+}
+
+#ifdef KERNEL_X86
+/*____________________________________________________________________
+|
+| Function: Cpu_Has_AVX2
+|
+| Input: Called from MonsterKernel_Supported()
+| Output: Returns true if the cpu and os support AVX2.
+|___________________________________________________________________*/
+
+static bool Cpu_Has_AVX2 ()
+{
+#ifdef _MSC_VER
+	int info[4];
+
+	__cpuid (info, 0);
+	if (info[0] < 7)
+		return (false);
+	// OS must save the ymm registers
+	__cpuid (info, 1);
+	if ((info[2] & (1 << 27)) == 0)
+		return (false);
+	if ((_xgetbv (0) & 6) != 6)
+		return (false);
+	__cpuidex (info, 7, 0);
+	return ((info[1] & (1 << 5)) != 0);
+#else
+	return (__builtin_cpu_supports ("avx2") != 0);
+#endif
+}
+#endif
+
+/*____________________________________________________________________
+|
+| Function: MonsterKernel_Name
+|
+| Input: Called from headless driver
+| Output: Returns a printable name for the kernel.
+|___________________________________________________________________*/
+
+const char *MonsterKernel_Name (MonsterKernelType type)
+{
+	switch (type) {
+		case MONSTER_KERNEL_SCALAR: return ("scalar");
+		case MONSTER_KERNEL_SSE2:   return ("sse2");
+		case MONSTER_KERNEL_AVX2:   return ("avx2");
+		default:                    return ("unknown");
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: MonsterKernel_Update
+|
+| Input: Called from World_Step(), headless driver
+| Output: Updates every monster in the pool.  Falls back to the scalar
+|   kernel if the requested one isn't supported.
+|___________________________________________________________________*/
+
+void MonsterKernel_Update (
+	MonsterKernelType          type,
+	MonsterPool               *pool,
+	const MonsterKernelParams *params,
+	MonsterKernelResult       *result )
+{
+	result->attackers = 0;
+	result->num_arrived = 0;
+
+	if (!MonsterKernel_Supported (type))
+		type = MONSTER_KERNEL_SCALAR;
+
+	switch (type) {
+#ifdef KERNEL_X86
+		case MONSTER_KERNEL_SSE2:
+			Update_SSE2 (pool, params, result);
+			break;
+		case MONSTER_KERNEL_AVX2:
+			Update_AVX2 (pool, params, result);
+			break;
+#endif
+		default:
+			Update_Scalar (pool, 0, params, result);
+			break;
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Update_Scalar
+|
+| Input: Called from MonsterKernel_Update(), Update_SSE2(), Update_AVX2()
+| Output: Updates monsters first thru count-1, one at a time.
+|___________________________________________________________________*/
+
+static void Update_Scalar (MonsterPool *pool, int first, const MonsterKernelParams *params, MonsterKernelResult *result)
+{
+	for (int k = first; k < pool->count; k++)
+		Update_One (pool, k, params, result);
+}
+
+/*____________________________________________________________________
+|
+| Function: Update_One
+|
+| Input: Called from Update_Scalar()
+| Output: Updates a single monster.  This is the reference the SIMD
+|   versions must match, operation for operation.
+|___________________________________________________________________*/
+
+static inline void Update_One (MonsterPool *pool, int k, const MonsterKernelParams *params, MonsterKernelResult *result)
+{
+	float mx = pool->x[k];
+	float mz = pool->z[k];
+	float speed = pool->speed[k] * params->time_step;
+	float seek_step = params->seek_speed * params->time_step;
+	float ex = params->event_x[pool->type[k]];
+	float ez = params->event_z[pool->type[k]];
+
+	// Distance to player
+	float dx = mx - params->player_x;
+	float dz = mz - params->player_z;
+	float dist = sqrtf ((dx * dx) + (dz * dz));
+
+	pool->growl[k] = 0;
+
+	// moves toward player if close or has been shot by player
+	if (dist < params->aggro_dist || pool->hits[k] > 0) {
+		if (dist > params->stop_dist) {
+			if (mx < params->player_x)
+				pool->x[k] = mx + speed;
+			else if (mx > params->player_x)
+				pool->x[k] = mx - speed;
+			if (mz < params->player_z)
+				pool->z[k] = mz + speed;
+			else if (mz > params->player_z)
+				pool->z[k] = mz - speed;
+		}
+		if (dist < params->attack_dist)
+			result->attackers++;
+		if (dist < params->growl_dist)
+			pool->growl[k] = 1;
+		return;
+	}
+
+	// otherwise move toward its event
+	float sx = mx - ex;
+	float sz = mz - ez;
+	float dist_e = sqrtf ((sx * sx) + (sz * sz));
+	pool->x[k] = mx + (((ex - mx) / dist_e) * seek_step);
+	pool->z[k] = mz + (((ez - mz) / dist_e) * seek_step);
+	if (dist_e < params->arrive_dist)
+		result->arrived[result->num_arrived++] = k;
+}
+
+#ifdef KERNEL_X86
+
+// Per lane select: mask ? a : b
+#define SELECT_PS(mask,a,b)    _mm_or_ps (_mm_and_ps (mask, a), _mm_andnot_ps (mask, b))
+#define SELECT256_PS(mask,a,b) _mm256_blendv_ps (b, a, mask)
+
+/*____________________________________________________________________
+|
+| Function: Update_SSE2
+|
+| Input: Called from MonsterKernel_Update()
+| Output: Updates monsters 4 at a time, remainder with the scalar
+|   version.
+|___________________________________________________________________*/
+
+static void Update_SSE2 (MonsterPool *pool, const MonsterKernelParams *params, MonsterKernelResult *result)
+{
+	const __m128 px     = _mm_set1_ps (params->player_x);
+	const __m128 pz     = _mm_set1_ps (params->player_z);
+	const __m128 aggro  = _mm_set1_ps (params->aggro_dist);
+	const __m128 stop   = _mm_set1_ps (params->stop_dist);
+	const __m128 attack = _mm_set1_ps (params->attack_dist);
+	const __m128 growl  = _mm_set1_ps (params->growl_dist);
+	const __m128 arrive = _mm_set1_ps (params->arrive_dist);
+	const __m128 step   = _mm_set1_ps (params->seek_speed * params->time_step);
+	const __m128 dt     = _mm_set1_ps (params->time_step);
+	const __m128i zero  = _mm_setzero_si128 ();
+	const float *evx = params->event_x;
+	const float *evz = params->event_z;
+	const unsigned char *type = pool->type;
+	int k, n = pool->count & ~3;
+
+	for (k = 0; k < n; k += 4) {
+		__m128 mx    = _mm_load_ps (pool->x + k);
+		__m128 mz    = _mm_load_ps (pool->z + k);
+		__m128 speed = _mm_mul_ps (_mm_load_ps (pool->speed + k), dt);
+		__m128i hits = _mm_load_si128 ((const __m128i *)(pool->hits + k));
+		__m128 ex    = _mm_set_ps (evx[type[k+3]], evx[type[k+2]], evx[type[k+1]], evx[type[k]]);
+		__m128 ez    = _mm_set_ps (evz[type[k+3]], evz[type[k+2]], evz[type[k+1]], evz[type[k]]);
+
+		// Distance to player
+		__m128 dx   = _mm_sub_ps (mx, px);
+		__m128 dz   = _mm_sub_ps (mz, pz);
+		__m128 dist = _mm_sqrt_ps (_mm_add_ps (_mm_mul_ps (dx, dx), _mm_mul_ps (dz, dz)));
+
+		__m128 chase = _mm_or_ps (_mm_cmplt_ps (dist, aggro), _mm_castsi128_ps (_mm_cmpgt_epi32 (hits, zero)));
+		__m128 move  = _mm_and_ps (chase, _mm_cmpgt_ps (dist, stop));
+
+		// Chase: step each axis toward the player
+		__m128 cx = SELECT_PS (_mm_cmplt_ps (mx, px), _mm_add_ps (mx, speed), SELECT_PS (_mm_cmpgt_ps (mx, px), _mm_sub_ps (mx, speed), mx));
+		__m128 cz = SELECT_PS (_mm_cmplt_ps (mz, pz), _mm_add_ps (mz, speed), SELECT_PS (_mm_cmpgt_ps (mz, pz), _mm_sub_ps (mz, speed), mz));
+		cx = SELECT_PS (move, cx, mx);
+		cz = SELECT_PS (move, cz, mz);
+
+		// Seek: step toward the event
+		__m128 sx     = _mm_sub_ps (mx, ex);
+		__m128 sz     = _mm_sub_ps (mz, ez);
+		__m128 dist_e = _mm_sqrt_ps (_mm_add_ps (_mm_mul_ps (sx, sx), _mm_mul_ps (sz, sz)));
+		__m128 nx     = _mm_add_ps (mx, _mm_mul_ps (_mm_div_ps (_mm_sub_ps (ex, mx), dist_e), step));
+		__m128 nz     = _mm_add_ps (mz, _mm_mul_ps (_mm_div_ps (_mm_sub_ps (ez, mz), dist_e), step));
+
+		_mm_store_ps (pool->x + k, SELECT_PS (chase, cx, nx));
+		_mm_store_ps (pool->z + k, SELECT_PS (chase, cz, nz));
+
+		Store_Masks (pool, k, 4,
+			_mm_movemask_ps (_mm_and_ps (chase, _mm_cmplt_ps (dist, attack))),
+			_mm_movemask_ps (_mm_and_ps (chase, _mm_cmplt_ps (dist, growl))),
+			_mm_movemask_ps (_mm_andnot_ps (chase, _mm_cmplt_ps (dist_e, arrive))),
+			result);
+	}
+
+	Update_Scalar (pool, n, params, result);
+}
+
+/*____________________________________________________________________
+|
+| Function: Update_AVX2
+|
+| Input: Called from MonsterKernel_Update()
+| Output: Updates monsters 8 at a time, remainder with the scalar
+|   version.
+|___________________________________________________________________*/
+
+TARGET_AVX2 static void Update_AVX2 (MonsterPool *pool, const MonsterKernelParams *params, MonsterKernelResult *result)
+{
+	const __m256 px     = _mm256_set1_ps (params->player_x);
+	const __m256 pz     = _mm256_set1_ps (params->player_z);
+	const __m256 aggro  = _mm256_set1_ps (params->aggro_dist);
+	const __m256 stop   = _mm256_set1_ps (params->stop_dist);
+	const __m256 attack = _mm256_set1_ps (params->attack_dist);
+	const __m256 growl  = _mm256_set1_ps (params->growl_dist);
+	const __m256 arrive = _mm256_set1_ps (params->arrive_dist);
+	const __m256 step   = _mm256_set1_ps (params->seek_speed * params->time_step);
+	const __m256 dt     = _mm256_set1_ps (params->time_step);
+	const __m256i zero  = _mm256_setzero_si256 ();
+	const float *evx = params->event_x;
+	const float *evz = params->event_z;
+	const unsigned char *type = pool->type;
+	int k, n = pool->count & ~7;
+
+	for (k = 0; k < n; k += 8) {
+		__m256 mx    = _mm256_load_ps (pool->x + k);
+		__m256 mz    = _mm256_load_ps (pool->z + k);
+		__m256 speed = _mm256_mul_ps (_mm256_load_ps (pool->speed + k), dt);
+		__m256i hits = _mm256_load_si256 ((const __m256i *)(pool->hits + k));
+		__m256 ex    = _mm256_set_ps (evx[type[k+7]], evx[type[k+6]], evx[type[k+5]], evx[type[k+4]],
+		                              evx[type[k+3]], evx[type[k+2]], evx[type[k+1]], evx[type[k]]);
+		__m256 ez    = _mm256_set_ps (evz[type[k+7]], evz[type[k+6]], evz[type[k+5]], evz[type[k+4]],
+		                              evz[type[k+3]], evz[type[k+2]], evz[type[k+1]], evz[type[k]]);
+
+		// Distance to player
+		__m256 dx   = _mm256_sub_ps (mx, px);
+		__m256 dz   = _mm256_sub_ps (mz, pz);
+		__m256 dist = _mm256_sqrt_ps (_mm256_add_ps (_mm256_mul_ps (dx, dx), _mm256_mul_ps (dz, dz)));
+
+		__m256 chase = _mm256_or_ps (_mm256_cmp_ps (dist, aggro, _CMP_LT_OQ), _mm256_castsi256_ps (_mm256_cmpgt_epi32 (hits, zero)));
+		__m256 move  = _mm256_and_ps (chase, _mm256_cmp_ps (dist, stop, _CMP_GT_OQ));
+
+		// Chase: step each axis toward the player
+		__m256 cx = SELECT256_PS (_mm256_cmp_ps (mx, px, _CMP_LT_OQ), _mm256_add_ps (mx, speed),
+		                          SELECT256_PS (_mm256_cmp_ps (mx, px, _CMP_GT_OQ), _mm256_sub_ps (mx, speed), mx));
+		__m256 cz = SELECT256_PS (_mm256_cmp_ps (mz, pz, _CMP_LT_OQ), _mm256_add_ps (mz, speed),
+		                          SELECT256_PS (_mm256_cmp_ps (mz, pz, _CMP_GT_OQ), _mm256_sub_ps (mz, speed), mz));
+		cx = SELECT256_PS (move, cx, mx);
+		cz = SELECT256_PS (move, cz, mz);
+
+		// Seek: step toward the event
+		__m256 sx     = _mm256_sub_ps (mx, ex);
+		__m256 sz     = _mm256_sub_ps (mz, ez);
+		__m256 dist_e = _mm256_sqrt_ps (_mm256_add_ps (_mm256_mul_ps (sx, sx), _mm256_mul_ps (sz, sz)));
+		__m256 nx     = _mm256_add_ps (mx, _mm256_mul_ps (_mm256_div_ps (_mm256_sub_ps (ex, mx), dist_e), step));
+		__m256 nz     = _mm256_add_ps (mz, _mm256_mul_ps (_mm256_div_ps (_mm256_sub_ps (ez, mz), dist_e), step));
+
+		_mm256_store_ps (pool->x + k, SELECT256_PS (chase, cx, nx));
+		_mm256_store_ps (pool->z + k, SELECT256_PS (chase, cz, nz));
+
+		Store_Masks (pool, k, 8,
+			_mm256_movemask_ps (_mm256_and_ps (chase, _mm256_cmp_ps (dist, attack, _CMP_LT_OQ))),
+			_mm256_movemask_ps (_mm256_and_ps (chase, _mm256_cmp_ps (dist, growl, _CMP_LT_OQ))),
+			_mm256_movemask_ps (_mm256_andnot_ps (chase, _mm256_cmp_ps (dist_e, arrive, _CMP_LT_OQ))),
+			result);
+	}
+
+	Update_Scalar (pool, n, params, result);
+}
+
+/*____________________________________________________________________
+|
+| Function: Store_Masks
+|
+| Input: Called from Update_SSE2(), Update_AVX2()
+| Output: Writes per lane results (1 bit per lane) for monsters k thru
+|   k+lanes-1.
+|___________________________________________________________________*/
+
+static inline void Store_Masks (MonsterPool *pool, int k, int lanes, int attack, int growl, int arrived, MonsterKernelResult *result)
+{
+	for (int i = 0; i < lanes; i++) {
+		pool->growl[k+i] = (unsigned char)((growl >> i) & 1);
+		result->attackers += (attack >> i) & 1;
+		if ((arrived >> i) & 1)
+			result->arrived[result->num_arrived++] = k + i;
+	}
+}
+
+#endif
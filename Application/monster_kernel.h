@@ -0,0 +1,70 @@
+/*____________________________________________________________________
+|
+| File: monster_kernel.h
+|
+| Description: Batch update of every monster in a pool: distance to the
+|   player, chase/seek decision, movement and damage.  Has a scalar
+|   version and SSE2/AVX2 versions that produce bit identical results,
+|   chosen at runtime based on what the cpu supports.
+|
+|   Must be compiled without floating point contraction (no fused
+|   multiply-add, e.g. gcc -ffp-contract=off, msvc /fp:precise) for the
+|   versions to match exactly.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _MONSTER_KERNEL_H_
+#define _MONSTER_KERNEL_H_
+
+#include "monster_pool.h"
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef enum {
+	MONSTER_KERNEL_SCALAR,
+	MONSTER_KERNEL_SSE2,
+	MONSTER_KERNEL_AVX2
+} MonsterKernelType;
+
+typedef struct {
+	float        player_x, player_z;
+	const float *event_x;        // seek target of each monster type
+	const float *event_z;
+	float        aggro_dist;     // chase the player if closer than this (or shot)
+	float        stop_dist;      // stop moving if closer than this to the player
+	float        attack_dist;    // damage the player if closer than this
+	float        growl_dist;     // growl if chasing and closer than this
+	float        arrive_dist;    // seeking monster has reached its target if closer than this
+	float        seek_speed;     // units per second when seeking (chase speed is per monster)
+	float        time_step;      // seconds per update
+} MonsterKernelParams;
+
+typedef struct {
+	int  attackers;              // # of monsters close enough to damage the player
+	int *arrived;                // caller supplied, room for pool->count indices
+	int  num_arrived;            // # of indices (ascending) written to arrived
+} MonsterKernelResult;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+// Returns the fastest kernel the cpu supports
+MonsterKernelType MonsterKernel_Best ();
+bool              MonsterKernel_Supported (MonsterKernelType type);
+const char       *MonsterKernel_Name (MonsterKernelType type);
+
+// Updates all monsters in the pool (moves them, sets their growl flag)
+void MonsterKernel_Update (
+	MonsterKernelType          type,
+	MonsterPool               *pool,
+	const MonsterKernelParams *params,
+	MonsterKernelResult       *result );
+
+#endif
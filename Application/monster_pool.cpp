@@ -0,0 +1,223 @@
+/*____________________________________________________________________
+|
+| File: monster_pool.cpp
+|
+| Description: Structure of arrays storage for monsters.
+|
+| Functions: MonsterPool_Init
+|            MonsterPool_Free
+|            MonsterPool_Reserve
+|             Layout_Arrays
+|            MonsterPool_Add
+|            MonsterPool_Place
+|            MonsterPool_Remove
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mem_align.h"
+#include "monster_pool.h"
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static size_t Layout_Arrays (MonsterPool *pool, char *block, int capacity);
+
+/*____________________________________________________________________
+|
+| Function: MonsterPool_Init
+|
+| Input: Called from World_Init()
+| Output: Creates an empty pool with room for capacity monsters.
+|   Returns true on success, else false.
+|___________________________________________________________________*/
+
+bool MonsterPool_Init (MonsterPool *pool, int capacity)
+{
+	memset (pool, 0, sizeof(MonsterPool));
+
+	return (MonsterPool_Reserve (pool, capacity));
+}
+
+/*____________________________________________________________________
+|
+| Function: MonsterPool_Free
+|
+| Input: Called from World_Free()
+| Output: Frees all memory used by the pool.
+|___________________________________________________________________*/
+
+void MonsterPool_Free (MonsterPool *pool)
+{
+	if (pool->block)
+		Aligned_Free (pool->block);
+	memset (pool, 0, sizeof(MonsterPool));
+}
+
+/*____________________________________________________________________
+|
+| Function: MonsterPool_Reserve
+|
+| Input: Called from MonsterPool_Init(), MonsterPool_Add(), World
+| Output: Grows the pool to hold at least capacity monsters.  Returns
+|   true on success, else false (pool unchanged).
+|___________________________________________________________________*/
+
+bool MonsterPool_Reserve (MonsterPool *pool, int capacity)
+{
+	MonsterPool old;
+	char *block;
+	size_t size;
+
+	if (capacity <= pool->capacity)
+		return (true);
+
+	capacity = ALIGN_UP (capacity, MONSTER_POOL_GRANULARITY);
+
+	// Allocate one block for all the arrays
+	size = Layout_Arrays (pool, NULL, capacity);
+	block = (char *) Aligned_Malloc (size);
+	if (block == NULL)
+		return (false);
+	memset (block, 0, size);
+
+	// Move current monsters over to the new arrays
+	old = *pool;
+	Layout_Arrays (pool, block, capacity);
+	if (old.count) {
+		memcpy (pool->x,     old.x,     old.count * sizeof(float));
+		memcpy (pool->z,     old.z,     old.count * sizeof(float));
+		memcpy (pool->prev_x, old.prev_x, old.count * sizeof(float));
+		memcpy (pool->prev_z, old.prev_z, old.count * sizeof(float));
+		memcpy (pool->speed, old.speed, old.count * sizeof(float));
+		memcpy (pool->hits,  old.hits,  old.count * sizeof(int));
+		memcpy (pool->type,  old.type,  old.count * sizeof(unsigned char));
+		memcpy (pool->growl, old.growl, old.count * sizeof(unsigned char));
+	}
+	if (old.block)
+		Aligned_Free (old.block);
+
+	pool->block = block;
+	pool->capacity = capacity;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Layout_Arrays
+|
+| Input: Called from MonsterPool_Reserve()
+| Output: Returns the size of a block big enough for all the arrays,
+|   each starting on a cache line.  If block is not NULL, also sets the
+|   array pointers in pool.
+|___________________________________________________________________*/
+
+static size_t Layout_Arrays (MonsterPool *pool, char *block, int capacity)
+{
+	size_t offset = 0;
+
+#define PLACE_ARRAY(field,type)                                   \
+	if (block)                                                      \
+		pool->field = (type *)(block + offset);                       \
+	offset += ALIGN_UP (capacity * sizeof(type), CACHE_LINE_SIZE);
+
+	PLACE_ARRAY (x,     float)
+	PLACE_ARRAY (z,     float)
+	PLACE_ARRAY (prev_x, float)
+	PLACE_ARRAY (prev_z, float)
+	PLACE_ARRAY (speed, float)
+	PLACE_ARRAY (hits,  int)
+	PLACE_ARRAY (type,  unsigned char)
+	PLACE_ARRAY (growl, unsigned char)
+
+#undef PLACE_ARRAY
+
+	return (offset);
+}
+
+/*____________________________________________________________________
+|
+| Function: MonsterPool_Add
+|
+| Input: Called from World
+| Output: Adds a monster to the end of the pool, growing it if needed.
+|   Returns index of the new monster or -1 on error.
+|___________________________________________________________________*/
+
+int MonsterPool_Add (MonsterPool *pool, int type, float x, float z, float speed)
+{
+	int n = pool->count;
+
+	if (n == pool->capacity)
+		if (!MonsterPool_Reserve (pool, pool->capacity ? pool->capacity * 2 : MONSTER_POOL_GRANULARITY))
+			return (-1);
+
+	pool->x[n]     = x;
+	pool->z[n]     = z;
+	pool->prev_x[n] = x;
+	pool->prev_z[n] = z;
+	pool->speed[n] = speed;
+	pool->hits[n]  = 0;
+	pool->type[n]  = (unsigned char) type;
+	pool->growl[n] = 0;
+	pool->count++;
+
+	return (n);
+}
+
+/*____________________________________________________________________
+|
+| Function: MonsterPool_Place
+|
+| Input: Called from World
+| Output: Moves a monster to x,z.  Its previous position is set there
+|   too so rendering doesn't interpolate across the jump.
+|___________________________________________________________________*/
+
+void MonsterPool_Place (MonsterPool *pool, int index, float x, float z)
+{
+	pool->x[index] = x;
+	pool->z[index] = z;
+	pool->prev_x[index] = x;
+	pool->prev_z[index] = z;
+}
+
+/*____________________________________________________________________
+|
+| Function: MonsterPool_Remove
+|
+| Input: Called from World
+| Output: Removes a monster by moving the last monster into its slot.
+|___________________________________________________________________*/
+
+void MonsterPool_Remove (MonsterPool *pool, int index)
+{
+	int last = pool->count - 1;
+
+	if (index < 0 || index > last)
+		return;
+
+	if (index != last) {
+		pool->x[index]     = pool->x[last];
+		pool->z[index]     = pool->z[last];
+		pool->prev_x[index] = pool->prev_x[last];
+		pool->prev_z[index] = pool->prev_z[last];
+		pool->speed[index] = pool->speed[last];
+		pool->hits[index]  = pool->hits[last];
+		pool->type[index]  = pool->type[last];
+		pool->growl[index] = pool->growl[last];
+	}
+	pool->count--;
+}
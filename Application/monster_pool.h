@@ -0,0 +1,60 @@
+/*____________________________________________________________________
+|
+| File: monster_pool.h
+|
+| Description: Structure of arrays storage for monsters.  Every field
+|   is a separate cache line aligned array so per-frame loops walk
+|   dense memory.  Capacity grows at runtime and removal is a swap with
+|   the last monster so the arrays never have holes.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _MONSTER_POOL_H_
+#define _MONSTER_POOL_H_
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+// Capacity is always a multiple of this so batch kernels can run past count
+#define MONSTER_POOL_GRANULARITY 16
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	float         *x;
+	float         *z;
+	float         *prev_x;    // position before the last simulation step, for render interpolation
+	float         *prev_z;
+	float         *speed;     // chase speed, units per second
+	int           *hits;      // # of times shot
+	unsigned char *type;
+	unsigned char *growl;     // true if monster should be making noise
+	int            count;
+	int            capacity;
+	void          *block;     // single allocation holding all the arrays
+} MonsterPool;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+bool MonsterPool_Init (MonsterPool *pool, int capacity);
+void MonsterPool_Free (MonsterPool *pool);
+// Grows capacity to at least the requested size, keeping current monsters
+bool MonsterPool_Reserve (MonsterPool *pool, int capacity);
+// Returns index of the new monster or -1 on error
+int  MonsterPool_Add (MonsterPool *pool, int type, float x, float z, float speed);
+// Sets a monster's position with no interpolation from where it was (spawns, teleports)
+void MonsterPool_Place (MonsterPool *pool, int index, float x, float z);
+// Moves the last monster into the removed slot
+void MonsterPool_Remove (MonsterPool *pool, int index);
+
+#endif
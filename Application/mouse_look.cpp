@@ -0,0 +1,105 @@
+/*____________________________________________________________________
+|
+| File: mouse_look.cpp
+|
+| Description: Mouse look curves and accumulation.
+|
+| Functions: MouseLook_Init
+|            MouseLook_Add
+|            MouseLook_Take
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <string.h>
+#include <math.h>
+
+#include "mouse_look.h"
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+// Speed is measured over at least this long, so a count read alone at a
+//   high frame rate doesn't look like a fast move
+#define SPEED_WINDOW_MS  16.0f
+// Longest time a sample is taken to cover (the first, or after a stall)
+#define MAX_SAMPLE_MS    50.0f
+
+/*____________________________________________________________________
+|
+| Function: MouseLook_Init
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Sets up mouse look with curve and no movement.
+|___________________________________________________________________*/
+
+void MouseLook_Init (MouseLook *look, const MouseCurve *curve)
+{
+	memset (look, 0, sizeof(MouseLook));
+	look->curve = *curve;
+}
+
+/*____________________________________________________________________
+|
+| Function: MouseLook_Add
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Works out how fast the mouse has been moving, over the last
+|   SPEED_WINDOW_MS or the time since the last sample if longer, and
+|   adds the sample's movement times the curve's gain at that speed to
+|   the turn not yet taken.
+|___________________________________________________________________*/
+
+void MouseLook_Add (MouseLook *look, int dx, int dy, ProfileTime time)
+{
+	const MouseCurve *curve = &look->curve;
+	float ms = MAX_SAMPLE_MS, gain = 1;
+
+	// Slide the window on to this sample, keeping it at least SPEED_WINDOW_MS long
+	if (look->last_time != 0 && time > look->last_time && time - look->last_time < (ProfileTime)(MAX_SAMPLE_MS * 1e6))
+		ms = (float)((double)(time - look->last_time) / 1e6);
+	look->window_counts += sqrtf ((float)dx * dx + (float)dy * dy);
+	look->window_ms += ms;
+	if (look->window_ms > SPEED_WINDOW_MS) {
+		look->window_counts *= SPEED_WINDOW_MS / look->window_ms;
+		look->window_ms = SPEED_WINDOW_MS;
+	}
+
+	if (dx || dy) {
+		if (curve->acceleration != 0) {
+			float speed = look->window_counts / SPEED_WINDOW_MS - curve->threshold;
+			if (speed > 0)
+				gain += curve->acceleration * powf (speed, curve->exponent);
+			if (curve->max_gain > 0 && gain > curve->max_gain)
+				gain = curve->max_gain;
+		}
+		look->yaw += dx * curve->sensitivity * gain;
+		look->pitch += (curve->invert_y ? -dy : dy) * curve->sensitivity * gain;
+	}
+	look->last_time = time;
+}
+
+/*____________________________________________________________________
+|
+| Function: MouseLook_Take
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Returns the turn added up since the last take, in degrees,
+|   and starts over.
+|___________________________________________________________________*/
+
+void MouseLook_Take (MouseLook *look, float *yaw, float *pitch)
+{
+	*yaw = look->yaw;
+	*pitch = look->pitch;
+	look->yaw = 0;
+	look->pitch = 0;
+}
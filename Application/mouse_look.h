@@ -0,0 +1,62 @@
+/*____________________________________________________________________
+|
+| File: mouse_look.h
+|
+| Description: Turns raw mouse movement into camera turns.  Each sample
+|   of movement (counts, as often as the device is read) goes through
+|   a sensitivity and acceleration curve, by how fast the mouse moved
+|   over the last few ms, and the turn adds up in floating point until the camera takes it.
+|   Nothing is rounded to whole counts or degrees along the way, so
+|   slow movement isn't lost, and since the curve goes by the speed and
+|   not the size of a sample, the turn for a movement is the same at
+|   any frame rate.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _MOUSE_LOOK_H_
+#define _MOUSE_LOOK_H_
+
+#include "profile.h"
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+// Degrees per count = sensitivity * gain, gain = 1 + acceleration * (speed - threshold) ^ exponent,
+//   speed in counts per ms, no more than max_gain
+typedef struct {
+	float sensitivity;         // degrees per count, slow movement
+	float acceleration;        // 0 for none
+	float exponent;            // 1 is linear in speed
+	float threshold;           // counts per ms before acceleration starts
+	float max_gain;            // 0 for no limit
+	bool  invert_y;            // mouse forward looks down
+} MouseCurve;
+
+typedef struct {
+	MouseCurve  curve;
+	float       yaw;           // degrees not yet taken, turning right is positive
+	float       pitch;         // looking down is positive
+	ProfileTime last_time;     // of the last sample, 0 if none
+	float       window_counts; // movement over the last window_ms, for the speed
+	float       window_ms;
+} MouseLook;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+void MouseLook_Init (MouseLook *look, const MouseCurve *curve);
+
+// Adds a sample of movement read at time.  Add every read, even with no
+//   movement, so the next sample's speed is over the right time.
+void MouseLook_Add (MouseLook *look, int dx, int dy, ProfileTime time);
+
+// Returns the turn added up since the last take (degrees) and starts over
+void MouseLook_Take (MouseLook *look, float *yaw, float *pitch);
+
+#endif
@@ -0,0 +1,101 @@
+/*____________________________________________________________________
+|
+| File: packer.cpp
+|
+| Description: Offline tool that converts the game's asset files into
+|   an asset pack.  Only needs the platform independent modules:
+|
+|     g++ -O2 -o packer packer.cpp asset_convert.cpp asset_pack.cpp
+|
+|   Usage: packer list_file pack_file
+|     list_file has one asset per line: the file, then for a texture
+|     with alpha, its alpha file.  Lines starting with # are skipped.
+|
+|     Objects\monster1.lwo
+|     Objects\Images\zombie.bmp Objects\Images\zombie_fa.bmp
+|     wav\walk.wav
+|
+| Functions: main
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "asset_pack.h"
+#include "asset_convert.h"
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define MAX_ASSETS 1024
+
+/*____________________________________________________________________
+|
+| Function: main
+|
+| Input: Command line (see top of file)
+| Output: Converts every listed asset and writes the pack.  Returns 0 on
+|   success, else 1 (nothing is written if any asset fails).
+|___________________________________________________________________*/
+
+int main (int argc, char **argv)
+{
+	static AssetPackEntry entries[MAX_ASSETS];
+	static unsigned char *data[MAX_ASSETS];
+	char line[2 * ASSET_PACK_MAX_NAME + 2], file[ASSET_PACK_MAX_NAME], alt_file[ASSET_PACK_MAX_NAME];
+	int num_entries = 0, errors = 0;
+	unsigned long long total = 0;
+	FILE *fp;
+
+	if (argc != 3) {
+		fprintf (stderr, "usage: packer list_file pack_file\n");
+		return (1);
+	}
+	fp = fopen (argv[1], "r");
+	if (fp == NULL) {
+		fprintf (stderr, "can't read %s\n", argv[1]);
+		return (1);
+	}
+	while (fgets (line, sizeof(line), fp)) {
+		int n;
+		alt_file[0] = 0;
+		n = sscanf (line, "%95s %95s", file, alt_file);
+		if (n < 1 || file[0] == '#')
+			continue;
+		if (num_entries == MAX_ASSETS) {
+			fprintf (stderr, "too many assets (most is %d)\n", MAX_ASSETS);
+			errors++;
+			break;
+		}
+		if (!AssetConvert_File (file, n == 2 ? alt_file : NULL, &entries[num_entries], &data[num_entries])) {
+			fprintf (stderr, "can't convert %s\n", file);
+			errors++;
+			continue;
+		}
+		total += entries[num_entries].size;
+		num_entries++;
+	}
+	fclose (fp);
+
+	if (errors == 0 && !AssetPack_Write (argv[2], entries, (const void * const *) data, num_entries)) {
+		fprintf (stderr, "can't write %s (or an asset is listed twice)\n", argv[2]);
+		errors++;
+	}
+	if (errors == 0)
+		printf ("%d assets, %.1f MB\n", num_entries, total / 1048576.0);
+	for (int i = 0; i < num_entries; i++)
+		free (data[i]);
+
+	return (errors ? 1 : 0);
+}
@@ -0,0 +1,377 @@
+/*____________________________________________________________________
+|
+| File: particles.cpp
+|
+| Description: Pooled particle engine.
+|
+| Functions: Particle_Init
+|            Particle_Free
+|            Particle_Add_Effect
+|            Particle_Create_Emitter
+|            Particle_Move_Emitter
+|            Particle_Stop_Emitter
+|            Particle_Cull
+|            Particle_Update
+|             Emit
+|             Move_Particles
+|            Particle_Draw
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mem_align.h"
+#include "particles.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define PARTICLE_SSE2
+#include <emmintrin.h>
+#endif
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static void Emit (ParticleEngine *engine, int id, int count);
+static void Move_Particles (ParticleEngine *engine, float seconds);
+
+/*____________________________________________________________________
+|
+| Function: Particle_Init
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Creates an engine with room for capacity particles (none
+|   are made if 0) and max_emitters emitters, all allocated here.
+|   Returns true on success, else false.
+|___________________________________________________________________*/
+
+bool Particle_Init (ParticleEngine *engine, int capacity, int max_emitters, unsigned long long seed)
+{
+	size_t offset = 0;
+	char *arena;
+
+	memset (engine, 0, sizeof(ParticleEngine));
+	capacity = ALIGN_UP (capacity, PARTICLE_GRANULARITY);
+
+#define PLACE_ARRAY(field,type)                                   \
+	if (arena)                                                      \
+		engine->field = (type *)(arena + offset);                     \
+	offset += ALIGN_UP (capacity * sizeof(type), CACHE_LINE_SIZE);
+#define PLACE_ARRAYS                                              \
+	PLACE_ARRAY (x,       float)                                    \
+	PLACE_ARRAY (y,       float)                                    \
+	PLACE_ARRAY (z,       float)                                    \
+	PLACE_ARRAY (vx,      float)                                    \
+	PLACE_ARRAY (vy,      float)                                    \
+	PLACE_ARRAY (vz,      float)                                    \
+	PLACE_ARRAY (gravity, float)                                    \
+	PLACE_ARRAY (age,     float)                                    \
+	PLACE_ARRAY (life,    float)                                    \
+	PLACE_ARRAY (emitter, int)
+
+	// Size the arena, then lay the arrays out in it
+	arena = NULL;
+	PLACE_ARRAYS
+	// No arena for an engine that only culls emitters
+	if (offset) {
+		arena = (char *) Aligned_Malloc (offset);
+		if (arena == NULL)
+			return (false);
+		memset (arena, 0, offset);
+		offset = 0;
+		PLACE_ARRAYS
+	}
+
+#undef PLACE_ARRAYS
+#undef PLACE_ARRAY
+
+	engine->arena = arena;
+	engine->capacity = capacity;
+
+	engine->emitters = (ParticleEmitter *) calloc (max_emitters > 0 ? max_emitters : 1, sizeof(ParticleEmitter));
+	if (engine->emitters == NULL) {
+		Particle_Free (engine);
+		return (false);
+	}
+	engine->max_emitters = max_emitters;
+	Rng_Seed (&engine->rng, seed, RNG_STREAM_EFFECTS);
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Particle_Free
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Frees all memory used by the engine.
+|___________________________________________________________________*/
+
+void Particle_Free (ParticleEngine *engine)
+{
+	if (engine->arena)
+		Aligned_Free (engine->arena);
+	free (engine->emitters);
+	memset (engine, 0, sizeof(ParticleEngine));
+}
+
+/*____________________________________________________________________
+|
+| Function: Particle_Add_Effect
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Returns the id of a new effect or -1 if there are too many.
+|___________________________________________________________________*/
+
+int Particle_Add_Effect (ParticleEngine *engine, const ParticleEffect *effect)
+{
+	if (engine->num_effects == PARTICLE_MAX_EFFECTS)
+		return (-1);
+	engine->effects[engine->num_effects] = *effect;
+
+	return (engine->num_effects++);
+}
+
+/*____________________________________________________________________
+|
+| Function: Particle_Create_Emitter
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Returns the id of a new emitter or -1 if there are too many.
+|   New emitters are visible until the first cull.
+|___________________________________________________________________*/
+
+int Particle_Create_Emitter (ParticleEngine *engine, int effect, float x, float y, float z)
+{
+	ParticleEmitter *e;
+
+	if (engine->num_emitters == engine->max_emitters || effect < 0 || effect >= engine->num_effects)
+		return (-1);
+
+	e = &engine->emitters[engine->num_emitters];
+	e->effect = effect;
+	e->x = x;
+	e->y = y;
+	e->z = z;
+	e->owed = 0;
+	e->active = true;
+	e->visible = true;
+
+	return (engine->num_emitters++);
+}
+
+/*____________________________________________________________________
+|
+| Function: Particle_Move_Emitter
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Moves where an emitter makes particles.  Particles already
+|   made stay where they are.
+|___________________________________________________________________*/
+
+void Particle_Move_Emitter (ParticleEngine *engine, int emitter, float x, float y, float z)
+{
+	ParticleEmitter *e = &engine->emitters[emitter];
+
+	e->x = x;
+	e->y = y;
+	e->z = z;
+}
+
+/*____________________________________________________________________
+|
+| Function: Particle_Stop_Emitter
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Stops an emitter making particles.
+|___________________________________________________________________*/
+
+void Particle_Stop_Emitter (ParticleEngine *engine, int emitter)
+{
+	engine->emitters[emitter].active = false;
+	engine->emitters[emitter].owed = 0;
+}
+
+/*____________________________________________________________________
+|
+| Function: Particle_Cull
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Marks each emitter visible if the sphere its particles stay
+|   in touches the frustum.
+|___________________________________________________________________*/
+
+void Particle_Cull (ParticleEngine *engine, const Frustum *frustum)
+{
+	for (int i = 0; i < engine->num_emitters; i++) {
+		ParticleEmitter *e = &engine->emitters[i];
+		float center[3] = { e->x, e->y, e->z };
+		e->visible = Frustum_Test_Sphere (frustum, center, engine->effects[e->effect].radius) != FRUSTUM_OUTSIDE;
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Particle_Update
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Makes the particles each active, visible emitter owes for
+|   this much time, moves every particle once, then removes the dead
+|   ones (moving the last particle into the hole, so the arrays stay
+|   dense).
+|___________________________________________________________________*/
+
+void Particle_Update (ParticleEngine *engine, float seconds)
+{
+	int n;
+
+	for (int i = 0; i < engine->num_emitters; i++) {
+		ParticleEmitter *e = &engine->emitters[i];
+		if (!e->active || !e->visible)
+			continue;
+		e->owed += engine->effects[e->effect].rate * seconds;
+		n = (int) e->owed;
+		if (n > 0) {
+			e->owed -= n;
+			Emit (engine, i, n);
+		}
+	}
+
+	Move_Particles (engine, seconds);
+
+	for (int i = 0; i < engine->count; ) {
+		if (engine->age[i] < engine->life[i]) {
+			i++;
+			continue;
+		}
+		n = --engine->count;
+		engine->x[i]       = engine->x[n];
+		engine->y[i]       = engine->y[n];
+		engine->z[i]       = engine->z[n];
+		engine->vx[i]      = engine->vx[n];
+		engine->vy[i]      = engine->vy[n];
+		engine->vz[i]      = engine->vz[n];
+		engine->gravity[i] = engine->gravity[n];
+		engine->age[i]     = engine->age[n];
+		engine->life[i]    = engine->life[n];
+		engine->emitter[i] = engine->emitter[n];
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Emit
+|
+| Input: Called from Particle_Update()
+| Output: Adds count new particles at an emitter, as many as fit.
+|___________________________________________________________________*/
+
+static void Emit (ParticleEngine *engine, int id, int count)
+{
+	const ParticleEmitter *e = &engine->emitters[id];
+	const ParticleEffect *effect = &engine->effects[e->effect];
+	float side = effect->speed * effect->spread;
+
+	if (count > engine->capacity - engine->count) {
+		engine->dropped += count - (engine->capacity - engine->count);
+		count = engine->capacity - engine->count;
+	}
+	for (int i = 0; i < count; i++) {
+		int p = engine->count++;
+		engine->x[p]       = e->x + Rng_Float_Range (&engine->rng, -effect->jitter, effect->jitter);
+		engine->y[p]       = e->y;
+		engine->z[p]       = e->z + Rng_Float_Range (&engine->rng, -effect->jitter, effect->jitter);
+		engine->vx[p]      = Rng_Float_Range (&engine->rng, -side, side);
+		engine->vy[p]      = effect->speed;
+		engine->vz[p]      = Rng_Float_Range (&engine->rng, -side, side);
+		engine->gravity[p] = effect->gravity;
+		engine->age[p]     = 0;
+		engine->life[p]    = effect->life * Rng_Float_Range (&engine->rng, 0.75f, 1.25f);
+		engine->emitter[p] = id;
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Move_Particles
+|
+| Input: Called from Particle_Update()
+| Output: Ages every particle and moves it by its velocity (velocity
+|   first picks up gravity), 4 at a time where there's SSE2.  Dead ones
+|   are moved too, they're removed right after.
+|___________________________________________________________________*/
+
+static void Move_Particles (ParticleEngine *engine, float seconds)
+{
+	int i = 0;
+
+#ifdef PARTICLE_SSE2
+	// Capacity is a multiple of 4, so the last group can run past count
+	__m128 dt = _mm_set1_ps (seconds);
+	for (; i < engine->count; i += 4) {
+		__m128 vx = _mm_load_ps (engine->vx + i);
+		__m128 vy = _mm_sub_ps (_mm_load_ps (engine->vy + i), _mm_mul_ps (_mm_load_ps (engine->gravity + i), dt));
+		__m128 vz = _mm_load_ps (engine->vz + i);
+		_mm_store_ps (engine->vy + i, vy);
+		_mm_store_ps (engine->x + i, _mm_add_ps (_mm_load_ps (engine->x + i), _mm_mul_ps (vx, dt)));
+		_mm_store_ps (engine->y + i, _mm_add_ps (_mm_load_ps (engine->y + i), _mm_mul_ps (vy, dt)));
+		_mm_store_ps (engine->z + i, _mm_add_ps (_mm_load_ps (engine->z + i), _mm_mul_ps (vz, dt)));
+		_mm_store_ps (engine->age + i, _mm_add_ps (_mm_load_ps (engine->age + i), dt));
+	}
+#endif
+
+	for (; i < engine->count; i++) {
+		engine->vy[i] -= engine->gravity[i] * seconds;
+		engine->x[i] += engine->vx[i] * seconds;
+		engine->y[i] += engine->vy[i] * seconds;
+		engine->z[i] += engine->vz[i] * seconds;
+		engine->age[i] += seconds;
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Particle_Draw
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Queues a camera facing quad, sized for its age, for each
+|   particle whose emitter is visible.  Returns the # queued.
+|___________________________________________________________________*/
+
+int Particle_Draw (const ParticleEngine *engine, RenderQueue *queue, RenderObject quad, const RenderTexture *textures, const float *billboard)
+{
+	float m[16];
+	int drawn = 0;
+
+	memcpy (m, billboard, sizeof(m));
+	m[15] = 1;
+	for (int i = 0; i < engine->count; i++) {
+		const ParticleEmitter *e = &engine->emitters[engine->emitter[i]];
+		const ParticleEffect *effect = &engine->effects[e->effect];
+		if (!e->visible)
+			continue;
+		// Uniform scale times the billboard rotation, then the position
+		float size = effect->size_start + (effect->size_end - effect->size_start) * (engine->age[i] / engine->life[i]);
+		for (int r = 0; r < 3; r++) {
+			m[r * 4 + 0] = billboard[r * 4 + 0] * size;
+			m[r * 4 + 1] = billboard[r * 4 + 1] * size;
+			m[r * 4 + 2] = billboard[r * 4 + 2] * size;
+		}
+		m[12] = engine->x[i];
+		m[13] = engine->y[i];
+		m[14] = engine->z[i];
+		if (RenderQueue_Add (queue, quad, textures[e->effect], m))
+			drawn++;
+	}
+
+	return (drawn);
+}
@@ -0,0 +1,116 @@
+/*____________________________________________________________________
+|
+| File: particles.h
+|
+| Description: One particle engine for every effect in the game.  All
+|   particles live in a single structure of arrays allocated up front
+|   (the arena), whatever emitter made them, and the whole arena is
+|   updated in one pass per frame.  Emitters are light: an effect, a
+|   position and a visibility flag.  Emitters outside the view don't
+|   make new particles and their particles aren't drawn, so effects on
+|   monsters across the map cost next to nothing.
+|
+|   Particles can be drawn as camera facing quads through a render
+|   queue, one batch per effect.  That's one draw call per effect only
+|   with a backend that instances, otherwise it's a draw per particle,
+|   so a renderer that can't instance (like gx3d) draws its own effect
+|   at each visible emitter instead and uses an engine with no arena
+|   just to cull the emitters.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _PARTICLES_H_
+#define _PARTICLES_H_
+
+#include "frustum.h"
+#include "render_queue.h"
+#include "rng.h"
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define PARTICLE_MAX_EFFECTS     8
+#define PARTICLE_GRANULARITY     4    // arena capacity is a multiple of this so the update can run past count
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	float rate;                // particles per second
+	float life;                // seconds, each particle lives 75-125% of this
+	float speed;               // initial upward speed
+	float spread;              // sideways speed, as a fraction of speed
+	float jitter;              // random offset of new particles from the emitter
+	float gravity;             // downward acceleration (negative rises)
+	float size_start;          // quad size when born
+	float size_end;            // quad size when it dies
+	float radius;              // bounds of the emitter's particles, for culling
+} ParticleEffect;
+
+typedef struct {
+	int   effect;
+	float x, y, z;
+	float owed;                // fraction of a particle not yet made
+	bool  active;
+	bool  visible;
+} ParticleEmitter;
+
+typedef struct {
+	// Particles
+	float          *x, *y, *z;
+	float          *vx, *vy, *vz;
+	float          *gravity;
+	float          *age;
+	float          *life;
+	int            *emitter;
+	int             count;
+	int             capacity;
+	void           *arena;     // single allocation holding all the arrays
+	// Emitters
+	ParticleEmitter *emitters;
+	int             num_emitters;
+	int             max_emitters;
+	ParticleEffect  effects[PARTICLE_MAX_EFFECTS];
+	int             num_effects;
+	Rng             rng;
+	int             dropped;   // particles not made because the arena was full
+} ParticleEngine;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+// Returns true on success, else false.  capacity can be 0 for an engine
+//   that only culls emitters.
+bool Particle_Init (ParticleEngine *engine, int capacity, int max_emitters, unsigned long long seed);
+void Particle_Free (ParticleEngine *engine);
+
+// Returns the effect id or -1 if there are too many
+int  Particle_Add_Effect (ParticleEngine *engine, const ParticleEffect *effect);
+
+// Returns the emitter id (given out in order from 0) or -1 if there are too many
+int  Particle_Create_Emitter (ParticleEngine *engine, int effect, float x, float y, float z);
+void Particle_Move_Emitter (ParticleEngine *engine, int emitter, float x, float y, float z);
+// Stops an emitter making particles, the ones it made live out their lives
+void Particle_Stop_Emitter (ParticleEngine *engine, int emitter);
+
+// Marks the emitters that can be seen
+void Particle_Cull (ParticleEngine *engine, const Frustum *frustum);
+
+// Makes new particles at visible emitters, moves them all and removes dead ones
+void Particle_Update (ParticleEngine *engine, float seconds);
+
+// Queues a quad for each particle of a visible emitter.  billboard is a
+//   16 float rotation matrix facing the camera, textures has one texture
+//   per effect.  Returns the # of particles queued (each is a draw call
+//   if the backend can't instance).
+int  Particle_Draw (const ParticleEngine *engine, RenderQueue *queue, RenderObject quad, const RenderTexture *textures, const float *billboard);
+
+#endif
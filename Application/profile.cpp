@@ -0,0 +1,434 @@
+/*____________________________________________________________________
+|
+| File: profile.cpp
+|
+| Description: Scoped zone profiler.
+|
+| Functions: Profile_Now
+|            Profile_Init
+|            Profile_Free
+|            Profile_Set_Enabled
+|            Profile_Set_Thread_Name
+|            Profile_Record
+|             Get_Ring
+|            Profile_Begin_Frame
+|            Profile_End_Frame
+|             Find_Zone
+|            Profile_Summary
+|             Compare_Floats
+|            Profile_Write_Trace
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <new>
+
+#include "profile.h"
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	const char *name;
+	ProfileTime start;
+	ProfileTime end;
+} ProfileEvent;
+
+// Written only by its own thread, read by the exporter
+typedef struct {
+	ProfileEvent          events[PROFILE_RING_SIZE];
+	std::atomic<unsigned> head;                 // # of events ever written
+	const char           *thread_name;
+	int                   id;
+} ProfileRing;
+
+typedef struct {
+	const char *name;
+	ProfileTime frame_total;                    // time in this zone in the current frame
+	float       history[PROFILE_HISTORY];      // ms per frame
+} ProfileZoneHistory;
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static ProfileRing *Get_Ring ();
+static ProfileZoneHistory *Find_Zone (const char *name);
+static int Compare_Floats (const void *a, const void *b);
+
+/*___________________
+|
+| Global variables
+|__________________*/
+
+static std::atomic<ProfileRing *> Rings [PROFILE_MAX_THREADS];
+static std::atomic<int>           Num_Rings (0);
+static std::atomic<unsigned>      Generation (0);  // bumped by Profile_Free() so threads drop their old rings
+static bool                       Enabled = false;
+static thread_local ProfileRing  *Thread_Ring = NULL;
+static thread_local unsigned      Thread_Generation;
+
+// Frame summary, only touched by the thread that calls the frame functions
+static ProfileRing       *Frame_Ring = NULL;
+static unsigned           Frame_First_Event;
+static ProfileTime        Frame_Start;
+static ProfileZoneHistory Zones [PROFILE_MAX_ZONES];
+static int                Num_Zones = 0;
+static int                Num_Frames = 0;
+
+/*____________________________________________________________________
+|
+| Function: Profile_Now
+|
+| Input: Called from any module
+| Output: Returns nanoseconds on a clock that never goes backwards.
+|___________________________________________________________________*/
+
+ProfileTime Profile_Now ()
+{
+	return ((ProfileTime) std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now ().time_since_epoch ()).count ());
+}
+
+/*____________________________________________________________________
+|
+| Function: Profile_Init
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Clears all recorded data and starts recording.  Returns true
+|   on success, else false.
+|___________________________________________________________________*/
+
+bool Profile_Init ()
+{
+	Profile_Free ();
+	Enabled = true;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Profile_Free
+|
+| Input: Called from Profile_Init(), Program_Run(), headless driver
+| Output: Stops recording and frees every thread's ring.
+|___________________________________________________________________*/
+
+void Profile_Free ()
+{
+	int n = Num_Rings.load ();
+
+	Enabled = false;
+	for (int i = 0; i < n && i < PROFILE_MAX_THREADS; i++) {
+		delete Rings[i].load ();
+		Rings[i] = NULL;
+	}
+	Num_Rings = 0;
+	Generation++;
+	Thread_Ring = NULL;
+	Frame_Ring = NULL;
+	Num_Zones = 0;
+	Num_Frames = 0;
+}
+
+/*____________________________________________________________________
+|
+| Function: Profile_Set_Enabled
+|
+| Input: Called from any module
+| Output: Turns recording on or off (zones cost a clock read when off).
+|___________________________________________________________________*/
+
+void Profile_Set_Enabled (bool enabled)
+{
+	Enabled = enabled;
+}
+
+/*____________________________________________________________________
+|
+| Function: Profile_Set_Thread_Name
+|
+| Input: Called from any thread
+| Output: Names the calling thread in the exported trace.
+|___________________________________________________________________*/
+
+void Profile_Set_Thread_Name (const char *name)
+{
+	ProfileRing *ring = Get_Ring ();
+
+	if (ring)
+		ring->thread_name = name;
+}
+
+/*____________________________________________________________________
+|
+| Function: Profile_Record
+|
+| Input: Called from ProfileZone, any thread
+| Output: Adds an event to the calling thread's ring.  Only the owning
+|   thread writes a ring, so publishing the new head is all the
+|   synchronization needed.
+|___________________________________________________________________*/
+
+void Profile_Record (const char *name, ProfileTime start, ProfileTime end)
+{
+	ProfileRing *ring;
+	unsigned head;
+
+	if (!Enabled)
+		return;
+	ring = Get_Ring ();
+	if (ring == NULL)
+		return;
+
+	head = ring->head.load (std::memory_order_relaxed);
+	ProfileEvent *event = &ring->events[head & (PROFILE_RING_SIZE - 1)];
+	event->name = name;
+	event->start = start;
+	event->end = end;
+	ring->head.store (head + 1, std::memory_order_release);
+}
+
+/*____________________________________________________________________
+|
+| Function: Get_Ring
+|
+| Input: Called from Profile_Record(), Profile_Set_Thread_Name()
+| Output: Returns the calling thread's ring, creating it on first use,
+|   or NULL if there are already PROFILE_MAX_THREADS rings (or no
+|   memory).
+|___________________________________________________________________*/
+
+static ProfileRing *Get_Ring ()
+{
+	ProfileRing *ring;
+	int slot;
+
+	if (Thread_Ring && Thread_Generation == Generation.load (std::memory_order_relaxed))
+		return (Thread_Ring);
+	Thread_Ring = NULL;
+
+	slot = Num_Rings.fetch_add (1);
+	if (slot >= PROFILE_MAX_THREADS) {
+		Num_Rings.fetch_sub (1);
+		return (NULL);
+	}
+	ring = new (std::nothrow) ProfileRing;
+	if (ring == NULL) {
+		// leave the slot empty, the exporter skips it
+		return (NULL);
+	}
+	ring->head.store (0, std::memory_order_relaxed);
+	ring->thread_name = NULL;
+	ring->id = slot;
+	Rings[slot].store (ring, std::memory_order_release);
+	Thread_Ring = ring;
+	Thread_Generation = Generation.load (std::memory_order_relaxed);
+
+	return (ring);
+}
+
+/*____________________________________________________________________
+|
+| Function: Profile_Begin_Frame
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Marks the start of a frame.
+|___________________________________________________________________*/
+
+void Profile_Begin_Frame ()
+{
+	if (!Enabled)
+		return;
+	Frame_Ring = Get_Ring ();
+	if (Frame_Ring)
+		Frame_First_Event = Frame_Ring->head.load (std::memory_order_relaxed);
+	Frame_Start = Profile_Now ();
+}
+
+/*____________________________________________________________________
+|
+| Function: Profile_End_Frame
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Records the frame as a zone, then totals the time of each
+|   zone this thread ran during the frame into the rolling history.
+|___________________________________________________________________*/
+
+void Profile_End_Frame ()
+{
+	unsigned first, head;
+
+	if (!Enabled || Frame_Ring == NULL)
+		return;
+	Profile_Record ("Frame", Frame_Start, Profile_Now ());
+
+	head = Frame_Ring->head.load (std::memory_order_relaxed);
+	first = Frame_First_Event;
+	if (head - first > PROFILE_RING_SIZE)
+		first = head - PROFILE_RING_SIZE;
+
+	for (int i = 0; i < Num_Zones; i++)
+		Zones[i].frame_total = 0;
+	for (unsigned e = first; e != head; e++) {
+		const ProfileEvent *event = &Frame_Ring->events[e & (PROFILE_RING_SIZE - 1)];
+		ProfileZoneHistory *zone = Find_Zone (event->name);
+		if (zone)
+			zone->frame_total += event->end - event->start;
+	}
+	for (int i = 0; i < Num_Zones; i++)
+		Zones[i].history[Num_Frames % PROFILE_HISTORY] = Zones[i].frame_total / 1e6f;
+	Num_Frames++;
+}
+
+/*____________________________________________________________________
+|
+| Function: Find_Zone
+|
+| Input: Called from Profile_End_Frame()
+| Output: Returns the history for a zone name, adding it if new (with
+|   zeros for the frames before it showed up), or NULL if the table is
+|   full.
+|___________________________________________________________________*/
+
+static ProfileZoneHistory *Find_Zone (const char *name)
+{
+	for (int i = 0; i < Num_Zones; i++)
+		if (Zones[i].name == name || !strcmp (Zones[i].name, name))
+			return (&Zones[i]);
+
+	if (Num_Zones == PROFILE_MAX_ZONES)
+		return (NULL);
+	ProfileZoneHistory *zone = &Zones[Num_Zones++];
+	zone->name = name;
+	zone->frame_total = 0;
+	memset (zone->history, 0, sizeof(zone->history));
+
+	return (zone);
+}
+
+/*____________________________________________________________________
+|
+| Function: Profile_Summary
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Fills out with p50, p99 and max of each zone's per frame time
+|   over the rolling history.  Returns # of zones written.
+|___________________________________________________________________*/
+
+int Profile_Summary (ProfileZoneSummary *out, int max_out)
+{
+	float sorted[PROFILE_HISTORY];
+	int frames = Num_Frames < PROFILE_HISTORY ? Num_Frames : PROFILE_HISTORY;
+	int n = 0;
+
+	if (frames == 0)
+		return (0);
+
+	for (int i = 0; i < Num_Zones && n < max_out; i++, n++) {
+		memcpy (sorted, Zones[i].history, frames * sizeof(float));
+		qsort (sorted, frames, sizeof(float), Compare_Floats);
+		out[n].name = Zones[i].name;
+		out[n].p50_ms = sorted[(frames - 1) / 2];
+		out[n].p99_ms = sorted[((frames - 1) * 99) / 100];
+		out[n].max_ms = sorted[frames - 1];
+		out[n].frames = frames;
+	}
+
+	return (n);
+}
+
+/*____________________________________________________________________
+|
+| Function: Compare_Floats
+|
+| Input: Called from qsort()
+| Output: Orders floats smallest first.
+|___________________________________________________________________*/
+
+static int Compare_Floats (const void *a, const void *b)
+{
+	float fa = *(const float *)a;
+	float fb = *(const float *)b;
+
+	return (fa < fb ? -1 : fa > fb ? 1 : 0);
+}
+
+/*____________________________________________________________________
+|
+| Function: Profile_Write_Trace
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Writes the events in every ring as complete ("X") events in
+|   Chrome trace JSON, times in microseconds from the earliest event.
+|   Threads should not be recording while this runs.  Returns true on
+|   success, else false.
+|___________________________________________________________________*/
+
+bool Profile_Write_Trace (const char *filename)
+{
+	FILE *fp;
+	int n = Num_Rings.load ();
+
+	if (n > PROFILE_MAX_THREADS)
+		n = PROFILE_MAX_THREADS;
+	ProfileTime origin = 0;
+	bool have_origin = false, first = true;
+
+	fp = fopen (filename, "w");
+	if (fp == NULL)
+		return (false);
+
+	// Find the earliest start so times start at 0 (events are in order of end, an
+	//   enclosing zone is recorded after the zones inside it)
+	for (int r = 0; r < n; r++) {
+		ProfileRing *ring = Rings[r].load (std::memory_order_acquire);
+		if (ring == NULL)
+			continue;
+		unsigned head = ring->head.load (std::memory_order_acquire);
+		unsigned start = head > PROFILE_RING_SIZE ? head - PROFILE_RING_SIZE : 0;
+		for (unsigned e = start; e != head; e++) {
+			ProfileTime t = ring->events[e & (PROFILE_RING_SIZE - 1)].start;
+			if (!have_origin || t < origin) {
+				origin = t;
+				have_origin = true;
+			}
+		}
+	}
+
+	fprintf (fp, "{\"traceEvents\":[\n");
+	for (int r = 0; r < n; r++) {
+		ProfileRing *ring = Rings[r].load (std::memory_order_acquire);
+		if (ring == NULL)
+			continue;
+		if (ring->thread_name) {
+			fprintf (fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n", ring->id, ring->thread_name);
+			first = false;
+		}
+		unsigned head = ring->head.load (std::memory_order_acquire);
+		unsigned start = head > PROFILE_RING_SIZE ? head - PROFILE_RING_SIZE : 0;
+		for (unsigned e = start; e != head; e++) {
+			const ProfileEvent *event = &ring->events[e & (PROFILE_RING_SIZE - 1)];
+			fprintf (fp, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", first ? "" : ",\n",
+				event->name, ring->id, (event->start - origin) / 1000.0, (event->end - event->start) / 1000.0);
+			first = false;
+		}
+	}
+	fprintf (fp, "\n]}\n");
+
+	return (fclose (fp) == 0);
+}
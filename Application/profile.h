@@ -0,0 +1,95 @@
+/*____________________________________________________________________
+|
+| File: profile.h
+|
+| Description: Scoped zone profiler on a monotonic nanosecond clock.
+|   Each thread records the zones it runs into its own ring buffer (no
+|   locks, the oldest events are overwritten), which can be exported as
+|   a Chrome trace (chrome://tracing, ui.perfetto.dev).  Zones run on
+|   the thread that calls Profile_Begin_Frame()/Profile_End_Frame() are
+|   also totaled per frame for a rolling p50/p99 summary.
+|
+|   Zone names must be string literals (only the pointer is kept).
+|
+|   Usage:
+|     void Update ()
+|     {
+|       PROFILE_ZONE ("Update");
+|       ...
+|     }
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _PROFILE_H_
+#define _PROFILE_H_
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define PROFILE_MAX_THREADS  16
+#define PROFILE_RING_SIZE    65536    // events per thread, must be a power of 2
+#define PROFILE_MAX_ZONES    64       // distinct zone names in the summary
+#define PROFILE_HISTORY      600      // frames in the rolling summary
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef unsigned long long ProfileTime;   // nanoseconds
+
+typedef struct {
+	const char *name;
+	float       p50_ms;             // per frame total, over the last PROFILE_HISTORY frames
+	float       p99_ms;
+	float       max_ms;
+	int         frames;             // # of frames in the history
+} ProfileZoneSummary;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+// Returns a monotonic time in nanoseconds
+ProfileTime Profile_Now ();
+
+bool Profile_Init ();
+void Profile_Free ();                               // call once other threads are done recording
+void Profile_Set_Enabled (bool enabled);
+void Profile_Set_Thread_Name (const char *name);    // names the calling thread in the trace
+
+void Profile_Record (const char *name, ProfileTime start, ProfileTime end);
+
+// Frame boundaries on the main thread (End also records a "Frame" zone)
+void Profile_Begin_Frame ();
+void Profile_End_Frame ();
+
+// Fills out with the rolling summary of up to max_out zones, returns how many
+int  Profile_Summary (ProfileZoneSummary *out, int max_out);
+// Writes every event still in the rings as Chrome trace JSON.  Returns true on success, else false.
+bool Profile_Write_Trace (const char *filename);
+
+/*___________________
+|
+| Scoped zone
+|__________________*/
+
+class ProfileZone {
+public:
+	ProfileZone (const char *name) : zone_name (name), zone_start (Profile_Now ()) {}
+	~ProfileZone () { Profile_Record (zone_name, zone_start, Profile_Now ()); }
+private:
+	const char *zone_name;
+	ProfileTime zone_start;
+};
+
+#define PROFILE_CONCAT2(_a_,_b_) _a_##_b_
+#define PROFILE_CONCAT(_a_,_b_)  PROFILE_CONCAT2(_a_,_b_)
+#define PROFILE_ZONE(_name_)     ProfileZone PROFILE_CONCAT(profile_zone_,__LINE__) (_name_)
+
+#endif
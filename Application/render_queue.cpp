@@ -0,0 +1,285 @@
+/*____________________________________________________________________
+|
+| File: render_queue.cpp
+|
+| Description: Batches visible instances by (object, texture).
+|
+| Functions: RenderQueue_Init
+|            RenderQueue_Free
+|            RenderQueue_Begin_Frame
+|            RenderQueue_Add
+|             Find_Batch
+|             Grow
+|            RenderQueue_Add_Translate
+|            RenderQueue_Flush
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "render_queue.h"
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static int  Find_Batch (RenderQueue *queue, RenderObject object, RenderTexture texture);
+static bool Grow (RenderQueue *queue, int capacity);
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define MATRIX_FLOATS    16
+#define MIN_CAPACITY     64
+#define MIN_BATCHES      16
+
+/*____________________________________________________________________
+|
+| Function: RenderQueue_Init
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Creates an empty queue with room for capacity instances.
+|   Returns true on success, else false.
+|___________________________________________________________________*/
+
+bool RenderQueue_Init (RenderQueue *queue, int capacity)
+{
+	memset (queue, 0, sizeof(RenderQueue));
+	queue->last_batch = -1;
+
+	queue->batches = (RenderBatch *) malloc (MIN_BATCHES * sizeof(RenderBatch));
+	if (queue->batches == NULL)
+		return (false);
+	queue->batch_capacity = MIN_BATCHES;
+
+	return (Grow (queue, capacity < MIN_CAPACITY ? MIN_CAPACITY : capacity));
+}
+
+/*____________________________________________________________________
+|
+| Function: RenderQueue_Free
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Frees all memory used by the queue.
+|___________________________________________________________________*/
+
+void RenderQueue_Free (RenderQueue *queue)
+{
+	free (queue->matrices);
+	free (queue->sorted);
+	free (queue->batch);
+	free (queue->batches);
+	memset (queue, 0, sizeof(RenderQueue));
+}
+
+/*____________________________________________________________________
+|
+| Function: RenderQueue_Begin_Frame
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Empties the queue and zeros the per frame stats.
+|___________________________________________________________________*/
+
+void RenderQueue_Begin_Frame (RenderQueue *queue)
+{
+	queue->count = 0;
+	queue->num_batches = 0;
+	queue->last_batch = -1;
+	memset (&queue->stats, 0, sizeof(RenderQueueStats));
+}
+
+/*____________________________________________________________________
+|
+| Function: RenderQueue_Add
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Queues an instance of object, drawn with texture at matrix.
+|   Returns true on success, else false.
+|___________________________________________________________________*/
+
+bool RenderQueue_Add (RenderQueue *queue, RenderObject object, RenderTexture texture, const float *matrix)
+{
+	int batch;
+
+	if (queue->count == queue->capacity)
+		if (!Grow (queue, queue->capacity * 2))
+			return (false);
+
+	batch = Find_Batch (queue, object, texture);
+	if (batch == -1)
+		return (false);
+
+	memcpy (&queue->matrices[queue->count * MATRIX_FLOATS], matrix, MATRIX_FLOATS * sizeof(float));
+	queue->batch[queue->count] = batch;
+	queue->batches[batch].count++;
+	queue->count++;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Find_Batch
+|
+| Input: Called from RenderQueue_Add()
+| Output: Returns the batch for object and texture, adding one if there
+|   isn't one yet, or -1 on error.
+|___________________________________________________________________*/
+
+static int Find_Batch (RenderQueue *queue, RenderObject object, RenderTexture texture)
+{
+	RenderBatch *batch;
+
+	if (queue->last_batch != -1) {
+		batch = &queue->batches[queue->last_batch];
+		if (batch->object == object && batch->texture == texture)
+			return (queue->last_batch);
+	}
+	// There are only ever a handful of batches, so a linear search is fine
+	for (int i = 0; i < queue->num_batches; i++)
+		if (queue->batches[i].object == object && queue->batches[i].texture == texture) {
+			queue->last_batch = i;
+			return (i);
+		}
+
+	if (queue->num_batches == queue->batch_capacity) {
+		batch = (RenderBatch *) realloc (queue->batches, 2 * queue->batch_capacity * sizeof(RenderBatch));
+		if (batch == NULL)
+			return (-1);
+		queue->batches = batch;
+		queue->batch_capacity *= 2;
+	}
+	batch = &queue->batches[queue->num_batches];
+	batch->object = object;
+	batch->texture = texture;
+	batch->count = 0;
+	batch->start = 0;
+	queue->last_batch = queue->num_batches++;
+
+	return (queue->last_batch);
+}
+
+/*____________________________________________________________________
+|
+| Function: Grow
+|
+| Input: Called from RenderQueue_Init(), RenderQueue_Add()
+| Output: Makes room for capacity instances, keeping those queued.
+|   Returns true on success, else false (queue unchanged).
+|___________________________________________________________________*/
+
+static bool Grow (RenderQueue *queue, int capacity)
+{
+	float *matrices, *sorted;
+	int *batch;
+
+	matrices = (float *) realloc (queue->matrices, capacity * MATRIX_FLOATS * sizeof(float));
+	if (matrices)
+		queue->matrices = matrices;
+	sorted = (float *) realloc (queue->sorted, capacity * MATRIX_FLOATS * sizeof(float));
+	if (sorted)
+		queue->sorted = sorted;
+	batch = (int *) realloc (queue->batch, capacity * sizeof(int));
+	if (batch)
+		queue->batch = batch;
+	if (matrices == NULL || sorted == NULL || batch == NULL)
+		return (false);
+
+	queue->capacity = capacity;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: RenderQueue_Add_Translate
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Queues an instance of object placed at x,y,z with no rotation
+|   or scaling.  Returns true on success, else false.
+|___________________________________________________________________*/
+
+bool RenderQueue_Add_Translate (RenderQueue *queue, RenderObject object, RenderTexture texture, float x, float y, float z)
+{
+	float m[MATRIX_FLOATS] = {
+		1, 0, 0, 0,
+		0, 1, 0, 0,
+		0, 0, 1, 0,
+		x, y, z, 1
+	};
+
+	return (RenderQueue_Add (queue, object, texture, m));
+}
+
+/*____________________________________________________________________
+|
+| Function: RenderQueue_Flush
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Groups the queued instances by batch (a counting sort, which
+|   keeps the order instances were added within a batch) and draws each
+|   batch with one texture change, skipping it if the previous batch
+|   used the same texture.  Empties the queue.
+|___________________________________________________________________*/
+
+void RenderQueue_Flush (RenderQueue *queue, const RenderBackend *backend)
+{
+	RenderTexture current = NULL;
+	bool have_texture = false;
+	int start = 0;
+
+	if (queue->count == 0)
+		return;
+
+	for (int b = 0; b < queue->num_batches; b++) {
+		queue->batches[b].start = start;
+		start += queue->batches[b].count;
+		queue->batches[b].count = 0;
+	}
+	for (int i = 0; i < queue->count; i++) {
+		RenderBatch *batch = &queue->batches[queue->batch[i]];
+		memcpy (&queue->sorted[(batch->start + batch->count) * MATRIX_FLOATS], &queue->matrices[i * MATRIX_FLOATS], MATRIX_FLOATS * sizeof(float));
+		batch->count++;
+	}
+
+	for (int b = 0; b < queue->num_batches; b++) {
+		RenderBatch *batch = &queue->batches[b];
+		const float *matrices = &queue->sorted[batch->start * MATRIX_FLOATS];
+		// Whatever was drawn before the flush may have changed the texture, so always set the first
+		if (!have_texture || batch->texture != current) {
+			backend->set_texture (backend->context, batch->texture);
+			current = batch->texture;
+			have_texture = true;
+			queue->stats.texture_changes++;
+		}
+		if (backend->draw_instances) {
+			backend->draw_instances (backend->context, batch->object, matrices, batch->count);
+			queue->stats.draw_calls++;
+		}
+		else {
+			for (int i = 0; i < batch->count; i++) {
+				backend->set_object_matrix (backend->context, batch->object, &matrices[i * MATRIX_FLOATS]);
+				backend->draw_object (backend->context, batch->object);
+			}
+			queue->stats.matrix_changes += batch->count;
+			queue->stats.draw_calls += batch->count;
+		}
+		queue->stats.instances += batch->count;
+		queue->stats.batches++;
+	}
+
+	queue->count = 0;
+	queue->num_batches = 0;
+	queue->last_batch = -1;
+}
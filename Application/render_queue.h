@@ -0,0 +1,87 @@
+/*____________________________________________________________________
+|
+| File: render_queue.h
+|
+| Description: Collects the visible instances of a frame, groups them
+|   by (object, texture) and submits each group as one batch, so a
+|   texture is bound once per group instead of once per instance.  The
+|   graphics calls go through a table of backend functions, so the
+|   queue runs with the real renderer or with a mock that just counts
+|   calls.  A backend that can instance draws a whole batch in one call,
+|   otherwise the batch is drawn one instance at a time.
+|
+|   Matrices are 16 floats, row major with the translation in elements
+|   12-14 (the gx3dMatrix layout).
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _RENDER_QUEUE_H_
+#define _RENDER_QUEUE_H_
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef void *RenderObject;        // backend's handle for a model
+typedef void *RenderTexture;       // backend's handle for a texture
+
+typedef struct {
+	void (*set_texture)       (void *context, RenderTexture texture);
+	void (*set_object_matrix) (void *context, RenderObject object, const float *matrix);
+	void (*draw_object)       (void *context, RenderObject object);
+	// Draws count instances, matrices are 16 floats each (NULL if the backend can't instance)
+	void (*draw_instances)    (void *context, RenderObject object, const float *matrices, int count);
+	void  *context;
+} RenderBackend;
+
+typedef struct {
+	int instances;                 // # of instances submitted
+	int batches;                   // # of (object, texture) groups submitted
+	int draw_calls;
+	int texture_changes;
+	int matrix_changes;
+} RenderQueueStats;
+
+typedef struct {
+	RenderObject  object;
+	RenderTexture texture;
+	int           count;           // # of instances in this batch
+	int           start;           // first instance in sorted order
+} RenderBatch;
+
+typedef struct {
+	float       *matrices;         // 16 floats per instance, in the order added
+	float       *sorted;           // same, grouped by batch
+	int         *batch;            // batch of each instance
+	int          count;
+	int          capacity;
+	RenderBatch *batches;          // in order of first appearance
+	int          num_batches;
+	int          batch_capacity;
+	int          last_batch;       // batch found by the last add (instances usually come in runs)
+	RenderQueueStats stats;        // totals since RenderQueue_Begin_Frame()
+} RenderQueue;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+bool RenderQueue_Init (RenderQueue *queue, int capacity);
+void RenderQueue_Free (RenderQueue *queue);
+
+// Empties the queue and zeros the stats
+void RenderQueue_Begin_Frame (RenderQueue *queue);
+
+// Queues an instance (grows the queue if needed).  Returns true on success, else false.
+bool RenderQueue_Add (RenderQueue *queue, RenderObject object, RenderTexture texture, const float *matrix);
+bool RenderQueue_Add_Translate (RenderQueue *queue, RenderObject object, RenderTexture texture, float x, float y, float z);
+
+// Draws everything queued, one batch at a time in order of first
+//   appearance, then empties the queue (stats keep adding up)
+void RenderQueue_Flush (RenderQueue *queue, const RenderBackend *backend);
+
+#endif
@@ -0,0 +1,376 @@
+/*____________________________________________________________________
+|
+| File: replay.cpp
+|
+| Description: Session record and playback.
+|
+| Functions: Replay_Init
+|            Replay_Free
+|            Replay_Record
+|             Put_Varint
+|             Put_Bytes
+|            Replay_Save
+|            Replay_Load
+|            Replay_Next
+|             Get_Varint
+|             Get_Bytes
+|            Replay_Rewind
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "replay.h"
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static bool Put_Varint (Replay *replay, unsigned value);
+static bool Put_Bytes (Replay *replay, const void *bytes, int count);
+static bool Get_Varint (Replay *replay, unsigned *value);
+static bool Get_Bytes (Replay *replay, void *bytes, int count);
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define MIN_CAPACITY    4096
+
+// Step flags (first varint of each step)
+#define TICK_MOVING     0x01
+#define TICK_SHOTS      0x02    // shot count follows
+#define TICK_MOUSE      0x04    // mouse x, y follow (zigzag)
+#define TICK_POSE       0x08    // position, heading follow (6 floats)
+#define TICK_RUN        0x10
+#define TICK_MOVE_SHIFT 5       // move bits
+
+#define ZIGZAG(_n_)     (((unsigned)(_n_) << 1) ^ (unsigned)((_n_) >> 31))
+#define UNZIGZAG(_u_)   ((int)((_u_) >> 1) ^ -(int)((_u_) & 1))
+
+/*____________________________________________________________________
+|
+| Function: Replay_Init
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Starts an empty recording of a session played in world.
+|   Returns true on success, else false.
+|___________________________________________________________________*/
+
+bool Replay_Init (Replay *replay, unsigned seed, float rate, const World *world, unsigned flags)
+{
+	memset (replay, 0, sizeof(Replay));
+	replay->seed = seed;
+	replay->rate = rate;
+	replay->monsters = world->monsters.count / WORLD_MONSTER_TYPES;
+	replay->flags = flags;
+	memcpy (replay->monster_center_y, world->monster_center_y, sizeof(replay->monster_center_y));
+	memcpy (replay->monster_radius, world->monster_radius, sizeof(replay->monster_radius));
+
+	replay->data = (unsigned char *) malloc (MIN_CAPACITY);
+	if (replay->data == NULL)
+		return (false);
+	replay->capacity = MIN_CAPACITY;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Replay_Free
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Frees all memory used by the replay.
+|___________________________________________________________________*/
+
+void Replay_Free (Replay *replay)
+{
+	free (replay->data);
+	memset (replay, 0, sizeof(Replay));
+}
+
+/*____________________________________________________________________
+|
+| Function: Replay_Record
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Adds a step to the recording.  Returns true on success, else
+|   false.
+|___________________________________________________________________*/
+
+bool Replay_Record (Replay *replay, const ReplayTick *tick)
+{
+	const WorldInput *in = &tick->input, *last = &replay->last.input;
+	unsigned flags;
+	bool ok;
+
+	flags = (tick->move & 0xF) << TICK_MOVE_SHIFT;
+	if (in->moving)
+		flags |= TICK_MOVING;
+	if (in->shots)
+		flags |= TICK_SHOTS;
+	if (tick->mouse_x || tick->mouse_y)
+		flags |= TICK_MOUSE;
+	if (replay->ticks == 0 ||
+		memcmp (&in->player_position, &last->player_position, sizeof(WorldVector)) ||
+		memcmp (&in->player_heading, &last->player_heading, sizeof(WorldVector)))
+		flags |= TICK_POSE;
+	if (tick->run)
+		flags |= TICK_RUN;
+
+	ok = Put_Varint (replay, flags);
+	if (ok && (flags & TICK_SHOTS))
+		ok = Put_Varint (replay, (unsigned) in->shots);
+	if (ok && (flags & TICK_MOUSE))
+		ok = Put_Varint (replay, ZIGZAG (tick->mouse_x)) && Put_Varint (replay, ZIGZAG (tick->mouse_y));
+	if (ok && (flags & TICK_POSE))
+		ok = Put_Bytes (replay, &in->player_position, sizeof(WorldVector)) && Put_Bytes (replay, &in->player_heading, sizeof(WorldVector));
+	if (!ok)
+		return (false);
+
+	replay->last = *tick;
+	replay->ticks++;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Put_Varint
+|
+| Input: Called from Replay_Record()
+| Output: Appends value 7 bits at a time, low bits first.  Returns true
+|   on success, else false.
+|___________________________________________________________________*/
+
+static bool Put_Varint (Replay *replay, unsigned value)
+{
+	unsigned char bytes[5];
+	int n = 0;
+
+	while (value >= 0x80) {
+		bytes[n++] = (unsigned char)(value | 0x80);
+		value >>= 7;
+	}
+	bytes[n++] = (unsigned char) value;
+
+	return (Put_Bytes (replay, bytes, n));
+}
+
+/*____________________________________________________________________
+|
+| Function: Put_Bytes
+|
+| Input: Called from Replay_Record(), Put_Varint()
+| Output: Appends count bytes (grows the buffer if needed).  Returns
+|   true on success, else false.
+|___________________________________________________________________*/
+
+static bool Put_Bytes (Replay *replay, const void *bytes, int count)
+{
+	if (replay->size + count > replay->capacity) {
+		int capacity = replay->capacity * 2;
+		unsigned char *data = (unsigned char *) realloc (replay->data, capacity);
+		if (data == NULL)
+			return (false);
+		replay->data = data;
+		replay->capacity = capacity;
+	}
+	memcpy (replay->data + replay->size, bytes, count);
+	replay->size += count;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Replay_Save
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Writes the header (magic, version, seed, rate, monsters, flags,
+|   monster bounds, # of steps, # of data bytes) and step data to a
+|   file.  Returns true on success, else false.
+|___________________________________________________________________*/
+
+bool Replay_Save (const Replay *replay, const char *filename)
+{
+	FILE *fp;
+	unsigned magic = REPLAY_MAGIC, version = REPLAY_VERSION;
+	bool ok;
+
+	fp = fopen (filename, "wb");
+	if (fp == NULL)
+		return (false);
+
+	ok = fwrite (&magic, sizeof(magic), 1, fp) == 1 &&
+		fwrite (&version, sizeof(version), 1, fp) == 1 &&
+		fwrite (&replay->seed, sizeof(replay->seed), 1, fp) == 1 &&
+		fwrite (&replay->rate, sizeof(replay->rate), 1, fp) == 1 &&
+		fwrite (&replay->monsters, sizeof(replay->monsters), 1, fp) == 1 &&
+		fwrite (&replay->flags, sizeof(replay->flags), 1, fp) == 1 &&
+		fwrite (replay->monster_center_y, sizeof(replay->monster_center_y), 1, fp) == 1 &&
+		fwrite (replay->monster_radius, sizeof(replay->monster_radius), 1, fp) == 1 &&
+		fwrite (&replay->ticks, sizeof(replay->ticks), 1, fp) == 1 &&
+		fwrite (&replay->size, sizeof(replay->size), 1, fp) == 1 &&
+		(replay->size == 0 || fwrite (replay->data, replay->size, 1, fp) == 1);
+
+	if (fclose (fp) != 0)
+		ok = false;
+
+	return (ok);
+}
+
+/*____________________________________________________________________
+|
+| Function: Replay_Load
+|
+| Input: Called from headless driver
+| Output: Reads a file written by Replay_Save(), ready to play back from
+|   the first step.  Returns true on success, else false.
+|___________________________________________________________________*/
+
+bool Replay_Load (Replay *replay, const char *filename)
+{
+	FILE *fp;
+	unsigned magic, version;
+	bool ok;
+
+	memset (replay, 0, sizeof(Replay));
+	fp = fopen (filename, "rb");
+	if (fp == NULL)
+		return (false);
+
+	ok = fread (&magic, sizeof(magic), 1, fp) == 1 && magic == REPLAY_MAGIC &&
+		fread (&version, sizeof(version), 1, fp) == 1 && version == REPLAY_VERSION &&
+		fread (&replay->seed, sizeof(replay->seed), 1, fp) == 1 &&
+		fread (&replay->rate, sizeof(replay->rate), 1, fp) == 1 &&
+		fread (&replay->monsters, sizeof(replay->monsters), 1, fp) == 1 &&
+		fread (&replay->flags, sizeof(replay->flags), 1, fp) == 1 &&
+		fread (replay->monster_center_y, sizeof(replay->monster_center_y), 1, fp) == 1 &&
+		fread (replay->monster_radius, sizeof(replay->monster_radius), 1, fp) == 1 &&
+		fread (&replay->ticks, sizeof(replay->ticks), 1, fp) == 1 &&
+		fread (&replay->size, sizeof(replay->size), 1, fp) == 1 &&
+		replay->ticks >= 0 && replay->size >= 0 && replay->rate > 0;
+	if (ok) {
+		replay->data = (unsigned char *) malloc (replay->size ? replay->size : 1);
+		replay->capacity = replay->size;
+		ok = replay->data != NULL && (replay->size == 0 || fread (replay->data, replay->size, 1, fp) == 1);
+	}
+	fclose (fp);
+
+	if (!ok)
+		Replay_Free (replay);
+
+	return (ok);
+}
+
+/*____________________________________________________________________
+|
+| Function: Replay_Next
+|
+| Input: Called from headless driver
+| Output: Decodes the next step into tick.  Returns true on success, else
+|   false (no more steps or the data is bad).
+|___________________________________________________________________*/
+
+bool Replay_Next (Replay *replay, ReplayTick *tick)
+{
+	unsigned flags, value, x, y;
+
+	if (replay->read_pos >= replay->size || !Get_Varint (replay, &flags))
+		return (false);
+
+	*tick = replay->last;
+	tick->move = (flags >> TICK_MOVE_SHIFT) & 0xF;
+	tick->run = (flags & TICK_RUN) != 0;
+	tick->input.moving = (flags & TICK_MOVING) != 0;
+	tick->input.shots = 0;
+	tick->mouse_x = tick->mouse_y = 0;
+	if (flags & TICK_SHOTS) {
+		if (!Get_Varint (replay, &value))
+			return (false);
+		tick->input.shots = (int) value;
+	}
+	if (flags & TICK_MOUSE) {
+		if (!Get_Varint (replay, &x) || !Get_Varint (replay, &y))
+			return (false);
+		tick->mouse_x = UNZIGZAG (x);
+		tick->mouse_y = UNZIGZAG (y);
+	}
+	if (flags & TICK_POSE) {
+		if (!Get_Bytes (replay, &tick->input.player_position, sizeof(WorldVector)) ||
+			!Get_Bytes (replay, &tick->input.player_heading, sizeof(WorldVector)))
+			return (false);
+	}
+	replay->last = *tick;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Get_Varint
+|
+| Input: Called from Replay_Next()
+| Output: Reads a value written by Put_Varint().  Returns true on
+|   success, else false.
+|___________________________________________________________________*/
+
+static bool Get_Varint (Replay *replay, unsigned *value)
+{
+	unsigned char byte;
+	int shift = 0;
+
+	*value = 0;
+	do {
+		if (shift > 28 || !Get_Bytes (replay, &byte, 1))
+			return (false);
+		*value |= (unsigned)(byte & 0x7F) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Get_Bytes
+|
+| Input: Called from Replay_Next(), Get_Varint()
+| Output: Reads count bytes.  Returns true on success, else false.
+|___________________________________________________________________*/
+
+static bool Get_Bytes (Replay *replay, void *bytes, int count)
+{
+	if (replay->read_pos + count > replay->size)
+		return (false);
+	memcpy (bytes, replay->data + replay->read_pos, count);
+	replay->read_pos += count;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Replay_Rewind
+|
+| Input: Called from headless driver
+| Output: Starts play back over from the first step.
+|___________________________________________________________________*/
+
+void Replay_Rewind (Replay *replay)
+{
+	replay->read_pos = 0;
+	memset (&replay->last, 0, sizeof(ReplayTick));
+}
@@ -0,0 +1,89 @@
+/*____________________________________________________________________
+|
+| File: replay.h
+|
+| Description: Records a play session (the random seed, then each
+|   simulation step's input) in a compact binary form, and plays it back
+|   so the session can be rerun headless, as fast as possible, as a
+|   benchmark or regression test.
+|
+|   Each step stores the held move bits, run state, mouse movement since
+|   the previous step, shots and the player position and heading the
+|   simulation was given.  Values that didn't change since the previous
+|   step take no space, a step standing still with no input is 1 byte.
+|
+|   File layout (little endian): header (see Replay_Save()), then the
+|   step data.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _REPLAY_H_
+#define _REPLAY_H_
+
+#include "world.h"
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define REPLAY_MAGIC        0x4c50525a  // "ZRPL"
+#define REPLAY_VERSION      2        // 2: seed is the world's master seed (was an srand() seed)
+
+// Replay.flags
+#define REPLAY_FLAG_IMMORTAL 0x1        // health was restored whenever it ran out (headless runs)
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	WorldInput input;          // what the simulation was given this step
+	unsigned   move;           // move bits held (CAMERA_MOVE_*, 4 bits)
+	bool       run;
+	int        mouse_x;        // mouse movement since the previous step
+	int        mouse_y;
+} ReplayTick;
+
+typedef struct {
+	// Session
+	unsigned       seed;       // master seed the world was made with
+	float          rate;       // simulation steps per second
+	int            monsters;   // monsters of each type at the start
+	unsigned       flags;
+	float          monster_center_y[WORLD_MONSTER_TYPES];
+	float          monster_radius[WORLD_MONSTER_TYPES];
+	int            ticks;
+	// Step data
+	unsigned char *data;
+	int            size;
+	int            capacity;
+	int            read_pos;
+	ReplayTick     last;       // previous step recorded or played back
+} Replay;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+// Starts recording a session of world (call after World_Init() and
+//   World_Set_Monster_Bounds()).  Returns true on success, else false.
+bool Replay_Init (Replay *replay, unsigned seed, float rate, const World *world, unsigned flags);
+void Replay_Free (Replay *replay);
+
+// Adds a step.  Returns true on success, else false (out of memory).
+bool Replay_Record (Replay *replay, const ReplayTick *tick);
+
+// Returns true on success, else false.
+bool Replay_Save (const Replay *replay, const char *filename);
+bool Replay_Load (Replay *replay, const char *filename);
+
+// Gets the next step, returns false after the last one
+bool Replay_Next (Replay *replay, ReplayTick *tick);
+void Replay_Rewind (Replay *replay);
+
+#endif
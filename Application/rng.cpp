@@ -0,0 +1,204 @@
+/*____________________________________________________________________
+|
+| File: rng.cpp
+|
+| Description: Random number streams.
+|
+| Functions: Rng_Seed
+|             Split_Mix
+|            Rng_Next
+|            Rng_Range
+|            Rng_Float_Range
+|            Rng_Fill_Float_Range
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include "rng.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define RNG_SSE2
+#include <emmintrin.h>
+#endif
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static unsigned long long Split_Mix (unsigned long long *state);
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define FLOAT_SCALE   (1.0f / 16777216)     // 24 random bits to 0-1
+
+#define ROTL(_x_,_k_) (((_x_) << (_k_)) | ((_x_) >> (32 - (_k_))))
+
+/*____________________________________________________________________
+|
+| Function: Rng_Seed
+|
+| Input: Called from World_Init(), Program_Run(), headless driver
+| Output: Seeds a stream.  Different stream ids with the same master seed
+|   give unrelated sequences.
+|___________________________________________________________________*/
+
+void Rng_Seed (Rng *rng, unsigned long long master_seed, int stream)
+{
+	unsigned long long state = master_seed ^ ((unsigned long long)(stream + 1) * 0xD1B54A32D192ED03ULL);
+
+	for (int lane = 0; lane < RNG_LANES; lane++) {
+		unsigned long long a = Split_Mix (&state), b = Split_Mix (&state);
+		rng->s[0][lane] = (unsigned) a;
+		rng->s[1][lane] = (unsigned)(a >> 32);
+		rng->s[2][lane] = (unsigned) b;
+		rng->s[3][lane] = (unsigned)(b >> 32);
+		// All zero state never leaves zero
+		if ((a | b) == 0)
+			rng->s[0][lane] = 1;
+	}
+	rng->lane = 0;
+}
+
+/*____________________________________________________________________
+|
+| Function: Split_Mix
+|
+| Input: Called from Rng_Seed()
+| Output: Returns the next splitmix64 value (spreads a seed over the
+|   generator state).
+|___________________________________________________________________*/
+
+static unsigned long long Split_Mix (unsigned long long *state)
+{
+	unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+	return (z ^ (z >> 31));
+}
+
+/*____________________________________________________________________
+|
+| Function: Rng_Next
+|
+| Input: Called from any module
+| Output: Returns 32 random bits from the next generator in turn.
+|___________________________________________________________________*/
+
+unsigned Rng_Next (Rng *rng)
+{
+	int lane = rng->lane;
+	unsigned s0 = rng->s[0][lane], s1 = rng->s[1][lane], s2 = rng->s[2][lane], s3 = rng->s[3][lane];
+	unsigned result = ROTL (s0 + s3, 7) + s0;
+	unsigned t = s1 << 9;
+
+	s2 ^= s0;
+	s3 ^= s1;
+	s1 ^= s2;
+	s0 ^= s3;
+	s2 ^= t;
+	s3 = ROTL (s3, 11);
+
+	rng->s[0][lane] = s0;
+	rng->s[1][lane] = s1;
+	rng->s[2][lane] = s2;
+	rng->s[3][lane] = s3;
+	rng->lane = (lane + 1) & (RNG_LANES - 1);
+
+	return (result);
+}
+
+/*____________________________________________________________________
+|
+| Function: Rng_Range
+|
+| Input: Called from any module
+| Output: Returns a random integer, low <= n < high.
+|___________________________________________________________________*/
+
+int Rng_Range (Rng *rng, int low, int high)
+{
+	unsigned range = (unsigned)(high - low);
+
+	return (low + (int)(((unsigned long long) Rng_Next (rng) * range) >> 32));
+}
+
+/*____________________________________________________________________
+|
+| Function: Rng_Float_Range
+|
+| Input: Called from any module
+| Output: Returns a random float, low <= f <= high.
+|___________________________________________________________________*/
+
+float Rng_Float_Range (Rng *rng, float low, float high)
+{
+	float f = (float)(Rng_Next (rng) >> 8) * FLOAT_SCALE;
+
+	return (f * (high - low) + low);
+}
+
+/*____________________________________________________________________
+|
+| Function: Rng_Fill_Float_Range
+|
+| Input: Called from World_Spawn_Monsters(), headless driver
+| Output: Fills out with count random floats, low <= f <= high.  The
+|   same values as count calls to Rng_Float_Range().
+|___________________________________________________________________*/
+
+void Rng_Fill_Float_Range (Rng *rng, float *out, int count, float low, float high)
+{
+	int i = 0;
+
+	// Single draws until the next one comes from the first generator
+	for (; i < count && rng->lane != 0; i++)
+		out[i] = Rng_Float_Range (rng, low, high);
+
+#ifdef RNG_SSE2
+	if (count - i >= RNG_LANES) {
+		__m128i s0 = _mm_loadu_si128 ((const __m128i *) rng->s[0]);
+		__m128i s1 = _mm_loadu_si128 ((const __m128i *) rng->s[1]);
+		__m128i s2 = _mm_loadu_si128 ((const __m128i *) rng->s[2]);
+		__m128i s3 = _mm_loadu_si128 ((const __m128i *) rng->s[3]);
+		__m128 scale = _mm_set1_ps (FLOAT_SCALE);
+		__m128 range = _mm_set1_ps (high - low);
+		__m128 base = _mm_set1_ps (low);
+
+		for (; count - i >= RNG_LANES; i += RNG_LANES) {
+			__m128i sum = _mm_add_epi32 (s0, s3);
+			__m128i result = _mm_add_epi32 (_mm_or_si128 (_mm_slli_epi32 (sum, 7), _mm_srli_epi32 (sum, 25)), s0);
+			__m128i t = _mm_slli_epi32 (s1, 9);
+			s2 = _mm_xor_si128 (s2, s0);
+			s3 = _mm_xor_si128 (s3, s1);
+			s1 = _mm_xor_si128 (s1, s2);
+			s0 = _mm_xor_si128 (s0, s3);
+			s2 = _mm_xor_si128 (s2, t);
+			s3 = _mm_or_si128 (_mm_slli_epi32 (s3, 11), _mm_srli_epi32 (s3, 21));
+
+			// Same operations, in the same order, as Rng_Float_Range()
+			__m128 f = _mm_mul_ps (_mm_cvtepi32_ps (_mm_srli_epi32 (result, 8)), scale);
+			_mm_storeu_ps (out + i, _mm_add_ps (_mm_mul_ps (f, range), base));
+		}
+
+		_mm_storeu_si128 ((__m128i *) rng->s[0], s0);
+		_mm_storeu_si128 ((__m128i *) rng->s[1], s1);
+		_mm_storeu_si128 ((__m128i *) rng->s[2], s2);
+		_mm_storeu_si128 ((__m128i *) rng->s[3], s3);
+	}
+#endif
+
+	for (; i < count; i++)
+		out[i] = Rng_Float_Range (rng, low, high);
+}
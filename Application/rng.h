@@ -0,0 +1,61 @@
+/*____________________________________________________________________
+|
+| File: rng.h
+|
+| Description: Seedable random number streams (xoshiro128++).  Every
+|   stream is its own state, seeded from a master seed and a stream id,
+|   so each system draws from its own stream: adding draws to one
+|   system doesn't change what another gets, and a thread can own a
+|   stream without locking.  Results are the same on every platform.
+|
+|   A stream runs 4 interleaved generators, so bulk fills produce 4
+|   values at a time with SSE2 (one at a time elsewhere).  Bulk and
+|   single draws give exactly the same sequence.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _RNG_H_
+#define _RNG_H_
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define RNG_LANES 4
+
+// Stream ids
+typedef enum {
+	RNG_STREAM_LAYOUT,         // events, scenery
+	RNG_STREAM_SPAWN,          // monster placement
+	RNG_STREAM_EFFECTS,        // presentation only (particles, sounds), never the simulation
+	RNG_NUM_STREAMS
+} RngStream;
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	unsigned s[4][RNG_LANES];  // state word i of each generator
+	int      lane;             // generator the next single draw comes from
+} Rng;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+void     Rng_Seed (Rng *rng, unsigned long long master_seed, int stream);
+
+unsigned Rng_Next (Rng *rng);                                   // 32 random bits
+int      Rng_Range (Rng *rng, int low, int high);               // low <= n < high
+float    Rng_Float_Range (Rng *rng, float low, float high);     // low <= f <= high
+
+// Fills out with count Rng_Float_Range() draws
+void     Rng_Fill_Float_Range (Rng *rng, float *out, int count, float low, float high);
+
+#endif
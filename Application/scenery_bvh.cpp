@@ -0,0 +1,236 @@
+/*____________________________________________________________________
+|
+| File: scenery_bvh.cpp
+|
+| Description: Bounding volume hierarchy over static scenery.
+|
+| Functions: SceneryBVH_Build
+|             Build_Node
+|            SceneryBVH_Free
+|            SceneryBVH_Cull
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include "scenery_bvh.h"
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	const float *xs;
+	const float *zs;
+	const float *local_min;
+	const float *local_max;
+} BuildData;
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static int Build_Node (SceneryBVH *bvh, const BuildData *data, int first, int count);
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define LEAF_ITEMS  8      // max # of items in a leaf
+#define MAX_DEPTH   64     // median splits keep depth near log2(items/LEAF_ITEMS)
+
+/*____________________________________________________________________
+|
+| Function: SceneryBVH_Build
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Builds the hierarchy top down, splitting each node at the
+|   median of its items along the longer of x and z.  Returns true on
+|   success, else false.
+|___________________________________________________________________*/
+
+bool SceneryBVH_Build (
+	SceneryBVH  *bvh,
+	const float *xs,
+	const float *zs,
+	int          count,
+	const float *local_min,
+	const float *local_max )
+{
+	BuildData data;
+
+	memset (bvh, 0, sizeof(SceneryBVH));
+	if (count <= 0)
+		return (true);
+
+	// A binary tree with at least one item per leaf has fewer than 2*count nodes
+	bvh->nodes = (SceneryBVHNode *) malloc (2 * count * sizeof(SceneryBVHNode));
+	bvh->items = (int *) malloc (count * sizeof(int));
+	bvh->item_x = (float *) malloc (count * sizeof(float));
+	bvh->item_z = (float *) malloc (count * sizeof(float));
+	if (bvh->nodes == NULL || bvh->items == NULL || bvh->item_x == NULL || bvh->item_z == NULL) {
+		SceneryBVH_Free (bvh);
+		return (false);
+	}
+	for (int i = 0; i < count; i++)
+		bvh->items[i] = i;
+	bvh->num_items = count;
+	memcpy (bvh->local_min, local_min, 3 * sizeof(float));
+	memcpy (bvh->local_max, local_max, 3 * sizeof(float));
+
+	data.xs = xs;
+	data.zs = zs;
+	data.local_min = local_min;
+	data.local_max = local_max;
+	Build_Node (bvh, &data, 0, count);
+
+	// Copy positions in item order so culling a leaf reads memory sequentially
+	for (int i = 0; i < count; i++) {
+		bvh->item_x[i] = xs[bvh->items[i]];
+		bvh->item_z[i] = zs[bvh->items[i]];
+	}
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Build_Node
+|
+| Input: Called from SceneryBVH_Build(), Build_Node()
+| Output: Creates the node for items[first] thru items[first+count-1]
+|   and everything under it.  Returns the index of the node.
+|___________________________________________________________________*/
+
+static int Build_Node (SceneryBVH *bvh, const BuildData *data, int first, int count)
+{
+	int index = bvh->num_nodes++;
+	SceneryBVHNode *node = &bvh->nodes[index];
+	int *items = &bvh->items[first];
+	float cmin_x, cmax_x, cmin_z, cmax_z;
+
+	// Bounds of the item positions
+	cmin_x = cmax_x = data->xs[items[0]];
+	cmin_z = cmax_z = data->zs[items[0]];
+	for (int i = 1; i < count; i++) {
+		float x = data->xs[items[i]];
+		float z = data->zs[items[i]];
+		if (x < cmin_x) cmin_x = x;
+		if (x > cmax_x) cmax_x = x;
+		if (z < cmin_z) cmin_z = z;
+		if (z > cmax_z) cmax_z = z;
+	}
+	// Every item is the same object, so the node's box is the position bounds grown by the object's box
+	node->min[0] = cmin_x + data->local_min[0];
+	node->min[1] = data->local_min[1];
+	node->min[2] = cmin_z + data->local_min[2];
+	node->max[0] = cmax_x + data->local_max[0];
+	node->max[1] = data->local_max[1];
+	node->max[2] = cmax_z + data->local_max[2];
+	node->first = first;
+	node->count = count;
+	node->right = -1;
+
+	if (count > LEAF_ITEMS) {
+		int half = count / 2;
+		const float *axis = (cmax_x - cmin_x) >= (cmax_z - cmin_z) ? data->xs : data->zs;
+		std::nth_element (items, items + half, items + count, [axis] (int a, int b) { return (axis[a] < axis[b]); });
+		Build_Node (bvh, data, first, half);
+		node->right = Build_Node (bvh, data, first + half, count - half);
+	}
+
+	return (index);
+}
+
+/*____________________________________________________________________
+|
+| Function: SceneryBVH_Free
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Frees all memory used by the hierarchy.
+|___________________________________________________________________*/
+
+void SceneryBVH_Free (SceneryBVH *bvh)
+{
+	free (bvh->nodes);
+	free (bvh->items);
+	free (bvh->item_x);
+	free (bvh->item_z);
+	memset (bvh, 0, sizeof(SceneryBVH));
+}
+
+/*____________________________________________________________________
+|
+| Function: SceneryBVH_Cull
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Walks the hierarchy depth first.  A node outside the frustum
+|   is skipped along with its subtree, a node inside has all its items
+|   accepted, and children of a node only test the planes their parent
+|   straddles.  Items in a leaf that straddles the frustum are tested
+|   individually.  Returns # of indices written to out.
+|___________________________________________________________________*/
+
+int SceneryBVH_Cull (const SceneryBVH *bvh, const Frustum *frustum, int *out)
+{
+	int stack_node[MAX_DEPTH * 2];
+	unsigned stack_planes[MAX_DEPTH * 2];
+	int sp = 0, found = 0;
+
+	if (bvh->num_nodes == 0)
+		return (0);
+
+	stack_node[sp] = 0;
+	stack_planes[sp] = FRUSTUM_ALL_PLANES;
+	sp++;
+
+	while (sp > 0) {
+		sp--;
+		const SceneryBVHNode *node = &bvh->nodes[stack_node[sp]];
+		unsigned planes = stack_planes[sp];
+
+		FrustumRelation relation = Frustum_Test_Box (frustum, node->min, node->max, &planes);
+		if (relation == FRUSTUM_OUTSIDE)
+			continue;
+		if (relation == FRUSTUM_INSIDE) {
+			memcpy (&out[found], &bvh->items[node->first], node->count * sizeof(int));
+			found += node->count;
+		}
+		else if (node->right == -1) {
+			float item_min[3], item_max[3];
+			item_min[1] = bvh->local_min[1];
+			item_max[1] = bvh->local_max[1];
+			for (int i = node->first; i < node->first + node->count; i++) {
+				item_min[0] = bvh->item_x[i] + bvh->local_min[0];
+				item_min[2] = bvh->item_z[i] + bvh->local_min[2];
+				item_max[0] = bvh->item_x[i] + bvh->local_max[0];
+				item_max[2] = bvh->item_z[i] + bvh->local_max[2];
+				unsigned item_planes = planes;
+				if (Frustum_Test_Box (frustum, item_min, item_max, &item_planes) != FRUSTUM_OUTSIDE)
+					out[found++] = bvh->items[i];
+			}
+		}
+		else {
+			stack_node[sp] = node->right;
+			stack_planes[sp] = planes;
+			sp++;
+			stack_node[sp] = (int)(node - bvh->nodes) + 1;
+			stack_planes[sp] = planes;
+			sp++;
+		}
+	}
+
+	return (found);
+}
@@ -0,0 +1,66 @@
+/*____________________________________________________________________
+|
+| File: scenery_bvh.h
+|
+| Description: Bounding volume hierarchy over static scenery (trees,
+|   flowers).  Built once after the scenery is placed, then walked each
+|   frame so a subtree completely outside the view frustum is rejected,
+|   and one completely inside is accepted, with a single box test.
+|   Every node's items are contiguous in the items array, so accepting a
+|   subtree is a copy.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _SCENERY_BVH_H_
+#define _SCENERY_BVH_H_
+
+#include "frustum.h"
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	float min[3];              // bounding box of everything under this node
+	float max[3];
+	int   first;               // this node's items are items[first] thru items[first+count-1]
+	int   count;
+	int   right;               // index of right child (left child follows this node), -1 if a leaf
+} SceneryBVHNode;
+
+typedef struct {
+	SceneryBVHNode *nodes;
+	int             num_nodes;
+	int            *items;      // caller's item indices, grouped by node
+	float          *item_x;     // position of each entry in items
+	float          *item_z;
+	int             num_items;
+	float           local_min[3];  // object bounding box
+	float           local_max[3];
+} SceneryBVH;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+// Builds the hierarchy over count items of the same object, placed at
+//   xs,zs (on the ground).  local_min,local_max is the object's bounding
+//   box.  Returns true on success, else false.
+bool SceneryBVH_Build (
+	SceneryBVH  *bvh,
+	const float *xs,
+	const float *zs,
+	int          count,
+	const float *local_min,
+	const float *local_max );
+void SceneryBVH_Free (SceneryBVH *bvh);
+
+// Writes the indices of items that may be visible to out (room for
+//   bvh->num_items) and returns how many
+int  SceneryBVH_Cull (const SceneryBVH *bvh, const Frustum *frustum, int *out);
+
+#endif
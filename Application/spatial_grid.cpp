@@ -0,0 +1,390 @@
+/*____________________________________________________________________
+|
+| File: spatial_grid.cpp
+|
+| Description: Uniform grid over the x-z plane for proximity queries.
+|
+| Functions: SpatialGrid_Init
+|            SpatialGrid_Free
+|            SpatialGrid_Reserve
+|            SpatialGrid_Insert
+|             Link
+|            SpatialGrid_Remove
+|             Unlink
+|            SpatialGrid_Update
+|            SpatialGrid_Rename
+|            SpatialGrid_Cell_Index
+|            SpatialGrid_Cell_Coord
+|            SpatialGrid_Query_Radius
+|            SpatialGrid_Query_Nearest
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "spatial_grid.h"
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static void Link (SpatialGrid *grid, int id, int cell);
+static void Unlink (SpatialGrid *grid, int id);
+
+/*____________________________________________________________________
+|
+| Function: SpatialGrid_Init
+|
+| Input: Called from World_Init()
+| Output: Creates an empty grid covering min..max in x and z, with
+|   room for capacity ids.  Returns true on success, else false.
+|___________________________________________________________________*/
+
+bool SpatialGrid_Init (SpatialGrid *grid, float min, float max, float cell_size, int capacity)
+{
+	int n;
+
+	memset (grid, 0, sizeof(SpatialGrid));
+
+	grid->min = min;
+	grid->max = max;
+	grid->cell_size = cell_size;
+	grid->inv_cell_size = 1 / cell_size;
+	grid->cells = (int) ceilf ((max - min) / cell_size);
+	if (grid->cells < 1)
+		grid->cells = 1;
+
+	n = grid->cells * grid->cells;
+	grid->head = (int *) malloc (n * sizeof(int));
+	if (grid->head == NULL)
+		return (false);
+	for (int i = 0; i < n; i++)
+		grid->head[i] = -1;
+
+	return (SpatialGrid_Reserve (grid, capacity));
+}
+
+/*____________________________________________________________________
+|
+| Function: SpatialGrid_Free
+|
+| Input: Called from World_Free()
+| Output: Frees all memory used by the grid.
+|___________________________________________________________________*/
+
+void SpatialGrid_Free (SpatialGrid *grid)
+{
+	free (grid->head);
+	free (grid->next);
+	free (grid->prev);
+	free (grid->cell);
+	memset (grid, 0, sizeof(SpatialGrid));
+}
+
+/*____________________________________________________________________
+|
+| Function: SpatialGrid_Reserve
+|
+| Input: Called from SpatialGrid_Init(), World
+| Output: Makes room for ids 0 thru capacity-1.  Returns true on
+|   success, else false.
+|___________________________________________________________________*/
+
+bool SpatialGrid_Reserve (SpatialGrid *grid, int capacity)
+{
+	int *next, *prev, *cell;
+
+	if (capacity <= grid->capacity)
+		return (true);
+
+	next = (int *) realloc (grid->next, capacity * sizeof(int));
+	if (next)
+		grid->next = next;
+	prev = (int *) realloc (grid->prev, capacity * sizeof(int));
+	if (prev)
+		grid->prev = prev;
+	cell = (int *) realloc (grid->cell, capacity * sizeof(int));
+	if (cell)
+		grid->cell = cell;
+	if (next == NULL || prev == NULL || cell == NULL)
+		return (false);
+
+	for (int i = grid->capacity; i < capacity; i++) {
+		grid->next[i] = -1;
+		grid->prev[i] = -1;
+		grid->cell[i] = -1;
+	}
+	grid->capacity = capacity;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: SpatialGrid_Cell_Coord
+|
+| Input: Called from grid functions, hitscan
+| Output: Returns the cell column (or row) containing v, clamped to the
+|   grid.
+|___________________________________________________________________*/
+
+int SpatialGrid_Cell_Coord (const SpatialGrid *grid, float v)
+{
+	int c = (int) floorf ((v - grid->min) * grid->inv_cell_size);
+
+	if (c < 0)
+		c = 0;
+	else if (c >= grid->cells)
+		c = grid->cells - 1;
+
+	return (c);
+}
+
+/*____________________________________________________________________
+|
+| Function: SpatialGrid_Cell_Index
+|
+| Input: Called from grid functions, hitscan
+| Output: Returns the index of the cell at column cx, row cz.
+|___________________________________________________________________*/
+
+int SpatialGrid_Cell_Index (const SpatialGrid *grid, int cx, int cz)
+{
+	return ((cz * grid->cells) + cx);
+}
+
+/*____________________________________________________________________
+|
+| Function: SpatialGrid_Insert
+|
+| Input: Called from World
+| Output: Adds id to the cell containing x,z.
+|___________________________________________________________________*/
+
+void SpatialGrid_Insert (SpatialGrid *grid, int id, float x, float z)
+{
+	if (id < 0 || id >= grid->capacity)
+		return;
+	if (grid->cell[id] != -1)
+		Unlink (grid, id);
+	Link (grid, id, SpatialGrid_Cell_Index (grid, SpatialGrid_Cell_Coord (grid, x), SpatialGrid_Cell_Coord (grid, z)));
+}
+
+/*____________________________________________________________________
+|
+| Function: SpatialGrid_Remove
+|
+| Input: Called from World
+| Output: Takes id out of the grid.
+|___________________________________________________________________*/
+
+void SpatialGrid_Remove (SpatialGrid *grid, int id)
+{
+	if (id < 0 || id >= grid->capacity || grid->cell[id] == -1)
+		return;
+	Unlink (grid, id);
+}
+
+/*____________________________________________________________________
+|
+| Function: SpatialGrid_Update
+|
+| Input: Called from World
+| Output: Moves id to the cell containing x,z, if it's not already
+|   there.
+|___________________________________________________________________*/
+
+void SpatialGrid_Update (SpatialGrid *grid, int id, float x, float z)
+{
+	int cell = SpatialGrid_Cell_Index (grid, SpatialGrid_Cell_Coord (grid, x), SpatialGrid_Cell_Coord (grid, z));
+
+	if (grid->cell[id] != cell) {
+		if (grid->cell[id] != -1)
+			Unlink (grid, id);
+		Link (grid, id, cell);
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: SpatialGrid_Rename
+|
+| Input: Called from World when a monster is swap-removed
+| Output: Replaces id 'from' with id 'to' in the same cell and list
+|   position.  'to' must not be in the grid.
+|___________________________________________________________________*/
+
+void SpatialGrid_Rename (SpatialGrid *grid, int from, int to)
+{
+	int cell = grid->cell[from];
+
+	if (from == to || cell == -1)
+		return;
+
+	grid->next[to] = grid->next[from];
+	grid->prev[to] = grid->prev[from];
+	grid->cell[to] = cell;
+	if (grid->prev[to] != -1)
+		grid->next[grid->prev[to]] = to;
+	else
+		grid->head[cell] = to;
+	if (grid->next[to] != -1)
+		grid->prev[grid->next[to]] = to;
+
+	grid->next[from] = -1;
+	grid->prev[from] = -1;
+	grid->cell[from] = -1;
+}
+
+/*____________________________________________________________________
+|
+| Function: Link
+|
+| Input: Called from SpatialGrid_Insert(), SpatialGrid_Update()
+| Output: Puts id at the front of a cell's list.
+|___________________________________________________________________*/
+
+static void Link (SpatialGrid *grid, int id, int cell)
+{
+	int first = grid->head[cell];
+
+	grid->prev[id] = -1;
+	grid->next[id] = first;
+	if (first != -1)
+		grid->prev[first] = id;
+	grid->head[cell] = id;
+	grid->cell[id] = cell;
+}
+
+/*____________________________________________________________________
+|
+| Function: Unlink
+|
+| Input: Called from grid functions
+| Output: Takes id out of its cell's list.
+|___________________________________________________________________*/
+
+static void Unlink (SpatialGrid *grid, int id)
+{
+	int prev = grid->prev[id];
+	int next = grid->next[id];
+
+	if (prev != -1)
+		grid->next[prev] = next;
+	else
+		grid->head[grid->cell[id]] = next;
+	if (next != -1)
+		grid->prev[next] = prev;
+
+	grid->next[id] = -1;
+	grid->prev[id] = -1;
+	grid->cell[id] = -1;
+}
+
+/*____________________________________________________________________
+|
+| Function: SpatialGrid_Query_Radius
+|
+| Input: Called from World
+| Output: Looks only at the cells overlapping the circle.  Returns # of
+|   ids within radius of x,z and writes up to max_out of them to out.
+|___________________________________________________________________*/
+
+int SpatialGrid_Query_Radius (
+	const SpatialGrid *grid,
+	float              x,
+	float              z,
+	float              radius,
+	const float       *xs,
+	const float       *zs,
+	int               *out,
+	int                max_out )
+{
+	int found = 0;
+	float r2 = radius * radius;
+	int cx0 = SpatialGrid_Cell_Coord (grid, x - radius);
+	int cx1 = SpatialGrid_Cell_Coord (grid, x + radius);
+	int cz0 = SpatialGrid_Cell_Coord (grid, z - radius);
+	int cz1 = SpatialGrid_Cell_Coord (grid, z + radius);
+
+	for (int cz = cz0; cz <= cz1; cz++) {
+		for (int cx = cx0; cx <= cx1; cx++) {
+			for (int id = grid->head[SpatialGrid_Cell_Index (grid, cx, cz)]; id != -1; id = grid->next[id]) {
+				float dx = xs[id] - x;
+				float dz = zs[id] - z;
+				if ((dx * dx) + (dz * dz) < r2) {
+					if (found < max_out)
+						out[found] = id;
+					found++;
+				}
+			}
+		}
+	}
+
+	return (found);
+}
+
+/*____________________________________________________________________
+|
+| Function: SpatialGrid_Query_Nearest
+|
+| Input: Called from World
+| Output: Searches rings of cells outward from x,z until no closer id
+|   can exist.  Returns the closest id within max_radius or -1.
+|___________________________________________________________________*/
+
+int SpatialGrid_Query_Nearest (
+	const SpatialGrid *grid,
+	float              x,
+	float              z,
+	float              max_radius,
+	const float       *xs,
+	const float       *zs,
+	float             *dist )
+{
+	int best = -1;
+	float best_d2 = max_radius * max_radius;
+	int cx = SpatialGrid_Cell_Coord (grid, x);
+	int cz = SpatialGrid_Cell_Coord (grid, z);
+
+	for (int ring = 0; ring < grid->cells; ring++) {
+		// everything in this ring or beyond is at least this far away
+		float ring_dist = (ring - 1) * grid->cell_size;
+		if (ring_dist > 0 && ring_dist * ring_dist >= best_d2)
+			break;
+		for (int rz = cz - ring; rz <= cz + ring; rz++) {
+			if (rz < 0 || rz >= grid->cells)
+				continue;
+			// only the edges of the ring (all of it for the first ring)
+			int step = (rz == cz - ring || rz == cz + ring) ? 1 : 2 * ring;
+			for (int rx = cx - ring; rx <= cx + ring; rx += step) {
+				if (rx < 0 || rx >= grid->cells)
+					continue;
+				for (int id = grid->head[SpatialGrid_Cell_Index (grid, rx, rz)]; id != -1; id = grid->next[id]) {
+					float dx = xs[id] - x;
+					float dz = zs[id] - z;
+					float d2 = (dx * dx) + (dz * dz);
+					if (d2 < best_d2) {
+						best_d2 = d2;
+						best = id;
+					}
+				}
+			}
+		}
+	}
+
+	if (dist && best != -1)
+		*dist = sqrtf (best_d2);
+
+	return (best);
+}
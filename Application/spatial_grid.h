@@ -0,0 +1,77 @@
+/*____________________________________________________________________
+|
+| File: spatial_grid.h
+|
+| Description: Uniform grid over the x-z plane for proximity queries.
+|   Each cell keeps an intrusive linked list of the ids in it, so
+|   inserting, removing and moving an id are constant time and a moving
+|   id is only relinked when it crosses into another cell.  Ids are
+|   indices into the caller's own position arrays, which are passed to
+|   the queries.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _SPATIAL_GRID_H_
+#define _SPATIAL_GRID_H_
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	float min;            // grid covers min..max in both x and z (positions outside are clamped)
+	float max;
+	float cell_size;
+	float inv_cell_size;
+	int   cells;          // # of cells along each axis
+	int  *head;           // first id in each cell, -1 if empty
+	int  *next;           // per id: next id in same cell, -1 at end
+	int  *prev;           // per id: previous id in same cell, -1 at start
+	int  *cell;           // per id: cell it is in, -1 if not in grid
+	int   capacity;       // # of ids there is room for
+} SpatialGrid;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+bool SpatialGrid_Init (SpatialGrid *grid, float min, float max, float cell_size, int capacity);
+void SpatialGrid_Free (SpatialGrid *grid);
+bool SpatialGrid_Reserve (SpatialGrid *grid, int capacity);
+
+void SpatialGrid_Insert (SpatialGrid *grid, int id, float x, float z);
+void SpatialGrid_Remove (SpatialGrid *grid, int id);
+// Moves id to the cell for x,z (does nothing if it hasn't changed cells)
+void SpatialGrid_Update (SpatialGrid *grid, int id, float x, float z);
+// Gives id 'from' the new id 'to' (to must not be in the grid), for swap-remove arrays
+void SpatialGrid_Rename (SpatialGrid *grid, int from, int to);
+
+int  SpatialGrid_Cell_Index (const SpatialGrid *grid, int cx, int cz);
+int  SpatialGrid_Cell_Coord (const SpatialGrid *grid, float v);
+
+// Returns # of ids within radius of x,z (writes up to max_out of them to out)
+int  SpatialGrid_Query_Radius (
+	const SpatialGrid *grid,
+	float              x,
+	float              z,
+	float              radius,
+	const float       *xs,        // positions of ids
+	const float       *zs,
+	int               *out,
+	int                max_out );
+
+// Returns closest id within max_radius of x,z or -1 if none
+int  SpatialGrid_Query_Nearest (
+	const SpatialGrid *grid,
+	float              x,
+	float              z,
+	float              max_radius,
+	const float       *xs,
+	const float       *zs,
+	float             *dist );    // distance to closest id (can be NULL)
+
+#endif
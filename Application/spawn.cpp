@@ -0,0 +1,144 @@
+/*____________________________________________________________________
+|
+| File: spawn.cpp
+|
+| Description: Spawn points outside an exclusion radius.
+|
+| Functions: Spawn_Init
+|            Spawn_Free
+|            Spawn_Set_Center
+|            Spawn_Points
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "spawn.h"
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define POINT_BATCH 128    // offsets drawn per bulk fill
+
+/*____________________________________________________________________
+|
+| Function: Spawn_Init
+|
+| Input: Called from World_Init(), headless driver
+| Output: Sets up a region with the cells of grid and no center yet
+|   (every cell allowed).  Returns true on success, else false.
+|___________________________________________________________________*/
+
+bool Spawn_Init (SpawnRegion *region, const SpatialGrid *grid, float radius)
+{
+	memset (region, 0, sizeof(SpawnRegion));
+	region->min = grid->min;
+	region->cell_size = grid->cell_size;
+	region->cells = grid->cells;
+	region->radius = radius;
+
+	region->allowed = (int *) malloc (region->cells * region->cells * sizeof(int));
+	if (region->allowed == NULL)
+		return (false);
+	for (int i = 0; i < region->cells * region->cells; i++)
+		region->allowed[i] = i;
+	region->num_allowed = region->cells * region->cells;
+	region->center_cx = -1;
+	region->center_cz = -1;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Spawn_Free
+|
+| Input: Called from World_Free(), headless driver
+| Output: Frees all memory used by the region.
+|___________________________________________________________________*/
+
+void Spawn_Free (SpawnRegion *region)
+{
+	free (region->allowed);
+	memset (region, 0, sizeof(SpawnRegion));
+}
+
+/*____________________________________________________________________
+|
+| Function: Spawn_Set_Center
+|
+| Input: Called from Respawn_Monsters(), headless driver
+| Output: Moves the exclusion to x,z (clamped to the area, like the
+|   grid).  A cell is allowed if no point in it can be closer than
+|   radius to any point in the center's cell, so the list only depends
+|   on which cell the center is in.
+|___________________________________________________________________*/
+
+void Spawn_Set_Center (SpawnRegion *region, float x, float z)
+{
+	int cx = (int)((x - region->min) / region->cell_size);
+	int cz = (int)((z - region->min) / region->cell_size);
+	float r2 = region->radius * region->radius;
+
+	if (cx < 0)
+		cx = 0;
+	else if (cx >= region->cells)
+		cx = region->cells - 1;
+	if (cz < 0)
+		cz = 0;
+	else if (cz >= region->cells)
+		cz = region->cells - 1;
+	if (cx == region->center_cx && cz == region->center_cz)
+		return;
+
+	region->center_cx = cx;
+	region->center_cz = cz;
+	region->num_allowed = 0;
+	for (int j = 0; j < region->cells; j++) {
+		// Gap between this row of cells and the center's
+		int gz = abs (j - cz) - 1;
+		float dz = gz > 0 ? gz * region->cell_size : 0;
+		for (int i = 0; i < region->cells; i++) {
+			int gx = abs (i - cx) - 1;
+			float dx = gx > 0 ? gx * region->cell_size : 0;
+			if (dx * dx + dz * dz >= r2)
+				region->allowed[region->num_allowed++] = j * region->cells + i;
+		}
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Spawn_Points
+|
+| Input: Called from Respawn_Monsters(), headless driver
+| Output: Writes count points, each in a random allowed cell (anywhere
+|   in the area if none are allowed).
+|___________________________________________________________________*/
+
+void Spawn_Points (SpawnRegion *region, Rng *rng, float *xs, float *zs, int count)
+{
+	float offset[2 * POINT_BATCH];
+	int n, cell;
+
+	for (n = 0; n < count; n++) {
+		if (n % POINT_BATCH == 0)
+			Rng_Fill_Float_Range (rng, offset, 2 * (count - n < POINT_BATCH ? count - n : POINT_BATCH), 0, region->cell_size);
+		if (region->num_allowed)
+			cell = region->allowed[Rng_Range (rng, 0, region->num_allowed)];
+		else
+			cell = Rng_Range (rng, 0, region->cells * region->cells);
+		xs[n] = region->min + (cell % region->cells) * region->cell_size + offset[2 * (n % POINT_BATCH)];
+		zs[n] = region->min + (cell / region->cells) * region->cell_size + offset[2 * (n % POINT_BATCH) + 1];
+	}
+}
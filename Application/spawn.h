@@ -0,0 +1,56 @@
+/*____________________________________________________________________
+|
+| File: spawn.h
+|
+| Description: Picks spawn points in the play area that are at least
+|   a given distance from a center (the player), in constant time per
+|   point.  The area is split into the cells of a spatial grid and only
+|   cells entirely outside the exclusion radius are sampled: a random
+|   allowed cell, then a random point in it.  The allowed cells are
+|   listed again only when the center moves into another cell.
+|
+|   If no cell is far enough away (a tiny area or a huge radius), points
+|   come from the whole area.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _SPAWN_H_
+#define _SPAWN_H_
+
+#include "spatial_grid.h"
+#include "rng.h"
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	float min;                 // area covers min..max in x and z
+	float cell_size;
+	int   cells;               // # of cells along each axis
+	float radius;              // exclusion radius
+	int  *allowed;             // cells entirely outside the exclusion
+	int   num_allowed;
+	int   center_cx;           // cell of the center the list was made for (-1 if none)
+	int   center_cz;
+} SpawnRegion;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+// Uses the same cells as grid.  Returns true on success, else false.
+bool Spawn_Init (SpawnRegion *region, const SpatialGrid *grid, float radius);
+void Spawn_Free (SpawnRegion *region);
+
+// Moves the center of the exclusion
+void Spawn_Set_Center (SpawnRegion *region, float x, float z);
+
+// Writes count random points at least radius from the center
+void Spawn_Points (SpawnRegion *region, Rng *rng, float *xs, float *zs, int count);
+
+#endif
@@ -0,0 +1,427 @@
+/*____________________________________________________________________
+|
+| File: voice.cpp
+|
+| Description: Sound voice manager with virtual voices.
+|
+| Functions: Voice_Init
+|            Voice_Free
+|            Voice_Load
+|            Voice_Create_Emitter
+|             New_Emitter
+|            Voice_Set_Position
+|            Voice_Set_Sample
+|            Voice_Play
+|            Voice_Stop
+|             Release_Voice
+|            Voice_Is_Playing
+|            Voice_Play_Once
+|            Voice_Update
+|             Audibility
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "voice.h"
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static int   New_Emitter (VoiceManager *manager, int sample, bool one_shot);
+static void  Release_Voice (VoiceManager *manager, VoiceEmitter *e, bool stop);
+static float Audibility (const VoiceManager *manager, const VoiceEmitter *e);
+
+/*____________________________________________________________________
+|
+| Function: Voice_Init
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Sets up a manager with num_voices real voices, all free, and
+|   room for max_emitters emitters.  Returns true on success, else false.
+|___________________________________________________________________*/
+
+bool Voice_Init (VoiceManager *manager, const VoiceBackend *backend, int num_voices, int max_emitters)
+{
+	memset (manager, 0, sizeof(VoiceManager));
+	manager->backend = *backend;
+	if (num_voices > VOICE_MAX_VOICES)
+		num_voices = VOICE_MAX_VOICES;
+
+	manager->emitters = (VoiceEmitter *) calloc (max_emitters > 0 ? max_emitters : 1, sizeof(VoiceEmitter));
+	manager->order = (int *) malloc ((max_emitters > 0 ? max_emitters : 1) * sizeof(int));
+	manager->voice_owner = (int *) malloc ((num_voices > 0 ? num_voices : 1) * sizeof(int));
+	if (manager->emitters == NULL || manager->order == NULL || manager->voice_owner == NULL) {
+		Voice_Free (manager);
+		return (false);
+	}
+	manager->max_emitters = max_emitters;
+	manager->num_voices = num_voices;
+	for (int i = 0; i < num_voices; i++)
+		manager->voice_owner[i] = -1;
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Voice_Free
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Frees all memory used by the manager (the backend frees its
+|   own samples).
+|___________________________________________________________________*/
+
+void Voice_Free (VoiceManager *manager)
+{
+	free (manager->emitters);
+	free (manager->order);
+	free (manager->voice_owner);
+	memset (manager, 0, sizeof(VoiceManager));
+}
+
+/*____________________________________________________________________
+|
+| Function: Voice_Load
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Returns the sample id for a file, loading it through the
+|   backend only the first time.  Returns -1 on error.
+|___________________________________________________________________*/
+
+int Voice_Load (VoiceManager *manager, const char *file, bool positional, float min_dist, float max_dist, float volume)
+{
+	VoiceSample *s;
+
+	for (int i = 0; i < manager->num_samples; i++) {
+		s = &manager->samples[i];
+		if (!strcmp (s->file, file) && s->positional == positional && s->min_dist == min_dist && s->max_dist == max_dist && s->volume == volume)
+			return (i);
+	}
+	if (manager->num_samples == VOICE_MAX_SAMPLES || strlen (file) >= VOICE_MAX_PATH)
+		return (-1);
+
+	s = &manager->samples[manager->num_samples];
+	strcpy (s->file, file);
+	s->positional = positional;
+	s->min_dist = min_dist;
+	s->max_dist = max_dist;
+	s->volume = volume;
+	s->seconds = 0;
+	if (!manager->backend.load_sample (manager->backend.context, manager->num_samples, file, positional, min_dist, max_dist, &s->seconds))
+		return (-1);
+
+	return (manager->num_samples++);
+}
+
+/*____________________________________________________________________
+|
+| Function: Voice_Create_Emitter
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Returns the id of a new, silent emitter or -1 if there are too
+|   many.
+|___________________________________________________________________*/
+
+int Voice_Create_Emitter (VoiceManager *manager, int sample)
+{
+	return (New_Emitter (manager, sample, false));
+}
+
+/*____________________________________________________________________
+|
+| Function: New_Emitter
+|
+| Input: Called from Voice_Create_Emitter(), Voice_Play_Once()
+| Output: Returns a free emitter set up for sample, or -1 if there are
+|   none.
+|___________________________________________________________________*/
+
+static int New_Emitter (VoiceManager *manager, int sample, bool one_shot)
+{
+	if (sample < 0 || sample >= manager->num_samples)
+		return (-1);
+
+	for (int i = 0; i < manager->max_emitters; i++) {
+		VoiceEmitter *e = &manager->emitters[i];
+		if (!e->in_use) {
+			memset (e, 0, sizeof(VoiceEmitter));
+			e->sample = sample;
+			e->in_use = true;
+			e->one_shot = one_shot;
+			e->voice = -1;
+			return (i);
+		}
+	}
+
+	return (-1);
+}
+
+/*____________________________________________________________________
+|
+| Function: Voice_Set_Position
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Moves an emitter.  The library only hears about it if the
+|   emitter is on a real voice at the next update.
+|___________________________________________________________________*/
+
+void Voice_Set_Position (VoiceManager *manager, int emitter, float x, float y, float z)
+{
+	VoiceEmitter *e = &manager->emitters[emitter];
+
+	if (e->x != x || e->y != y || e->z != z) {
+		e->x = x;
+		e->y = y;
+		e->z = z;
+		e->moved = true;
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Voice_Set_Sample
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Makes an emitter play sample from now on.
+|___________________________________________________________________*/
+
+void Voice_Set_Sample (VoiceManager *manager, int emitter, int sample)
+{
+	VoiceEmitter *e = &manager->emitters[emitter];
+
+	if (sample == e->sample || sample < 0 || sample >= manager->num_samples)
+		return;
+	if (e->playing)
+		Voice_Stop (manager, emitter);
+	e->sample = sample;
+}
+
+/*____________________________________________________________________
+|
+| Function: Voice_Play
+|
+| Input: Called from Program_Run(), Voice_Play_Once(), headless driver
+| Output: Starts an emitter's sound from the beginning.  It gets a real
+|   voice at the next update if it's audible enough (if it has one
+|   already, the sound restarts on it now).
+|___________________________________________________________________*/
+
+void Voice_Play (VoiceManager *manager, int emitter, bool loop)
+{
+	VoiceEmitter *e = &manager->emitters[emitter];
+
+	e->playing = true;
+	e->loop = loop;
+	e->time = 0;
+	if (e->voice != -1)
+		manager->backend.play (manager->backend.context, e->voice, e->sample, loop, manager->samples[e->sample].volume);
+}
+
+/*____________________________________________________________________
+|
+| Function: Voice_Stop
+|
+| Input: Called from Program_Run(), Voice_Set_Sample(), headless driver
+| Output: Stops an emitter's sound, freeing its voice.
+|___________________________________________________________________*/
+
+void Voice_Stop (VoiceManager *manager, int emitter)
+{
+	VoiceEmitter *e = &manager->emitters[emitter];
+
+	Release_Voice (manager, e, true);
+	e->playing = false;
+	if (e->one_shot)
+		e->in_use = false;
+}
+
+/*____________________________________________________________________
+|
+| Function: Release_Voice
+|
+| Input: Called from Voice_Stop(), Voice_Update()
+| Output: Takes the real voice from an emitter (stopping it in the
+|   library if stop is set), leaving the emitter virtual.
+|___________________________________________________________________*/
+
+static void Release_Voice (VoiceManager *manager, VoiceEmitter *e, bool stop)
+{
+	if (e->voice == -1)
+		return;
+	if (stop)
+		manager->backend.stop (manager->backend.context, e->voice);
+	manager->voice_owner[e->voice] = -1;
+	e->voice = -1;
+}
+
+/*____________________________________________________________________
+|
+| Function: Voice_Is_Playing
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Returns true if the emitter's sound hasn't ended (on a real
+|   voice or not).
+|___________________________________________________________________*/
+
+bool Voice_Is_Playing (const VoiceManager *manager, int emitter)
+{
+	return (manager->emitters[emitter].playing);
+}
+
+/*____________________________________________________________________
+|
+| Function: Voice_Play_Once
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Plays a sample once at x,y,z from an emitter that frees itself
+|   when the sound ends.  Returns false if no emitter is free.
+|___________________________________________________________________*/
+
+bool Voice_Play_Once (VoiceManager *manager, int sample, float x, float y, float z)
+{
+	int emitter = New_Emitter (manager, sample, true);
+
+	if (emitter == -1)
+		return (false);
+	Voice_Set_Position (manager, emitter, x, y, z);
+	Voice_Play (manager, emitter, false);
+
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: Voice_Update
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Ends the sounds that have finished (real voices the library
+|   says have stopped, virtual ones past the sample's length), then
+|   gives the real voices to the most audible emitters: quieter ones
+|   lose theirs, louder ones start on a free voice (from the beginning,
+|   the library can't start part way).  Last, sends the positions of
+|   real voices that moved.
+|___________________________________________________________________*/
+
+void Voice_Update (VoiceManager *manager, float listener_x, float listener_y, float listener_z, float seconds)
+{
+	VoiceBackend *backend = &manager->backend;
+	int n = 0, budget, free_voice = 0;
+
+	manager->listener[0] = listener_x;
+	manager->listener[1] = listener_y;
+	manager->listener[2] = listener_z;
+	memset (&manager->stats, 0, sizeof(VoiceStats));
+
+	// Sounds that have ended
+	for (int i = 0; i < manager->max_emitters; i++) {
+		VoiceEmitter *e = &manager->emitters[i];
+		if (!e->in_use || !e->playing)
+			continue;
+		e->time += seconds;
+		if (e->loop)
+			continue;
+		if (e->voice != -1 ? !backend->is_playing (backend->context, e->voice) : e->time >= manager->samples[e->sample].seconds) {
+			Release_Voice (manager, e, false);
+			e->playing = false;
+			if (e->one_shot)
+				e->in_use = false;
+		}
+	}
+
+	// Rank what's still playing, silent ones give up their voices
+	for (int i = 0; i < manager->max_emitters; i++) {
+		VoiceEmitter *e = &manager->emitters[i];
+		if (!e->in_use || !e->playing)
+			continue;
+		e->audibility = Audibility (manager, e);
+		if (e->audibility > 0)
+			manager->order[n++] = i;
+		else
+			Release_Voice (manager, e, true);
+	}
+	budget = n < manager->num_voices ? n : manager->num_voices;
+	// Only the first budget places matter, so select them (ties go to the lower id)
+	for (int k = 0; k < budget; k++) {
+		int best = k;
+		for (int j = k + 1; j < n; j++) {
+			const VoiceEmitter *a = &manager->emitters[manager->order[j]], *b = &manager->emitters[manager->order[best]];
+			if (a->audibility > b->audibility || (a->audibility == b->audibility && manager->order[j] < manager->order[best]))
+				best = j;
+		}
+		int t = manager->order[k];
+		manager->order[k] = manager->order[best];
+		manager->order[best] = t;
+	}
+
+	// Quieter emitters go virtual, which frees enough voices for the louder ones
+	for (int k = budget; k < n; k++) {
+		VoiceEmitter *e = &manager->emitters[manager->order[k]];
+		if (e->voice != -1) {
+			Release_Voice (manager, e, true);
+			manager->stats.steals++;
+		}
+	}
+	for (int k = 0; k < budget; k++) {
+		int id = manager->order[k];
+		VoiceEmitter *e = &manager->emitters[id];
+		const VoiceSample *s = &manager->samples[e->sample];
+		if (e->voice == -1) {
+			while (manager->voice_owner[free_voice] != -1)
+				free_voice++;
+			e->voice = free_voice;
+			manager->voice_owner[free_voice] = id;
+			backend->play (backend->context, e->voice, e->sample, e->loop, s->volume);
+			e->moved = true;
+		}
+		if (e->moved && s->positional) {
+			backend->set_position (backend->context, e->voice, e->x, e->y, e->z);
+			manager->stats.position_updates++;
+		}
+		e->moved = false;
+	}
+
+	manager->stats.real = budget;
+	manager->stats.virtual_voices = n - budget;
+}
+
+/*____________________________________________________________________
+|
+| Function: Audibility
+|
+| Input: Called from Voice_Update()
+| Output: Returns how loud an emitter is at the listener: the sample's
+|   volume, falling off as min_dist / distance past min_dist, and 0 past
+|   max_dist.  Sounds that aren't positional are always at full volume.
+|___________________________________________________________________*/
+
+static float Audibility (const VoiceManager *manager, const VoiceEmitter *e)
+{
+	const VoiceSample *s = &manager->samples[e->sample];
+	float dx, dy, dz, d;
+
+	if (!s->positional)
+		return (s->volume);
+
+	dx = e->x - manager->listener[0];
+	dy = e->y - manager->listener[1];
+	dz = e->z - manager->listener[2];
+	d = sqrtf (dx * dx + dy * dy + dz * dz);
+	if (d >= s->max_dist)
+		return (0);
+	if (d <= s->min_dist)
+		return (s->volume);
+
+	return (s->volume * s->min_dist / d);
+}
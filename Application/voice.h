@@ -0,0 +1,121 @@
+/*____________________________________________________________________
+|
+| File: voice.h
+|
+| Description: Sound voice manager.  Each sound file is loaded once and
+|   any number of emitters (a monster's growl, a gun shot) can play it.
+|   Only a fixed budget of real voices is ever playing: each update the
+|   most audible emitters (loudest after distance falloff) get them and
+|   the rest are virtual, keeping their own playback time so they can
+|   finish or be heard again without costing the sound library anything.
+|   Positions only go to the library for emitters on a real voice.
+|
+|   The sound calls go through a table of backend functions, so the
+|   manager runs with the real sound library or with a stand-in that
+|   just counts calls.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _VOICE_H_
+#define _VOICE_H_
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define VOICE_MAX_SAMPLES 32
+#define VOICE_MAX_PATH    64
+#define VOICE_MAX_VOICES  32       // most real voices a manager can have
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	// Loads a sound file as sample id, sets its length in seconds (0 if unknown).  Returns true on success.
+	bool (*load_sample)  (void *context, int sample, const char *file, bool positional, float min_dist, float max_dist, float *seconds);
+	// Starts sample playing from the beginning on real voice voice (0-1 volume)
+	void (*play)         (void *context, int voice, int sample, bool loop, float volume);
+	void (*stop)         (void *context, int voice);
+	bool (*is_playing)   (void *context, int voice);
+	void (*set_position) (void *context, int voice, float x, float y, float z);
+	void  *context;
+} VoiceBackend;
+
+typedef struct {
+	char  file[VOICE_MAX_PATH];
+	bool  positional;          // false for sounds heard the same anywhere (2D)
+	float min_dist;            // full volume inside this
+	float max_dist;            // silent beyond this
+	float volume;              // 0-1
+	float seconds;             // length, 0 if unknown
+} VoiceSample;
+
+typedef struct {
+	int   sample;
+	float x, y, z;
+	bool  in_use;
+	bool  one_shot;            // free the emitter when the sound ends
+	bool  playing;
+	bool  loop;
+	bool  moved;               // position changed since last sent to the library
+	float time;                // seconds since it started playing
+	float audibility;          // volume after distance falloff, this update
+	int   voice;               // real voice, -1 if virtual
+} VoiceEmitter;
+
+typedef struct {
+	int real;                  // emitters on a real voice after the last update
+	int virtual_voices;        // emitters playing without one
+	int position_updates;      // positions sent to the library in the last update
+	int steals;                // real voices taken from quieter emitters in the last update
+} VoiceStats;
+
+typedef struct {
+	VoiceBackend  backend;
+	VoiceSample   samples[VOICE_MAX_SAMPLES];
+	int           num_samples;
+	VoiceEmitter *emitters;
+	int           max_emitters;
+	int          *voice_owner;  // emitter on each real voice, -1 if free
+	int           num_voices;
+	int          *order;        // scratch, emitters by audibility
+	float         listener[3];
+	VoiceStats    stats;
+} VoiceManager;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+// num_voices real voices (at most VOICE_MAX_VOICES), room for max_emitters emitters.  Returns true on success, else false.
+bool  Voice_Init (VoiceManager *manager, const VoiceBackend *backend, int num_voices, int max_emitters);
+void  Voice_Free (VoiceManager *manager);
+
+// Returns the sample id for a file (loaded the first time it's asked for), or -1 on error
+int   Voice_Load (VoiceManager *manager, const char *file, bool positional, float min_dist, float max_dist, float volume);
+
+// Returns a new emitter id or -1 if there are too many
+int   Voice_Create_Emitter (VoiceManager *manager, int sample);
+void  Voice_Set_Position (VoiceManager *manager, int emitter, float x, float y, float z);
+// Changes the sample an emitter plays, stopping it if it was playing another
+void  Voice_Set_Sample (VoiceManager *manager, int emitter, int sample);
+// Starts (or restarts) an emitter's sound
+void  Voice_Play (VoiceManager *manager, int emitter, bool loop);
+void  Voice_Stop (VoiceManager *manager, int emitter);
+// True if the emitter's sound hasn't ended, real or virtual
+bool  Voice_Is_Playing (const VoiceManager *manager, int emitter);
+
+// Plays a sample once from a temporary emitter.  Returns false if there's no free emitter.
+bool  Voice_Play_Once (VoiceManager *manager, int sample, float x, float y, float z);
+
+// Advances playback by seconds, hands the real voices to the most
+//   audible emitters and sends the positions that changed
+void  Voice_Update (VoiceManager *manager, float listener_x, float listener_y, float listener_z, float seconds);
+
+#endif
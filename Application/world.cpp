@@ -0,0 +1,662 @@
+/*____________________________________________________________________
+|
+| File: world.cpp
+|
+| Description: Platform independent game simulation.  Holds monster,
+|   scenery, event, first aid and player health state and advances it
+|   one step at a time.
+|
+| Functions: World_Init
+|            World_Free
+|            World_Spawn_Monsters
+|            World_Set_Monster_Kernel
+|            World_Set_Monster_Bounds
+|            World_Set_Shot_Penetration
+|            World_Cast_Shot
+|             Add_Shot_Hit
+|            World_Step
+|             Process_Shots
+|              Kill_Monster
+|             Collect_First_Aids
+|             Update_Monsters
+|              Respawn_Monsters
+|              Update_Monster_Grid
+|             Update_Hit_Markers
+|            World_Monster_Render_Position
+|            World_All_First_Aids_Collected
+|            World_Monsters_In_Radius
+|            World_Nearest_Monster
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+/*___________________
+|
+| Include Files
+|__________________*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "world.h"
+#include "profile.h"
+
+/*___________________
+|
+| Function Prototypes
+|__________________*/
+
+static void Process_Shots (World *world, float time_step, const WorldInput *input, WorldStepResult *result);
+static void Add_Shot_Hit (WorldShot *shot, int index, float distance, int max_hits);
+static void Collect_First_Aids (World *world, const WorldInput *input, WorldStepResult *result);
+static void Update_Monsters (World *world, float time_step, const WorldInput *input, WorldStepResult *result);
+static void Kill_Monster (World *world, int index, const WorldVector *position);
+static void Respawn_Monsters (World *world, const int *indices, int count, const WorldVector *position);
+static void Update_Monster_Grid (World *world);
+static void Update_Hit_Markers (World *world, float time_step);
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define HITS_TO_KILL      3
+#define SPAWN_BATCH       256		// monsters placed per bulk draw
+// Speeds are per second (the old per frame speeds at 60 frames per second)
+#define SEEK_SPEED        15.0f
+#define ATTACK_DAMAGE     1000.0f	// health lost per second for each monster in range
+
+static const float Monster_Type_Speed [WORLD_MONSTER_TYPES] = { 9.0f, 15.0f, 21.0f };
+
+/*____________________________________________________________________
+|
+| Function: World_Init
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Randomly places events, first aids, trees, flowers and
+|   monsters.  The same seed gives the same world on every platform.
+|___________________________________________________________________*/
+
+bool World_Init (World *world, unsigned seed)
+{
+	memset (world, 0, sizeof(World));
+	world->seed = seed;
+	Rng_Seed (&world->layout_rng, seed, RNG_STREAM_LAYOUT);
+	Rng_Seed (&world->spawn_rng, seed, RNG_STREAM_SPAWN);
+
+	if (!MonsterPool_Init (&world->monsters, WORLD_MONSTER_TYPES * WORLD_START_MONSTERS))
+		return (false);
+	if (!SpatialGrid_Init (&world->monster_grid, -WORLD_HALF_SIZE, WORLD_HALF_SIZE, WORLD_GRID_CELL_SIZE, world->monsters.capacity))
+		return (false);
+	if (!SpatialGrid_Init (&world->pickup_grid, -WORLD_HALF_SIZE, WORLD_HALF_SIZE, WORLD_GRID_CELL_SIZE, WORLD_MAX_EVENTS))
+		return (false);
+	if (!SpatialGrid_Init (&world->tree_grid, -WORLD_HALF_SIZE, WORLD_HALF_SIZE, WORLD_GRID_CELL_SIZE, WORLD_MAX_TREES))
+		return (false);
+	if (!Spawn_Init (&world->spawn_region, &world->monster_grid, WORLD_SPAWN_DIST))
+		return (false);
+	world->cell_stamp = (unsigned *) calloc (world->monster_grid.cells * world->monster_grid.cells, sizeof(unsigned));
+	if (world->cell_stamp == NULL)
+		return (false);
+	world->monster_kernel = MonsterKernel_Best ();
+
+	world->health = WORLD_MAX_HEALTH;
+
+	// Create events coordinates at random and place first aids at them
+	for (int i = 0; i < WORLD_MAX_EVENTS; i++) {
+		world->event_x[i] = Rng_Range (&world->layout_rng, -WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+		world->event_y[i] = 0;
+		world->event_z[i] = Rng_Range (&world->layout_rng, -WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+		world->first_aid_x[i] = world->event_x[i] + 5;
+		world->first_aid_z[i] = world->event_z[i] + 5;
+		SpatialGrid_Insert (&world->pickup_grid, i, world->first_aid_x[i], world->first_aid_z[i]);
+	}
+	// Trees
+	Rng_Fill_Float_Range (&world->layout_rng, world->tree_x, WORLD_MAX_TREES, -WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+	Rng_Fill_Float_Range (&world->layout_rng, world->tree_z, WORLD_MAX_TREES, -WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+	for (int i = 0; i < WORLD_MAX_TREES; i++)
+		SpatialGrid_Insert (&world->tree_grid, i, world->tree_x[i], world->tree_z[i]);
+	// Flowers
+	Rng_Fill_Float_Range (&world->layout_rng, world->flower_x, WORLD_MAX_FLOWERS, -WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+	Rng_Fill_Float_Range (&world->layout_rng, world->flower_z, WORLD_MAX_FLOWERS, -WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+	// Monsters
+	for (int i = 0; i < WORLD_MONSTER_TYPES; i++) {
+		world->monster_center_y[i] = 0;
+		world->monster_radius[i] = 1;
+		World_Spawn_Monsters (world, i, WORLD_START_MONSTERS);
+	}
+
+	return (world->monsters.count == WORLD_MONSTER_TYPES * WORLD_START_MONSTERS);
+}
+
+/*____________________________________________________________________
+|
+| Function: World_Free
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Frees any resources used by the world.
+|___________________________________________________________________*/
+
+void World_Free (World *world)
+{
+	MonsterPool_Free (&world->monsters);
+	SpatialGrid_Free (&world->monster_grid);
+	SpatialGrid_Free (&world->pickup_grid);
+	SpatialGrid_Free (&world->tree_grid);
+	Spawn_Free (&world->spawn_region);
+	free (world->cell_stamp);
+	world->cell_stamp = NULL;
+	if (world->arrived)
+		free (world->arrived);
+	world->arrived = NULL;
+	world->arrived_capacity = 0;
+}
+
+/*____________________________________________________________________
+|
+| Function: World_Spawn_Monsters
+|
+| Input: Called from World_Init(), headless driver
+| Output: Adds count monsters of a type at random positions in the
+|   play area.  Returns # of monsters spawned.
+|___________________________________________________________________*/
+
+int World_Spawn_Monsters (World *world, int type, int count)
+{
+	float position[2 * SPAWN_BATCH];	// x, z pairs
+	int n, index;
+
+	if (!MonsterPool_Reserve (&world->monsters, world->monsters.count + count))
+		return (0);
+	if (!SpatialGrid_Reserve (&world->monster_grid, world->monsters.capacity))
+		return (0);
+
+	for (n = 0; n < count; n++) {
+		if (n % SPAWN_BATCH == 0)
+			Rng_Fill_Float_Range (&world->spawn_rng, position, 2 * (count - n < SPAWN_BATCH ? count - n : SPAWN_BATCH), -WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+		float x = position[2 * (n % SPAWN_BATCH)];
+		float z = position[2 * (n % SPAWN_BATCH) + 1];
+		index = MonsterPool_Add (&world->monsters, type, x, z, Monster_Type_Speed[type]);
+		if (index < 0)
+			break;
+		SpatialGrid_Insert (&world->monster_grid, index, x, z);
+	}
+
+	return (n);
+}
+
+/*____________________________________________________________________
+|
+| Function: World_Set_Monster_Kernel
+|
+| Input: Called from headless driver
+| Output: Selects which version of the monster update kernel to use.
+|___________________________________________________________________*/
+
+void World_Set_Monster_Kernel (World *world, MonsterKernelType type)
+{
+	world->monster_kernel = type;
+}
+
+/*____________________________________________________________________
+|
+| Function: World_Set_Monster_Bounds
+|
+| Input: Called from Program_Run()
+| Output: Sets the bounding sphere (relative to the monster position)
+|   used when shooting at a monster type.
+|___________________________________________________________________*/
+
+void World_Set_Monster_Bounds (World *world, int type, float center_y, float radius)
+{
+	world->monster_center_y[type] = center_y;
+	world->monster_radius[type] = radius;
+}
+
+/*____________________________________________________________________
+|
+| Function: World_Set_Shot_Penetration
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Sets how many monsters behind the first one a shot hits.
+|___________________________________________________________________*/
+
+void World_Set_Shot_Penetration (World *world, int count)
+{
+	if (count < 0)
+		count = 0;
+	else if (count > WORLD_MAX_PENETRATION)
+		count = WORLD_MAX_PENETRATION;
+	world->shot_penetration = count;
+}
+
+/*____________________________________________________________________
+|
+| Function: World_Cast_Shot
+|
+| Input: Called from Process_Shots(), headless driver
+| Output: Walks the grid cells under the shot, nearest first, testing
+|   the trees and monsters in each cell and the cells around it (a
+|   monster or trunk can stick out of its cell into the path), each
+|   cell once.  Stops once nothing unseen can be closer than what was
+|   already hit: the first tree, or the last monster the shot can pass
+|   through.
+|___________________________________________________________________*/
+
+void World_Cast_Shot (World *world, const WorldVector *origin, const WorldVector *dir, WorldShot *shot)
+{
+	MonsterPool *monsters = &world->monsters;
+	const SpatialGrid *grid = &world->monster_grid;
+	float o[3] = { origin->x, origin->y, origin->z };
+	float d[3] = { dir->x, dir->y, dir->z };
+	int max_hits = world->shot_penetration + 1;
+	HitscanWalk walk;
+	int cx, cz;
+	float t_exit;
+
+	shot->num_monsters = 0;
+	shot->blocked = -1;
+	shot->cells = 0;
+
+	// New mark for the cells this shot looks at
+	if (++world->shot_stamp == 0) {
+		memset (world->cell_stamp, 0, grid->cells * grid->cells * sizeof(unsigned));
+		world->shot_stamp = 1;
+	}
+
+	Hitscan_Begin (&walk, grid, o[0], o[2], d[0], d[2], WORLD_SHOT_RANGE);
+	while (Hitscan_Next (&walk, &cx, &cz, &t_exit)) {
+		shot->cells++;
+		for (int j = cz - 1; j <= cz + 1; j++) {
+			if (j < 0 || j >= grid->cells)
+				continue;
+			for (int i = cx - 1; i <= cx + 1; i++) {
+				if (i < 0 || i >= grid->cells)
+					continue;
+				int cell = j * grid->cells + i;
+				if (world->cell_stamp[cell] == world->shot_stamp)
+					continue;
+				world->cell_stamp[cell] = world->shot_stamp;
+				for (int id = world->tree_grid.head[cell]; id != -1; id = world->tree_grid.next[id]) {
+					float t = Hitscan_Ray_Cylinder (o, d, world->tree_x[id], world->tree_z[id], WORLD_TREE_RADIUS);
+					if (t >= 0 && t <= WORLD_SHOT_RANGE && (shot->blocked < 0 || t < shot->blocked))
+						shot->blocked = t;
+				}
+				for (int id = grid->head[cell]; id != -1; id = grid->next[id]) {
+					int type = monsters->type[id];
+					float center[3] = { monsters->x[id], world->monster_center_y[type], monsters->z[id] };
+					float t = Hitscan_Ray_Sphere (o, d, center, world->monster_radius[type]);
+					if (t >= 0 && t <= WORLD_SHOT_RANGE)
+						Add_Shot_Hit (shot, id, t, max_hits);
+				}
+			}
+		}
+		// Monsters behind the tree are safe
+		if (shot->blocked >= 0)
+			while (shot->num_monsters && shot->distance[shot->num_monsters - 1] >= shot->blocked)
+				shot->num_monsters--;
+		// Everything that can be hit before t_exit has been tested
+		if (shot->blocked >= 0 && shot->blocked <= t_exit)
+			break;
+		if (shot->num_monsters == max_hits && shot->distance[max_hits - 1] <= t_exit)
+			break;
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Add_Shot_Hit
+|
+| Input: Called from World_Cast_Shot()
+| Output: Adds a monster to the shot's hits, kept nearest first, if it's
+|   one of the max_hits nearest so far.  Ties (a shot fired from inside
+|   several monsters) go to the lowest index, so the result doesn't
+|   depend on the order the cells are walked.
+|___________________________________________________________________*/
+
+static void Add_Shot_Hit (WorldShot *shot, int index, float distance, int max_hits)
+{
+	int i;
+
+	if (shot->blocked >= 0 && distance >= shot->blocked)
+		return;
+	if (shot->num_monsters == max_hits) {
+		if (distance > shot->distance[max_hits - 1] ||
+			(distance == shot->distance[max_hits - 1] && index > shot->monsters[max_hits - 1]))
+			return;
+		shot->num_monsters--;
+	}
+	for (i = shot->num_monsters; i > 0 && (shot->distance[i - 1] > distance ||
+		(shot->distance[i - 1] == distance && shot->monsters[i - 1] > index)); i--) {
+		shot->monsters[i] = shot->monsters[i - 1];
+		shot->distance[i] = shot->distance[i - 1];
+	}
+	shot->monsters[i] = index;
+	shot->distance[i] = distance;
+	shot->num_monsters++;
+}
+
+/*____________________________________________________________________
+|
+| Function: World_Step
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Advances the simulation by time_step seconds.  Gives the same
+|   results for the same steps and inputs no matter how fast it's
+|   called, so the caller should call it at a fixed rate.
+|___________________________________________________________________*/
+
+void World_Step (
+	World            *world,
+	float             time_step,
+	const WorldInput *input,
+	WorldStepResult  *result )
+{
+	PROFILE_ZONE ("World_Step");
+	MonsterPool *monsters = &world->monsters;
+	WorldStepResult r;
+
+	memset (&r, 0, sizeof(r));
+
+	// Remember where monsters were so rendering can interpolate
+	memcpy (monsters->prev_x, monsters->x, monsters->count * sizeof(float));
+	memcpy (monsters->prev_z, monsters->z, monsters->count * sizeof(float));
+
+	Process_Shots (world, time_step, input, &r);
+	Collect_First_Aids (world, input, &r);
+	Update_Monsters (world, time_step, input, &r);
+	Update_Hit_Markers (world, time_step);
+
+	if (result)
+		*result = r;
+}
+
+/*____________________________________________________________________
+|
+| Function: Process_Shots
+|
+| Input: Called from World_Step()
+| Output: Damages the monsters each shot fired this step hits (the
+|   nearest one, plus any it passes through).
+|___________________________________________________________________*/
+
+static void Process_Shots (World *world, float time_step, const WorldInput *input, WorldStepResult *result)
+{
+	MonsterPool *monsters = &world->monsters;
+	WorldShot shot;
+	int kills[WORLD_MAX_PENETRATION + 1], num_kills;
+
+	for (int s = 0; s < input->shots; s++) {
+		World_Cast_Shot (world, &input->player_position, &input->player_heading, &shot);
+		num_kills = 0;
+		for (int h = 0; h < shot.num_monsters; h++) {
+			int k = shot.monsters[h];
+			result->hits++;
+			// increases the hit tracker
+			monsters->hits[k]++;
+			// Create a new hit marker
+			world->hit_position[world->hit_index].x = monsters->x[k];
+			world->hit_position[world->hit_index].y = world->monster_center_y[monsters->type[k]];
+			world->hit_position[world->hit_index].z = monsters->z[k];
+			world->hit_timer[world->hit_index] = WORLD_HIT_MARKER_TIME + time_step;
+			world->hit_index = (world->hit_index + 1) % WORLD_MAX_HIT;
+			// checks to see if the monster has been hit enough times, if so then kill it
+			if (monsters->hits[k] >= HITS_TO_KILL)
+				kills[num_kills++] = k;
+		}
+		// Kill highest index first, each kill moves the last monster into the slot
+		for (int i = 1; i < num_kills; i++)
+			for (int j = i; j > 0 && kills[j - 1] < kills[j]; j--) {
+				int k = kills[j];
+				kills[j] = kills[j - 1];
+				kills[j - 1] = k;
+			}
+		for (int i = 0; i < num_kills; i++) {
+			world->deadmonsters++;
+			result->kills++;
+			Kill_Monster (world, kills[i], &input->player_position);
+		}
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Kill_Monster
+|
+| Input: Called from Process_Shots()
+| Output: Despawns a monster (the last monster takes its slot) and
+|   spawns a replacement of the same type away from the player.
+|___________________________________________________________________*/
+
+static void Kill_Monster (World *world, int index, const WorldVector *position)
+{
+	MonsterPool *monsters = &world->monsters;
+	int type = monsters->type[index];
+	int last = monsters->count - 1;
+
+	SpatialGrid_Remove (&world->monster_grid, index);
+	MonsterPool_Remove (monsters, index);
+	SpatialGrid_Rename (&world->monster_grid, last, index);
+
+	index = MonsterPool_Add (monsters, type, 0, 0, Monster_Type_Speed[type]);
+	if (index >= 0)
+		Respawn_Monsters (world, &index, 1, position);
+}
+
+/*____________________________________________________________________
+|
+| Function: Collect_First_Aids
+|
+| Input: Called from World_Step()
+| Output: Picks up any first aids the moving player is close to.  Only
+|   looks at first aids in nearby grid cells.
+|___________________________________________________________________*/
+
+static void Collect_First_Aids (World *world, const WorldInput *input, WorldStepResult *result)
+{
+	int found[WORLD_MAX_EVENTS], n;
+
+	if (!input->moving)
+		return;
+
+	n = SpatialGrid_Query_Radius (&world->pickup_grid, input->player_position.x, input->player_position.z, WORLD_COLLECT_DIST,
+		world->first_aid_x, world->first_aid_z, found, WORLD_MAX_EVENTS);
+	for (int f = 0; f < n; f++) {
+		int i = found[f];
+		SpatialGrid_Remove (&world->pickup_grid, i);
+		result->first_aids_collected++;
+		world->first_aid_collected[i] = true;
+		// move it out of the play area
+		world->first_aid_x[i] = 2000.0;
+		world->first_aid_z[i] = 2000.0;
+		if (world->health <= WORLD_MAX_HEALTH - 500)
+			world->health += 500;
+		else
+			world->health = WORLD_MAX_HEALTH;
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Update_Monsters
+|
+| Input: Called from World_Step()
+| Output: Moves monsters toward the player if close (or if they have
+|   been shot), otherwise toward their assigned event.  Close monsters
+|   damage the player.  The per-monster work is done in a batch by the
+|   monster kernel.
+|___________________________________________________________________*/
+
+static void Update_Monsters (World *world, float time_step, const WorldInput *input, WorldStepResult *result)
+{
+	PROFILE_ZONE ("Monster AI");
+	MonsterPool *monsters = &world->monsters;
+	MonsterKernelParams params;
+	MonsterKernelResult kr;
+	float event_x[WORLD_MONSTER_TYPES], event_z[WORLD_MONSTER_TYPES];
+
+	// Make sure there is room to report every monster as arrived
+	if (world->arrived_capacity < monsters->capacity) {
+		int *arrived = (int *) realloc (world->arrived, monsters->capacity * sizeof(int));
+		if (arrived == NULL)
+			return;
+		world->arrived = arrived;
+		world->arrived_capacity = monsters->capacity;
+	}
+
+	// Monster type 1 seeks event1, type 2 seeks event2, etc..
+	for (int i = 0; i < WORLD_MONSTER_TYPES; i++) {
+		event_x[i] = (float) world->event_x[i];
+		event_z[i] = (float) world->event_z[i];
+	}
+
+	params.player_x    = input->player_position.x;
+	params.player_z    = input->player_position.z;
+	params.event_x     = event_x;
+	params.event_z     = event_z;
+	params.aggro_dist  = WORLD_AGGRO_DIST;
+	params.stop_dist   = 10;
+	params.attack_dist = WORLD_ATTACK_DIST;
+	params.growl_dist  = WORLD_GROWL_DIST;
+	params.arrive_dist = 5;
+	params.seek_speed  = SEEK_SPEED;
+	params.time_step   = time_step;
+	kr.arrived = world->arrived;
+
+	MonsterKernel_Update (world->monster_kernel, monsters, &params, &kr);
+
+	// close monsters damage the player
+	world->health -= kr.attackers * ATTACK_DAMAGE * time_step;
+	result->damage += kr.attackers * ATTACK_DAMAGE * time_step;
+
+	// monsters that reached their event are relocated to a random coordinate
+	Respawn_Monsters (world, kr.arrived, kr.num_arrived, &input->player_position);
+
+	Update_Monster_Grid (world);
+}
+
+/*____________________________________________________________________
+|
+| Function: Respawn_Monsters
+|
+| Input: Called from Kill_Monster(), Update_Monsters()
+| Output: Moves monsters to random spots in the game area at least
+|   WORLD_SPAWN_DIST from the player, in time proportional to count.
+|___________________________________________________________________*/
+
+static void Respawn_Monsters (World *world, const int *indices, int count, const WorldVector *position)
+{
+	MonsterPool *monsters = &world->monsters;
+	float xs[SPAWN_BATCH], zs[SPAWN_BATCH];
+
+	if (count == 0)
+		return;
+
+	Spawn_Set_Center (&world->spawn_region, position->x, position->z);
+	for (int first = 0; first < count; first += SPAWN_BATCH) {
+		int n = count - first < SPAWN_BATCH ? count - first : SPAWN_BATCH;
+		Spawn_Points (&world->spawn_region, &world->spawn_rng, xs, zs, n);
+		for (int i = 0; i < n; i++) {
+			int index = indices[first + i];
+			MonsterPool_Place (monsters, index, xs[i], zs[i]);
+			monsters->hits[index] = 0;
+			SpatialGrid_Update (&world->monster_grid, index, xs[i], zs[i]);
+		}
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: Update_Monster_Grid
+|
+| Input: Called from Update_Monsters()
+| Output: Moves monsters that crossed into a new cell to that cell's
+|   list (monsters that stayed in their cell aren't touched).
+|___________________________________________________________________*/
+
+static void Update_Monster_Grid (World *world)
+{
+	MonsterPool *monsters = &world->monsters;
+
+	for (int k = 0; k < monsters->count; k++)
+		SpatialGrid_Update (&world->monster_grid, k, monsters->x[k], monsters->z[k]);
+}
+
+/*____________________________________________________________________
+|
+| Function: Update_Hit_Markers
+|
+| Input: Called from World_Step()
+| Output: Counts down active hit markers.
+|___________________________________________________________________*/
+
+static void Update_Hit_Markers (World *world, float time_step)
+{
+	for (int i = 0; i < WORLD_MAX_HIT; i++) {
+		if (world->hit_timer[i] > 0)
+			world->hit_timer[i] -= time_step;
+	}
+}
+
+/*____________________________________________________________________
+|
+| Function: World_Monster_Render_Position
+|
+| Input: Called from Program_Run()
+| Output: Returns in x,z where to draw a monster between simulation
+|   steps (alpha 0 is its position before the last step, 1 its current
+|   position).
+|___________________________________________________________________*/
+
+void World_Monster_Render_Position (const World *world, int index, float alpha, float *x, float *z)
+{
+	const MonsterPool *monsters = &world->monsters;
+
+	*x = monsters->prev_x[index] + ((monsters->x[index] - monsters->prev_x[index]) * alpha);
+	*z = monsters->prev_z[index] + ((monsters->z[index] - monsters->prev_z[index]) * alpha);
+}
+
+/*____________________________________________________________________
+|
+| Function: World_All_First_Aids_Collected
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Returns true if every first aid has been picked up.
+|___________________________________________________________________*/
+
+bool World_All_First_Aids_Collected (const World *world)
+{
+	for (int i = 0; i < WORLD_MAX_EVENTS; i++)
+		if (!world->first_aid_collected[i])
+			return (false);
+	return (true);
+}
+
+/*____________________________________________________________________
+|
+| Function: World_Monsters_In_Radius
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Returns # of monsters within radius of x,z and writes up to
+|   max_out of their pool indices to out.
+|___________________________________________________________________*/
+
+int World_Monsters_In_Radius (const World *world, float x, float z, float radius, int *out, int max_out)
+{
+	return (SpatialGrid_Query_Radius (&world->monster_grid, x, z, radius, world->monsters.x, world->monsters.z, out, max_out));
+}
+
+/*____________________________________________________________________
+|
+| Function: World_Nearest_Monster
+|
+| Input: Called from Program_Run(), headless driver
+| Output: Returns pool index of the closest monster within max_radius of
+|   x,z or -1 if none.
+|___________________________________________________________________*/
+
+int World_Nearest_Monster (const World *world, float x, float z, float max_radius, float *dist)
+{
+	return (SpatialGrid_Query_Nearest (&world->monster_grid, x, z, max_radius, world->monsters.x, world->monsters.z, dist));
+}
@@ -0,0 +1,164 @@
+/*____________________________________________________________________
+|
+| File: world.h
+|
+| Description: Platform independent game simulation (monsters, scenery,
+|   events, first aids, player health).  Has no dependency on dp.h or
+|   any of the gx/snd/ev libraries so it can be built and run headless.
+|
+| (C) Copyright 2013 Abonvita Software LLC.
+| Licensed under the GX Toolkit License, Version 1.0.
+|___________________________________________________________________*/
+
+#ifndef _WORLD_H_
+#define _WORLD_H_
+
+#include "monster_pool.h"
+#include "monster_kernel.h"
+#include "spatial_grid.h"
+#include "rng.h"
+#include "spawn.h"
+#include "hitscan.h"
+
+/*___________________
+|
+| Constants
+|__________________*/
+
+#define WORLD_MONSTER_TYPES   3
+#define WORLD_START_MONSTERS  25      // per monster type, more can be spawned at runtime
+#define WORLD_MAX_TREES       150
+#define WORLD_MAX_FLOWERS     400
+#define WORLD_MAX_EVENTS      3
+#define WORLD_MAX_HIT         25
+#define WORLD_MAX_HEALTH      3000.0f
+#define WORLD_HALF_SIZE       750     // play area is +/- this in x and z
+
+#define WORLD_AGGRO_DIST      150     // monsters closer than this chase the player
+#define WORLD_ATTACK_DIST     15      // monsters closer than this damage the player
+#define WORLD_GROWL_DIST      75      // chasing monsters closer than this growl
+#define WORLD_COLLECT_DIST    10      // player closer than this collects a first aid
+#define WORLD_SPAWN_DIST      250     // respawned monsters are placed at least this far away
+#define WORLD_GRID_CELL_SIZE  50      // size of a spatial grid cell
+#define WORLD_HIT_MARKER_TIME 1.0f    // seconds a hit marker stays on screen
+#define WORLD_SHOT_RANGE      2200    // farther than across the play area
+#define WORLD_TREE_RADIUS     2.0f    // tree trunks stop shots
+#define WORLD_MAX_PENETRATION 8       // most extra monsters one shot can pass through
+
+/*___________________
+|
+| Type definitions
+|__________________*/
+
+typedef struct {
+	float x, y, z;
+} WorldVector;
+
+// Input to a single simulation step
+typedef struct {
+	WorldVector player_position;
+	WorldVector player_heading;    // normalized view direction, used for shots
+	bool        moving;            // true if the player is moving this step
+	int         shots;             // # of shots fired this step
+} WorldInput;
+
+// What a shot hits, nearest first
+typedef struct {
+	int   monsters[WORLD_MAX_PENETRATION + 1];     // monster pool indices
+	float distance[WORLD_MAX_PENETRATION + 1];
+	int   num_monsters;
+	float blocked;                 // distance to the tree that stopped it, -1 if none
+	int   cells;                   // # of grid cells walked
+} WorldShot;
+
+// Things that happened during a single simulation step (for sounds, etc.)
+typedef struct {
+	int hits;                      // # of monsters hit by shots
+	int kills;                     // # of monsters killed
+	int first_aids_collected;      // # of first aids picked up
+	float damage;                  // health lost
+} WorldStepResult;
+
+typedef struct {
+	// Random streams (seeded from one master seed)
+	unsigned seed;
+	Rng   layout_rng;                                              // events, scenery
+	Rng   spawn_rng;                                               // monster placement
+	// Player
+	float health;
+	int   deadmonsters;
+	// Monsters
+	MonsterPool monsters;
+	float monster_center_y[WORLD_MONSTER_TYPES];                   // bounding sphere of each monster type
+	float monster_radius[WORLD_MONSTER_TYPES];
+	MonsterKernelType monster_kernel;                              // batch update to use
+	int  *arrived;                                                 // scratch for monster kernel
+	int   arrived_capacity;
+	SpatialGrid monster_grid;                                      // monster pool indices by position
+	SpawnRegion spawn_region;                                      // respawn points away from the player
+	int   shot_penetration;                                        // extra monsters a shot passes through
+	unsigned *cell_stamp;                                          // per grid cell: last shot that looked at it
+	unsigned  shot_stamp;
+	// Scenery
+	float tree_x[WORLD_MAX_TREES];
+	float tree_z[WORLD_MAX_TREES];
+	float flower_x[WORLD_MAX_FLOWERS];
+	float flower_z[WORLD_MAX_FLOWERS];
+	SpatialGrid tree_grid;                                         // tree indices, same cells as monster_grid
+	// Events
+	int   event_x[WORLD_MAX_EVENTS];
+	int   event_y[WORLD_MAX_EVENTS];
+	int   event_z[WORLD_MAX_EVENTS];
+	float first_aid_x[WORLD_MAX_EVENTS];
+	float first_aid_z[WORLD_MAX_EVENTS];
+	bool  first_aid_collected[WORLD_MAX_EVENTS];
+	SpatialGrid pickup_grid;                                       // first aids not yet collected
+	// Hit markers
+	WorldVector hit_position[WORLD_MAX_HIT];
+	float       hit_timer[WORLD_MAX_HIT];    // seconds remaining, <= 0 if not active
+	int         hit_index;
+} World;
+
+/*___________________
+|
+| Functions
+|__________________*/
+
+// Randomly places events, scenery and monsters, the same way for the same seed.  Returns true on success, else false.
+bool World_Init (World *world, unsigned seed);
+void World_Free (World *world);
+
+// Adds count monsters of a type at random positions, returns # actually spawned
+int World_Spawn_Monsters (World *world, int type, int count);
+
+// Selects the monster update kernel (defaults to the fastest supported)
+void World_Set_Monster_Kernel (World *world, MonsterKernelType type);
+
+// Sets the bounding sphere used for shooting a monster type (radius at most WORLD_GRID_CELL_SIZE)
+void World_Set_Monster_Bounds (World *world, int type, float center_y, float radius);
+
+// Sets how many monsters behind the first a shot also hits (0 to WORLD_MAX_PENETRATION)
+void World_Set_Shot_Penetration (World *world, int count);
+
+// Finds what a shot from origin along dir (normalized) hits, in time
+//   proportional to the # of grid cells it crosses
+void World_Cast_Shot (World *world, const WorldVector *origin, const WorldVector *dir, WorldShot *shot);
+
+// Advance the simulation by one fixed time step
+void World_Step (
+	World           *world,
+	float            time_step,      // seconds
+	const WorldInput *input,
+	WorldStepResult *result );       // can be NULL
+
+// Returns where to draw a monster, alpha of the way (0-1) from its position
+//   before the last step to its current position
+void World_Monster_Render_Position (const World *world, int index, float alpha, float *x, float *z);
+
+bool World_All_First_Aids_Collected (const World *world);
+
+// Proximity queries (use the spatial grid, cost depends on local density only)
+int  World_Monsters_In_Radius (const World *world, float x, float z, float radius, int *out, int max_out);
+int  World_Nearest_Monster (const World *world, float x, float z, float max_radius, float *dist);
+
+#endif